@@ -0,0 +1,230 @@
+/**
+ * Tokenized log decoding (FRAME_LOG, see src/utils/tlog.h)
+ *
+ * The firmware sends TLOG() messages as a 32-bit format-string hash plus
+ * packed arguments. scripts/tlog_db.py writes the hash -> format table at
+ * build time (.pio/build/esp32-s3/tlog_tokens.json); this module turns a
+ * payload back into text using that table.
+ *
+ * Payload (LogPayload in binary_protocol.h):
+ *   [0-3]  timestamp_ms (uint32 LE)
+ *   [4-7]  token (uint32 LE, FNV-1a of the format string)
+ *   [8..]  arguments, in format order:
+ *          integers  zigzag varint
+ *          floats    float32 LE
+ *          strings   u8 length + bytes
+ *
+ * Standalone, decodes the log frames of a raw serial capture:
+ *   pnpm detokenize capture.bin [tlog_tokens.json]
+ */
+
+import { existsSync, readFileSync } from 'fs';
+import path from 'path';
+import type { LogMessage } from '../src/lib/types';
+
+export const DEFAULT_TOKEN_DB = process.env.TLOG_DB ||
+  path.join(__dirname, '..', '..', '.pio', 'build', 'esp32-s3', 'tlog_tokens.json');
+
+const FRAME_HEADER_WORD = 0xAA66;
+const FRAME_TYPE_LOG = 0x06;
+
+// printf conversion: flags, width, precision, length modifier, specifier
+const SPEC = /%([-+ 0#]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z)?([diuxXcsfFeEgG%])/g;
+
+export type TokenDb = Map<number, string>;
+
+/**
+ * Load tlog_tokens.json (empty table if the file does not exist)
+ */
+export function loadTokenDb(file = DEFAULT_TOKEN_DB): TokenDb {
+  const db: TokenDb = new Map();
+  if (!existsSync(file)) {
+    return db;
+  }
+  const json = JSON.parse(readFileSync(file, 'utf8'));
+  for (const [token, fmt] of Object.entries<string>(json.tokens ?? {})) {
+    db.set(parseInt(token, 16) >>> 0, fmt);
+  }
+  return db;
+}
+
+/**
+ * Sequential reader over the packed arguments (undefined once exhausted)
+ */
+class ArgReader {
+  private offset = 0;
+
+  constructor(private readonly buf: Buffer) {}
+
+  // Exact up to 2^53, far beyond anything the firmware logs
+  int(): number | undefined {
+    let value = 0;
+    let scale = 1;
+    while (this.offset < this.buf.length) {
+      const byte = this.buf[this.offset++];
+      value += (byte & 0x7F) * scale;
+      if ((byte & 0x80) === 0) {
+        return value % 2 === 1 ? -(value + 1) / 2 : value / 2;
+      }
+      scale *= 128;
+    }
+    return undefined;
+  }
+
+  float(): number | undefined {
+    if (this.offset + 4 > this.buf.length) {
+      return undefined;
+    }
+    const value = this.buf.readFloatLE(this.offset);
+    this.offset += 4;
+    return value;
+  }
+
+  str(): string | undefined {
+    if (this.offset >= this.buf.length) {
+      return undefined;
+    }
+    const len = this.buf[this.offset];
+    if (this.offset + 1 + len > this.buf.length) {
+      return undefined;
+    }
+    const value = this.buf.toString('utf8', this.offset + 1, this.offset + 1 + len);
+    this.offset += 1 + len;
+    return value;
+  }
+}
+
+function pad(text: string, flags: string, width?: string): string {
+  const w = width ? parseInt(width, 10) : 0;
+  if (text.length >= w) {
+    return text;
+  }
+  if (flags.includes('-')) {
+    return text.padEnd(w);
+  }
+  if (flags.includes('0') && /^[-+ ]?[0-9]/.test(text)) {
+    const sign = /^[-+ ]/.test(text) ? text[0] : '';
+    return sign + text.slice(sign.length).padStart(w - sign.length, '0');
+  }
+  return text.padStart(w);
+}
+
+function withSign(text: string, flags: string): string {
+  if (text.startsWith('-')) return text;
+  if (flags.includes('+')) return '+' + text;
+  if (flags.includes(' ')) return ' ' + text;
+  return text;
+}
+
+/**
+ * Format the arguments against a printf format string
+ */
+export function formatArgs(fmt: string, args: Buffer): string {
+  const reader = new ArgReader(args);
+  return fmt.replace(SPEC, (_m, flags: string, width: string | undefined,
+    precision: string | undefined, length: string | undefined, spec: string) => {
+    if (spec === '%') {
+      return '%';
+    }
+    let text: string;
+    if ('diuxXc'.includes(spec)) {
+      const value = reader.int();
+      if (value === undefined) return '<?>';
+      if (spec === 'c') {
+        text = String.fromCharCode(value & 0xFF);
+      } else if (spec === 'x' || spec === 'X') {
+        // Negative values print as the two's complement of the argument width
+        const bits = length === 'll' ? 64 : length === 'hh' ? 8 : length === 'h' ? 16 : 32;
+        const unsigned = value < 0 ? value + Math.pow(2, bits) : value;
+        text = unsigned.toString(16);
+        if (spec === 'X') text = text.toUpperCase();
+        if (flags.includes('#') && unsigned !== 0) text = '0x' + text;
+      } else {
+        text = withSign(value.toString(), flags);
+      }
+    } else if (spec === 's') {
+      const value = reader.str();
+      if (value === undefined) return '<?>';
+      text = precision !== undefined ? value.slice(0, parseInt(precision, 10)) : value;
+    } else {
+      const value = reader.float();
+      if (value === undefined) return '<?>';
+      const digits = precision !== undefined ? parseInt(precision, 10) : 6;
+      if (spec === 'f' || spec === 'F') {
+        text = value.toFixed(digits);
+      } else if (spec === 'e' || spec === 'E') {
+        text = value.toExponential(digits).replace(/e([+-])(\d)$/, 'e$10$2');
+      } else {
+        text = String(Number(value.toPrecision(Math.max(digits, 1))));
+      }
+      if (spec === spec.toUpperCase()) text = text.toUpperCase();
+      text = withSign(text, flags);
+    }
+    return pad(text, flags, width);
+  });
+}
+
+/**
+ * Decode a FRAME_LOG payload (LogPayload in binary_protocol.h)
+ */
+export function detokenize(payload: Buffer, db: TokenDb): LogMessage {
+  const time_ms = payload.readUInt32LE(0);
+  const token = payload.readUInt32LE(4);
+  const args = payload.subarray(8);
+  const fmt = db.get(token);
+  const text = fmt !== undefined
+    ? formatArgs(fmt, args)
+    : `<token 0x${token.toString(16).padStart(8, '0')}, ${args.length} arg bytes: ${args.toString('hex')}>`;
+  return { time_ms, token, text, known: fmt !== undefined };
+}
+
+/**
+ * CRC-16-CCITT (same as calculateCRC16 in binary_protocol.h)
+ */
+function crc16(data: Buffer): number {
+  let crc = 0xFFFF;
+  for (let i = 0; i < data.length; i++) {
+    crc ^= data[i] << 8;
+    for (let bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc & 0xFFFF;
+}
+
+/**
+ * Extract every valid FRAME_LOG payload from a raw serial capture
+ */
+export function* logFramesIn(capture: Buffer): Generator<Buffer> {
+  for (let i = 0; i + 5 <= capture.length; i++) {
+    if (capture.readUInt16LE(i) !== FRAME_HEADER_WORD || capture[i + 2] !== FRAME_TYPE_LOG) {
+      continue;
+    }
+    const length = capture.readUInt16LE(i + 3);
+    const end = i + 5 + length;
+    if (length < 8 || end + 2 > capture.length) {
+      continue;
+    }
+    if (crc16(capture.subarray(i + 2, end)) !== capture.readUInt16LE(end)) {
+      continue;
+    }
+    yield capture.subarray(i + 5, end);
+    i = end + 1;
+  }
+}
+
+if (process.argv[1]?.endsWith('detokenize.ts')) {
+  const [capturePath, dbPath] = process.argv.slice(2);
+  if (!capturePath) {
+    console.error('Usage: pnpm detokenize <capture.bin> [tlog_tokens.json]');
+    process.exit(1);
+  }
+  const db = loadTokenDb(dbPath ?? DEFAULT_TOKEN_DB);
+  if (db.size === 0) {
+    console.warn('⚠️  No token database loaded, messages print as raw tokens');
+  }
+  for (const payload of logFramesIn(readFileSync(capturePath))) {
+    const message = detokenize(payload, db);
+    console.log(`[${(message.time_ms / 1000).toFixed(3)}] ${message.text}`);
+  }
+}
@@ -0,0 +1,393 @@
+/**
+ * Typed frame decoding for the ESP32 binary protocol
+ *
+ * Besides the periodic 0xAA55 DataPacket, the firmware sends typed frames:
+ *   [0-1]  header (0xAA66 as uint16 LE)
+ *   [2]    type (FrameType)
+ *   [3-4]  payload length (uint16 LE)
+ *   [5..]  payload
+ *   [..]   crc (uint16 LE, CRC-16-CCITT over type, length and payload)
+ *
+ * See src/utils/binary_protocol.h for the firmware side.
+ */
+
+import type {
+  DeviceInfo,
+  LoopTiming,
+  LoopTimingEntry,
+  MotorStats,
+  MotorStatsEntry,
+  PacketField,
+  ScanSample,
+  ScanSamples,
+  SensorHealth,
+  SensorHealthEntry,
+  StateEvent,
+  StatsChannel,
+  StatsSummary,
+  WatchdogDiag,
+} from '../src/lib/types';
+
+export const FRAME_HEADER_WORD = 0xAA66;
+export const FRAME_HEADER_SIZE = 5;
+export const FRAME_CRC_SIZE = 2;
+export const FRAME_MAX_PAYLOAD = 256;
+
+export enum FrameType {
+  DEVICE_INFO = 0x01,
+  STATE_EVENT = 0x02,
+  WATCHDOG_DIAG = 0x03,
+  LOOP_TIMING = 0x04,
+  STATS_SUMMARY = 0x05,
+  LOG = 0x06,
+  SCAN_SAMPLES = 0x07,
+  MOTOR_STATS = 0x08,
+  SENSOR_HEALTH = 0x09,
+}
+
+// StatsKind names (telemetry_stats.h)
+const STATS_KINDS = ['pad_pct', 'duty', 'error', 'distance'] as const;
+const STATS_BUCKETS = 8;
+const STATS_CHANNEL_SIZE = 38;
+
+const SCAN_SAMPLE_SIZE = 12;
+
+// SweepMode names (param_registry.h)
+const SWEEP_MODES = ['forward', 'bidirectional', 'tracking', 'continuous'] as const;
+
+// SystemState and SafetyReason names (tof_sensor.h, safety_state_machine.h)
+const SYSTEM_STATES = ['NORMAL', 'DEFLATING', 'RELEASING', 'WAITING'] as const;
+const SAFETY_REASONS: Record<number, string> = {
+  1: 'out_of_bounds',
+  2: 'valid_reading',
+  3: 'pressure_released',
+  4: 'deflate_timeout',
+  5: 'release_done',
+};
+
+/**
+ * DataPacket field ids (DataField in binary_protocol.h)
+ */
+export enum DataField {
+  TIMESTAMP_MS = 1,
+  SETPOINT_PCT,
+  PRESSURE_PCT,
+  DUTY_PCT,
+  TOF_CM,
+  SERVO_ANGLE,
+  TOF_CURRENT_CM,
+  MODE,
+  ACTIVE_SENSOR,
+  ULTRASONIC_CM,
+  TOF_RAW_CM,
+  FORCE_SCALE,
+  DISTANCE_SCALE,
+  DIST_CLOSE_MAX_CM,
+  DIST_MEDIUM_MAX_CM,
+  DIST_FAR_MAX_CM,
+  CRC,
+}
+
+export enum FieldType {
+  U8 = 1,
+  U16 = 2,
+  U32 = 3,
+  F32 = 4,
+}
+
+/**
+ * Layout of the 123-byte DataPacket used until a device info frame arrives
+ */
+export const DEFAULT_PACKET_SIZE = 123;
+export const DEFAULT_PACKET_LAYOUT: PacketField[] = [
+  { id: DataField.TIMESTAMP_MS, type: FieldType.U32, offset: 2, count: 1 },
+  { id: DataField.SETPOINT_PCT, type: FieldType.F32, offset: 6, count: 5 },
+  { id: DataField.PRESSURE_PCT, type: FieldType.F32, offset: 26, count: 5 },
+  { id: DataField.DUTY_PCT, type: FieldType.F32, offset: 46, count: 5 },
+  { id: DataField.TOF_CM, type: FieldType.F32, offset: 66, count: 5 },
+  { id: DataField.SERVO_ANGLE, type: FieldType.U8, offset: 86, count: 1 },
+  { id: DataField.TOF_CURRENT_CM, type: FieldType.F32, offset: 87, count: 1 },
+  { id: DataField.MODE, type: FieldType.U8, offset: 91, count: 1 },
+  { id: DataField.ACTIVE_SENSOR, type: FieldType.U8, offset: 92, count: 1 },
+  { id: DataField.ULTRASONIC_CM, type: FieldType.F32, offset: 93, count: 1 },
+  { id: DataField.TOF_RAW_CM, type: FieldType.F32, offset: 97, count: 1 },
+  { id: DataField.FORCE_SCALE, type: FieldType.F32, offset: 101, count: 1 },
+  { id: DataField.DISTANCE_SCALE, type: FieldType.F32, offset: 105, count: 1 },
+  { id: DataField.DIST_CLOSE_MAX_CM, type: FieldType.F32, offset: 109, count: 1 },
+  { id: DataField.DIST_MEDIUM_MAX_CM, type: FieldType.F32, offset: 113, count: 1 },
+  { id: DataField.DIST_FAR_MAX_CM, type: FieldType.F32, offset: 117, count: 1 },
+  { id: DataField.CRC, type: FieldType.U16, offset: 121, count: 1 },
+];
+
+/**
+ * Read one element of a described field
+ */
+export function readField(packet: Buffer, field: PacketField, index = 0): number {
+  switch (field.type) {
+    case FieldType.U8:
+      return packet.readUInt8(field.offset + index);
+    case FieldType.U16:
+      return packet.readUInt16LE(field.offset + index * 2);
+    case FieldType.U32:
+      return packet.readUInt32LE(field.offset + index * 4);
+    case FieldType.F32:
+      return packet.readFloatLE(field.offset + index * 4);
+    default:
+      return NaN;
+  }
+}
+
+/**
+ * Decode a FRAME_DEVICE_INFO payload (DeviceInfoPayload in binary_protocol.h)
+ */
+export function decodeDeviceInfo(payload: Buffer): DeviceInfo {
+  let o = 0;
+  const u8 = () => payload.readUInt8(o++);
+  const u16 = () => { const v = payload.readUInt16LE(o); o += 2; return v; };
+  const u32 = () => { const v = payload.readUInt32LE(o); o += 4; return v; };
+
+  const protocol_version = u8();
+  const motor_count = u8();
+  const pad_count = u8();
+  const pot_count = u8();
+  const control_mode = u8() === 1 ? 'newtons' : 'millivolts';
+  const sweep_mode = SWEEP_MODES[u8()] ?? 'forward';
+  const control_freq_hz = u16();
+  const logging_period_ms = u16();
+  const pwm_freq_hz = u32();
+  const pwm_res_bits = u8();
+  const outer_freq_hz = u8();
+  const sweep_estimated_ms = u16();
+  const sweep_enabled = u8() === 1;
+  const servo_min_angle = u8();
+  const servo_max_angle = u8();
+  const servo_step = u8();
+  const servo_manual_angle = u8();
+  const servo_settle_ms = u8();
+  const servo_reading_delay_ms = u8();
+  const sector_count = u8();
+
+  const mins = Array.from({ length: 5 }, () => u8());
+  const maxs = Array.from({ length: 5 }, () => u8());
+  const sectors = mins.slice(0, sector_count).map((min, i) => ({ min, max: maxs[i] }));
+
+  const git_hash = payload.subarray(o, o + 12).toString('ascii').replace(/\0.*$/, '');
+  o += 12;
+
+  const data_packet_header = u16();
+  const data_packet_size = u16();
+  const field_count = u8();
+  const fields: PacketField[] = [];
+  for (let i = 0; i < field_count; i++) {
+    fields.push({ id: u8(), type: u8(), offset: u8(), count: u8() });
+  }
+
+  return {
+    protocol_version,
+    motor_count,
+    pad_count,
+    pot_count,
+    control_mode,
+    sweep_mode,
+    control_freq_hz,
+    outer_freq_hz,
+    logging_period_ms,
+    pwm_freq_hz,
+    pwm_res_bits,
+    sweep_estimated_ms,
+    sweep_enabled,
+    servo_min_angle,
+    servo_max_angle,
+    servo_step,
+    servo_manual_angle,
+    servo_settle_ms,
+    servo_reading_delay_ms,
+    sectors,
+    git_hash,
+    data_packet_header,
+    data_packet_size,
+    fields,
+  };
+}
+
+/**
+ * Decode a FRAME_STATE_EVENT payload (StateEventPayload in binary_protocol.h)
+ */
+export function decodeStateEvent(payload: Buffer): StateEvent {
+  const from = payload.readUInt8(5);
+  const to = payload.readUInt8(6);
+  const reason = payload.readUInt8(7);
+  return {
+    time_ms: payload.readUInt32LE(0),
+    motor: payload.readUInt8(4),
+    from: SYSTEM_STATES[from] ?? `STATE_${from}`,
+    to: SYSTEM_STATES[to] ?? `STATE_${to}`,
+    reason: SAFETY_REASONS[reason] ?? `reason_${reason}`,
+    pressure_pct: payload.readFloatLE(8),
+    ticks_in_state: payload.readUInt16LE(12),
+    dropped: payload.readUInt16LE(14),
+  };
+}
+
+/**
+ * Decode a FRAME_WATCHDOG_DIAG payload (WatchdogDiagPayload in binary_protocol.h)
+ */
+export function decodeWatchdogDiag(payload: Buffer): WatchdogDiag {
+  return {
+    kicks: payload.readUInt32LE(0),
+    misses: payload.readUInt32LE(4),
+    late_ticks: payload.readUInt32LE(8),
+    worst_gap_us: payload.readUInt32LE(12),
+    last_gap_us: payload.readUInt32LE(16),
+    deadline_ms: payload.readUInt16LE(20),
+    armed: payload.readUInt8(22) === 1,
+    tripped: payload.readUInt8(23) === 1,
+    outer_kicks: payload.readUInt32LE(24),
+    outer_misses: payload.readUInt32LE(28),
+    outer_worst_gap_us: payload.readUInt32LE(32),
+    outer_deadline_ms: payload.readUInt16LE(36),
+    outer_tripped: payload.readUInt8(38) === 1,
+  };
+}
+
+function decodeLoopTimingEntry(payload: Buffer, o: number): LoopTimingEntry {
+  return {
+    rate_hz: payload.readUInt16LE(o),
+    ticks: payload.readUInt16LE(o + 2),
+    late_ticks: payload.readUInt16LE(o + 4),
+    overruns: payload.readUInt16LE(o + 6),
+    exec_avg_us: payload.readUInt16LE(o + 8),
+    exec_max_us: payload.readUInt16LE(o + 10),
+    period_max_us: payload.readUInt32LE(o + 12),
+  };
+}
+
+/**
+ * Decode a FRAME_LOOP_TIMING payload (LoopTimingPayload in binary_protocol.h)
+ */
+export function decodeLoopTiming(payload: Buffer): LoopTiming {
+  return {
+    inner: decodeLoopTimingEntry(payload, 0),
+    outer: decodeLoopTimingEntry(payload, 16),
+    torn_reads: payload.readUInt16LE(32),
+    stale_holds: payload.readUInt16LE(34),
+    mux_busy: payload.readUInt16LE(36),
+  };
+}
+
+/**
+ * Decode a FRAME_STATS_SUMMARY payload (StatsSummaryPayload in binary_protocol.h)
+ */
+export function decodeStatsSummary(payload: Buffer): StatsSummary {
+  const kind = payload.readUInt8(0);
+  const channelCount = payload.readUInt8(1);
+  const channels: StatsChannel[] = [];
+  for (let i = 0; i < channelCount; i++) {
+    const o = 12 + i * STATS_CHANNEL_SIZE;
+    channels.push({
+      count: payload.readUInt16LE(o),
+      mean: payload.readFloatLE(o + 2),
+      stddev: payload.readFloatLE(o + 6),
+      min: payload.readFloatLE(o + 10),
+      max: payload.readFloatLE(o + 14),
+      p95: payload.readFloatLE(o + 18),
+      histogram: Array.from({ length: STATS_BUCKETS }, (_, b) => payload.readUInt16LE(o + 22 + b * 2)),
+    });
+  }
+  return {
+    kind: STATS_KINDS[kind] ?? `kind_${kind}`,
+    window_ms: payload.readUInt16LE(2),
+    bucket_min: payload.readFloatLE(4),
+    bucket_width: payload.readFloatLE(8),
+    channels,
+  };
+}
+
+/**
+ * Decode a FRAME_SCAN_SAMPLES payload (ScanSamplesPayload in binary_protocol.h)
+ */
+export function decodeScanSamples(payload: Buffer): ScanSamples {
+  const firstSeq = payload.readUInt32LE(0);
+  const count = payload.readUInt8(8);
+  const samples: ScanSample[] = [];
+  for (let i = 0; i < count; i++) {
+    const o = 9 + i * SCAN_SAMPLE_SIZE;
+    samples.push({
+      seq: firstSeq + i,
+      time_ms: payload.readUInt32LE(o),
+      tof_cm: payload.readInt16LE(o + 4) / 10,
+      ultrasonic_cm: payload.readInt16LE(o + 6) / 10,
+      distance_cm: payload.readInt16LE(o + 8) / 10,
+      angle: payload.readUInt8(o + 10),
+      active_sensor: payload.readUInt8(o + 11),
+    });
+  }
+  return {
+    overflows: payload.readUInt32LE(4),
+    samples,
+  };
+}
+
+const MOTOR_STATS_ENTRY_SIZE = 48;
+const MOTOR_STATS_MOTORS = 5;
+
+/**
+ * Decode a FRAME_MOTOR_STATS payload (MotorStatsPayload in binary_protocol.h)
+ */
+export function decodeMotorStats(payload: Buffer): MotorStats {
+  const seconds = (o: number) => payload.readUInt32LE(o) / 10;
+  const motors: MotorStatsEntry[] = [];
+  for (let i = 0; i < MOTOR_STATS_MOTORS; i++) {
+    const o = 8 + i * MOTOR_STATS_ENTRY_SIZE;
+    motors.push({
+      forward_s: seconds(o),
+      reverse_s: seconds(o + 4),
+      brake_s: seconds(o + 8),
+      coast_s: seconds(o + 12),
+      duty_s: seconds(o + 16),
+      saturated_s: seconds(o + 20),
+      state_s: [0, 1, 2, 3].map((s) => seconds(o + 24 + s * 4)),
+      reversals: payload.readUInt32LE(o + 40),
+      brake_events: payload.readUInt32LE(o + 44),
+    });
+  }
+  return {
+    uptime_ms: payload.readUInt32LE(0),
+    emergency_brakes: payload.readUInt32LE(4),
+    motors,
+  };
+}
+
+const SENSOR_HEALTH_ENTRY_SIZE = 31;
+const SENSOR_STATUS = ['ok', 'no_target', 'failed'] as const;
+const SENSOR_FAULT = ['none', 'timeouts', 'checksums', 'stuck'] as const;
+const SWEEP_HEALTH_MODE = ['normal', 'ultrasonic_only', 'tof_only', 'blind'] as const;
+
+function decodeSensorHealthEntry(payload: Buffer, o: number): SensorHealthEntry {
+  return {
+    status: SENSOR_STATUS[payload.readUInt8(o)] ?? 'failed',
+    fault: SENSOR_FAULT[payload.readUInt8(o + 1)] ?? 'none',
+    rate_hz: payload.readUInt16LE(o + 2) / 10,
+    timeout_pct: payload.readUInt8(o + 4),
+    checksum_pct: payload.readUInt8(o + 5),
+    out_of_range_pct: payload.readUInt8(o + 6),
+    reads: payload.readUInt32LE(o + 7),
+    timeouts: payload.readUInt32LE(o + 11),
+    checksum_errors: payload.readUInt32LE(o + 15),
+    out_of_range: payload.readUInt32LE(o + 19),
+    stuck_events: payload.readUInt32LE(o + 23),
+    failures: payload.readUInt32LE(o + 27),
+  };
+}
+
+/**
+ * Decode a FRAME_SENSOR_HEALTH payload (SensorHealthPayload in binary_protocol.h)
+ */
+export function decodeSensorHealth(payload: Buffer): SensorHealth {
+  return {
+    uptime_ms: payload.readUInt32LE(0),
+    sweep_mode: SWEEP_HEALTH_MODE[payload.readUInt8(4)] ?? 'normal',
+    tof: decodeSensorHealthEntry(payload, 5),
+    ultrasonic: decodeSensorHealthEntry(payload, 5 + SENSOR_HEALTH_ENTRY_SIZE),
+  };
+}
@@ -0,0 +1,256 @@
+/**
+ * Serial firmware update (OTA:* commands, see src/utils/ota_update.h)
+ *
+ * Streams a firmware image into the inactive app slot of the ESP32 in
+ * base64 chunks, each with a CRC-16, then asks the firmware to verify the
+ * whole-image CRC-32 and reboot into it. A dropped chunk or link is
+ * recovered from the offset the firmware reports (OTA:STATUS), so an
+ * interrupted push resumes instead of starting over.
+ *
+ * Used by serial-ws-bridge.ts ({ type: 'ota_push', path }) or standalone:
+ *   SERIAL_PORT=/dev/cu.usbserial-10 pnpm ota-push ../.pio/build/esp32-s3/firmware.bin
+ * (stop the bridge first, only one process can own the port)
+ */
+
+import { readFileSync } from 'fs';
+import { SerialPort } from 'serialport';
+
+export const OTA_CHUNK_SIZE = 192;          // Must not exceed OTA_CHUNK_MAX in firmware
+const REPLY_TIMEOUT_MS = 2000;
+const END_TIMEOUT_MS = 10000;               // esp_ota_end() hashes the whole image
+const MAX_RETRIES = 5;
+
+export interface OtaProgress {
+  sent: number;
+  total: number;
+  retries: number;
+}
+
+/**
+ * CRC-16-CCITT (same as calculateCRC16 in binary_protocol.h)
+ */
+function crc16(data: Buffer): number {
+  let crc = 0xFFFF;
+  for (let i = 0; i < data.length; i++) {
+    crc ^= data[i] << 8;
+    for (let bit = 0; bit < 8; bit++) {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc & 0xFFFF;
+}
+
+let crc32Table: Uint32Array | null = null;
+
+/**
+ * CRC-32 (IEEE 802.3, as zlib and esp_rom_crc32_le)
+ */
+export function crc32(data: Buffer): number {
+  if (!crc32Table) {
+    crc32Table = new Uint32Array(256);
+    for (let n = 0; n < 256; n++) {
+      let c = n;
+      for (let k = 0; k < 8; k++) {
+        c = c & 1 ? 0xEDB88320 ^ (c >>> 1) : c >>> 1;
+      }
+      crc32Table[n] = c >>> 0;
+    }
+  }
+  let crc = 0xFFFFFFFF;
+  for (let i = 0; i < data.length; i++) {
+    crc = crc32Table[(crc ^ data[i]) & 0xFF] ^ (crc >>> 8);
+  }
+  return (crc ^ 0xFFFFFFFF) >>> 0;
+}
+
+/**
+ * Collects ACK:OTA / ERR:OTA lines from the serial stream.
+ * Binary telemetry is paused by the firmware during a transfer, but stray
+ * bytes before BEGIN are tolerated by matching on the line prefix.
+ */
+class OtaReplyReader {
+  private text = '';
+  private waiter: ((line: string | null) => void) | null = null;
+  private lines: string[] = [];
+  private readonly onData = (chunk: Buffer) => this.feed(chunk);
+
+  constructor(private readonly port: SerialPort) {
+    port.on('data', this.onData);
+  }
+
+  close() {
+    this.port.off('data', this.onData);
+  }
+
+  private feed(chunk: Buffer) {
+    this.text += chunk.toString('latin1');
+    let newline: number;
+    while ((newline = this.text.indexOf('\n')) >= 0) {
+      const line = this.text.slice(0, newline).trim();
+      this.text = this.text.slice(newline + 1);
+      const match = line.match(/(ACK:OTA:|ERR:OTA:|ERR:INVALID_COMMAND:OTA).*/);
+      if (match) {
+        this.lines.push(match[0]);
+      }
+    }
+    // Do not let a long run of binary bytes without newline grow forever
+    if (this.text.length > 4096) {
+      this.text = this.text.slice(-512);
+    }
+    if (this.waiter && this.lines.length > 0) {
+      const resolve = this.waiter;
+      this.waiter = null;
+      resolve(this.lines.shift()!);
+    }
+  }
+
+  /**
+   * Send one command and wait for the next OTA reply (null on timeout)
+   */
+  request(command: string, timeoutMs = REPLY_TIMEOUT_MS): Promise<string | null> {
+    this.lines = [];
+    return new Promise((resolve) => {
+      const timer = setTimeout(() => {
+        this.waiter = null;
+        resolve(null);
+      }, timeoutMs);
+      this.waiter = (line) => {
+        clearTimeout(timer);
+        resolve(line);
+      };
+      this.port.write(command + '\n');
+    });
+  }
+}
+
+/**
+ * Parse "ACK:OTA:STATUS:STATE=RECEIVING,OFFSET=1024,..." into a map
+ */
+function parseStatus(line: string): Record<string, string> {
+  const fields: Record<string, string> = {};
+  for (const pair of line.replace('ACK:OTA:STATUS:', '').split(',')) {
+    const [key, value] = pair.split('=');
+    if (key) fields[key] = value ?? '';
+  }
+  return fields;
+}
+
+/**
+ * Push a firmware image over an open serial port
+ * Resolves once the firmware acknowledged OTA:END and is rebooting.
+ */
+export async function pushFirmware(
+  port: SerialPort,
+  image: Buffer,
+  onProgress?: (progress: OtaProgress) => void
+): Promise<void> {
+  const reader = new OtaReplyReader(port);
+  const imageCrc = crc32(image);
+  let retries = 0;
+
+  try {
+    // Resume an open session for the same image, otherwise start a new one
+    let offset = 0;
+    const statusLine = await reader.request('OTA:STATUS');
+    const status: Record<string, string> = statusLine?.startsWith('ACK:OTA:STATUS:') ? parseStatus(statusLine) : {};
+    const sameImage = status.STATE === 'RECEIVING' &&
+      Number(status.SIZE) === image.length &&
+      parseInt(status.CRC ?? '', 16) === imageCrc;
+
+    if (sameImage) {
+      offset = Number(status.OFFSET);
+      console.log(`🔁 Resuming update at ${offset}/${image.length} bytes`);
+    } else {
+      if (status.STATE === 'RECEIVING') {
+        await reader.request('OTA:ABORT');
+      }
+      const begin = await reader.request(`OTA:BEGIN:${image.length}:${imageCrc.toString(16)}`);
+      if (!begin?.startsWith('ACK:OTA:BEGIN')) {
+        throw new Error(`OTA:BEGIN failed: ${begin ?? 'timeout'}`);
+      }
+    }
+
+    while (offset < image.length) {
+      const chunk = image.subarray(offset, offset + OTA_CHUNK_SIZE);
+      const reply = await reader.request(
+        `OTA:CHUNK:${offset}:${crc16(chunk).toString(16)}:${chunk.toString('base64')}`
+      );
+
+      if (reply?.startsWith('ACK:OTA:CHUNK:')) {
+        offset = Number(reply.split(':')[3]);
+        retries = 0;
+        onProgress?.({ sent: offset, total: image.length, retries });
+        continue;
+      }
+
+      if (++retries > MAX_RETRIES) {
+        throw new Error(`Chunk at ${offset} failed: ${reply ?? 'timeout'}`);
+      }
+
+      // Rejected chunk: ERR:OTA:<reason>:<resume offset>
+      const parts = reply?.split(':') ?? [];
+      if (parts[0] === 'ERR' && parts.length >= 4 && /^\d+$/.test(parts[3])) {
+        offset = Number(parts[3]);
+      } else {
+        // Lost reply: ask where the firmware is
+        const resync = await reader.request('OTA:STATUS');
+        if (resync?.startsWith('ACK:OTA:STATUS:')) {
+          const fields = parseStatus(resync);
+          if (fields.STATE !== 'RECEIVING') {
+            throw new Error(`Session lost (${fields.STATE}, ${fields.ERROR})`);
+          }
+          offset = Number(fields.OFFSET);
+        }
+      }
+      onProgress?.({ sent: offset, total: image.length, retries });
+    }
+
+    const end = await reader.request('OTA:END', END_TIMEOUT_MS);
+    if (!end?.startsWith('ACK:OTA:END')) {
+      throw new Error(`OTA:END failed: ${end ?? 'timeout'}`);
+    }
+  } finally {
+    reader.close();
+  }
+}
+
+// ============================================================================
+// Standalone usage
+// ============================================================================
+
+if (process.argv[1]?.endsWith('ota-push.ts')) {
+  const imagePath = process.argv[2];
+  const serialPath = process.env.SERIAL_PORT || '/dev/ttyUSB0';
+  if (!imagePath) {
+    console.error('Usage: SERIAL_PORT=<port> tsx dev/ota-push.ts <firmware.bin>');
+    process.exit(1);
+  }
+
+  const image = readFileSync(imagePath);
+  const port = new SerialPort({ path: serialPath, baudRate: 115200 });
+
+  port.on('open', async () => {
+    console.log(`📦 ${imagePath}: ${image.length} bytes, CRC-32 ${crc32(image).toString(16)}`);
+    let lastPct = -1;
+    try {
+      await pushFirmware(port, image, ({ sent, total }) => {
+        const pct = Math.floor((sent / total) * 100);
+        if (pct !== lastPct && pct % 5 === 0) {
+          console.log(`   ${pct}% (${sent}/${total})`);
+          lastPct = pct;
+        }
+      });
+      console.log('✅ Image accepted, ESP32 is rebooting (self-test runs after boot)');
+      port.close();
+    } catch (error) {
+      console.error('❌ Update failed:', (error as Error).message);
+      port.close();
+      process.exit(1);
+    }
+  });
+
+  port.on('error', (err) => {
+    console.error('❌ Serial port error:', err.message);
+    process.exit(1);
+  });
+}
@@ -7,20 +7,65 @@
  * based on calibrated prestress (0%) and maxstress*0.95 (100%)
  *
  * Includes potentiometer scales and dynamic distance thresholds
+ *
+ * Also decodes typed 0xAA66 frames (see frame-protocol.ts). On connect the
+ * bridge requests the device info frame and, once received, parses
+ * DataPackets using the field layout the firmware advertises.
  */
 
+import { readFileSync } from 'fs';
 import { WebSocketServer, WebSocket } from 'ws';
 import { SerialPort } from 'serialport';
-import type { MotorData } from '../src/lib/types';
+import type { DeviceInfo, MotorData, PacketField } from '../src/lib/types';
+import {
+  DataField,
+  DEFAULT_PACKET_LAYOUT,
+  DEFAULT_PACKET_SIZE,
+  FRAME_CRC_SIZE,
+  FRAME_HEADER_SIZE,
+  FRAME_HEADER_WORD,
+  FRAME_MAX_PAYLOAD,
+  FrameType,
+  decodeDeviceInfo,
+  decodeLoopTiming,
+  decodeMotorStats,
+  decodeScanSamples,
+  decodeSensorHealth,
+  decodeStateEvent,
+  decodeStatsSummary,
+  decodeWatchdogDiag,
+  readField,
+} from './frame-protocol';
+import { detokenize, loadTokenDb } from './detokenize';
+import { pushFirmware } from './ota-push';
 
 const WS_PORT = 3001;
 const BAUD_RATE = 115200;
 
 // Binary protocol constants (5 motors + potentiometer data + raw sensor readings)
-// Packet: 2+4+20+20+20+20+1+4+1+1+8+8+12+2 = 123 bytes
-const PACKET_SIZE = 123;
+// Packet: 2+4+20+20+20+20+1+4+1+1+8+8+12+2 = 123 bytes (default until device info arrives)
+let PACKET_SIZE = DEFAULT_PACKET_SIZE;
+let packetLayout = new Map<number, PacketField>(DEFAULT_PACKET_LAYOUT.map((f) => [f.id, f]));
 const HEADER_WORD = 0xAA55;  // Combined 16-bit header
 
+// Latest device info frame (sent to newly connected clients)
+let deviceInfo: DeviceInfo | null = null;
+
+// Last reported watchdog miss counts (to log new misses only)
+let lastWatchdogMisses = 0;
+let lastOuterWatchdogMisses = 0;
+
+// Firmware update in progress (other commands are refused meanwhile)
+let otaActive = false;
+
+// Next expected sweep sample (to report gaps) and last overflow count
+let nextScanSeq: number | null = null;
+let lastScanOverflows = 0;
+
+// TLOG token database from the last firmware build (reloaded when a log
+// frame carries an unknown token, e.g. after flashing a new build)
+let tokenDb = loadTokenDb();
+
 // Serial port path - you'll need to update this
 // Run: node -e "require('serialport').SerialPort.list().then(ports => console.log(ports))"
 // to find your ESP32 port
@@ -117,42 +162,46 @@ function parseBinaryPacket(packet: Buffer): MotorData | null {
   }
 
   try {
-    const activeSensor = packet.readUInt8(92); // 0=none, 1=TOF, 2=ultrasonic, 3=both
+    // Read element `index` of a field; NaN if the firmware does not send it
+    const get = (id: DataField, index = 0): number => {
+      const field = packetLayout.get(id);
+      return field && index < field.count ? readField(packet, field, index) : NaN;
+    };
     return {
-      time_ms: packet.readUInt32LE(2),
-      sp1_pct: packet.readFloatLE(6),
-      sp2_pct: packet.readFloatLE(10),
-      sp3_pct: packet.readFloatLE(14),
-      sp4_pct: packet.readFloatLE(18),
-      sp5_pct: packet.readFloatLE(22),
-      pp1_pct: packet.readFloatLE(26),
-      pp2_pct: packet.readFloatLE(30),
-      pp3_pct: packet.readFloatLE(34),
-      pp4_pct: packet.readFloatLE(38),
-      pp5_pct: packet.readFloatLE(42),
-      duty1_pct: packet.readFloatLE(46),
-      duty2_pct: packet.readFloatLE(50),
-      duty3_pct: packet.readFloatLE(54),
-      duty4_pct: packet.readFloatLE(58),
-      duty5_pct: packet.readFloatLE(62),
-      tof1_cm: packet.readFloatLE(66),
-      tof2_cm: packet.readFloatLE(70),
-      tof3_cm: packet.readFloatLE(74),
-      tof4_cm: packet.readFloatLE(78),
-      tof5_cm: packet.readFloatLE(82),
-      servo_angle: packet.readUInt8(86),
-      tof_current_cm: packet.readFloatLE(87),
-      active_sensor: activeSensor,
+      time_ms: get(DataField.TIMESTAMP_MS),
+      sp1_pct: get(DataField.SETPOINT_PCT, 0),
+      sp2_pct: get(DataField.SETPOINT_PCT, 1),
+      sp3_pct: get(DataField.SETPOINT_PCT, 2),
+      sp4_pct: get(DataField.SETPOINT_PCT, 3),
+      sp5_pct: get(DataField.SETPOINT_PCT, 4),
+      pp1_pct: get(DataField.PRESSURE_PCT, 0),
+      pp2_pct: get(DataField.PRESSURE_PCT, 1),
+      pp3_pct: get(DataField.PRESSURE_PCT, 2),
+      pp4_pct: get(DataField.PRESSURE_PCT, 3),
+      pp5_pct: get(DataField.PRESSURE_PCT, 4),
+      duty1_pct: get(DataField.DUTY_PCT, 0),
+      duty2_pct: get(DataField.DUTY_PCT, 1),
+      duty3_pct: get(DataField.DUTY_PCT, 2),
+      duty4_pct: get(DataField.DUTY_PCT, 3),
+      duty5_pct: get(DataField.DUTY_PCT, 4),
+      tof1_cm: get(DataField.TOF_CM, 0),
+      tof2_cm: get(DataField.TOF_CM, 1),
+      tof3_cm: get(DataField.TOF_CM, 2),
+      tof4_cm: get(DataField.TOF_CM, 3),
+      tof5_cm: get(DataField.TOF_CM, 4),
+      servo_angle: get(DataField.SERVO_ANGLE),
+      tof_current_cm: get(DataField.TOF_CURRENT_CM),
+      active_sensor: get(DataField.ACTIVE_SENSOR), // 0=none, 1=TOF, 2=ultrasonic, 3=both
       // Raw sensor readings (for CSV logging)
-      ultrasonic_cm: packet.readFloatLE(93),
-      tof_raw_cm: packet.readFloatLE(97),
+      ultrasonic_cm: get(DataField.ULTRASONIC_CM),
+      tof_raw_cm: get(DataField.TOF_RAW_CM),
       // Potentiometer scales
-      force_scale: packet.readFloatLE(101),
-      distance_scale: packet.readFloatLE(105),
+      force_scale: get(DataField.FORCE_SCALE),
+      distance_scale: get(DataField.DISTANCE_SCALE),
       // Dynamic distance thresholds
-      dist_close_max: packet.readFloatLE(109),
-      dist_medium_max: packet.readFloatLE(113),
-      dist_far_max: packet.readFloatLE(117),
+      dist_close_max: get(DataField.DIST_CLOSE_MAX_CM),
+      dist_medium_max: get(DataField.DIST_MEDIUM_MAX_CM),
+      dist_far_max: get(DataField.DIST_FAR_MAX_CM),
     };
   } catch (error) {
     console.error('❌ Error parsing binary packet:', error);
@@ -160,31 +209,133 @@ function parseBinaryPacket(packet: Buffer): MotorData | null {
   }
 }
 
+/**
+ * Handle a validated typed frame
+ */
+function handleFrame(type: number, payload: Buffer) {
+  switch (type) {
+    case FrameType.DEVICE_INFO: {
+      const info = decodeDeviceInfo(payload);
+      if (info.data_packet_header !== HEADER_WORD) {
+        console.warn(`⚠️  Unexpected DataPacket header in device info: 0x${info.data_packet_header.toString(16)}`);
+        return;
+      }
+      deviceInfo = info;
+      PACKET_SIZE = info.data_packet_size;
+      packetLayout = new Map(info.fields.map((f) => [f.id, f]));
+      console.log(`ℹ️  Device info: firmware ${info.git_hash}, protocol v${info.protocol_version}, ` +
+        `${info.motor_count} motors, ${PACKET_SIZE}-byte packets`);
+      broadcast({ type: 'device_info', payload: info });
+      break;
+    }
+
+    case FrameType.STATE_EVENT: {
+      const event = decodeStateEvent(payload);
+      console.log(`🛡️  M${event.motor + 1}: ${event.from} → ${event.to} (${event.reason}, ` +
+        `${event.pressure_pct.toFixed(1)}%)`);
+      if (event.dropped > 0) {
+        console.warn(`⚠️  ${event.dropped} state events dropped by firmware`);
+      }
+      broadcast({ type: 'state_event', payload: event, isRecording });
+      break;
+    }
+
+    case FrameType.WATCHDOG_DIAG: {
+      const diag = decodeWatchdogDiag(payload);
+      if (diag.misses > lastWatchdogMisses) {
+        console.warn(`🚨 Control loop missed ${diag.misses - lastWatchdogMisses} deadline(s), motors braked ` +
+          `(worst gap ${(diag.worst_gap_us / 1000).toFixed(1)} ms)`);
+      }
+      lastWatchdogMisses = diag.misses;
+      if (diag.outer_misses > lastOuterWatchdogMisses) {
+        console.warn(`🚨 Supervisory loop missed ${diag.outer_misses - lastOuterWatchdogMisses} deadline(s), motors braked ` +
+          `(worst gap ${(diag.outer_worst_gap_us / 1000).toFixed(1)} ms)`);
+      }
+      lastOuterWatchdogMisses = diag.outer_misses;
+      broadcast({ type: 'watchdog_diag', payload: diag });
+      break;
+    }
+
+    case FrameType.LOOP_TIMING: {
+      const timing = decodeLoopTiming(payload);
+      if (timing.stale_holds > 0) {
+        console.warn(`⚠️  Pressure loop held motors for ${timing.stale_holds} tick(s): no setpoints from the supervisory loop`);
+      }
+      broadcast({ type: 'loop_timing', payload: timing });
+      break;
+    }
+
+    case FrameType.STATS_SUMMARY: {
+      broadcast({ type: 'stats_summary', payload: decodeStatsSummary(payload) });
+      break;
+    }
+
+    case FrameType.SCAN_SAMPLES: {
+      const scan = decodeScanSamples(payload);
+      if (scan.samples.length > 0) {
+        const first = scan.samples[0].seq;
+        if (nextScanSeq !== null && first !== nextScanSeq && first !== 0) {  // 0 = device rebooted
+          console.warn(`⚠️  ${(first - nextScanSeq) >>> 0} sweep sample(s) missing before #${first}`);
+        }
+        nextScanSeq = (first + scan.samples.length) >>> 0;
+      }
+      if (scan.overflows > lastScanOverflows) {
+        console.warn(`⚠️  Sweep sample queue overflowed (${scan.overflows - lastScanOverflows} dropped)`);
+      }
+      lastScanOverflows = scan.overflows;
+      broadcast({ type: 'scan_samples', payload: scan });
+      break;
+    }
+
+    case FrameType.MOTOR_STATS: {
+      broadcast({ type: 'motor_stats', payload: decodeMotorStats(payload) });
+      break;
+    }
+
+    case FrameType.SENSOR_HEALTH: {
+      broadcast({ type: 'sensor_health', payload: decodeSensorHealth(payload) });
+      break;
+    }
+
+    case FrameType.LOG: {
+      let message = detokenize(payload, tokenDb);
+      if (!message.known) {
+        tokenDb = loadTokenDb();
+        message = detokenize(payload, tokenDb);
+      }
+      console.log(`📝 ${message.text}`);
+      broadcast({ type: 'log', payload: message });
+      break;
+    }
+
+    default:
+      console.warn(`⚠️  Unknown frame type: 0x${type.toString(16)}`);
+  }
+}
+
 /**
  * Process incoming binary data
- * Accumulates data in buffer and extracts complete packets
+ * Accumulates data in buffer and extracts complete packets and typed frames
  */
 function processBinaryData(chunk: Buffer) {
   // Append new data to buffer
   binaryBuffer = Buffer.concat([binaryBuffer, chunk]);
 
-  // Process all complete packets in buffer
-  while (binaryBuffer.length >= PACKET_SIZE) {
-    // Look for packet header (0xAA55 as little-endian uint16)
+  // Process all complete packets/frames in buffer
+  while (binaryBuffer.length >= FRAME_HEADER_SIZE) {
+    // Look for either header (as little-endian uint16)
     let headerIndex = -1;
-    for (let i = 0; i <= binaryBuffer.length - PACKET_SIZE; i++) {
+    for (let i = 0; i <= binaryBuffer.length - 2; i++) {
       const word = binaryBuffer.readUInt16LE(i);
-      if (word === HEADER_WORD) {
+      if (word === HEADER_WORD || word === FRAME_HEADER_WORD) {
         headerIndex = i;
         break;
       }
     }
 
     if (headerIndex === -1) {
-      // No header found, keep last PACKET_SIZE bytes in case header is split
-      if (binaryBuffer.length > PACKET_SIZE * 2) {
-        binaryBuffer = binaryBuffer.subarray(binaryBuffer.length - PACKET_SIZE);
-      }
+      // No header found, keep the last byte in case the header is split
+      binaryBuffer = binaryBuffer.subarray(binaryBuffer.length - 1);
       break;
     }
 
@@ -193,6 +344,40 @@ function processBinaryData(chunk: Buffer) {
       binaryBuffer = binaryBuffer.subarray(headerIndex);
     }
 
+    if (binaryBuffer.readUInt16LE(0) === FRAME_HEADER_WORD) {
+      if (binaryBuffer.length < FRAME_HEADER_SIZE) {
+        break;
+      }
+      const type = binaryBuffer.readUInt8(2);
+      const length = binaryBuffer.readUInt16LE(3);
+      if (length > FRAME_MAX_PAYLOAD) {
+        // Not a real frame header, skip it and resync
+        binaryBuffer = binaryBuffer.subarray(2);
+        continue;
+      }
+      const frameSize = FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE;
+      if (binaryBuffer.length < frameSize) {
+        break;
+      }
+
+      const calculatedCRC = calculateCRC16(binaryBuffer.subarray(2, FRAME_HEADER_SIZE + length));
+      const frameCRC = binaryBuffer.readUInt16LE(FRAME_HEADER_SIZE + length);
+      if (calculatedCRC !== frameCRC) {
+        console.warn(`⚠️  Frame CRC mismatch: calculated 0x${calculatedCRC.toString(16)}, received 0x${frameCRC.toString(16)}`);
+        binaryBuffer = binaryBuffer.subarray(2);
+        continue;
+      }
+
+      const payload = Buffer.from(binaryBuffer.subarray(FRAME_HEADER_SIZE, FRAME_HEADER_SIZE + length));
+      binaryBuffer = binaryBuffer.subarray(frameSize);
+      try {
+        handleFrame(type, payload);
+      } catch (error) {
+        console.error('❌ Error decoding frame:', error);
+      }
+      continue;
+    }
+
     // Check if we have a complete packet
     if (binaryBuffer.length < PACKET_SIZE) {
       break;
@@ -200,12 +385,15 @@ function processBinaryData(chunk: Buffer) {
 
     // Extract packet
     const packet = binaryBuffer.subarray(0, PACKET_SIZE);
-    binaryBuffer = binaryBuffer.subarray(PACKET_SIZE);
 
     // Parse and broadcast packet
     const motorData = parseBinaryPacket(packet);
     if (motorData) {
+      binaryBuffer = binaryBuffer.subarray(PACKET_SIZE);
       broadcastData(motorData);
+    } else {
+      // False header match, skip it and resync
+      binaryBuffer = binaryBuffer.subarray(2);
     }
   }
 }
@@ -220,6 +408,8 @@ function initSerial() {
     serialPort.on('open', () => {
       console.log(`✅ Serial port opened: ${SERIAL_PORT} @ ${BAUD_RATE} baud`);
       console.log('📡 Binary protocol mode (123-byte packets with normalized values + raw sensor readings + potentiometer data)');
+      // Request build info and packet layout (also sent by the firmware on boot)
+      sendCommandToESP32('INFO:GET\n');
     });
 
     serialPort.on('error', (err) => {
@@ -278,6 +468,10 @@ function broadcast(message: any) {
  * Send command to ESP32 via serial port
  */
 function sendCommandToESP32(command: string) {
+  if (otaActive) {
+    console.warn(`⚠️  Firmware update running, dropped: ${command.trim()}`);
+    return;
+  }
   if (serialPort && serialPort.isOpen) {
     serialPort.write(command, (err) => {
       if (err) {
@@ -291,6 +485,51 @@ function sendCommandToESP32(command: string) {
   }
 }
 
+/**
+ * Push a firmware image through the open serial port and report progress
+ */
+async function startOtaPush(ws: WebSocket, path: unknown) {
+  if (otaActive) {
+    ws.send(JSON.stringify({ type: 'error', message: 'Firmware update already running' }));
+    return;
+  }
+  if (typeof path !== 'string' || !serialPort || !serialPort.isOpen) {
+    ws.send(JSON.stringify({ type: 'error', message: 'Invalid firmware path or serial port closed' }));
+    return;
+  }
+
+  let image: Buffer;
+  try {
+    image = readFileSync(path);
+  } catch (error) {
+    ws.send(JSON.stringify({ type: 'error', message: `Cannot read ${path}` }));
+    return;
+  }
+
+  otaActive = true;
+  console.log(`📦 Firmware update: ${path} (${image.length} bytes)`);
+  let lastPct = -1;
+  try {
+    await pushFirmware(serialPort, image, (progress) => {
+      const pct = Math.floor((progress.sent / progress.total) * 100);
+      if (pct !== lastPct) {
+        lastPct = pct;
+        broadcast({ type: 'ota_progress', payload: progress });
+      }
+    });
+    console.log('✅ Firmware accepted, ESP32 rebooting');
+    broadcast({ type: 'ota_result', payload: { ok: true, message: 'Rebooting into new firmware' } });
+    // The new image announces itself with a device info frame after boot
+    deviceInfo = null;
+  } catch (error) {
+    const message = (error as Error).message;
+    console.error('❌ Firmware update failed:', message);
+    broadcast({ type: 'ota_result', payload: { ok: false, message } });
+  } finally {
+    otaActive = false;
+  }
+}
+
 // WebSocket Server
 wss.on('connection', (ws: WebSocket) => {
   clients.add(ws);
@@ -306,6 +545,11 @@ wss.on('connection', (ws: WebSocket) => {
     })
   );
 
+  // Send cached device info so the client knows the firmware capabilities
+  if (deviceInfo) {
+    ws.send(JSON.stringify({ type: 'device_info', payload: deviceInfo }));
+  }
+
   ws.on('message', (data: Buffer) => {
     try {
       const message = JSON.parse(data.toString());
@@ -399,6 +643,11 @@ wss.on('connection', (ws: WebSocket) => {
           }
           break;
 
+        case 'ota_push':
+          // Stream a firmware image to the ESP32 (see ota-push.ts)
+          startOtaPush(ws, message.path);
+          break;
+
         case 'ping':
           ws.send(JSON.stringify({ type: 'pong' }));
           break;
@@ -75,6 +75,233 @@ export interface MotorData {
   dist_far_max: number;  // FAR/OUT boundary (150-450 cm)
 }
 
+/**
+ * One entry of the DataPacket layout table (from the device info frame)
+ */
+export interface PacketField {
+  id: number;      // DataField id (see binary_protocol.h)
+  type: number;    // 1=u8, 2=u16, 3=u32, 4=f32
+  offset: number;  // Byte offset from start of packet
+  count: number;   // Number of consecutive elements
+}
+
+/**
+ * Build info and capability descriptor sent by the firmware
+ * (FRAME_DEVICE_INFO, on boot and on INFO:GET)
+ */
+export interface DeviceInfo {
+  protocol_version: number;
+  motor_count: number;
+  pad_count: number;
+  pot_count: number;
+  control_mode: 'millivolts' | 'newtons';
+  sweep_mode: 'forward' | 'bidirectional' | 'tracking' | 'continuous';
+  control_freq_hz: number;   // Inner pressure loop
+  outer_freq_hz: number;     // Supervisory loop (0 on older firmware)
+  logging_period_ms: number;
+  pwm_freq_hz: number;
+  pwm_res_bits: number;
+  sweep_estimated_ms: number;
+  sweep_enabled: boolean;
+  servo_min_angle: number;
+  servo_max_angle: number;
+  servo_step: number;
+  servo_manual_angle: number;
+  servo_settle_ms: number;
+  servo_reading_delay_ms: number;
+  sectors: { min: number; max: number }[];
+  git_hash: string;
+  data_packet_header: number;
+  data_packet_size: number;
+  fields: PacketField[];
+}
+
+/**
+ * Safety state machine transition (FRAME_STATE_EVENT)
+ */
+export interface StateEvent {
+  time_ms: number;
+  motor: number;           // 0-based motor index
+  from: string;            // NORMAL | DEFLATING | RELEASING | WAITING
+  to: string;
+  reason: string;          // Guard that fired, e.g. 'pressure_released'
+  pressure_pct: number;    // Normalized pressure at the transition
+  ticks_in_state: number;  // Control ticks spent in the previous state
+  dropped: number;         // Events lost on the device before this one
+}
+
+/**
+ * Control loop watchdog counters (FRAME_WATCHDOG_DIAG, 1 Hz)
+ */
+export interface WatchdogDiag {
+  kicks: number;         // Control ticks seen
+  misses: number;        // Deadlines missed (motors braked by the ISR)
+  late_ticks: number;    // Ticks later than 1.5x the control period
+  worst_gap_us: number;  // Longest interval between ticks
+  last_gap_us: number;   // Interval before the latest tick
+  deadline_ms: number;
+  armed: boolean;
+  tripped: boolean;
+  outer_kicks: number;         // Supervisory loop ticks seen
+  outer_misses: number;        // Supervisory deadlines missed (motors braked by the ISR)
+  outer_worst_gap_us: number;  // Longest interval between supervisory ticks
+  outer_deadline_ms: number;
+  outer_tripped: boolean;
+}
+
+/**
+ * Timing of one control loop over the last window (FRAME_LOOP_TIMING)
+ */
+export interface LoopTimingEntry {
+  rate_hz: number;        // Configured rate
+  ticks: number;
+  late_ticks: number;     // Started more than 1.5x the period late
+  overruns: number;       // Execution longer than the period
+  exec_avg_us: number;
+  exec_max_us: number;
+  period_max_us: number;  // Longest interval between tick starts
+}
+
+/**
+ * Inner/outer loop timing and setpoint mailbox counters (FRAME_LOOP_TIMING, 1 Hz)
+ */
+export interface LoopTiming {
+  inner: LoopTimingEntry;  // Pressure loop task
+  outer: LoopTimingEntry;  // Supervisory loop
+  torn_reads: number;      // Mailbox copies discarded (previous command reused)
+  stale_holds: number;     // Inner ticks braked for lack of fresh setpoints
+  mux_busy: number;        // Inner ticks that reused old pad readings
+}
+
+/**
+ * One channel (motor) over a statistics window
+ */
+export interface StatsChannel {
+  count: number;        // Samples in the window
+  mean: number;
+  stddev: number;
+  min: number;
+  max: number;
+  p95: number;          // Interpolated from the histogram on the device
+  histogram: number[];  // 8 buckets, first and last are open-ended
+}
+
+/**
+ * Per-motor statistics of one quantity (FRAME_STATS_SUMMARY, every
+ * STATS_PERIOD_MS when PARAM TELEMETRY_MODE is 1 or 2)
+ */
+export interface StatsSummary {
+  kind: string;          // pad_pct | duty | error | distance
+  window_ms: number;
+  bucket_min: number;    // Lower edge of bucket 0
+  bucket_width: number;
+  channels: StatsChannel[];
+}
+
+/**
+ * One sweep measurement (FRAME_SCAN_SAMPLES)
+ */
+export interface ScanSample {
+  seq: number;             // Sample number since boot (gaps = dropped)
+  time_ms: number;
+  angle: number;           // Servo angle (degrees)
+  tof_cm: number;          // Raw TOF (-1 = error)
+  ultrasonic_cm: number;   // Raw ultrasonic
+  distance_cm: number;     // Fused minimum (999 = no valid reading)
+  active_sensor: number;   // 0=none, 1=TOF, 2=ultrasonic, 3=both
+}
+
+/**
+ * Batch of consecutive sweep measurements (FRAME_SCAN_SAMPLES)
+ */
+export interface ScanSamples {
+  overflows: number;       // Samples dropped by the firmware queue since boot
+  samples: ScanSample[];
+}
+
+/**
+ * Lifetime actuation counters of one motor (FRAME_MOTOR_STATS)
+ */
+export interface MotorStatsEntry {
+  forward_s: number;      // Time per drive mode
+  reverse_s: number;
+  brake_s: number;
+  coast_s: number;
+  duty_s: number;         // Duty integral while driven (100% for 1 s = 1)
+  saturated_s: number;    // Driven at 100% duty
+  state_s: number[];      // Time per SystemState (normal, deflating, releasing, waiting)
+  reversals: number;      // Forward <-> reverse direction changes
+  brake_events: number;   // Entries into brake
+}
+
+/**
+ * Per-motor lifetime actuation counters, restored from NVS at boot
+ * (FRAME_MOTOR_STATS, 1 Hz). Rates are differences over uptime_ms.
+ */
+export interface MotorStats {
+  uptime_ms: number;
+  emergency_brakes: number;  // Watchdog ISR brakes (all motors at once)
+  motors: MotorStatsEntry[];
+}
+
+/**
+ * Health of one range sensor (FRAME_SENSOR_HEALTH). Percentages cover
+ * the last 32 reads, counters are since boot.
+ */
+export interface SensorHealthEntry {
+  status: 'ok' | 'no_target' | 'failed';
+  fault: 'none' | 'timeouts' | 'checksums' | 'stuck';  // Cause of the last failure
+  rate_hz: number;        // Valid reads per second
+  timeout_pct: number;
+  checksum_pct: number;
+  out_of_range_pct: number;
+  reads: number;
+  timeouts: number;
+  checksum_errors: number;
+  out_of_range: number;
+  stuck_events: number;
+  failures: number;       // Transitions to failed
+}
+
+/**
+ * Range sensor health and the sweep mode chosen from it
+ * (FRAME_SENSOR_HEALTH, 1 Hz)
+ */
+export interface SensorHealth {
+  uptime_ms: number;
+  sweep_mode: 'normal' | 'ultrasonic_only' | 'tof_only' | 'blind';
+  tof: SensorHealthEntry;
+  ultrasonic: SensorHealthEntry;
+}
+
+/**
+ * Tokenized firmware log message (FRAME_LOG, detokenized by the bridge
+ * with tlog_tokens.json, see dev/detokenize.ts)
+ */
+export interface LogMessage {
+  time_ms: number;   // millis() on the ESP32
+  token: number;     // Format-string hash
+  text: string;      // Formatted message (raw token and bytes if unknown)
+  known: boolean;    // Token found in the database
+}
+
+/**
+ * Firmware update progress (bridge 'ota_push')
+ */
+export interface OtaProgress {
+  sent: number;     // Bytes acknowledged by the ESP32
+  total: number;    // Image size
+  retries: number;  // Retries of the current chunk
+}
+
+/**
+ * Firmware update outcome (bridge 'ota_push')
+ */
+export interface OtaResult {
+  ok: boolean;
+  message: string;
+}
+
 /**
  * Radar scan point - angle and distance pair
  */
@@ -98,6 +325,51 @@ export type WebSocketMessage =
       payload: MotorData;
       timestamp: number;
     }
+  | {
+      type: 'device_info';
+      payload: DeviceInfo;
+    }
+  | {
+      type: 'state_event';
+      payload: StateEvent;
+      isRecording?: boolean;
+    }
+  | {
+      type: 'watchdog_diag';
+      payload: WatchdogDiag;
+    }
+  | {
+      type: 'loop_timing';
+      payload: LoopTiming;
+    }
+  | {
+      type: 'stats_summary';
+      payload: StatsSummary;
+    }
+  | {
+      type: 'scan_samples';
+      payload: ScanSamples;
+    }
+  | {
+      type: 'motor_stats';
+      payload: MotorStats;
+    }
+  | {
+      type: 'sensor_health';
+      payload: SensorHealth;
+    }
+  | {
+      type: 'log';
+      payload: LogMessage;
+    }
+  | {
+      type: 'ota_progress';
+      payload: OtaProgress;
+    }
+  | {
+      type: 'ota_result';
+      payload: OtaResult;
+    }
   | {
       type: 'reset_complete';
     }
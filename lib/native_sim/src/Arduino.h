@@ -0,0 +1,124 @@
+/**
+ * @file Arduino.h
+ * @brief Arduino-ESP32 core API for the native virtual device
+ *
+ * Covers the subset of the Arduino-ESP32 2.x core used by the firmware.
+ * Pins, LEDC, the ADC and the UARTs are backed by the plant and scene
+ * models (sim_plant.h, sim_scene.h); Serial is a pseudo-terminal
+ * (sim_pty.cpp). Time is CLOCK_MONOTONIC since process start.
+ */
+
+#ifndef NATIVE_SIM_ARDUINO_H
+#define NATIVE_SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+using std::abs;
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+typedef enum {
+    ADC_0db,
+    ADC_2_5db,
+    ADC_6db,
+    ADC_11db
+} adc_attenuation_t;
+
+inline bool isDigit(int c) { return c >= '0' && c <= '9'; }
+
+// ============================================================================
+// Time
+// ============================================================================
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// ============================================================================
+// GPIO, ADC and LEDC (see sim_plant.h)
+// ============================================================================
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation);
+inline int8_t digitalPinToAnalogChannel(uint8_t pin) { return (int8_t)pin; }  // Channel = GPIO (hal/adc_hal.h)
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+void ledcWrite(uint8_t channel, uint32_t duty);
+uint32_t ledcRead(uint8_t channel);
+
+// ============================================================================
+// CPU Frequency and Hardware Timers
+// ============================================================================
+
+bool setCpuFrequencyMhz(uint32_t cpu_freq_mhz);
+uint32_t getCpuFrequencyMhz();
+
+struct hw_timer_s;
+typedef struct hw_timer_s hw_timer_t;
+
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool count_up);
+void timerEnd(hw_timer_t* timer);
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge);
+void timerDetachInterrupt(hw_timer_t* timer);
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarm_value, bool autoreload);
+void timerAlarmEnable(hw_timer_t* timer);
+void timerAlarmDisable(hw_timer_t* timer);
+
+// ============================================================================
+// Sketch Entry Points (defined by the firmware)
+// ============================================================================
+
+void setup();
+void loop();
+
+#endif // NATIVE_SIM_ARDUINO_H
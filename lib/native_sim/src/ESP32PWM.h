@@ -0,0 +1,14 @@
+/**
+ * @file ESP32PWM.h
+ * @brief ESP32Servo timer allocation (native virtual device, no-op)
+ */
+
+#ifndef NATIVE_SIM_ESP32PWM_H
+#define NATIVE_SIM_ESP32PWM_H
+
+class ESP32PWM {
+public:
+    static void allocateTimer(int timer) { (void)timer; }
+};
+
+#endif // NATIVE_SIM_ESP32PWM_H
@@ -0,0 +1,30 @@
+/**
+ * @file ESP32Servo.h
+ * @brief Servo driving the simulated TOF mount (native virtual device)
+ *
+ * write() sets the commanded angle; the mount follows with the dead time
+ * and slew rate of sim_scene.h.
+ */
+
+#ifndef NATIVE_SIM_ESP32SERVO_H
+#define NATIVE_SIM_ESP32SERVO_H
+
+#include "ESP32PWM.h"
+
+class Servo {
+public:
+    void setPeriodHertz(int hertz) { (void)hertz; }
+    int attach(int pin);
+    int attach(int pin, int min_us, int max_us);
+    void detach() { attached_pin = -1; }
+    bool attached() const { return attached_pin >= 0; }
+    void write(int angle);
+    void writeMicroseconds(int us);
+    int read() const { return angle_deg; }
+
+private:
+    int attached_pin = -1;
+    int angle_deg = 90;
+};
+
+#endif // NATIVE_SIM_ESP32SERVO_H
@@ -0,0 +1,28 @@
+/**
+ * @file Esp.h
+ * @brief ESP chip helpers (native virtual device)
+ */
+
+#ifndef NATIVE_SIM_ESP_H
+#define NATIVE_SIM_ESP_H
+
+#include <stdint.h>
+
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getCpuFreqMHz();
+    const char* getChipModel();
+    uint8_t getChipRevision();
+
+    /**
+     * @brief Re-execute the process (same arguments, same pty link)
+     */
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_SIM_ESP_H
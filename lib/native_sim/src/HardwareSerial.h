@@ -0,0 +1,49 @@
+/**
+ * @file HardwareSerial.h
+ * @brief UARTs of the native virtual device
+ *
+ * UART0 (Serial) is the host link, a pseudo-terminal (sim_pty.cpp).
+ * UART1 carries the TOF sensor frames and UART2 the MaxSonar serial
+ * output, both generated from the scene (sim_scene.h).
+ */
+
+#ifndef NATIVE_SIM_HARDWARE_SERIAL_H
+#define NATIVE_SIM_HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+class SimUart;
+
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uart_nr);
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rx_pin = -1, int8_t tx_pin = -1,
+               bool invert = false, unsigned long timeout_ms = 20000UL, uint8_t rxfifo_full_thrhd = 112);
+    void end() {}
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t byte) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite();
+    void flush() override;
+    size_t setRxBufferSize(size_t size) { return size; }
+
+    operator bool() const { return true; }
+
+private:
+    SimUart* device();
+
+    int uart_nr;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif // NATIVE_SIM_HARDWARE_SERIAL_H
@@ -0,0 +1,42 @@
+/**
+ * @file Preferences.h
+ * @brief NVS key-value store of the native virtual device
+ *
+ * One file per key under SIM_DATA_DIR/nvs/<namespace>/, so stored
+ * parameters, calibration and counters persist across runs.
+ */
+
+#ifndef NATIVE_SIM_PREFERENCES_H
+#define NATIVE_SIM_PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool read_only = false);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t max_len);
+
+    size_t putUChar(const char* key, uint8_t value);
+    uint8_t getUChar(const char* key, uint8_t default_value = 0);
+    size_t putUInt(const char* key, uint32_t value);
+    uint32_t getUInt(const char* key, uint32_t default_value = 0);
+
+private:
+    std::string keyPath(const char* key) const;
+
+    std::string dir;
+    bool opened = false;
+    bool read_only = false;
+};
+
+#endif // NATIVE_SIM_PREFERENCES_H
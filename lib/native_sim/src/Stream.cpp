@@ -0,0 +1,50 @@
+/**
+ * @file Stream.cpp
+ * @brief Implementation of the Arduino Stream base class
+ */
+
+#include "Arduino.h"
+
+int Stream::timedRead() {
+    unsigned long start = millis();
+    do {
+        int c = read();
+        if (c >= 0) {
+            return c;
+        }
+        delay(1);
+    } while (millis() - start < timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) {
+            break;
+        }
+        buffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String text;
+    int c = timedRead();
+    while (c >= 0 && c != terminator) {
+        text += (char)c;
+        c = timedRead();
+    }
+    return text;
+}
+
+String Stream::readString() {
+    String text;
+    int c = timedRead();
+    while (c >= 0) {
+        text += (char)c;
+        c = timedRead();
+    }
+    return text;
+}
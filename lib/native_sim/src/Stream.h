@@ -0,0 +1,31 @@
+/**
+ * @file Stream.h
+ * @brief Arduino Stream base class (native virtual device)
+ */
+
+#ifndef NATIVE_SIM_STREAM_H
+#define NATIVE_SIM_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout_ms) { timeout = timeout_ms; }
+    unsigned long getTimeout() const { return timeout; }
+
+    size_t readBytes(uint8_t* buffer, size_t length);
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+    String readStringUntil(char terminator);
+    String readString();
+
+protected:
+    int timedRead();
+
+    unsigned long timeout = 1000;
+};
+
+#endif // NATIVE_SIM_STREAM_H
@@ -0,0 +1,221 @@
+/**
+ * @file WString.cpp
+ * @brief Implementation of the Arduino String class
+ */
+
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ============================================================================
+// Internal Helper Functions
+// ============================================================================
+
+static std::string formatUnsigned(unsigned long long value, unsigned char base) {
+    if (base < 2 || base > 36) {
+        base = 10;
+    }
+    if (value == 0) {
+        return "0";
+    }
+    std::string digits;
+    while (value > 0) {
+        unsigned digit = (unsigned)(value % base);
+        digits.insert(digits.begin(), (char)(digit < 10 ? '0' + digit : 'a' + digit - 10));
+        value /= base;
+    }
+    return digits;
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+    if (value < 0 && base == 10) {
+        return "-" + formatUnsigned(0ULL - (unsigned long long)value, base);
+    }
+    return formatUnsigned((unsigned long long)value, base);
+}
+
+static std::string formatFloat(double value, unsigned int decimal_places) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", (int)decimal_places, value);
+    return text;
+}
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+String::String(const char* cstr) : buffer(cstr ? cstr : "") {}
+String::String(char c) : buffer(1, c) {}
+String::String(unsigned char value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(long long value, unsigned char base) : buffer(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : buffer(formatUnsigned(value, base)) {}
+String::String(float value, unsigned int decimal_places) : buffer(formatFloat(value, decimal_places)) {}
+String::String(double value, unsigned int decimal_places) : buffer(formatFloat(value, decimal_places)) {}
+
+bool String::reserve(unsigned int size) {
+    buffer.reserve(size);
+    return true;
+}
+
+// ============================================================================
+// Comparison and Search
+// ============================================================================
+
+bool String::equalsIgnoreCase(const String& rhs) const {
+    if (buffer.size() != rhs.buffer.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)rhs.buffer[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool String::startsWith(const String& prefix) const {
+    return buffer.compare(0, prefix.buffer.size(), prefix.buffer) == 0;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+    return offset <= buffer.size() && buffer.compare(offset, prefix.buffer.size(), prefix.buffer) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return buffer.size() >= suffix.buffer.size() &&
+           buffer.compare(buffer.size() - suffix.buffer.size(), suffix.buffer.size(), suffix.buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < buffer.size() ? buffer[index] : 0;
+}
+
+void String::setCharAt(unsigned int index, char c) {
+    if (index < buffer.size()) {
+        buffer[index] = c;
+    }
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = buffer.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    size_t pos = buffer.find(str.buffer, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = buffer.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& str) const {
+    size_t pos = buffer.rfind(str.buffer);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int begin) const {
+    return substring(begin, length());
+}
+
+String String::substring(unsigned int begin, unsigned int end) const {
+    if (begin > end) {
+        std::swap(begin, end);
+    }
+    if (begin >= buffer.size()) {
+        return String();
+    }
+    if (end > buffer.size()) {
+        end = (unsigned int)buffer.size();
+    }
+    return String(buffer.substr(begin, end - begin));
+}
+
+// ============================================================================
+// Modification
+// ============================================================================
+
+void String::replace(const String& find, const String& replacement) {
+    if (find.buffer.empty()) {
+        return;
+    }
+    size_t pos = 0;
+    while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+        buffer.replace(pos, find.buffer.size(), replacement.buffer);
+        pos += replacement.buffer.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < buffer.size()) {
+        buffer.erase(index);
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < buffer.size()) {
+        buffer.erase(index, count);
+    }
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = (char)tolower((unsigned char)buffer[i]);
+    }
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = (char)toupper((unsigned char)buffer[i]);
+    }
+}
+
+void String::trim() {
+    size_t first = 0;
+    while (first < buffer.size() && isspace((unsigned char)buffer[first])) {
+        first++;
+    }
+    size_t last = buffer.size();
+    while (last > first && isspace((unsigned char)buffer[last - 1])) {
+        last--;
+    }
+    buffer = buffer.substr(first, last - first);
+}
+
+// ============================================================================
+// Conversion
+// ============================================================================
+
+long String::toInt() const {
+    return strtol(buffer.c_str(), NULL, 10);
+}
+
+float String::toFloat() const {
+    return (float)toDouble();
+}
+
+double String::toDouble() const {
+    return strtod(buffer.c_str(), NULL);
+}
+
+// ============================================================================
+// Concatenation
+// ============================================================================
+
+String operator+(const String& lhs, const String& rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const String& lhs, const char* rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const char* lhs, const String& rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const String& lhs, char rhs) { String s(lhs); s += rhs; return s; }
+String operator+(const String& lhs, int rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, unsigned int rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, long rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, unsigned long rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, float rhs) { return lhs + String(rhs); }
+String operator+(const String& lhs, double rhs) { return lhs + String(rhs); }
@@ -0,0 +1,91 @@
+/**
+ * @file WString.h
+ * @brief Arduino String on std::string (native virtual device)
+ */
+
+#ifndef NATIVE_SIM_WSTRING_H
+#define NATIVE_SIM_WSTRING_H
+
+#include <stddef.h>
+#include <string>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String {
+public:
+    String(const char* cstr = "");
+    String(const std::string& str) : buffer(str) {}
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimal_places = 2);
+    explicit String(double value, unsigned int decimal_places = 2);
+
+    const char* c_str() const { return buffer.c_str(); }
+    unsigned int length() const { return (unsigned int)buffer.size(); }
+    bool isEmpty() const { return buffer.empty(); }
+    bool reserve(unsigned int size);
+
+    String& operator+=(const String& rhs) { buffer += rhs.buffer; return *this; }
+    String& operator+=(const char* cstr) { buffer += cstr; return *this; }
+    String& operator+=(char c) { buffer += c; return *this; }
+    bool concat(const String& rhs) { buffer += rhs.buffer; return true; }
+
+    bool operator==(const String& rhs) const { return buffer == rhs.buffer; }
+    bool operator==(const char* cstr) const { return buffer == cstr; }
+    bool operator!=(const String& rhs) const { return buffer != rhs.buffer; }
+    bool operator!=(const char* cstr) const { return buffer != cstr; }
+    bool operator<(const String& rhs) const { return buffer < rhs.buffer; }
+    bool equals(const String& rhs) const { return buffer == rhs.buffer; }
+    bool equalsIgnoreCase(const String& rhs) const;
+
+    bool startsWith(const String& prefix) const;
+    bool startsWith(const String& prefix, unsigned int offset) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const;
+    void setCharAt(unsigned int index, char c);
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String& str) const;
+    String substring(unsigned int begin) const;
+    String substring(unsigned int begin, unsigned int end) const;
+
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+private:
+    std::string buffer;
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(const String& lhs, int rhs);
+String operator+(const String& lhs, unsigned int rhs);
+String operator+(const String& lhs, long rhs);
+String operator+(const String& lhs, unsigned long rhs);
+String operator+(const String& lhs, float rhs);
+String operator+(const String& lhs, double rhs);
+
+#endif // NATIVE_SIM_WSTRING_H
@@ -0,0 +1,16 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief ROM CRC helpers of the native virtual device
+ */
+
+#ifndef NATIVE_SIM_ESP_ROM_CRC_H
+#define NATIVE_SIM_ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+/**
+ * @brief CRC-32 (IEEE 802.3), same chaining as the ESP32 ROM
+ */
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const* buf, uint32_t len);
+
+#endif // NATIVE_SIM_ESP_ROM_CRC_H
@@ -0,0 +1,13 @@
+/**
+ * @file esp_timer.h
+ * @brief High-resolution time of the native virtual device
+ */
+
+#ifndef NATIVE_SIM_ESP_TIMER_H
+#define NATIVE_SIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
+
+#endif // NATIVE_SIM_ESP_TIMER_H
@@ -0,0 +1,57 @@
+/**
+ * @file FreeRTOS.h
+ * @brief FreeRTOS kernel types for the native virtual device
+ *
+ * Tasks are POSIX threads, ticks are milliseconds of CLOCK_MONOTONIC and
+ * every portMUX critical section takes one process-wide recursive lock
+ * (the single-lock equivalent of disabling interrupts on both cores).
+ * Task priorities and core affinity are accepted and ignored.
+ */
+
+#ifndef NATIVE_SIM_FREERTOS_H
+#define NATIVE_SIM_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// ============================================================================
+// Critical Sections
+// ============================================================================
+
+typedef struct {
+    uint32_t owner;              // Unused: one lock serves every mux
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void simEnterCritical(portMUX_TYPE* mux);
+void simExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) simEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) simExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) simEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) simExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) simEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) simExitCritical(mux)
+#define taskENTER_CRITICAL(mux) simEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux) simExitCritical(mux)
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+BaseType_t xPortGetCoreID();
+
+#endif // NATIVE_SIM_FREERTOS_H
@@ -0,0 +1,20 @@
+/**
+ * @file queue.h
+ * @brief FreeRTOS copy queues (native virtual device)
+ */
+
+#ifndef NATIVE_SIM_QUEUE_H
+#define NATIVE_SIM_QUEUE_H
+
+#include "FreeRTOS.h"
+
+struct SimQueue;
+typedef SimQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_priority_woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#endif // NATIVE_SIM_QUEUE_H
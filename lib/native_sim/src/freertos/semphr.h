@@ -0,0 +1,19 @@
+/**
+ * @file semphr.h
+ * @brief FreeRTOS mutexes on std::timed_mutex (native virtual device)
+ */
+
+#ifndef NATIVE_SIM_SEMPHR_H
+#define NATIVE_SIM_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+struct SimSemaphore;
+typedef SimSemaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif // NATIVE_SIM_SEMPHR_H
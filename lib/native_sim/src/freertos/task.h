@@ -0,0 +1,36 @@
+/**
+ * @file task.h
+ * @brief FreeRTOS task API on POSIX threads (native virtual device)
+ */
+
+#ifndef NATIVE_SIM_TASK_H
+#define NATIVE_SIM_TASK_H
+
+#include "FreeRTOS.h"
+
+struct SimTask;
+typedef SimTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack_depth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core_id);
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stack_depth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t increment);
+BaseType_t xTaskDelayUntil(TickType_t* previous_wake, TickType_t increment);
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+void xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+
+#endif // NATIVE_SIM_TASK_H
@@ -0,0 +1,23 @@
+/**
+ * @file adc_hal.h
+ * @brief ADC HAL oneshot conversion of the native virtual device
+ *
+ * Channel numbers are GPIO numbers here (see digitalPinToAnalogChannel()),
+ * so a conversion reads the same simulated input as analogRead().
+ */
+
+#ifndef NATIVE_SIM_ADC_HAL_H
+#define NATIVE_SIM_ADC_HAL_H
+
+typedef enum {
+    ADC_NUM_1 = 0,
+    ADC_NUM_2 = 1
+} adc_ll_num_t;
+
+/**
+ * @brief One 12-bit conversion
+ * @return 0 (ESP_OK)
+ */
+int adc_hal_convert(adc_ll_num_t adc_n, int channel, int* out_raw);
+
+#endif // NATIVE_SIM_ADC_HAL_H
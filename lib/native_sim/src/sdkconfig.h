@@ -0,0 +1,14 @@
+/**
+ * @file sdkconfig.h
+ * @brief ESP-IDF configuration of the native virtual device
+ *
+ * No power management and no bootloader rollback: the firmware takes its
+ * CONFIG_PM_ENABLE = 0 and software rollback paths.
+ */
+
+#ifndef NATIVE_SIM_SDKCONFIG_H
+#define NATIVE_SIM_SDKCONFIG_H
+
+#define CONFIG_FREERTOS_HZ 1000
+
+#endif // NATIVE_SIM_SDKCONFIG_H
@@ -0,0 +1,487 @@
+/**
+ * @file sim_core.cpp
+ * @brief Clock, pins, ADC, LEDC, hardware timers and UART plumbing
+ *        of the native virtual device
+ */
+
+#include "Arduino.h"
+#include "sim_core.h"
+#include "sim_plant.h"
+#include "sim_scene.h"
+#include "sim_uart.h"
+#include "soc/gpio_struct.h"
+#include "soc/ledc_struct.h"
+#include "hal/adc_hal.h"
+#include "esp_adc_cal.h"
+#include "config/pins.h"
+#include "sensors/ultrasonic_sensor.h"
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <time.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+static SimConfig config;
+
+static const char* envString(const char* name, const char* fallback) {
+    const char* value = getenv(name);
+    return (value != nullptr && value[0] != '\0') ? value : fallback;
+}
+
+static float envFloat(const char* name, float fallback) {
+    const char* value = getenv(name);
+    return (value != nullptr && value[0] != '\0') ? (float)atof(value) : fallback;
+}
+
+/**
+ * @brief Parse a "<from_s>:<to_s>" fault window (to_s omitted = forever)
+ */
+static void envWindow(const char* name, float window[2]) {
+    window[0] = -1.0f;
+    window[1] = -1.0f;
+    const char* value = getenv(name);
+    if (value == nullptr || value[0] == '\0') {
+        return;
+    }
+    window[0] = (float)atof(value);
+    const char* colon = strchr(value, ':');
+    window[1] = (colon != nullptr && colon[1] != '\0') ? (float)atof(colon + 1) : 1e9f;
+}
+
+static void loadConfig() {
+    config.pty_link = envString("SIM_PTY_LINK", "/tmp/ttyESP32SIM");
+    config.data_dir = envString("SIM_DATA_DIR", ".pio/sim");
+    config.scene = envString("SIM_SCENE", "moving");
+    config.pot_mv[0] = envFloat("SIM_POT1_MV", 3300.0f);
+    config.pot_mv[1] = envFloat("SIM_POT2_MV", 1650.0f);
+    config.tof_hz = envFloat("SIM_TOF_HZ", 100.0f);
+    config.servo_dps = envFloat("SIM_SERVO_DPS", 450.0f);
+    config.servo_lag_ms = envFloat("SIM_SERVO_LAG_MS", 15.0f);
+    config.pad_delay_ms = envFloat("SIM_PAD_DELAY_MS", 0.0f);
+    config.pad_coupling = envFloat("SIM_PAD_COUPLING", 0.0f);
+    envWindow("SIM_TOF_DEAD", config.tof_dead_s);
+    envWindow("SIM_US_STUCK", config.us_stuck_s);
+    envWindow("SIM_PAD_PRESS", config.pad_press_s);
+}
+
+const SimConfig& simConfig() {
+    return config;
+}
+
+bool simFaultActive(const float window[2]) {
+    float now_s = (float)(simMicros64() * 1e-6);
+    return window[0] >= 0.0f && now_s >= window[0] && now_s < window[1];
+}
+
+// ============================================================================
+// Clock
+// ============================================================================
+
+static uint64_t monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static const uint64_t start_us = monotonicMicros();
+
+uint64_t simMicros64() {
+    return monotonicMicros() - start_us;
+}
+
+void simSleepUntil(uint64_t deadline_us) {
+    uint64_t absolute = start_us + deadline_us;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(absolute / 1000000ULL);
+    ts.tv_nsec = (long)(absolute % 1000000ULL) * 1000L;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0) {
+        // EINTR: keep sleeping
+    }
+}
+
+float simNoise(float stddev) {
+    static std::mutex noise_lock;
+    static std::mt19937 generator(12345);
+    std::normal_distribution<float> normal(0.0f, stddev);
+    std::lock_guard<std::mutex> guard(noise_lock);
+    return normal(generator);
+}
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(simMicros64() / 1000ULL);
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)simMicros64();
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(ms);
+}
+
+void delayMicroseconds(uint32_t us) {
+    simSleepUntil(simMicros64() + us);
+}
+
+void yield() {
+    std::this_thread::yield();
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)simMicros64();
+}
+
+// ============================================================================
+// GPIO
+// ============================================================================
+
+static std::atomic<uint8_t> pin_levels[SIM_GPIO_COUNT];
+
+gpio_dev_t GPIO;
+
+uint8_t simPinLevel(uint8_t pin) {
+    return pin < SIM_GPIO_COUNT ? pin_levels[pin].load() : LOW;
+}
+
+void simPinWriteMask(int bank, uint32_t mask, bool level) {
+    for (int bit = 0; bit < 32; bit++) {
+        int pin = bank * 32 + bit;
+        if ((mask & (1UL << bit)) && pin < SIM_GPIO_COUNT) {
+            pin_levels[pin] = level ? HIGH : LOW;
+        }
+    }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < SIM_GPIO_COUNT) {
+        pin_levels[pin] = val ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return simPinLevel(pin);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+    (void)state;
+    (void)timeout;
+    if (pin != ULTRASONIC_PIN) {
+        return 0;
+    }
+    float distance_cm = simSceneUltrasonic();
+    return (unsigned long)(distance_cm * US_PER_CM);
+}
+
+// ============================================================================
+// ADC
+// ============================================================================
+
+static uint8_t muxChannel() {
+    return (simPinLevel(MUX_S0) ? 0x01 : 0) | (simPinLevel(MUX_S1) ? 0x02 : 0) |
+           (simPinLevel(MUX_S2) ? 0x04 : 0) | (simPinLevel(MUX_S3) ? 0x08 : 0);
+}
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+    float mv = 0.0f;
+    if (pin == MUX_SIG) {
+        mv = simPlantMuxMillivolts(muxChannel());
+    } else if (pin == ULTRASONIC_PIN) {
+        // SIM_US_STUCK: the output freezes at its last value
+        static float held_mv = 0.0f;
+        if (!simFaultActive(config.us_stuck_s)) {
+            held_mv = simSceneUltrasonic() * (3300.0f / 512.0f);
+        }
+        mv = held_mv;
+    }
+    mv = constrain(mv, 0.0f, 3300.0f);
+    return (uint32_t)(mv + 0.5f);
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return (uint16_t)(analogReadMilliVolts(pin) * 4095UL / 3300UL);
+}
+
+void analogReadResolution(uint8_t bits) {
+    (void)bits;
+}
+
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation) {
+    (void)pin;
+    (void)attenuation;
+}
+
+int adc_hal_convert(adc_ll_num_t adc_n, int channel, int* out_raw) {
+    (void)adc_n;
+    *out_raw = analogRead((uint8_t)channel);
+    return 0;
+}
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t adc_num, adc_atten_t atten, adc_bits_width_t bit_width,
+                                             uint32_t default_vref, esp_adc_cal_characteristics_t* chars) {
+    (void)adc_num;
+    (void)atten;
+    (void)bit_width;
+    chars->vref = default_vref;
+    return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t adc_reading, const esp_adc_cal_characteristics_t* chars) {
+    (void)chars;
+    return (adc_reading * 3300UL + 2047UL) / 4095UL;   // Inverse of analogRead()
+}
+
+// ============================================================================
+// LEDC
+// ============================================================================
+
+constexpr int LEDC_CHANNELS = 8;
+constexpr int LEDC_TIMERS = 4;
+
+struct LedcTimerState {
+    double freq_hz;
+    uint8_t bits;
+};
+
+static LedcTimerState ledc_timers[LEDC_TIMERS];
+static std::atomic<uint32_t> ledc_duty[LEDC_CHANNELS];
+static std::atomic<uint8_t> pin_channel[SIM_GPIO_COUNT];   // Channel + 1, 0 = not attached
+
+ledc_dev_t LEDC;
+
+static int ledcTimerOf(uint8_t channel) {
+    return (channel / 2) % LEDC_TIMERS;   // Arduino core pairing of channels on timers
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits) {
+    if (channel >= LEDC_CHANNELS) {
+        return 0.0;
+    }
+    LedcTimerState& timer = ledc_timers[ledcTimerOf(channel)];
+    timer.freq_hz = freq;
+    timer.bits = resolution_bits;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    if (pin < SIM_GPIO_COUNT && channel < LEDC_CHANNELS) {
+        pin_channel[pin] = channel + 1;
+    }
+}
+
+void ledcDetachPin(uint8_t pin) {
+    if (pin < SIM_GPIO_COUNT) {
+        pin_channel[pin] = 0;
+    }
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel < LEDC_CHANNELS) {
+        ledc_duty[channel] = duty;
+    }
+}
+
+uint32_t ledcRead(uint8_t channel) {
+    return channel < LEDC_CHANNELS ? ledc_duty[channel].load() : 0;
+}
+
+float simPinDuty(uint8_t pin) {
+    if (pin >= SIM_GPIO_COUNT || pin_channel[pin] == 0) {
+        return 0.0f;
+    }
+    int channel = pin_channel[pin] - 1;
+    const LedcTimerState& timer = ledc_timers[ledcTimerOf(channel)];
+    if (timer.bits == 0) {
+        return 0.0f;
+    }
+    float duty = (float)ledc_duty[channel] / (float)(1UL << timer.bits);
+    return duty > 1.0f ? 1.0f : duty;
+}
+
+uint32_t simLedcCounter(uint8_t timer) {
+    if (timer >= LEDC_TIMERS || ledc_timers[timer].freq_hz <= 0.0 || ledc_timers[timer].bits == 0) {
+        return 0;
+    }
+    // All timers started at t = 0: counter = elapsed counts modulo the period
+    const LedcTimerState& t = ledc_timers[timer];
+    uint32_t period = 1UL << t.bits;
+    double counts = (double)simMicros64() * 1e-6 * t.freq_hz * period;
+    return (uint32_t)fmod(counts, (double)period);
+}
+
+// ============================================================================
+// CPU Frequency
+// ============================================================================
+
+static std::atomic<uint32_t> cpu_freq_mhz(240);
+
+bool setCpuFrequencyMhz(uint32_t freq) {
+    cpu_freq_mhz = freq;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return cpu_freq_mhz;
+}
+
+// ============================================================================
+// Hardware Timers
+// ============================================================================
+
+struct hw_timer_s {
+    uint16_t divider;
+    uint64_t alarm_ticks;
+    bool autoreload;
+    void (*isr)(void);
+    std::atomic<bool> enabled;
+    std::atomic<bool> running;
+    std::thread thread;
+};
+
+static void timerThread(hw_timer_t* timer) {
+    uint64_t next_us = simMicros64();
+    while (timer->running) {
+        uint64_t period_us = timer->alarm_ticks * timer->divider / 80ULL;   // 80 MHz APB
+        if (period_us == 0) {
+            period_us = 1000;
+        }
+        next_us += period_us;
+        simSleepUntil(next_us);
+        if (timer->enabled && timer->isr != nullptr) {
+            timer->isr();
+            if (!timer->autoreload) {
+                timer->enabled = false;
+            }
+        }
+    }
+}
+
+hw_timer_t* timerBegin(uint8_t num, uint16_t divider, bool count_up) {
+    (void)num;
+    (void)count_up;
+    hw_timer_t* timer = new hw_timer_t();
+    timer->divider = divider;
+    timer->alarm_ticks = 0;
+    timer->autoreload = false;
+    timer->isr = nullptr;
+    timer->enabled = false;
+    timer->running = true;
+    timer->thread = std::thread(timerThread, timer);
+    return timer;
+}
+
+void timerEnd(hw_timer_t* timer) {
+    if (timer == nullptr) {
+        return;
+    }
+    timer->running = false;
+    timer->thread.join();
+    delete timer;
+}
+
+void timerAttachInterrupt(hw_timer_t* timer, void (*fn)(void), bool edge) {
+    (void)edge;
+    timer->isr = fn;
+}
+
+void timerDetachInterrupt(hw_timer_t* timer) {
+    timer->isr = nullptr;
+}
+
+void timerAlarmWrite(hw_timer_t* timer, uint64_t alarm_value, bool autoreload) {
+    timer->alarm_ticks = alarm_value;
+    timer->autoreload = autoreload;
+}
+
+void timerAlarmEnable(hw_timer_t* timer) {
+    timer->enabled = true;
+}
+
+void timerAlarmDisable(hw_timer_t* timer) {
+    timer->enabled = false;
+}
+
+// ============================================================================
+// UARTs
+// ============================================================================
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+
+SimUart* simUartDevice(int uart_nr) {
+    switch (uart_nr) {
+        case 0: return simPtyUart();
+        case 1: return simTofUart();
+        default: return simSonarUart();
+    }
+}
+
+HardwareSerial::HardwareSerial(int uart_nr) : uart_nr(uart_nr) {}
+
+SimUart* HardwareSerial::device() {
+    return simUartDevice(uart_nr);
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rx_pin, int8_t tx_pin,
+                           bool invert, unsigned long timeout_ms, uint8_t rxfifo_full_thrhd) {
+    (void)config;
+    (void)rx_pin;
+    (void)tx_pin;
+    (void)invert;
+    (void)timeout_ms;
+    (void)rxfifo_full_thrhd;
+    device()->begin(baud);
+}
+
+int HardwareSerial::available() {
+    return device()->available();
+}
+
+int HardwareSerial::read() {
+    return device()->read();
+}
+
+int HardwareSerial::peek() {
+    return device()->peek();
+}
+
+size_t HardwareSerial::write(uint8_t byte) {
+    return device()->write(&byte, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return device()->write(buffer, size);
+}
+
+int HardwareSerial::availableForWrite() {
+    return 4096;
+}
+
+void HardwareSerial::flush() {
+    device()->flush();
+}
+
+// ============================================================================
+// Startup
+// ============================================================================
+
+void simEspSetArgs(int argc, char** argv);   // sim_esp.cpp
+void simStartPty();                          // sim_pty.cpp
+void simStartPhysics();                      // sim_main.cpp
+
+void simInit(int argc, char** argv) {
+    simEspSetArgs(argc, argv);
+    loadConfig();
+    simStartPty();
+    simStartPhysics();
+}
@@ -0,0 +1,92 @@
+/**
+ * @file sim_core.h
+ * @brief Native virtual device: configuration, clock and pin state
+ *
+ * The firmware runs unmodified on top of this library ([env:native] in
+ * platformio.ini). Settings come from environment variables, read once
+ * at startup:
+ *
+ *   SIM_PTY_LINK     Symlink to the host pty (default /tmp/ttyESP32SIM)
+ *   SIM_DATA_DIR     NVS and OTA slot storage (default .pio/sim)
+ *   SIM_SCENE        moving | static:<cm> | empty (default moving)
+ *   SIM_POT1_MV      Force scale potentiometer (default 3300)
+ *   SIM_POT2_MV      Distance scale potentiometer (default 1650)
+ *   SIM_TOF_HZ       TOF frame rate (default 100)
+ *   SIM_SERVO_DPS    Servo slew rate, deg/s (default 450)
+ *   SIM_SERVO_LAG_MS Servo dead time (default 15)
+ *   SIM_PAD_DELAY_MS Transport delay from actuator force to pad (default 0)
+ *   SIM_PAD_COUPLING Share of a neighbour's force a pad reads (default 0)
+ *   SIM_TOF_DEAD     <from_s>[:<to_s>] TOF sends no frames (default never)
+ *   SIM_US_STUCK     <from_s>[:<to_s>] ultrasonic output frozen (default never)
+ */
+
+#ifndef NATIVE_SIM_CORE_H
+#define NATIVE_SIM_CORE_H
+
+#include <stdint.h>
+
+struct SimConfig {
+    const char* pty_link;
+    const char* data_dir;
+    const char* scene;
+    float pot_mv[2];
+    float tof_hz;
+    float servo_dps;
+    float servo_lag_ms;
+    float pad_delay_ms;
+    float pad_coupling;
+    float tof_dead_s[2];         // Fault windows since start (s), -1 = none
+    float us_stuck_s[2];
+    float pad_press_s[2];
+};
+
+/**
+ * @brief Settings parsed from the environment (valid after simInit())
+ */
+const SimConfig& simConfig();
+
+/**
+ * @brief Check whether a fault window of the config is open now
+ */
+bool simFaultActive(const float window[2]);
+
+/**
+ * @brief Parse the environment, create the pty and start the physics thread
+ */
+void simInit(int argc, char** argv);
+
+/**
+ * @brief Microseconds since process start (64-bit, never wraps)
+ */
+uint64_t simMicros64();
+
+/**
+ * @brief Sleep until simMicros64() reaches deadline_us
+ */
+void simSleepUntil(uint64_t deadline_us);
+
+/**
+ * @brief Gaussian noise sample (thread-safe)
+ */
+float simNoise(float stddev);
+
+// ============================================================================
+// Pins (written by the firmware, read by the plant)
+// ============================================================================
+
+constexpr int SIM_GPIO_COUNT = 49;
+
+uint8_t simPinLevel(uint8_t pin);
+void simPinWriteMask(int bank, uint32_t mask, bool level);
+
+/**
+ * @brief LEDC duty on a pin as a fraction of the period (0-1)
+ */
+float simPinDuty(uint8_t pin);
+
+/**
+ * @brief LEDC counter of a timer at the current time (0 to 2^bits - 1)
+ */
+uint32_t simLedcCounter(uint8_t timer);
+
+#endif // NATIVE_SIM_CORE_H
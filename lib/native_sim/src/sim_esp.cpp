@@ -0,0 +1,313 @@
+/**
+ * @file sim_esp.cpp
+ * @brief ESP class, ROM CRC, base64 and OTA slots of the native virtual device
+ */
+
+#include "Arduino.h"
+#include "esp_ota_ops.h"
+#include "esp_rom_crc.h"
+#include "mbedtls/base64.h"
+#include "sim_core.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+EspClass ESP;
+
+static int saved_argc = 0;
+static char** saved_argv = nullptr;
+
+void simEspSetArgs(int argc, char** argv) {
+    saved_argc = argc;
+    saved_argv = argv;
+}
+
+void simPtyKeepAcrossExec();   // sim_pty.cpp
+
+// ============================================================================
+// ESP Class
+// ============================================================================
+
+constexpr uint32_t SIM_HEAP_SIZE = 320000;
+constexpr uint32_t SIM_FREE_HEAP = 200000;
+
+uint32_t EspClass::getHeapSize() {
+    return SIM_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return SIM_FREE_HEAP;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return SIM_FREE_HEAP;
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+    return getCpuFrequencyMhz();
+}
+
+const char* EspClass::getChipModel() {
+    return "ESP32-S3 (native sim)";
+}
+
+uint8_t EspClass::getChipRevision() {
+    return 0;
+}
+
+void EspClass::restart() {
+    fprintf(stderr, "native_sim: restart\n");
+    fflush(nullptr);
+    simPtyKeepAcrossExec();
+    (void)saved_argc;
+    execv("/proc/self/exe", saved_argv);
+    perror("native_sim: execv");
+    _exit(1);
+}
+
+// ============================================================================
+// CRC-32 and Base64
+// ============================================================================
+
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const* buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+static int base64Value(unsigned char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+int mbedtls_base64_decode(unsigned char* dst, size_t dlen, size_t* olen,
+                          const unsigned char* src, size_t slen) {
+    size_t symbols = 0;
+    size_t padding = 0;
+    for (size_t i = 0; i < slen; i++) {
+        if (src[i] == '=') {
+            padding++;
+        } else if (padding > 0 || base64Value(src[i]) < 0) {
+            return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+        } else {
+            symbols++;
+        }
+    }
+    if (padding > 2 || (symbols + padding) % 4 != 0) {
+        return MBEDTLS_ERR_BASE64_INVALID_CHARACTER;
+    }
+
+    size_t needed = (symbols * 6) / 8;
+    *olen = needed;
+    if (dst == nullptr || dlen < needed) {
+        return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+    }
+
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t out = 0;
+    for (size_t i = 0; i < symbols; i++) {
+        acc = (acc << 6) | (uint32_t)base64Value(src[i]);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            dst[out++] = (unsigned char)(acc >> bits);
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// OTA Slots
+// ============================================================================
+//
+// SIM_DATA_DIR/ota/app0.bin, app1.bin hold received images and
+// SIM_DATA_DIR/ota/boot the selected slot. Only the ESP image magic byte
+// is validated; the native binary itself never changes.
+// ============================================================================
+
+constexpr uint32_t OTA_SLOT_SIZE = 0x140000;   // default.csv app slot
+constexpr uint8_t ESP_IMAGE_MAGIC = 0xE9;
+
+static esp_partition_t slots[2] = {
+    {0x10000, OTA_SLOT_SIZE, "app0", false},
+    {0x150000, OTA_SLOT_SIZE, "app1", false},
+};
+
+struct OtaSession {
+    FILE* file;
+    int slot;
+    uint32_t written;
+    uint8_t first_byte;
+};
+
+static OtaSession session = {nullptr, -1, 0, 0};
+static int running_slot = -1;
+
+static std::string otaDir() {
+    return std::string(simConfig().data_dir) + "/ota";
+}
+
+static std::string slotPath(int slot) {
+    return otaDir() + "/" + slots[slot].label + ".bin";
+}
+
+static int slotIndex(const esp_partition_t* partition) {
+    if (partition == &slots[0]) return 0;
+    if (partition == &slots[1]) return 1;
+    return -1;
+}
+
+static void ensureOtaDir() {
+    std::string base = simConfig().data_dir;
+    for (size_t pos = 0; pos <= base.size(); pos++) {
+        if (pos == base.size() || (base[pos] == '/' && pos > 0)) {
+            mkdir(base.substr(0, pos).c_str(), 0755);
+        }
+    }
+    mkdir(otaDir().c_str(), 0755);
+}
+
+static int bootSlot() {
+    FILE* f = fopen((otaDir() + "/boot").c_str(), "r");
+    int slot = 0;
+    if (f != nullptr) {
+        if (fscanf(f, "%d", &slot) != 1 || slot < 0 || slot > 1) {
+            slot = 0;
+        }
+        fclose(f);
+    }
+    return slot;
+}
+
+const esp_partition_t* esp_ota_get_running_partition(void) {
+    if (running_slot < 0) {
+        running_slot = bootSlot();   // Selected slot at process start
+    }
+    return &slots[running_slot];
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start_from) {
+    int from = slotIndex(start_from ? start_from : esp_ota_get_running_partition());
+    return &slots[from == 0 ? 1 : 0];
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t* partition, size_t image_size, esp_ota_handle_t* out_handle) {
+    (void)image_size;
+    int slot = slotIndex(partition);
+    if (slot < 0 || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (slot == slotIndex(esp_ota_get_running_partition()) || session.file != nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ensureOtaDir();
+    session.file = fopen(slotPath(slot).c_str(), "wb");
+    if (session.file == nullptr) {
+        return ESP_FAIL;
+    }
+    session.slot = slot;
+    session.written = 0;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void* data, size_t size) {
+    if (handle != 1 || session.file == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (session.written == 0 && size > 0) {
+        session.first_byte = static_cast<const uint8_t*>(data)[0];
+        if (session.first_byte != ESP_IMAGE_MAGIC) {
+            return ESP_ERR_OTA_VALIDATE_FAILED;
+        }
+    }
+    if (session.written + size > OTA_SLOT_SIZE || fwrite(data, 1, size, session.file) != size) {
+        return ESP_FAIL;
+    }
+    session.written += (uint32_t)size;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle) {
+    if (handle != 1 || session.file == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bool ok = fclose(session.file) == 0;
+    session.file = nullptr;
+    if (!ok || session.written == 0 || session.first_byte != ESP_IMAGE_MAGIC) {
+        unlink(slotPath(session.slot).c_str());
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle) {
+    if (handle != 1 || session.file == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    fclose(session.file);
+    session.file = nullptr;
+    unlink(slotPath(session.slot).c_str());
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+    int slot = slotIndex(partition);
+    if (slot < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // A slot that never received an image still holds the factory build
+    FILE* image = fopen(slotPath(slot).c_str(), "rb");
+    if (image != nullptr) {
+        int magic = fgetc(image);
+        fclose(image);
+        if (magic != ESP_IMAGE_MAGIC) {
+            return ESP_ERR_OTA_VALIDATE_FAILED;
+        }
+    } else if (slot != 0) {
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    ensureOtaDir();
+    FILE* f = fopen((otaDir() + "/boot").c_str(), "w");
+    if (f == nullptr) {
+        return ESP_FAIL;
+    }
+    fprintf(f, "%d\n", slot);
+    fclose(f);
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot(void) {
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(nullptr);
+    if (esp_ota_set_boot_partition(previous) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    ESP.restart();
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t* partition, esp_ota_img_states_t* state) {
+    if (slotIndex(partition) < 0 || state == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *state = ESP_OTA_IMG_VALID;
+    return ESP_OK;
+}
@@ -0,0 +1,284 @@
+/**
+ * @file sim_freertos.cpp
+ * @brief FreeRTOS kernel services on POSIX threads (native virtual device)
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "sim_core.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Critical Sections
+// ============================================================================
+
+static std::recursive_mutex critical_lock;
+
+void simEnterCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    critical_lock.lock();
+}
+
+void simExitCritical(portMUX_TYPE* mux) {
+    (void)mux;
+    critical_lock.unlock();
+}
+
+BaseType_t xPortGetCoreID() {
+    return 0;
+}
+
+// ============================================================================
+// Tasks
+// ============================================================================
+
+struct SimTask {
+    std::string name;
+    TaskFunction_t fn;
+    void* parameter;
+    uint32_t stack_depth;
+    pthread_t thread;
+
+    std::mutex notify_lock;
+    std::condition_variable notify_cv;
+    uint32_t notify_count = 0;
+};
+
+static thread_local SimTask* current_task = nullptr;
+
+static void* taskTrampoline(void* arg) {
+    SimTask* task = static_cast<SimTask*>(arg);
+    current_task = task;
+    task->fn(task->parameter);
+    return nullptr;   // Returning from a task is an error on FreeRTOS; here it just ends
+}
+
+static std::chrono::microseconds ticksToDuration(TickType_t ticks) {
+    return std::chrono::microseconds((uint64_t)ticks * 1000ULL);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core_id) {
+    (void)priority;
+    (void)core_id;
+    SimTask* task = new SimTask();
+    task->name = name ? name : "";
+    task->fn = fn;
+    task->parameter = parameter;
+    task->stack_depth = stack_depth;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&task->thread, &attr, taskTrampoline, task);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        delete task;
+        return pdFAIL;
+    }
+    if (handle != nullptr) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, parameter, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == current_task) {
+        pthread_exit(nullptr);
+    }
+    // Deleting another task is not used by the firmware; the thread keeps running
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(simMicros64() / 1000ULL);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    simSleepUntil(simMicros64() + (uint64_t)ticks * 1000ULL);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* previous_wake, TickType_t increment) {
+    TickType_t wake = *previous_wake + increment;
+    TickType_t now = xTaskGetTickCount();
+    *previous_wake = wake;
+    if ((int32_t)(wake - now) <= 0) {
+        return pdFALSE;   // Deadline already passed: no delay, like the kernel
+    }
+    simSleepUntil(simMicros64() + (uint64_t)(wake - now) * 1000ULL);
+    return pdTRUE;
+}
+
+void vTaskDelayUntil(TickType_t* previous_wake, TickType_t increment) {
+    xTaskDelayUntil(previous_wake, increment);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (current_task == nullptr) {
+        // Main thread (setup/loop) gets its handle on first use
+        SimTask* task = new SimTask();
+        task->name = "loopTask";
+        task->thread = pthread_self();
+        task->stack_depth = 8192;
+        current_task = task;
+    }
+    return current_task;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    SimTask* t = task ? task : xTaskGetCurrentTaskHandle();
+    return t->stack_depth / 2;   // No stack measurement on the host
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+    if (task == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(task->notify_lock);
+        task->notify_count++;
+    }
+    task->notify_cv.notify_one();
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_woken) {
+    xTaskNotifyGive(task);
+    if (higher_priority_woken != nullptr) {
+        *higher_priority_woken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    SimTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> guard(task->notify_lock);
+    auto ready = [task] { return task->notify_count > 0; };
+    if (ticks_to_wait == portMAX_DELAY) {
+        task->notify_cv.wait(guard, ready);
+    } else if (!task->notify_cv.wait_for(guard, ticksToDuration(ticks_to_wait), ready)) {
+        return 0;
+    }
+    uint32_t value = task->notify_count;
+    task->notify_count = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+// ============================================================================
+// Mutexes
+// ============================================================================
+
+struct SimSemaphore {
+    std::timed_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new SimSemaphore();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+    if (ticks_to_wait == portMAX_DELAY) {
+        semaphore->mutex.lock();
+        return pdTRUE;
+    }
+    return semaphore->mutex.try_lock_for(ticksToDuration(ticks_to_wait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+// ============================================================================
+// Queues
+// ============================================================================
+
+struct SimQueue {
+    std::mutex lock;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    SimQueue* queue = new SimQueue();
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    if (queue == nullptr) {
+        return pdFALSE;
+    }
+    std::unique_lock<std::mutex> guard(queue->lock);
+    auto has_space = [queue] { return queue->items.size() < queue->length; };
+    if (ticks_to_wait == portMAX_DELAY) {
+        queue->not_full.wait(guard, has_space);
+    } else if (!queue->not_full.wait_for(guard, ticksToDuration(ticks_to_wait), has_space)) {
+        return pdFALSE;   // errQUEUE_FULL
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+    guard.unlock();
+    queue->not_empty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_priority_woken) {
+    if (higher_priority_woken != nullptr) {
+        *higher_priority_woken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait) {
+    if (queue == nullptr) {
+        return pdFALSE;
+    }
+    std::unique_lock<std::mutex> guard(queue->lock);
+    auto has_item = [queue] { return !queue->items.empty(); };
+    if (ticks_to_wait == portMAX_DELAY) {
+        queue->not_empty.wait(guard, has_item);
+    } else if (!queue->not_empty.wait_for(guard, ticksToDuration(ticks_to_wait), has_item)) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    guard.unlock();
+    queue->not_full.notify_one();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    if (queue == nullptr) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return (UBaseType_t)queue->items.size();
+}
@@ -0,0 +1,41 @@
+/**
+ * @file sim_main.cpp
+ * @brief Process entry of the native virtual device
+ *
+ * Mirrors the Arduino-ESP32 loopTask: setup() once, then loop() forever
+ * on the main thread. A physics thread advances the plant and the servo
+ * mount at SIM_PHYSICS_HZ.
+ */
+
+#include "Arduino.h"
+#include "sim_core.h"
+#include "sim_plant.h"
+#include "sim_scene.h"
+
+#include <thread>
+
+constexpr uint32_t SIM_PHYSICS_HZ = 1000;
+
+static void physicsThread() {
+    const uint64_t period_us = 1000000ULL / SIM_PHYSICS_HZ;
+    const float dt = 1.0f / SIM_PHYSICS_HZ;
+    uint64_t next_us = simMicros64();
+    for (;;) {
+        next_us += period_us;
+        simSleepUntil(next_us);
+        simPlantStep(dt);
+        simSceneStep(dt);
+    }
+}
+
+void simStartPhysics() {
+    std::thread(physicsThread).detach();
+}
+
+int main(int argc, char** argv) {
+    simInit(argc, argv);
+    setup();
+    for (;;) {
+        loop();
+    }
+}
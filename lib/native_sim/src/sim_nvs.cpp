@@ -0,0 +1,165 @@
+/**
+ * @file sim_nvs.cpp
+ * @brief Preferences (NVS) of the native virtual device
+ *
+ * Every key is a file SIM_DATA_DIR/nvs/<namespace>/<key> holding the raw
+ * value bytes. Like NVS, a read-only begin() fails for a namespace that
+ * was never written.
+ */
+
+#include "Preferences.h"
+#include "sim_core.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// ============================================================================
+// Internal Helper Functions
+// ============================================================================
+
+static bool makeDirs(const std::string& path) {
+    for (size_t pos = 1; pos <= path.size(); pos++) {
+        if (pos == path.size() || path[pos] == '/') {
+            std::string part = path.substr(0, pos);
+            if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    out.clear();
+    uint8_t chunk[512];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        out.insert(out.end(), chunk, chunk + n);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool writeFile(const std::string& path, const void* data, size_t len) {
+    // Write then rename: a crash never leaves a half-written value
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (f == nullptr) {
+        return false;
+    }
+    bool ok = fwrite(data, 1, len, f) == len;
+    ok = (fclose(f) == 0) && ok;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// ============================================================================
+// Preferences
+// ============================================================================
+
+bool Preferences::begin(const char* name, bool ro) {
+    if (opened || name == nullptr || name[0] == '\0' || strlen(name) > 15) {
+        return false;
+    }
+    dir = std::string(simConfig().data_dir) + "/nvs/" + name;
+    struct stat st;
+    if (stat(dir.c_str(), &st) != 0) {
+        if (ro || !makeDirs(dir)) {
+            return false;
+        }
+    }
+    read_only = ro;
+    opened = true;
+    return true;
+}
+
+void Preferences::end() {
+    opened = false;
+}
+
+std::string Preferences::keyPath(const char* key) const {
+    return dir + "/" + key;
+}
+
+bool Preferences::clear() {
+    if (!opened || read_only) {
+        return false;
+    }
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) {
+        return false;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (entry->d_name[0] != '.') {
+            unlink(keyPath(entry->d_name).c_str());
+        }
+    }
+    closedir(d);
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!opened || read_only || key == nullptr) {
+        return false;
+    }
+    return unlink(keyPath(key).c_str()) == 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    struct stat st;
+    return opened && key != nullptr && stat(keyPath(key).c_str(), &st) == 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!opened || read_only || key == nullptr || value == nullptr || len == 0) {
+        return 0;
+    }
+    return writeFile(keyPath(key), value, len) ? len : 0;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    struct stat st;
+    if (!opened || key == nullptr || stat(keyPath(key).c_str(), &st) != 0) {
+        return 0;
+    }
+    return (size_t)st.st_size;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t max_len) {
+    std::vector<uint8_t> data;
+    if (!opened || key == nullptr || buf == nullptr || !readFile(keyPath(key), data)) {
+        return 0;
+    }
+    if (data.size() > max_len) {
+        return 0;   // NVS refuses a buffer that is too small
+    }
+    memcpy(buf, data.data(), data.size());
+    return data.size();
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+    return putBytes(key, &value, sizeof(value));
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t default_value) {
+    uint8_t value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : default_value;
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+    return putBytes(key, &value, sizeof(value));
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t default_value) {
+    uint32_t value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : default_value;
+}
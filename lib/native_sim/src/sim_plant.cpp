@@ -0,0 +1,140 @@
+/**
+ * @file sim_plant.cpp
+ * @brief Motor and pressure pad model of the native virtual device
+ */
+
+#include "sim_plant.h"
+#include "sim_core.h"
+#include "config/pins.h"
+
+#include <math.h>
+#include <deque>
+#include <mutex>
+
+// ============================================================================
+// Model Constants
+// ============================================================================
+
+constexpr float CONTACT_POS = 0.3f;           // Travel (0-1) where the pad is touched
+constexpr float FREE_SPEED = 0.5f;            // Travel per second at full duty
+constexpr float PRESS_TAU_S = 0.15f;          // Force lag while pressing
+constexpr float RELEASE_TAU_S = 0.05f;        // Force lag while reversing
+constexpr float COAST_TAU_S = 2.0f;           // Force leak while coasting
+constexpr float PAD_OFFSET_MV = 300.0f;       // Pad output with no force
+constexpr float PAD_SPAN_MV = 2500.0f;        // Pad output change at full force
+constexpr float PAD_NOISE_MV = 4.0f;
+constexpr float PRESS_FAULT_FORCE = 1.1f;     // External load on pad 1 during SIM_PAD_PRESS
+
+// Per-motor gain spread, so the loops do not all behave identically
+static const float MOTOR_GAIN[NUM_MOTORS] = {1.00f, 0.92f, 1.08f, 0.96f, 1.04f};
+
+static const uint8_t PWM_PINS[NUM_MOTORS] = {M1_PWM, M2_PWM, M3_PWM, M4_PWM, M5_PWM};
+static const uint8_t IN1_PINS[NUM_MOTORS] = {M1_IN1, M2_IN1, M3_IN1, M4_IN1, M5_IN1};
+static const uint8_t IN2_PINS[NUM_MOTORS] = {M1_IN2, M2_IN2, M3_IN2, M4_IN2, M5_IN2};
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct MotorPlant {
+    float position;               // Actuator travel (0-1)
+    float force;                  // Normalized pad force (0-1)
+};
+
+struct ForceSample {
+    uint64_t at_us;
+    float force;
+};
+
+static MotorPlant motors[NUM_MOTORS];
+static std::deque<ForceSample> force_history[NUM_MOTORS];   // Front = force the pad sees
+static std::mutex plant_lock;
+
+// ============================================================================
+// Internal Helper Functions
+// ============================================================================
+
+static float approach(float value, float target, float tau, float dt) {
+    return value + (target - value) * (1.0f - expf(-dt / tau));
+}
+
+static void stepMotor(int i, float dt) {
+    MotorPlant& m = motors[i];
+    bool in1 = simPinLevel(IN1_PINS[i]);
+    bool in2 = simPinLevel(IN2_PINS[i]);
+    float duty = simPinDuty(PWM_PINS[i]) * MOTOR_GAIN[i];
+
+    if (in1 && !in2) {
+        // Forward: travel to the pad, then press with a force set by duty
+        if (m.position < CONTACT_POS) {
+            m.position = fminf(CONTACT_POS, m.position + duty * FREE_SPEED * dt);
+        } else {
+            m.force = approach(m.force, fminf(duty, 1.0f), PRESS_TAU_S, dt);
+        }
+    } else if (!in1 && in2) {
+        // Reverse: release the force, then retract
+        if (m.force > 0.01f) {
+            m.force = approach(m.force, 0.0f, RELEASE_TAU_S * (1.0f - 0.5f * duty), dt);
+        } else {
+            m.force = 0.0f;
+            m.position = fmaxf(0.0f, m.position - duty * FREE_SPEED * dt);
+        }
+    } else if (in1 && in2) {
+        // Coast: the screw backdrives slowly
+        m.force = approach(m.force, 0.0f, COAST_TAU_S, dt);
+    }
+    // Brake (both low): hold position and force
+}
+
+/**
+ * @brief Force motor i applies to its pad, as the pad currently sees it
+ */
+static float padForce(int i) {
+    return force_history[i].empty() ? motors[i].force : force_history[i].front().force;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void simPlantStep(float dt) {
+    std::lock_guard<std::mutex> guard(plant_lock);
+    uint64_t now_us = simMicros64();
+    uint64_t delay_us = (uint64_t)(simConfig().pad_delay_ms * 1000.0f);
+    for (int i = 0; i < NUM_MOTORS; i++) {
+        stepMotor(i, dt);
+        std::deque<ForceSample>& history = force_history[i];
+        history.push_back({now_us, motors[i].force});
+        while (history.size() > 1 && now_us - history[1].at_us >= delay_us) {
+            history.pop_front();
+        }
+    }
+}
+
+float simPlantMuxMillivolts(uint8_t channel) {
+    for (int i = 0; i < NUM_PRESSURE_PADS; i++) {
+        if (PP_CHANNELS[i] == channel) {
+            float force;
+            {
+                std::lock_guard<std::mutex> guard(plant_lock);
+                force = padForce(i);
+                if (i > 0) {
+                    force += simConfig().pad_coupling * padForce(i - 1);
+                }
+                if (i < NUM_MOTORS - 1) {
+                    force += simConfig().pad_coupling * padForce(i + 1);
+                }
+            }
+            if (i == 0 && simFaultActive(simConfig().pad_press_s)) {
+                force += PRESS_FAULT_FORCE;
+            }
+            return PAD_OFFSET_MV + force * PAD_SPAN_MV + simNoise(PAD_NOISE_MV);
+        }
+    }
+    for (int i = 0; i < NUM_POTENTIOMETERS; i++) {
+        if (POT_CHANNELS[i] == channel) {
+            return simConfig().pot_mv[i] + simNoise(2.0f);
+        }
+    }
+    return 0.0f;   // Unconnected input
+}
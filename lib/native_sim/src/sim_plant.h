@@ -0,0 +1,31 @@
+/**
+ * @file sim_plant.h
+ * @brief Motor and pressure pad model of the native virtual device
+ *
+ * Each motor presses its pad through a lead screw. While the actuator
+ * travels free (x < contact) the pad reads its offset; past contact the
+ * force follows the forward duty with a first-order lag. Reverse
+ * releases the force and retracts, brake holds, coast slowly leaks.
+ * The pad sees the force SIM_PAD_DELAY_MS late (strap slack, pad
+ * compliance), plus SIM_PAD_COUPLING times the force of each neighbouring
+ * motor (motor i-1 and i+1).
+ * Drive mode comes from the H-bridge pins exactly as the firmware sets
+ * them (IN1/IN2 levels plus LEDC duty on the PWM pin).
+ */
+
+#ifndef NATIVE_SIM_PLANT_H
+#define NATIVE_SIM_PLANT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Advance the motors by dt seconds (physics thread)
+ */
+void simPlantStep(float dt);
+
+/**
+ * @brief Voltage at the multiplexer output for a channel (mV)
+ */
+float simPlantMuxMillivolts(uint8_t channel);
+
+#endif // NATIVE_SIM_PLANT_H
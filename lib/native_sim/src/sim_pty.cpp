@@ -0,0 +1,191 @@
+/**
+ * @file sim_pty.cpp
+ * @brief Host link (UART0) of the native virtual device on a pseudo-terminal
+ *
+ * The slave side is published as a symlink at SIM_PTY_LINK, so the bridge
+ * opens it like the USB serial port of a real board. The device keeps its
+ * own handle on the slave: clients may come and go without the link
+ * hanging up. Output that the host does not drain within a few
+ * milliseconds is dropped, like a UART TX FIFO with nobody listening.
+ */
+
+#include "sim_uart.h"
+#include "sim_core.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <deque>
+#include <mutex>
+
+constexpr int PTY_WRITE_TIMEOUT_MS = 5;
+constexpr size_t PTY_RX_CHUNK = 256;
+
+static int master_fd = -1;
+static int slave_fd = -1;
+
+// ============================================================================
+// Host UART
+// ============================================================================
+
+class PtyUart : public SimUart {
+public:
+    int available() override {
+        std::lock_guard<std::mutex> guard(rx_lock);
+        fill();
+        return (int)rx.size();
+    }
+
+    int read() override {
+        std::lock_guard<std::mutex> guard(rx_lock);
+        fill();
+        if (rx.empty()) {
+            return -1;
+        }
+        uint8_t byte = rx.front();
+        rx.pop_front();
+        return byte;
+    }
+
+    int peek() override {
+        std::lock_guard<std::mutex> guard(rx_lock);
+        fill();
+        return rx.empty() ? -1 : rx.front();
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        if (master_fd < 0) {
+            return size;
+        }
+        std::lock_guard<std::mutex> guard(tx_lock);   // Keep each frame contiguous
+        size_t sent = 0;
+        while (sent < size) {
+            ssize_t n = ::write(master_fd, data + sent, size - sent);
+            if (n > 0) {
+                sent += (size_t)n;
+                continue;
+            }
+            if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                break;
+            }
+            struct pollfd pfd = {master_fd, POLLOUT, 0};
+            if (poll(&pfd, 1, PTY_WRITE_TIMEOUT_MS) <= 0) {
+                break;   // Host not reading: drop the rest
+            }
+        }
+        return size;
+    }
+
+private:
+    void fill() {
+        if (master_fd < 0) {
+            return;
+        }
+        uint8_t chunk[PTY_RX_CHUNK];
+        ssize_t n;
+        while ((n = ::read(master_fd, chunk, sizeof(chunk))) > 0) {
+            rx.insert(rx.end(), chunk, chunk + n);
+        }
+    }
+
+    std::mutex rx_lock;
+    std::mutex tx_lock;
+    std::deque<uint8_t> rx;
+};
+
+SimUart* simPtyUart() {
+    static PtyUart uart;
+    return &uart;
+}
+
+// ============================================================================
+// Setup and Teardown
+// ============================================================================
+
+static void removeLink() {
+    unlink(simConfig().pty_link);
+}
+
+static void onSignal(int sig) {
+    removeLink();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void installCleanup() {
+    atexit(removeLink);
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void simPtyKeepAcrossExec() {
+    // ESP.restart(): the new process image takes over the same pty, so the
+    // link path and any open client survive the reboot
+    char value[16];
+    fcntl(master_fd, F_SETFD, 0);
+    fcntl(slave_fd, F_SETFD, 0);
+    snprintf(value, sizeof(value), "%d", master_fd);
+    setenv("SIM_PTY_MASTER_FD", value, 1);
+    snprintf(value, sizeof(value), "%d", slave_fd);
+    setenv("SIM_PTY_SLAVE_FD", value, 1);
+}
+
+static bool adoptInheritedPty() {
+    const char* master = getenv("SIM_PTY_MASTER_FD");
+    const char* slave = getenv("SIM_PTY_SLAVE_FD");
+    if (master == nullptr || slave == nullptr) {
+        return false;
+    }
+    master_fd = atoi(master);
+    slave_fd = atoi(slave);
+    unsetenv("SIM_PTY_MASTER_FD");
+    unsetenv("SIM_PTY_SLAVE_FD");
+    fcntl(master_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(slave_fd, F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+void simStartPty() {
+    if (adoptInheritedPty()) {
+        fprintf(stderr, "native_sim: restarted on %s\n", simConfig().pty_link);
+        installCleanup();
+        return;
+    }
+
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        perror("native_sim: posix_openpt");
+        exit(1);
+    }
+    const char* slave_name = ptsname(master_fd);
+    slave_fd = open(slave_name, O_RDWR | O_NOCTTY);
+    if (slave_fd < 0) {
+        perror("native_sim: open pty slave");
+        exit(1);
+    }
+
+    // Raw 8N1 on both ends: binary frames must pass unmodified
+    struct termios tio;
+    tcgetattr(slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave_fd, TCSANOW, &tio);
+    fcntl(master_fd, F_SETFL, fcntl(master_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(master_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(slave_fd, F_SETFD, FD_CLOEXEC);
+
+    const char* link = simConfig().pty_link;
+    unlink(link);
+    if (symlink(slave_name, link) != 0) {
+        perror("native_sim: symlink");
+        exit(1);
+    }
+    installCleanup();
+
+    fprintf(stderr, "native_sim: serial port %s -> %s\n", link, slave_name);
+}
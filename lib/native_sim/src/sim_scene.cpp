@@ -0,0 +1,147 @@
+/**
+ * @file sim_scene.cpp
+ * @brief Servo mount and obstacle scene of the native virtual device
+ */
+
+#include "sim_scene.h"
+#include "sim_core.h"
+#include "ESP32Servo.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <mutex>
+
+// ============================================================================
+// Scene Constants
+// ============================================================================
+
+constexpr float BACKGROUND_CM = 450.0f;
+constexpr float TARGET_HALF_WIDTH_DEG = 15.0f;
+constexpr float PILLAR_ANGLE_DEG = 150.0f;
+constexpr float PILLAR_HALF_WIDTH_DEG = 6.0f;
+constexpr float PILLAR_CM = 120.0f;
+constexpr float ULTRASONIC_AXIS_DEG = 90.0f;
+constexpr float ULTRASONIC_HALF_CONE_DEG = 10.0f;
+constexpr float ULTRASONIC_MIN_RANGE_CM = 30.0f;
+constexpr float ULTRASONIC_MAX_RANGE_CM = 500.0f;
+constexpr float TWO_PI_F = 6.2831853f;
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct ServoCommand {
+    uint64_t at_us;
+    float angle_deg;
+};
+
+static std::mutex servo_lock;
+static std::deque<ServoCommand> pending;     // Commands still inside the dead time
+static float servo_target = 90.0f;
+static float servo_angle = 90.0f;
+
+// ============================================================================
+// Internal Helper Functions
+// ============================================================================
+
+static float sceneTime() {
+    return (float)(simMicros64() * 1e-6);
+}
+
+static bool sceneIs(const char* name) {
+    return strcmp(simConfig().scene, name) == 0;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void simServoCommand(float angle_deg) {
+    std::lock_guard<std::mutex> guard(servo_lock);
+    pending.push_back({simMicros64(), angle_deg});
+}
+
+void simSceneStep(float dt) {
+    uint64_t lag_us = (uint64_t)(simConfig().servo_lag_ms * 1000.0f);
+    uint64_t now_us = simMicros64();
+
+    std::lock_guard<std::mutex> guard(servo_lock);
+    while (!pending.empty() && now_us - pending.front().at_us >= lag_us) {
+        servo_target = pending.front().angle_deg;
+        pending.pop_front();
+    }
+    float max_step = simConfig().servo_dps * dt;
+    float error = servo_target - servo_angle;
+    servo_angle += fmaxf(-max_step, fminf(max_step, error));
+}
+
+float simServoAngle() {
+    std::lock_guard<std::mutex> guard(servo_lock);
+    return servo_angle;
+}
+
+float simSceneDistance(float angle_deg) {
+    const char* scene = simConfig().scene;
+    if (sceneIs("empty")) {
+        return -1.0f;
+    }
+    if (strncmp(scene, "static:", 7) == 0) {
+        return (float)atof(scene + 7);
+    }
+
+    // "moving" (default)
+    float t = sceneTime();
+    float distance = BACKGROUND_CM;
+    if (fabsf(angle_deg - PILLAR_ANGLE_DEG) <= PILLAR_HALF_WIDTH_DEG) {
+        distance = fminf(distance, PILLAR_CM);
+    }
+    float target_angle = 90.0f + 60.0f * sinf(TWO_PI_F * t / 40.0f);
+    float target_cm = 170.0f + 110.0f * sinf(TWO_PI_F * t / 23.0f);
+    if (fabsf(angle_deg - target_angle) <= TARGET_HALF_WIDTH_DEG) {
+        distance = fminf(distance, target_cm);
+    }
+    return distance;
+}
+
+float simSceneUltrasonic() {
+    float nearest = ULTRASONIC_MAX_RANGE_CM;
+    for (float a = ULTRASONIC_AXIS_DEG - ULTRASONIC_HALF_CONE_DEG;
+         a <= ULTRASONIC_AXIS_DEG + ULTRASONIC_HALF_CONE_DEG; a += 1.0f) {
+        float d = simSceneDistance(a);
+        if (d > 0.0f) {
+            nearest = fminf(nearest, d);
+        }
+    }
+    return fmaxf(ULTRASONIC_MIN_RANGE_CM, nearest + simNoise(1.0f));
+}
+
+// ============================================================================
+// ESP32Servo
+// ============================================================================
+
+int Servo::attach(int pin) {
+    attached_pin = pin;
+    return 0;
+}
+
+int Servo::attach(int pin, int min_us, int max_us) {
+    (void)min_us;
+    (void)max_us;
+    return attach(pin);
+}
+
+void Servo::write(int angle) {
+    if (angle < 0) {
+        angle = 0;
+    } else if (angle > 180) {
+        angle = 180;
+    }
+    angle_deg = angle;
+    simServoCommand((float)angle);
+}
+
+void Servo::writeMicroseconds(int us) {
+    write((us - 500) * 180 / 2000);   // 500-2500 us over 0-180 deg
+}
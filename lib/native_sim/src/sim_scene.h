@@ -0,0 +1,40 @@
+/**
+ * @file sim_scene.h
+ * @brief Servo mount and obstacle scene of the native virtual device
+ *
+ * SIM_SCENE selects the world seen by the TOF and the ultrasonic sensor:
+ * - moving:      wall at 450 cm, a person-sized target wandering in angle
+ *                and distance, a fixed pillar at 150 deg
+ * - static:<cm>  flat wall at <cm>
+ * - empty:       nothing in range
+ */
+
+#ifndef NATIVE_SIM_SCENE_H
+#define NATIVE_SIM_SCENE_H
+
+/**
+ * @brief Set the commanded servo angle (Servo::write)
+ */
+void simServoCommand(float angle_deg);
+
+/**
+ * @brief Advance the servo mount by dt seconds (physics thread)
+ */
+void simSceneStep(float dt);
+
+/**
+ * @brief Actual servo angle (deg)
+ */
+float simServoAngle();
+
+/**
+ * @brief Distance along a bearing at the current time (cm, < 0 = no return)
+ */
+float simSceneDistance(float angle_deg);
+
+/**
+ * @brief Ultrasonic reading: nearest return in the fixed 20 deg cone (cm)
+ */
+float simSceneUltrasonic();
+
+#endif // NATIVE_SIM_SCENE_H
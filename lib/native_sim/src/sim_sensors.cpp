@@ -0,0 +1,155 @@
+/**
+ * @file sim_sensors.cpp
+ * @brief Serial range sensors of the native virtual device
+ *
+ * UART1: TOFSense-style 16-byte frames at SIM_TOF_HZ, ranging along the
+ * actual servo angle. UART2: HRLV-MaxSonar "R####\r" lines (mm) at 10 Hz. Frames are
+ * produced lazily when the firmware polls, as if they had arrived at the
+ * sensor rate; at most SENSOR_BACKLOG_FRAMES are kept, like a full FIFO.
+ * SIM_TOF_DEAD silences UART1 for a time window.
+ */
+
+#include "sim_uart.h"
+#include "sim_core.h"
+#include "sim_scene.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <deque>
+#include <mutex>
+
+constexpr size_t SENSOR_BACKLOG_FRAMES = 16;
+constexpr size_t TOF_FRAME_BYTES = 16;
+constexpr float SONAR_HZ = 10.0f;
+constexpr float TOF_NOISE_CM = 0.8f;
+
+// ============================================================================
+// Frame-Producing UART
+// ============================================================================
+
+class SensorUart : public SimUart {
+public:
+    int available() override {
+        std::lock_guard<std::mutex> guard(lock);
+        produce();
+        return (int)rx.size();
+    }
+
+    int read() override {
+        std::lock_guard<std::mutex> guard(lock);
+        produce();
+        if (rx.empty()) {
+            return -1;
+        }
+        uint8_t byte = rx.front();
+        rx.pop_front();
+        return byte;
+    }
+
+    int peek() override {
+        std::lock_guard<std::mutex> guard(lock);
+        produce();
+        return rx.empty() ? -1 : rx.front();
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        (void)data;
+        return size;   // Sensor configuration commands are ignored
+    }
+
+protected:
+    virtual float rateHz() const = 0;
+    virtual size_t frameBytes() const = 0;
+    virtual void appendFrame(std::deque<uint8_t>& out) = 0;
+
+private:
+    void produce() {
+        uint64_t now_us = simMicros64();
+        uint64_t period_us = (uint64_t)(1e6f / fmaxf(rateHz(), 1.0f));
+        if (next_us == 0) {
+            next_us = now_us + period_us;
+            return;
+        }
+        while (now_us >= next_us) {
+            appendFrame(rx);
+            next_us += period_us;
+        }
+        size_t limit = SENSOR_BACKLOG_FRAMES * frameBytes();
+        while (rx.size() > limit) {
+            rx.pop_front();
+        }
+    }
+
+    std::mutex lock;
+    std::deque<uint8_t> rx;
+    uint64_t next_us = 0;
+};
+
+// ============================================================================
+// TOF (UART1)
+// ============================================================================
+
+class TofUart : public SensorUart {
+protected:
+    float rateHz() const override { return simConfig().tof_hz; }
+    size_t frameBytes() const override { return TOF_FRAME_BYTES; }
+
+    void appendFrame(std::deque<uint8_t>& out) override {
+        if (simFaultActive(simConfig().tof_dead_s)) {
+            return;   // Unplugged: the UART stays silent
+        }
+        float distance_cm = simSceneDistance(simServoAngle());
+        uint32_t distance_mm = 0;   // 0 = no return
+        if (distance_cm > 0.0f) {
+            distance_mm = (uint32_t)fmaxf(0.0f, (distance_cm + simNoise(TOF_NOISE_CM)) * 10.0f);
+        }
+        uint32_t time_ms = (uint32_t)(simMicros64() / 1000ULL);
+        uint16_t signal = distance_mm ? 40 : 0;
+
+        uint8_t frame[TOF_FRAME_BYTES] = {
+            0x57, 0x00, 0xFF, 0x00,
+            (uint8_t)time_ms, (uint8_t)(time_ms >> 8), (uint8_t)(time_ms >> 16), (uint8_t)(time_ms >> 24),
+            (uint8_t)distance_mm, (uint8_t)(distance_mm >> 8), (uint8_t)(distance_mm >> 16),
+            0x00,                                   // Distance status
+            (uint8_t)signal, (uint8_t)(signal >> 8),
+            0x05,                                   // Range precision (cm)
+            0x00};
+        uint8_t checksum = 0;
+        for (size_t i = 0; i < TOF_FRAME_BYTES - 1; i++) {
+            checksum += frame[i];
+        }
+        frame[TOF_FRAME_BYTES - 1] = checksum;
+        out.insert(out.end(), frame, frame + TOF_FRAME_BYTES);
+    }
+};
+
+// ============================================================================
+// MaxSonar (UART2)
+// ============================================================================
+
+class SonarUart : public SensorUart {
+protected:
+    float rateHz() const override { return SONAR_HZ; }
+    size_t frameBytes() const override { return 6; }
+
+    void appendFrame(std::deque<uint8_t>& out) override {
+        char line[16];
+        long range_mm = lroundf(fminf(simSceneUltrasonic() * 10.0f, 9999.0f));
+        snprintf(line, sizeof(line), "R%04ld\r", range_mm);
+        out.insert(out.end(), line, line + 6);
+    }
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+SimUart* simTofUart() {
+    static TofUart uart;
+    return &uart;
+}
+
+SimUart* simSonarUart() {
+    static SonarUart uart;
+    return &uart;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file sim_uart.h
+ * @brief Byte devices behind the simulated UARTs
+ */
+
+#ifndef NATIVE_SIM_UART_H
+#define NATIVE_SIM_UART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class SimUart {
+public:
+    virtual ~SimUart() {}
+    virtual void begin(unsigned long baud) { (void)baud; }
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t write(const uint8_t* data, size_t size) = 0;
+    virtual void flush() {}
+};
+
+/**
+ * @brief Device of a UART (0 = host pty, 1 = TOF, 2 = MaxSonar)
+ */
+SimUart* simUartDevice(int uart_nr);
+
+SimUart* simPtyUart();
+SimUart* simTofUart();
+SimUart* simSonarUart();
+
+#endif // NATIVE_SIM_UART_H
@@ -0,0 +1,39 @@
+/**
+ * @file gpio_struct.h
+ * @brief GPIO set/clear registers of the native virtual device
+ *
+ * Writes to out_w1ts/out_w1tc (GPIO 0-31) and out1_w1ts.val/out1_w1tc.val
+ * (GPIO 32-48) update the simulated pin levels, so direct register
+ * writes from an ISR reach the plant like digitalWrite() does.
+ */
+
+#ifndef NATIVE_SIM_GPIO_STRUCT_H
+#define NATIVE_SIM_GPIO_STRUCT_H
+
+#include <stdint.h>
+
+void simPinWriteMask(int bank, uint32_t mask, bool level);
+
+template <int BANK, bool LEVEL>
+struct SimGpioWriteReg {
+    SimGpioWriteReg& operator=(uint32_t mask) {
+        simPinWriteMask(BANK, mask, LEVEL);
+        return *this;
+    }
+};
+
+template <int BANK, bool LEVEL>
+struct SimGpioWriteReg1 {
+    SimGpioWriteReg<BANK, LEVEL> val;
+};
+
+typedef struct {
+    SimGpioWriteReg<0, true> out_w1ts;
+    SimGpioWriteReg<0, false> out_w1tc;
+    SimGpioWriteReg1<1, true> out1_w1ts;
+    SimGpioWriteReg1<1, false> out1_w1tc;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+#endif // NATIVE_SIM_GPIO_STRUCT_H
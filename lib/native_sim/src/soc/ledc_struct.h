@@ -0,0 +1,44 @@
+/**
+ * @file ledc_struct.h
+ * @brief LEDC timer counters of the native virtual device
+ *
+ * LEDC.timer_group[0].timer[t].value.timer_cnt reads the counter a timer
+ * would hold now, computed from the clock and the timer's frequency.
+ */
+
+#ifndef NATIVE_SIM_LEDC_STRUCT_H
+#define NATIVE_SIM_LEDC_STRUCT_H
+
+#include <stdint.h>
+
+uint32_t simLedcCounter(uint8_t timer);
+
+struct SimLedcCounterRef {
+    uint8_t timer;
+    operator uint32_t() const { return simLedcCounter(timer); }
+};
+
+struct SimLedcTimerValueRef {
+    SimLedcCounterRef timer_cnt;
+};
+
+struct SimLedcTimer {
+    SimLedcTimerValueRef value;
+};
+
+struct SimLedcTimerGroup {
+    SimLedcTimerGroup() {
+        for (uint8_t t = 0; t < 4; t++) {
+            timer[t].value.timer_cnt.timer = t;
+        }
+    }
+    SimLedcTimer timer[4];
+};
+
+typedef struct {
+    SimLedcTimerGroup timer_group[1];
+} ledc_dev_t;
+
+extern ledc_dev_t LEDC;
+
+#endif // NATIVE_SIM_LEDC_STRUCT_H
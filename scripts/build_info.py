@@ -0,0 +1,31 @@
+"""
+PlatformIO pre-build script: inject build info into the firmware.
+
+Defines FIRMWARE_GIT_HASH (short git hash, "+" suffix when the tree
+has local changes) so the device info frame can report which build is
+running on the board.
+"""
+
+import subprocess
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+
+def git_hash():
+    try:
+        short = subprocess.check_output(
+            ["git", "rev-parse", "--short=8", "HEAD"],
+            cwd=env.subst("$PROJECT_DIR"),  # noqa: F821
+            stderr=subprocess.DEVNULL,
+        ).decode().strip()
+        dirty = subprocess.call(
+            ["git", "diff", "--quiet", "HEAD"],
+            cwd=env.subst("$PROJECT_DIR"),  # noqa: F821
+            stderr=subprocess.DEVNULL,
+        ) != 0
+        return short + ("+" if dirty else "")
+    except Exception:
+        return "unknown"
+
+
+env.Append(CPPDEFINES=[("FIRMWARE_GIT_HASH", env.StringifyMacro(git_hash()))])  # noqa: F821
@@ -0,0 +1,132 @@
+"""
+Controller benchmark: run each control law on every motor in turn and
+print the step response scorecard (DIAG:CTRL) side by side.
+
+Works against the native virtual device (docs/virtual-device.md) or a
+board on a serial port. The setpoint steps come from the scene: with
+SIM_SCENE=moving every sector passes through all distance ranges.
+
+    python scripts/ctrl_scorecard.py /tmp/ttyESP32SIM [seconds_per_law] [laws]
+
+laws is a comma-separated list of CTRL_LAW values (default 0,1,2 =
+PI,PID,LQI). Each law first runs for a settling period (model fit, LQI
+design), then the scorecard is cleared and collected for
+seconds_per_law. Parameters are restored to CTRL_LAW_n=0 at the end but
+not saved.
+"""
+
+import os
+import re
+import sys
+import termios
+import time
+import tty
+
+NUM_MOTORS = 5
+WARMUP_S = 20
+LAW_NAMES = {0: "PI", 1: "PID", 2: "LQI"}
+SCORECARD_ATTEMPTS = 5
+# Telemetry frames share the port and can cut a line, so only complete rows count
+CTRL_LINE = re.compile(rb"CTRL:(\d):(LAW=[A-Z_0-9=.,\-]+,UNSETTLED=\d+)\r?\n")
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = termios.B115200
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    os.set_blocking(fd, False)
+    return fd
+
+
+def read_for(fd, seconds):
+    data = b""
+    deadline = time.time() + seconds
+    while time.time() < deadline:
+        try:
+            data += os.read(fd, 65536)
+        except BlockingIOError:
+            time.sleep(0.02)
+    return data
+
+
+def command(fd, text, wait_s=1.0):
+    read_for(fd, 0.05)
+    os.write(fd, text.encode() + b"\n")
+    reply = read_for(fd, wait_s)
+    if b"ERR:" in reply:
+        sys.exit("%s -> %s" % (text, re.search(rb"ERR:[ -~]*", reply).group().decode()))
+    return reply
+
+
+def set_law(fd, law):
+    for motor in range(1, NUM_MOTORS + 1):
+        command(fd, "PARAM:SET:CTRL_LAW_%d:%d" % (motor, law), 0.2)
+
+
+def scorecard(fd):
+    rows = {}
+    for _ in range(SCORECARD_ATTEMPTS):
+        reply = command(fd, "DIAG:CTRL", 1.5)
+        for motor, fields in CTRL_LINE.findall(reply):
+            rows.setdefault(int(motor), dict(kv.split(b"=") for kv in fields.split(b",")))
+        if len(rows) == NUM_MOTORS:
+            break
+    return rows
+
+
+def summarize(rows):
+    """Step-weighted mean over the motors."""
+    steps = sum(int(r[b"STEPS"]) for r in rows.values())
+    if steps == 0:
+        return None
+    mean = lambda key: sum(float(r[key]) * int(r[b"STEPS"]) for r in rows.values()) / steps
+    return {
+        "steps": steps,
+        "rise_ms": mean(b"RISE_MS"),
+        "overshoot_pct": mean(b"OVERSHOOT_PCT"),
+        "overshoot_max_pct": max(float(r[b"OVERSHOOT_MAX_PCT"]) for r in rows.values()),
+        "settle_ms": mean(b"SETTLE_MS"),
+        "iae": mean(b"IAE"),
+        "unsettled": sum(int(r[b"UNSETTLED"]) for r in rows.values()),
+    }
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    fd = open_port(sys.argv[1])
+    seconds = float(sys.argv[2]) if len(sys.argv) > 2 else 120.0
+    laws = [int(v) for v in sys.argv[3].split(",")] if len(sys.argv) > 3 else [0, 1, 2]
+
+    results = []
+    for law in laws:
+        set_law(fd, law)
+        read_for(fd, WARMUP_S)
+        command(fd, "DIAG:CTRL:RESET")
+        read_for(fd, seconds)
+        rows = scorecard(fd)
+        results.append((law, summarize(rows), rows))
+    set_law(fd, 0)
+
+    print("%-5s %6s %8s %8s %8s %9s %7s %9s" %
+          ("law", "steps", "rise_ms", "os_pct", "os_max", "settle_ms", "iae", "unsettled"))
+    for law, summary, _ in results:
+        name = LAW_NAMES.get(law, str(law))
+        if summary is None:
+            print("%-5s (no steps)" % name)
+            continue
+        print("%-5s %6d %8.0f %8.1f %8.1f %9.0f %7.2f %9d" %
+              (name, summary["steps"], summary["rise_ms"], summary["overshoot_pct"],
+               summary["overshoot_max_pct"], summary["settle_ms"], summary["iae"], summary["unsettled"]))
+
+    print()
+    print("Per motor (model from the last law):")
+    for motor, row in sorted(results[-1][2].items()):
+        print("  M%d tau=%s ms gain=%s (%s)" %
+              (motor, row[b"TAU_MS"].decode(), row[b"GAIN"].decode(), row[b"MODEL"].decode()))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+"""
+Over-pressure cutoff check with the default OVERPRESSURE_PCT, two cases:
+
+- Load: an external load above the calibrated maximum on pad 1 must trip
+  the guard, hold the latch (one trip, no release) while the load lasts,
+  and release it afterwards.
+- No load (--no-load): normal control must never trip, from the first
+  steps after the pressure loop starts.
+
+Runs against the native virtual device (docs/virtual-device.md), for
+example:
+
+    SIM_SCENE=static:75 SIM_PAD_PRESS=45:55 .pio/build/native/program &
+    python scripts/overpressure_check.py /tmp/ttyESP32SIM [seconds]
+
+    .pio/build/native/program &          # default moving scene, fresh NVS
+    python scripts/overpressure_check.py /tmp/ttyESP32SIM 90 --no-load
+
+The script waits until the pressure loop has set the limits, clears the
+counters, then polls DIAG:OVERPRESSURE for <seconds> (default 40); start
+it with the device so the no-load case covers the first steps. The load case
+exits non-zero if pad 1 never latched, re-tripped or released while the
+load lasted, or was still latched at the end; trips after the release are
+reported but allowed. The no-load case exits non-zero on any trip.
+"""
+
+import re
+import sys
+import time
+
+from ctrl_scorecard import NUM_MOTORS, command, open_port
+
+POLL_S = 0.5
+READY_TIMEOUT_S = 120
+ROW = re.compile(rb"OVERPRESSURE:(\d):LIMIT=(\d+),CEILING=(\d+),RELEASE=(\d+),LATCHED=(\d),TRIPS=(\d+),"
+                 rb"TRIP_MV=(\d+),PEAK_MV=(\d+),SAMPLES=(\d+)\r?\n")
+ACK = re.compile(rb"ACK:DIAG:OVERPRESSURE:PCT=(\d+),TRIPS=(\d+),BUSY=(\d+),CEILING_HOLDS=(\d+)")
+
+
+def snapshot(fd):
+    """Rows by pad (1-based) and the ACK fields, or None if the reply was cut."""
+    reply = command(fd, "DIAG:OVERPRESSURE", POLL_S)
+    rows = {}
+    for fields in ROW.findall(reply):
+        values = [int(v) for v in fields]
+        rows[values[0]] = dict(zip(("limit", "ceiling", "release", "latched", "trips", "trip_mv",
+                                    "peak_mv", "samples"), values[1:]))
+    ack = ACK.search(reply)
+    if len(rows) != NUM_MOTORS or ack is None:
+        return None
+    return rows, [int(v) for v in ack.groups()]
+
+
+def check_load(rows):
+    """Failures of the load case from the polled pad 1 rows."""
+    latched_s = 0.0
+    trips_at_latch = None     # Pad 1 trips when the latch was first seen
+    trips_at_release = None   # ... and when it was first seen released
+    for pad in rows:
+        if pad["latched"] and trips_at_release is None:
+            latched_s += POLL_S
+            if trips_at_latch is None:
+                trips_at_latch = pad["trips"]
+        elif trips_at_latch is not None and trips_at_release is None:
+            trips_at_release = pad["trips"]
+    print("pad 1: latched ~%.1f s, trips %s at latch, %s at release, %d at the end, peak %d mV" % (
+        latched_s, trips_at_latch, trips_at_release, rows[-1]["trips"], rows[-1]["peak_mv"]))
+
+    if trips_at_latch is None:
+        return ["pad 1 never latched"]
+    if trips_at_release is None:
+        return ["pad 1 still latched at the end"]
+    if trips_at_release != trips_at_latch or trips_at_latch != 1:
+        return ["pad 1 tripped %d times during one load" % trips_at_release]
+    return []
+
+
+def main():
+    args = [arg for arg in sys.argv[1:] if arg != "--no-load"]
+    no_load = len(args) != len(sys.argv) - 1
+    if not args:
+        sys.exit(__doc__)
+    fd = open_port(args[0])
+    seconds = float(args[1]) if len(args) > 1 else 40.0
+
+    deadline = time.time() + READY_TIMEOUT_S
+    while True:
+        snap = snapshot(fd)
+        if snap is not None and all(row["limit"] > 0 for row in snap[0].values()):
+            break
+        if time.time() > deadline:
+            sys.exit("FAIL: guard limits not set after %d s" % READY_TIMEOUT_S)
+        time.sleep(1.0)
+    rows, (pct, trips_at_ready, _, holds_at_start) = snap
+    print("OVERPRESSURE_PCT=%d, pad 1 limit %d mV, ceiling %d mV, release %d mV" % (
+        pct, rows[1]["limit"], rows[1]["ceiling"], rows[1]["release"]))
+    command(fd, "DIAG:OVERPRESSURE:RESET", 0.3)
+
+    pad1 = []
+    end = time.time() + seconds
+    last = None
+    while time.time() < end:
+        snap = snapshot(fd)
+        if snap is None:
+            continue
+        last = snap
+        pad1.append(snap[0][1])
+    if last is None:
+        sys.exit("FAIL: no complete DIAG:OVERPRESSURE reply")
+
+    rows, (_, total, busy, holds) = last
+    samples = sum(row["samples"] for row in rows.values())
+    peaks = " ".join("%d:%d/%d" % (pad, row["peak_mv"], row["limit"]) for pad, row in sorted(rows.items()))
+    print("peak/limit mV: %s, ceiling holds %d" % (peaks, holds - holds_at_start))
+    print("sampler: %d conversions, %d busy slots" % (samples, busy))
+
+    if no_load:
+        total += trips_at_ready
+        failures = ["%d trips without a load" % total] if total else []
+    else:
+        print("other pads: %d trips" % (total - rows[1]["trips"]))
+        failures = check_load(pad1)
+    if failures:
+        sys.exit("FAIL: " + ", ".join(failures))
+    print("PASS")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+"""
+PlatformIO pre-build script: build the tokenized logging database.
+
+Scans src/ for TLOG("...") calls, hashes each format string with the
+same 32-bit FNV-1a as src/utils/tlog.h and writes
+
+    $BUILD_DIR/tlog_tokens.json   {"version": 1, "tokens": {"0x1234abcd": "fmt"}}
+
+frontend/dev/detokenize.ts (and the serial bridge) read this file to turn
+FRAME_LOG frames back into text. Two different format strings with the
+same hash fail the build: rephrase one of them.
+
+Also runs standalone:
+
+    python scripts/tlog_db.py [output.json]
+"""
+
+import json
+import os
+import re
+import sys
+
+SOURCE_EXTENSIONS = (".c", ".cpp", ".h", ".hpp")
+
+# Comments and string/char literals, so comments can be dropped without
+# touching "//" inside a string
+LEXEME = re.compile(
+    r'//[^\n]*|/\*.*?\*/|"(?:[^"\\\n]|\\.)*"|\'(?:[^\'\\\n]|\\.)*\'',
+    re.S,
+)
+TLOG_CALL = re.compile(r'\bTLOG\s*\(\s*((?:"(?:[^"\\\n]|\\.)*"\s*)+)')
+STRING = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+
+SIMPLE_ESCAPES = {
+    "n": 0x0A, "t": 0x09, "r": 0x0D, "0": 0x00, "a": 0x07, "b": 0x08,
+    "f": 0x0C, "v": 0x0B, "\\": 0x5C, '"': 0x22, "'": 0x27, "?": 0x3F,
+}
+
+
+def fnv1a(data):
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def unescape(body):
+    """C string literal body -> bytes (UTF-8 source)."""
+    out = bytearray()
+    raw = body.encode("utf-8")
+    i = 0
+    while i < len(raw):
+        c = raw[i]
+        if c != 0x5C:
+            out.append(c)
+            i += 1
+            continue
+        esc = chr(raw[i + 1])
+        if esc == "x":
+            j = i + 2
+            while j < len(raw) and chr(raw[j]) in "0123456789abcdefABCDEF":
+                j += 1
+            out.append(int(raw[i + 2:j], 16) & 0xFF)
+            i = j
+        elif esc in "01234567":
+            j = i + 1
+            while j < len(raw) and j < i + 4 and chr(raw[j]) in "01234567":
+                j += 1
+            out.append(int(raw[i + 1:j], 8) & 0xFF)
+            i = j
+        else:
+            out.append(SIMPLE_ESCAPES.get(esc, ord(esc)))
+            i += 2
+    return bytes(out)
+
+
+def strip_comments(text):
+    return LEXEME.sub(lambda m: " " if m.group(0)[0] == "/" else m.group(0), text)
+
+
+def scan(src_dir):
+    """Return {token: format} for every TLOG call under src_dir."""
+    tokens = {}
+    for root, _, files in os.walk(src_dir):
+        for name in sorted(files):
+            if not name.endswith(SOURCE_EXTENSIONS):
+                continue
+            path = os.path.join(root, name)
+            with open(path, encoding="utf-8") as f:
+                text = strip_comments(f.read())
+            for call in TLOG_CALL.finditer(text):
+                fmt = b"".join(unescape(s) for s in STRING.findall(call.group(1)))
+                token = fnv1a(fmt)
+                fmt_text = fmt.decode("utf-8", errors="replace")
+                if token in tokens and tokens[token] != fmt_text:
+                    raise SystemExit(
+                        "tlog_db: token collision 0x%08x between %r and %r (%s)"
+                        % (token, tokens[token], fmt_text, path))
+                tokens[token] = fmt_text
+    return tokens
+
+
+def write_db(tokens, out_path):
+    out_dir = os.path.dirname(out_path)
+    if out_dir:
+        os.makedirs(out_dir, exist_ok=True)
+    db = {
+        "version": 1,
+        "tokens": {"0x%08x" % t: tokens[t] for t in sorted(tokens)},
+    }
+    with open(out_path, "w", encoding="utf-8") as f:
+        json.dump(db, f, indent=2, ensure_ascii=False)
+        f.write("\n")
+
+
+def main(argv):
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    out_path = argv[1] if len(argv) > 1 else os.path.join(
+        project_dir, ".pio", "build", "esp32-s3", "tlog_tokens.json")
+    tokens = scan(os.path.join(project_dir, "src"))
+    write_db(tokens, out_path)
+    print("tlog_db: %d formats -> %s" % (len(tokens), out_path))
+
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+except NameError:
+    if __name__ == "__main__":
+        main(sys.argv)
+else:
+    _tokens = scan(env.subst("$PROJECT_SRC_DIR"))  # noqa: F821
+    write_db(_tokens, os.path.join(env.subst("$BUILD_DIR"), "tlog_tokens.json"))  # noqa: F821
+    print("tlog_db: %d formats" % len(_tokens))
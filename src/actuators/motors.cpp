@@ -5,6 +5,12 @@
 
 #include "motors.h"
 #include "../config/pins.h"
+#include "../utils/binary_protocol.h"
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <soc/gpio_struct.h>
+#include <soc/ledc_struct.h>
+#include <algorithm>
 
 // Motor pin configuration arrays
 static const uint8_t MOTOR_PWM_PINS[NUM_MOTORS] = {M1_PWM, M2_PWM, M3_PWM, M4_PWM, M5_PWM};
@@ -20,6 +26,154 @@ struct PwmChannelMap {
 static PwmChannelMap pwmChannels[NUM_MOTORS];
 static uint8_t nextChannel = 0;
 
+// PWM phase tracking for synchronous ADC sampling. Duty in LEDC counts;
+// each motor's LEDC timer is read relative to motor 0's timer.
+static volatile uint16_t dutyCounts[NUM_MOTORS] = {0};
+static uint8_t motorTimer[NUM_MOTORS] = {0};
+static uint16_t timerOffset[NUM_MOTORS] = {0};   // Counts ahead of motor 0's timer
+
+// H-bridge input pin masks for the ISR brake (GPIO 0-31 and GPIO 32-48)
+static volatile uint32_t brakeMaskLow = 0;
+static volatile uint32_t brakeMaskHigh = 0;
+
+// Same masks per motor, and the over-pressure brake latch
+static uint32_t motorMaskLow[NUM_MOTORS] = {0};
+static uint32_t motorMaskHigh[NUM_MOTORS] = {0};
+static volatile bool brakeLatched[NUM_MOTORS] = {false};
+static portMUX_TYPE latchMux = portMUX_INITIALIZER_UNLOCKED;   // Latch check + direction pins
+
+// ============================================================================
+// Actuation Accounting
+// ============================================================================
+
+constexpr const char* NVS_NAMESPACE = "motorstats";
+constexpr const char* NVS_KEY = "blob";
+constexpr uint16_t MOTOR_STATS_VERSION = 1;
+constexpr uint16_t DUTY_FULL_COUNTS = (1 << PWM_RES_BITS) - 1;
+
+struct __attribute__((packed)) MotorStatsBlob {
+    uint16_t version;            // MOTOR_STATS_VERSION
+    uint8_t num_motors;          // NUM_MOTORS when stored
+    uint32_t emergency_brakes;
+    MotorCounters motors[NUM_MOTORS];
+    uint16_t crc;                // CRC-16 over everything above
+};
+
+// Counters since boot, updated on every drive call. The current segment
+// (mode, duty, state since last_us) is added when it ends.
+struct MotorAccount {
+    MotorCounters boot;          // duty_us here is in LEDC counts x us
+    uint32_t last_us;
+    uint16_t duty;               // LEDC counts of the current segment
+    uint8_t mode;                // MotorDriveMode of the current segment
+    uint8_t drive_dir;           // Last driven direction, MOTOR_MODE_COUNT before the first
+    uint8_t state;               // SystemState of the current segment
+};
+
+static MotorAccount accounts[NUM_MOTORS];
+static MotorCounters storedCounters[NUM_MOTORS];   // Lifetime totals loaded from NVS
+static uint32_t storedEmergencyBrakes = 0;
+static volatile uint32_t emergencyBrakes = 0;      // Since boot, written by the ISR brake
+static MotorStatsSaveTiming saveTiming = {0, 0, 0, 0};   // Written by saveMotorCounters() only
+static portMUX_TYPE accountMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Close the current segment of a motor at now_us (accountMux held)
+ */
+static inline void accrueSegment(MotorAccount& account, uint32_t now_us) {
+    uint32_t dt_us = now_us - account.last_us;
+    account.last_us = now_us;
+    account.boot.mode_us[account.mode] += dt_us;
+    account.boot.state_us[account.state] += dt_us;
+    if (account.mode == MOTOR_MODE_FORWARD || account.mode == MOTOR_MODE_REVERSE) {
+        account.boot.duty_us += (uint64_t)account.duty * dt_us;
+        if (account.duty >= DUTY_FULL_COUNTS) {
+            account.boot.saturated_us += dt_us;
+        }
+    }
+}
+
+/**
+ * @brief Start a new segment on every drive call
+ */
+static inline void accountDrive(uint8_t motor_index, uint8_t mode, uint16_t duty) {
+    uint32_t now_us = micros();
+    portENTER_CRITICAL(&accountMux);
+    MotorAccount& account = accounts[motor_index];
+    accrueSegment(account, now_us);
+    if (mode == MOTOR_MODE_BRAKE && account.mode != MOTOR_MODE_BRAKE) {
+        account.boot.brake_events++;
+    }
+    if ((mode == MOTOR_MODE_FORWARD || mode == MOTOR_MODE_REVERSE) && duty > 0) {
+        if (account.drive_dir != MOTOR_MODE_COUNT && account.drive_dir != mode) {
+            account.boot.reversals++;
+        }
+        account.drive_dir = mode;
+    }
+    account.mode = mode;
+    account.duty = duty;
+    portEXIT_CRITICAL(&accountMux);
+}
+
+/**
+ * @brief Lifetime counters of one motor (accountMux held)
+ */
+static void lifetimeCounters(uint8_t motor_index, MotorCounters* out) {
+    const MotorCounters& stored = storedCounters[motor_index];
+    const MotorCounters& boot = accounts[motor_index].boot;
+    for (int m = 0; m < MOTOR_MODE_COUNT; ++m) {
+        out->mode_us[m] = stored.mode_us[m] + boot.mode_us[m];
+    }
+    for (int s = 0; s < MOTOR_STATE_SLOTS; ++s) {
+        out->state_us[s] = stored.state_us[s] + boot.state_us[s];
+    }
+    out->duty_us = stored.duty_us + boot.duty_us / DUTY_FULL_COUNTS;
+    out->saturated_us = stored.saturated_us + boot.saturated_us;
+    out->reversals = stored.reversals + boot.reversals;
+    out->brake_events = stored.brake_events + boot.brake_events;
+}
+
+/**
+ * @brief Restore the lifetime totals saved by saveMotorCounters()
+ */
+static void loadMotorCounters() {
+    memset(storedCounters, 0, sizeof(storedCounters));
+    storedEmergencyBrakes = 0;
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        return;
+    }
+    MotorStatsBlob blob;
+    bool ok = prefs.getBytesLength(NVS_KEY) == sizeof(blob) &&
+              prefs.getBytes(NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    if (!ok || blob.version != MOTOR_STATS_VERSION || blob.num_motors != NUM_MOTORS) {
+        return;
+    }
+    if (calculateCRC16((const uint8_t*)&blob, offsetof(MotorStatsBlob, crc)) != blob.crc) {
+        return;
+    }
+    memcpy(storedCounters, blob.motors, sizeof(storedCounters));
+    storedEmergencyBrakes = blob.emergency_brakes;
+}
+
+/**
+ * @brief Add a pin to the emergency brake masks and to its motor's masks
+ * @param motor_index Motor the pin drives
+ * @param pin GPIO number
+ */
+static void addBrakePin(uint8_t motor_index, uint8_t pin) {
+    if (pin < 32) {
+        brakeMaskLow |= (1UL << pin);
+        motorMaskLow[motor_index] |= (1UL << pin);
+    } else {
+        brakeMaskHigh |= (1UL << (pin - 32));
+        motorMaskHigh[motor_index] |= (1UL << (pin - 32));
+    }
+}
+
 /**
  * @brief Get or assign a PWM channel for a given pin
  *
@@ -50,6 +204,44 @@ static uint8_t getPwmChannel(uint8_t pin) {
     return channel;
 }
 
+/**
+ * @brief Read the counter of an LEDC low-speed timer (0 to PWM_PERIOD_COUNTS-1)
+ */
+static inline uint16_t readLedcCounter(uint8_t timer) {
+    return (uint16_t)LEDC.timer_group[0].timer[timer].value.timer_cnt;
+}
+
+/**
+ * @brief Measure how far each motor's LEDC timer runs ahead of motor 0's
+ *
+ * All timers run at PWM_FREQ_HZ from the same clock, so the offsets are
+ * constant once started. Channels share a timer in pairs (Arduino core:
+ * timer = (channel / 2) % 4).
+ */
+static void measureTimerOffsets() {
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorTimer[i] = (getPwmChannel(MOTOR_PWM_PINS[i]) / 2) % 4;
+    }
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        if (motorTimer[i] == motorTimer[0]) {
+            timerOffset[i] = 0;
+            continue;
+        }
+        // Bracket the read with two reference reads, retry if they wrapped
+        for (int attempt = 0; attempt < 8; ++attempt) {
+            uint16_t before = readLedcCounter(motorTimer[0]);
+            uint16_t counter = readLedcCounter(motorTimer[i]);
+            uint16_t after = readLedcCounter(motorTimer[0]);
+            if (after < before) {
+                continue;
+            }
+            uint16_t reference = (before + after) / 2;
+            timerOffset[i] = (counter - reference) & (PWM_PERIOD_COUNTS - 1);
+            break;
+        }
+    }
+}
+
 /**
  * @brief Set motor PWM duty cycle
  *
@@ -57,8 +249,9 @@ static uint8_t getPwmChannel(uint8_t pin) {
  *
  * @param motor_index Motor index (0-3)
  * @param duty_pct Duty cycle percentage (0-100)
+ * @param mode Drive mode set on the direction pins (for the accounting)
  */
-static void setMotorPwm(uint8_t motor_index, float duty_pct) {
+static void setMotorPwm(uint8_t motor_index, float duty_pct, MotorDriveMode mode) {
     if (motor_index >= NUM_MOTORS) return;
 
     // Clamp duty cycle to valid range
@@ -67,6 +260,8 @@ static void setMotorPwm(uint8_t motor_index, float duty_pct) {
 
     // Convert percentage to duty value (0-1023 for 10-bit resolution)
     uint32_t duty_value = (uint32_t)((duty_pct / 100.0f) * ((1 << PWM_RES_BITS) - 1));
+    dutyCounts[motor_index] = (uint16_t)duty_value;
+    accountDrive(motor_index, mode, (uint16_t)duty_value);
 
     // Get PWM channel for this motor
     uint8_t channel = getPwmChannel(MOTOR_PWM_PINS[motor_index]);
@@ -101,18 +296,44 @@ void initMotorSystem() {
         pinMode(in2_pin, OUTPUT);
         digitalWrite(in1_pin, LOW);
         digitalWrite(in2_pin, LOW);
+
+        addBrakePin(i, in1_pin);
+        addBrakePin(i, in2_pin);
+    }
+
+    measureTimerOffsets();
+
+    // Lifetime totals continue from the last save; pins start LOW at 0% duty
+    loadMotorCounters();
+    uint32_t now_us = micros();
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        accounts[i].last_us = now_us;
+        accounts[i].mode = MOTOR_MODE_COAST;
+        accounts[i].drive_dir = MOTOR_MODE_COUNT;
     }
 }
 
 void motorForward(uint8_t motor_index, float duty_pct) {
     if (motor_index >= NUM_MOTORS) return;
 
-    // Set direction: IN1=HIGH, IN2=LOW
-    digitalWrite(MOTOR_IN1_PINS[motor_index], HIGH);
-    digitalWrite(MOTOR_IN2_PINS[motor_index], LOW);
+    // Over-pressure latch: no inflation until the guard releases it. The
+    // check and the direction pins are one step against the sampler ISR on
+    // Core 0, so a trip cannot land between them and be overwritten.
+    portENTER_CRITICAL(&latchMux);
+    bool latched = brakeLatched[motor_index];
+    if (!latched) {
+        // Set direction: IN1=HIGH, IN2=LOW
+        digitalWrite(MOTOR_IN1_PINS[motor_index], HIGH);
+        digitalWrite(MOTOR_IN2_PINS[motor_index], LOW);
+    }
+    portEXIT_CRITICAL(&latchMux);
+    if (latched) {
+        motorBrake(motor_index);
+        return;
+    }
 
     // Set PWM duty cycle
-    setMotorPwm(motor_index, duty_pct);
+    setMotorPwm(motor_index, duty_pct, MOTOR_MODE_FORWARD);
 }
 
 void motorReverse(uint8_t motor_index, float duty_pct) {
@@ -123,7 +344,7 @@ void motorReverse(uint8_t motor_index, float duty_pct) {
     digitalWrite(MOTOR_IN2_PINS[motor_index], HIGH);
 
     // Set PWM duty cycle
-    setMotorPwm(motor_index, duty_pct);
+    setMotorPwm(motor_index, duty_pct, MOTOR_MODE_REVERSE);
 }
 
 void motorBrake(uint8_t motor_index) {
@@ -132,7 +353,7 @@ void motorBrake(uint8_t motor_index) {
     // Active brake: both pins LOW, max PWM
     digitalWrite(MOTOR_IN1_PINS[motor_index], LOW);
     digitalWrite(MOTOR_IN2_PINS[motor_index], LOW);
-    setMotorPwm(motor_index, 100.0f);
+    setMotorPwm(motor_index, 100.0f, MOTOR_MODE_BRAKE);
 }
 
 void motorCoast(uint8_t motor_index) {
@@ -141,7 +362,7 @@ void motorCoast(uint8_t motor_index) {
     // Coast: both pins HIGH, PWM doesn't matter
     digitalWrite(MOTOR_IN1_PINS[motor_index], HIGH);
     digitalWrite(MOTOR_IN2_PINS[motor_index], HIGH);
-    setMotorPwm(motor_index, 0.0f);
+    setMotorPwm(motor_index, 0.0f, MOTOR_MODE_COAST);
 }
 
 void stopAllMotors() {
@@ -149,3 +370,179 @@ void stopAllMotors() {
         motorBrake(i);
     }
 }
+
+bool getPwmQuietWindow(uint16_t* center, uint16_t* half_width) {
+    // Switching edges of every motor, in motor 0's timer counts. An output
+    // at 0% or 100% never switches (brake holds 100%).
+    uint16_t edges[2 * NUM_MOTORS];
+    int edge_count = 0;
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        uint16_t duty = dutyCounts[i];
+        if (duty == 0 || duty >= PWM_PERIOD_COUNTS - 1) {
+            continue;
+        }
+        // Rising edge at counter 0, falling edge at the duty value (hpoint 0)
+        edges[edge_count++] = (uint16_t)((PWM_PERIOD_COUNTS - timerOffset[i]) & (PWM_PERIOD_COUNTS - 1));
+        edges[edge_count++] = (uint16_t)((duty + PWM_PERIOD_COUNTS - timerOffset[i]) & (PWM_PERIOD_COUNTS - 1));
+    }
+    if (edge_count == 0) {
+        return false;
+    }
+
+    // Largest gap between consecutive edges around the period
+    std::sort(edges, edges + edge_count);
+    uint16_t best_start = edges[edge_count - 1];
+    uint16_t best_gap = (uint16_t)(edges[0] + PWM_PERIOD_COUNTS - edges[edge_count - 1]);
+    for (int i = 1; i < edge_count; ++i) {
+        uint16_t gap = edges[i] - edges[i - 1];
+        if (gap > best_gap) {
+            best_gap = gap;
+            best_start = edges[i - 1];
+        }
+    }
+
+    // Aim the sample-and-hold at the middle of the gap
+    *center = (uint16_t)((best_start + best_gap / 2 + PWM_PERIOD_COUNTS - PWM_SAMPLE_LEAD_COUNTS) & (PWM_PERIOD_COUNTS - 1));
+    *half_width = std::max<uint16_t>(best_gap / 4, 1);
+    return true;
+}
+
+bool waitForPwmPhase(uint16_t center, uint16_t half_width, uint32_t timeout_us) {
+    uint32_t start_us = micros();
+    for (;;) {
+        uint16_t distance = (readLedcCounter(motorTimer[0]) - center) & (PWM_PERIOD_COUNTS - 1);
+        if (distance <= half_width || distance >= PWM_PERIOD_COUNTS - half_width) {
+            return true;
+        }
+        if (micros() - start_us >= timeout_us) {
+            return false;
+        }
+    }
+}
+
+void IRAM_ATTR motorsEmergencyBrakeFromISR() {
+    // Both inputs LOW on every H-bridge (same state as motorBrake)
+    GPIO.out_w1tc = brakeMaskLow;
+    GPIO.out1_w1tc.val = brakeMaskHigh;
+    emergencyBrakes++;
+}
+
+void IRAM_ATTR motorLatchBrakeFromISR(uint8_t motor_index) {
+    if (motor_index >= NUM_MOTORS) return;
+
+    // Both inputs LOW on this H-bridge only
+    portENTER_CRITICAL_ISR(&latchMux);
+    brakeLatched[motor_index] = true;
+    GPIO.out_w1tc = motorMaskLow[motor_index];
+    GPIO.out1_w1tc.val = motorMaskHigh[motor_index];
+    portEXIT_CRITICAL_ISR(&latchMux);
+}
+
+void IRAM_ATTR motorReleaseBrakeLatch(uint8_t motor_index) {
+    if (motor_index >= NUM_MOTORS) return;
+    portENTER_CRITICAL_SAFE(&latchMux);   // Task or ISR
+    brakeLatched[motor_index] = false;
+    portEXIT_CRITICAL_SAFE(&latchMux);
+}
+
+bool IRAM_ATTR motorBrakeLatched(uint8_t motor_index) {
+    return motor_index < NUM_MOTORS && brakeLatched[motor_index];
+}
+
+void motorSetAccountingState(uint8_t motor_index, uint8_t state) {
+    if (motor_index >= NUM_MOTORS || state >= MOTOR_STATE_SLOTS) return;
+
+    uint32_t now_us = micros();
+    portENTER_CRITICAL(&accountMux);
+    MotorAccount& account = accounts[motor_index];
+    if (account.state != state) {
+        accrueSegment(account, now_us);
+        account.state = state;
+    }
+    portEXIT_CRITICAL(&accountMux);
+}
+
+void getMotorCounters(uint8_t motor_index, MotorCounters* out) {
+    if (motor_index >= NUM_MOTORS || out == NULL) return;
+
+    uint32_t now_us = micros();
+    portENTER_CRITICAL(&accountMux);
+    accrueSegment(accounts[motor_index], now_us);
+    lifetimeCounters(motor_index, out);
+    portEXIT_CRITICAL(&accountMux);
+}
+
+uint32_t getEmergencyBrakeCount() {
+    return storedEmergencyBrakes + emergencyBrakes;
+}
+
+bool motorsAtRest() {
+    bool at_rest = true;
+    portENTER_CRITICAL(&accountMux);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        const MotorAccount& account = accounts[i];
+        if ((account.mode == MOTOR_MODE_FORWARD || account.mode == MOTOR_MODE_REVERSE) && account.duty > 0) {
+            at_rest = false;
+        }
+    }
+    portEXIT_CRITICAL(&accountMux);
+    return at_rest;
+}
+
+bool saveMotorCounters() {
+    uint32_t start_us = micros();
+    MotorStatsBlob blob;
+    blob.version = MOTOR_STATS_VERSION;
+    blob.num_motors = NUM_MOTORS;
+    blob.emergency_brakes = getEmergencyBrakeCount();
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        MotorCounters counters;
+        getMotorCounters(i, &counters);
+        memcpy(&blob.motors[i], &counters, sizeof(counters));
+    }
+    blob.crc = calculateCRC16((const uint8_t*)&blob, offsetof(MotorStatsBlob, crc));
+
+    Preferences prefs;
+    bool ok = false;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        ok = prefs.putBytes(NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+        prefs.end();
+    }
+
+    uint32_t elapsed_us = micros() - start_us;
+    saveTiming.last_us = elapsed_us;
+    if (elapsed_us > saveTiming.max_us) {
+        saveTiming.max_us = elapsed_us;
+    }
+    if (ok) {
+        saveTiming.saves++;
+    } else {
+        saveTiming.failures++;
+    }
+    return ok;
+}
+
+void getMotorStatsSaveTiming(MotorStatsSaveTiming* out) {
+    if (out == NULL) return;
+    *out = saveTiming;
+}
+
+void resetMotorCounters() {
+    uint32_t now_us = micros();
+    portENTER_CRITICAL(&accountMux);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        memset(&accounts[i].boot, 0, sizeof(accounts[i].boot));
+        accounts[i].last_us = now_us;
+        accounts[i].drive_dir = MOTOR_MODE_COUNT;
+    }
+    memset(storedCounters, 0, sizeof(storedCounters));
+    storedEmergencyBrakes = 0;
+    emergencyBrakes = 0;
+    portEXIT_CRITICAL(&accountMux);
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(NVS_KEY);
+        prefs.end();
+    }
+}
@@ -4,6 +4,11 @@
  *
  * Provides functions to control 5 DC motors using H-bridge drivers (L298N, TB6612, etc.)
  * with automatic LEDC PWM channel assignment. Supports forward, reverse, brake, and coast modes.
+ *
+ * Every drive call also updates per-motor actuation counters (time per
+ * drive mode and per safety state, duty integral, saturation time,
+ * reversals, brake events). The counters are lifetime totals: they are
+ * restored from NVS at init and saved with saveMotorCounters().
  */
 
 #ifndef MOTORS_H
@@ -11,6 +16,49 @@
 
 #include <Arduino.h>
 
+// ============================================================================
+// Actuation Accounting
+// ============================================================================
+
+/**
+ * @brief H-bridge drive modes, as counted by the accounting
+ */
+enum MotorDriveMode : uint8_t {
+    MOTOR_MODE_FORWARD = 0,
+    MOTOR_MODE_REVERSE,
+    MOTOR_MODE_BRAKE,
+    MOTOR_MODE_COAST,
+    MOTOR_MODE_COUNT
+};
+
+/**
+ * Number of safety states counted per motor (one per SystemState,
+ * see tof_sensor.h; set with motorSetAccountingState())
+ */
+constexpr int MOTOR_STATE_SLOTS = 4;
+
+/**
+ * @brief Lifetime actuation counters of one motor
+ */
+struct MotorCounters {
+    uint64_t mode_us[MOTOR_MODE_COUNT];      // Time in each drive mode
+    uint64_t duty_us;                        // Duty integral while driven (100% for 1 s = 1e6)
+    uint64_t saturated_us;                   // Driven at 100% duty
+    uint64_t state_us[MOTOR_STATE_SLOTS];    // Time in each SystemState
+    uint32_t reversals;                      // Forward <-> reverse direction changes
+    uint32_t brake_events;                   // Entries into brake from any other mode
+};
+
+/**
+ * @brief Duration of the NVS writes done by saveMotorCounters()
+ */
+struct MotorStatsSaveTiming {
+    uint32_t saves;                          // Blobs written since boot
+    uint32_t failures;                       // Saves that could not write the blob
+    uint32_t last_us;                        // Duration of the latest save
+    uint32_t max_us;                         // Longest save since boot
+};
+
 /**
  * @brief Initialize the motor control system
  *
@@ -66,4 +114,124 @@ void motorCoast(uint8_t motor_index);
  */
 void stopAllMotors();
 
+/**
+ * @brief Brake all motors from interrupt context
+ *
+ * Clears every H-bridge input pin with direct GPIO register writes
+ * (W1TC registers), so it runs in a bounded number of cycles without
+ * touching the LEDC driver or any lock. Both inputs LOW is the brake
+ * state used by motorBrake(); the PWM duty is left unchanged, so braking
+ * is active during the PWM on-phase. Safe to call from an ISR on any core.
+ *
+ * The next motorForward()/motorReverse() call re-drives the pins.
+ */
+void motorsEmergencyBrakeFromISR();
+
+/**
+ * @brief Brake one motor from interrupt context and latch the brake
+ *
+ * Same register writes as motorsEmergencyBrakeFromISR(), on this motor's
+ * H-bridge inputs only. While latched, motorForward() brakes instead of
+ * driving; motorReverse() is still allowed so the pad can be relieved.
+ * The latch and motorForward()'s check + direction pin writes share a
+ * spinlock, so a forward drive in progress cannot undo a trip.
+ * Called by the over-pressure sampler ISR (see overpressure_guard.h).
+ *
+ * @param motor_index Motor index (0-4)
+ */
+void motorLatchBrakeFromISR(uint8_t motor_index);
+
+/**
+ * @brief Clear the brake latch of a motor (the next drive call applies)
+ *
+ * Safe to call from an ISR.
+ *
+ * @param motor_index Motor index (0-4)
+ */
+void motorReleaseBrakeLatch(uint8_t motor_index);
+
+/**
+ * @brief true while motorLatchBrakeFromISR() holds the motor (ISR-safe)
+ * @param motor_index Motor index (0-4)
+ */
+bool motorBrakeLatched(uint8_t motor_index);
+
+/**
+ * @brief Find the PWM phase furthest from any motor switching edge
+ *
+ * Collects the rising and falling edges of every motor that is switching
+ * (duty strictly between 0% and 100%) and returns the middle of the
+ * largest edge-free gap, moved earlier by PWM_SAMPLE_LEAD_COUNTS so the
+ * ADC sample-and-hold lands there. With a single motor switching this is
+ * the middle of its off-time.
+ *
+ * @param center Output target phase in LEDC counts (motor 0's timer)
+ * @param half_width Output accepted distance from center (counts)
+ * @return false if no motor is switching (any phase is quiet)
+ */
+bool getPwmQuietWindow(uint16_t* center, uint16_t* half_width);
+
+/**
+ * @brief Busy-wait until the PWM counter is within a phase window
+ *
+ * Spins on the LEDC timer counter, so the wait is under one PWM period
+ * (50 us at 20 kHz) unless the window is missed.
+ *
+ * @param center Target phase from getPwmQuietWindow()
+ * @param half_width Accepted distance from center
+ * @param timeout_us Give up after this long
+ * @return false on timeout
+ */
+bool waitForPwmPhase(uint16_t center, uint16_t half_width, uint32_t timeout_us);
+
+/**
+ * @brief Set the safety state that time is counted against
+ *
+ * Called by the supervisory loop after each safety step.
+ *
+ * @param motor_index Motor index (0-4)
+ * @param state SystemState value (0 to MOTOR_STATE_SLOTS-1)
+ */
+void motorSetAccountingState(uint8_t motor_index, uint8_t state);
+
+/**
+ * @brief Copy the lifetime counters of one motor (NVS base + since boot)
+ * @param motor_index Motor index (0-4)
+ * @param out Output counters, including time in the current mode up to now
+ */
+void getMotorCounters(uint8_t motor_index, MotorCounters* out);
+
+/**
+ * @brief Lifetime number of motorsEmergencyBrakeFromISR() calls
+ */
+uint32_t getEmergencyBrakeCount();
+
+/**
+ * @brief True if every motor is braked, coasting or driven at 0% duty
+ */
+bool motorsAtRest();
+
+/**
+ * @brief Write the lifetime counters to NVS
+ *
+ * Blocks for the flash write (a few ms), which also stalls the other core.
+ * The supervisory loop calls it once MOTOR_STATS_SAVE_MS has elapsed and
+ * motorsAtRest() holds. It is also called at OTA:BEGIN, before a firmware
+ * restart and by DIAG:MOTORSTATS:SAVE. Each call is timed.
+ *
+ * @return true if the blob was written
+ */
+bool saveMotorCounters();
+
+/**
+ * @brief Copy the save count and durations
+ * @param out Output snapshot
+ */
+void getMotorStatsSaveTiming(MotorStatsSaveTiming* out);
+
+/**
+ * @brief Zero all counters and erase the stored copy
+ */
+void resetMotorCounters();
+
 #endif // MOTORS_H
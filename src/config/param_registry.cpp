@@ -0,0 +1,293 @@
+/**
+ * @file param_registry.cpp
+ * @brief Implementation of the runtime parameter registry
+ */
+
+#include "param_registry.h"
+#include "system_config.h"
+#include "../control/control_law.h"
+#include "../control/overpressure_guard.h"
+#include "../control/pi_controller.h"
+#include "../sensors/tof_sensor.h"
+#include "../utils/binary_protocol.h"
+#include "../utils/tlog.h"
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+
+// ============================================================================
+// Registry Table
+// ============================================================================
+
+#ifdef SWEEP_MODE_BIDIRECTIONAL
+constexpr float SWEEP_MODE_DEFAULT = SWEEP_BIDIRECTIONAL;
+#else
+constexpr float SWEEP_MODE_DEFAULT = SWEEP_FORWARD;
+#endif
+
+// Indexed by ParamId
+static const ParamDesc PARAM_TABLE[PARAM_COUNT] = {
+    // id                     name               type            min    max      default                   offset
+    {PARAM_LOG_PERIOD_MS,   "LOG_PERIOD_MS",   PARAM_TYPE_U32, 10.0f, 1000.0f, (float)LOGGING_PERIOD_MS, offsetof(ParamSnapshot, log_period_ms)},
+    {PARAM_SWEEP_MODE,      "SWEEP_MODE",      PARAM_TYPE_U8,  0.0f,  3.0f,    SWEEP_MODE_DEFAULT,       offsetof(ParamSnapshot, sweep_mode)},
+    {PARAM_SETPOINT_FAR,    "SETPOINT_FAR",    PARAM_TYPE_F32, 0.0f,  100.0f,  SETPOINT_FAR,             offsetof(ParamSnapshot, setpoint_far)},
+    {PARAM_SETPOINT_MEDIUM, "SETPOINT_MEDIUM", PARAM_TYPE_F32, 0.0f,  100.0f,  SETPOINT_MEDIUM,          offsetof(ParamSnapshot, setpoint_medium)},
+    {PARAM_SETPOINT_CLOSE,  "SETPOINT_CLOSE",  PARAM_TYPE_F32, 0.0f,  100.0f,  SETPOINT_CLOSE,           offsetof(ParamSnapshot, setpoint_close)},
+    {PARAM_SAFE_PRESSURE,   "SAFE_PRESSURE",   PARAM_TYPE_F32, 0.0f,  100.0f,  SAFE_PRESSURE_THRESHOLD,  offsetof(ParamSnapshot, safe_pressure_pct)},
+    {PARAM_REVERSE_DUTY,    "REVERSE_DUTY",    PARAM_TYPE_F32, 0.0f,  100.0f,  REVERSE_DUTY_PCT,         offsetof(ParamSnapshot, reverse_duty_pct)},
+    {PARAM_RELEASE_TIME_MS, "RELEASE_TIME_MS", PARAM_TYPE_U32, 0.0f,  5000.0f, (float)RELEASE_TIME_MS,   offsetof(ParamSnapshot, release_time_ms)},
+    {PARAM_RELEASE_HOLD_MS, "RELEASE_HOLD_MS", PARAM_TYPE_U32, 0.0f,  2000.0f, (float)RELEASE_HOLD_MS,   offsetof(ParamSnapshot, release_hold_ms)},
+    {PARAM_FORCE_SCALE_MIN, "FORCE_SCALE_MIN", PARAM_TYPE_F32, 0.0f,  1.5f,    FORCE_SCALE_MIN,          offsetof(ParamSnapshot, force_scale_min)},
+    {PARAM_FORCE_SCALE_MAX, "FORCE_SCALE_MAX", PARAM_TYPE_F32, 0.0f,  1.5f,    FORCE_SCALE_MAX,          offsetof(ParamSnapshot, force_scale_max)},
+    {PARAM_DIST_SCALE_MIN,  "DIST_SCALE_MIN",  PARAM_TYPE_F32, 0.1f,  3.0f,    DIST_SCALE_MIN,           offsetof(ParamSnapshot, dist_scale_min)},
+    {PARAM_DIST_SCALE_MAX,  "DIST_SCALE_MAX",  PARAM_TYPE_F32, 0.1f,  3.0f,    DIST_SCALE_MAX,           offsetof(ParamSnapshot, dist_scale_max)},
+    {PARAM_KP,              "KP",              PARAM_TYPE_F32, 0.0f,  50.0f,   PI_KP_DEFAULT,            offsetof(ParamSnapshot, kp)},
+    {PARAM_KI,              "KI",              PARAM_TYPE_F32, 0.0f,  50.0f,   PI_KI_DEFAULT,            offsetof(ParamSnapshot, ki)},
+    {PARAM_INNER_RATE_HZ,   "INNER_RATE_HZ",   PARAM_TYPE_U32, 50.0f, 500.0f,  (float)INNER_LOOP_FREQ_HZ, offsetof(ParamSnapshot, inner_rate_hz)},
+    {PARAM_OUTER_RATE_HZ,   "OUTER_RATE_HZ",   PARAM_TYPE_U32, 5.0f,  50.0f,   (float)CTRL_FREQ_HZ,      offsetof(ParamSnapshot, outer_rate_hz)},
+    {PARAM_TELEMETRY_MODE,  "TELEMETRY_MODE",  PARAM_TYPE_U8,  0.0f,  2.0f,    (float)TELEMETRY_MODE_DEFAULT, offsetof(ParamSnapshot, telemetry_mode)},
+    {PARAM_STATS_PERIOD_MS, "STATS_PERIOD_MS", PARAM_TYPE_U32, 250.0f, 10000.0f, (float)STATS_PERIOD_MS, offsetof(ParamSnapshot, stats_period_ms)},
+    {PARAM_POWER_MODE,      "POWER_MODE",      PARAM_TYPE_U8,  0.0f,  2.0f,    (float)POWER_MODE_DEFAULT, offsetof(ParamSnapshot, power_mode)},
+    {PARAM_CTRL_LAW_1,      "CTRL_LAW_1",      PARAM_TYPE_U8,  0.0f,  2.0f,    (float)CTRL_LAW_PI,       offsetof(ParamSnapshot, ctrl_law[0])},
+    {PARAM_CTRL_LAW_2,      "CTRL_LAW_2",      PARAM_TYPE_U8,  0.0f,  2.0f,    (float)CTRL_LAW_PI,       offsetof(ParamSnapshot, ctrl_law[1])},
+    {PARAM_CTRL_LAW_3,      "CTRL_LAW_3",      PARAM_TYPE_U8,  0.0f,  2.0f,    (float)CTRL_LAW_PI,       offsetof(ParamSnapshot, ctrl_law[2])},
+    {PARAM_CTRL_LAW_4,      "CTRL_LAW_4",      PARAM_TYPE_U8,  0.0f,  2.0f,    (float)CTRL_LAW_PI,       offsetof(ParamSnapshot, ctrl_law[3])},
+    {PARAM_CTRL_LAW_5,      "CTRL_LAW_5",      PARAM_TYPE_U8,  0.0f,  2.0f,    (float)CTRL_LAW_PI,       offsetof(ParamSnapshot, ctrl_law[4])},
+    {PARAM_KD,              "KD",              PARAM_TYPE_F32, 0.0f,  5.0f,    PID_KD_DEFAULT,           offsetof(ParamSnapshot, kd)},
+    {PARAM_D_FILTER_MS,     "D_FILTER_MS",     PARAM_TYPE_U32, 1.0f,  500.0f,  (float)PID_D_FILTER_MS_DEFAULT, offsetof(ParamSnapshot, d_filter_ms)},
+    {PARAM_SP_WEIGHT,       "SP_WEIGHT",       PARAM_TYPE_F32, 0.0f,  1.0f,    PID_SP_WEIGHT_DEFAULT,    offsetof(ParamSnapshot, sp_weight)},
+    {PARAM_LQI_Q_INT,       "LQI_Q_INT",       PARAM_TYPE_F32, 0.0f,  10000.0f, LQI_Q_INT_DEFAULT,       offsetof(ParamSnapshot, lqi_q_int)},
+    {PARAM_LQI_R,           "LQI_R",           PARAM_TYPE_F32, 0.001f, 100.0f, LQI_R_DEFAULT,            offsetof(ParamSnapshot, lqi_r)},
+    {PARAM_SMITH_1,         "SMITH_1",         PARAM_TYPE_U8,  0.0f,  1.0f,    0.0f,                     offsetof(ParamSnapshot, smith[0])},
+    {PARAM_SMITH_2,         "SMITH_2",         PARAM_TYPE_U8,  0.0f,  1.0f,    0.0f,                     offsetof(ParamSnapshot, smith[1])},
+    {PARAM_SMITH_3,         "SMITH_3",         PARAM_TYPE_U8,  0.0f,  1.0f,    0.0f,                     offsetof(ParamSnapshot, smith[2])},
+    {PARAM_SMITH_4,         "SMITH_4",         PARAM_TYPE_U8,  0.0f,  1.0f,    0.0f,                     offsetof(ParamSnapshot, smith[3])},
+    {PARAM_SMITH_5,         "SMITH_5",         PARAM_TYPE_U8,  0.0f,  1.0f,    0.0f,                     offsetof(ParamSnapshot, smith[4])},
+    {PARAM_DECOUPLE,        "DECOUPLE",        PARAM_TYPE_U8,  0.0f,  1.0f,    0.0f,                     offsetof(ParamSnapshot, decouple)},
+    {PARAM_POWER_BUDGET_PCT, "POWER_BUDGET_PCT", PARAM_TYPE_F32, 40.0f, 500.0f, POWER_BUDGET_UNLIMITED_PCT, offsetof(ParamSnapshot, power_budget_pct)},
+    {PARAM_OVERPRESSURE_PCT, "OVERPRESSURE_PCT", PARAM_TYPE_F32, 0.0f, 200.0f, OVERPRESSURE_DEFAULT_PCT, offsetof(ParamSnapshot, overpressure_pct)},
+};
+
+// ============================================================================
+// NVS Storage
+// ============================================================================
+
+constexpr const char* NVS_NAMESPACE = "params";
+constexpr const char* NVS_KEY = "values";
+constexpr const char* NVS_LEGACY_KEY = "blob";   // Raw ParamSnapshot of older firmware
+constexpr uint16_t PARAM_STORE_FORMAT = 1;       // Record layout, not the parameter set
+constexpr uint8_t PARAM_STORE_MAX_RECORDS = 64;  // Room for parameters added later
+
+static_assert(PARAM_COUNT <= PARAM_STORE_MAX_RECORDS, "Raise PARAM_STORE_MAX_RECORDS (changes the format)");
+
+/**
+ * Values are stored by ID, so adding a parameter keeps every stored value:
+ * records with an unknown ID are skipped, missing IDs keep their default.
+ */
+struct __attribute__((packed)) ParamRecord {
+    uint8_t id;                  // ParamId
+    float value;
+};
+
+struct __attribute__((packed)) ParamStoreBlob {
+    uint16_t format;             // PARAM_STORE_FORMAT
+    uint8_t count;               // Records in use
+    ParamRecord records[PARAM_STORE_MAX_RECORDS];
+    uint16_t crc;                // CRC-16 over everything above
+};
+
+// ============================================================================
+// State
+// ============================================================================
+
+// Live values, protected by a sequence counter (odd while a write is in progress)
+static ParamSnapshot current;
+static volatile uint32_t sequence = 0;
+static portMUX_TYPE write_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static float readField(const ParamSnapshot& snap, const ParamDesc& desc) {
+    const uint8_t* base = (const uint8_t*)&snap + desc.offset;
+    switch (desc.type) {
+        case PARAM_TYPE_U8:  return (float)*(const uint8_t*)base;
+        case PARAM_TYPE_U32: return (float)*(const uint32_t*)base;
+        case PARAM_TYPE_F32: return *(const float*)base;
+    }
+    return 0.0f;
+}
+
+static void writeField(ParamSnapshot& snap, const ParamDesc& desc, float value) {
+    uint8_t* base = (uint8_t*)&snap + desc.offset;
+    switch (desc.type) {
+        case PARAM_TYPE_U8:  *(uint8_t*)base = (uint8_t)lroundf(value); break;
+        case PARAM_TYPE_U32: *(uint32_t*)base = (uint32_t)lroundf(value); break;
+        case PARAM_TYPE_F32: *(float*)base = value; break;
+    }
+}
+
+static bool inRange(const ParamDesc& desc, float value) {
+    return !isnan(value) && value >= desc.min_value && value <= desc.max_value;
+}
+
+static void buildDefaults(ParamSnapshot* snap) {
+    memset(snap, 0, sizeof(ParamSnapshot));
+    for (int i = 0; i < PARAM_COUNT; ++i) {
+        writeField(*snap, PARAM_TABLE[i], PARAM_TABLE[i].default_value);
+    }
+}
+
+/**
+ * @brief Replace the live values (writers are serialized by write_mux)
+ */
+static void publish(const ParamSnapshot& snap) {
+    portENTER_CRITICAL(&write_mux);
+    sequence = sequence + 1;
+    __sync_synchronize();
+    memcpy(&current, &snap, sizeof(ParamSnapshot));
+    __sync_synchronize();
+    sequence = sequence + 1;
+    portEXIT_CRITICAL(&write_mux);
+}
+
+/**
+ * @brief Load the NVS copy on top of defaults
+ * @return true if a valid blob was found
+ */
+static bool loadFromNvs(ParamSnapshot* snap) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        return false;
+    }
+
+    ParamStoreBlob blob;
+    bool ok = prefs.getBytesLength(NVS_KEY) == sizeof(blob) &&
+              prefs.getBytes(NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    if (!ok || blob.format != PARAM_STORE_FORMAT || blob.count > PARAM_STORE_MAX_RECORDS) {
+        return false;
+    }
+    if (calculateCRC16((const uint8_t*)&blob, offsetof(ParamStoreBlob, crc)) != blob.crc) {
+        return false;
+    }
+
+    // Take stored values one by one, keeping the default for unknown IDs
+    // and anything out of range
+    for (int i = 0; i < blob.count; ++i) {
+        const ParamRecord& record = blob.records[i];
+        if (record.id < PARAM_COUNT && inRange(PARAM_TABLE[record.id], record.value)) {
+            writeField(*snap, PARAM_TABLE[record.id], record.value);
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void initParamRegistry() {
+    ParamSnapshot snap;
+    buildDefaults(&snap);
+    bool loaded = loadFromNvs(&snap);
+    publish(snap);
+
+    TLOG("Parameters: %s", loaded ? "loaded from NVS" : "defaults");
+}
+
+void paramSnapshot(ParamSnapshot* out) {
+    uint32_t before;
+    uint32_t after;
+    do {
+        before = sequence;
+        __sync_synchronize();
+        memcpy(out, (const void*)&current, sizeof(ParamSnapshot));
+        __sync_synchronize();
+        after = sequence;
+    } while (before != after || (before & 1));
+}
+
+const ParamDesc* paramFind(const String& key) {
+    for (int i = 0; i < PARAM_COUNT; ++i) {
+        if (key == PARAM_TABLE[i].name) {
+            return &PARAM_TABLE[i];
+        }
+    }
+
+    // Numeric ID
+    if (key.length() > 0 && isDigit(key[0])) {
+        int id = key.toInt();
+        if (id >= 0 && id < PARAM_COUNT) {
+            return &PARAM_TABLE[id];
+        }
+    }
+    return NULL;
+}
+
+const ParamDesc* paramTable(size_t* count) {
+    if (count) *count = PARAM_COUNT;
+    return PARAM_TABLE;
+}
+
+float paramGet(ParamId id) {
+    if (id >= PARAM_COUNT) {
+        return 0.0f;
+    }
+    ParamSnapshot snap;
+    paramSnapshot(&snap);
+    return readField(snap, PARAM_TABLE[id]);
+}
+
+bool paramSet(ParamId id, float value) {
+    if (id >= PARAM_COUNT || !inRange(PARAM_TABLE[id], value)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&write_mux);
+    sequence = sequence + 1;
+    __sync_synchronize();
+    writeField(current, PARAM_TABLE[id], value);
+    __sync_synchronize();
+    sequence = sequence + 1;
+    portEXIT_CRITICAL(&write_mux);
+    return true;
+}
+
+bool paramSave() {
+    ParamSnapshot snap;
+    paramSnapshot(&snap);
+
+    ParamStoreBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.format = PARAM_STORE_FORMAT;
+    blob.count = PARAM_COUNT;
+    for (int i = 0; i < PARAM_COUNT; ++i) {
+        blob.records[i].id = PARAM_TABLE[i].id;
+        blob.records[i].value = readField(snap, PARAM_TABLE[i]);
+    }
+    blob.crc = calculateCRC16((const uint8_t*)&blob, offsetof(ParamStoreBlob, crc));
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+    size_t written = prefs.putBytes(NVS_KEY, &blob, sizeof(blob));
+    prefs.remove(NVS_LEGACY_KEY);
+    prefs.end();
+    return written == sizeof(blob);
+}
+
+void paramResetDefaults() {
+    ParamSnapshot snap;
+    buildDefaults(&snap);
+    publish(snap);
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(NVS_KEY);
+        prefs.remove(NVS_LEGACY_KEY);
+        prefs.end();
+    }
+}
@@ -0,0 +1,233 @@
+/**
+ * @file param_registry.h
+ * @brief Runtime parameter registry with NVS persistence
+ *
+ * Tunables that used to need a reflash (setpoints, safety thresholds,
+ * potentiometer scaling, controller gains and laws, loop rates, logging
+ * rate, telemetry mode, sweep mode, power mode) live in one typed table
+ * with an ID, name, range and default. The compile-time
+ * constants in system_config.h / tof_sensor.h are now only the defaults.
+ *
+ * Commands (see docs/command-protocol.md):
+ * - PARAM:LIST
+ * - PARAM:GET:<name|id>
+ * - PARAM:SET:<name|id>:<value>
+ * - PARAM:SAVE   (persist to NVS)
+ * - PARAM:RESET  (restore defaults and erase NVS copy)
+ *
+ * Hot paths never read the table directly. Each task takes a
+ * ParamSnapshot at its tick boundary with paramSnapshot(); the copy is
+ * protected by a sequence counter so a SET landing mid-copy is retried
+ * and a tick always sees one consistent set of values.
+ */
+
+#ifndef PARAM_REGISTRY_H
+#define PARAM_REGISTRY_H
+
+#include <Arduino.h>
+#include "pins.h"
+
+// ============================================================================
+// Parameter IDs
+// ============================================================================
+
+/**
+ * @brief Stable parameter identifiers (never renumber, append only)
+ */
+enum ParamId : uint8_t {
+    PARAM_LOG_PERIOD_MS = 0,     // DataPacket period (ms)
+    PARAM_SWEEP_MODE,            // 0=forward, 1=bidirectional, 2=tracking, 3=continuous
+    PARAM_SETPOINT_FAR,          // FAR range setpoint (%)
+    PARAM_SETPOINT_MEDIUM,       // MEDIUM range setpoint (%)
+    PARAM_SETPOINT_CLOSE,        // CLOSE range setpoint (%)
+    PARAM_SAFE_PRESSURE,         // Deflation target (%)
+    PARAM_REVERSE_DUTY,          // Deflation duty (%)
+    PARAM_RELEASE_TIME_MS,       // Max deflation time (ms)
+    PARAM_RELEASE_HOLD_MS,       // Reverse time after reaching target (ms)
+    PARAM_FORCE_SCALE_MIN,       // Force scale at pot 1 = 0%
+    PARAM_FORCE_SCALE_MAX,       // Force scale at pot 1 = 100%
+    PARAM_DIST_SCALE_MIN,        // Distance scale at pot 2 = 0%
+    PARAM_DIST_SCALE_MAX,        // Distance scale at pot 2 = 100%
+    PARAM_KP,                    // PI proportional gain
+    PARAM_KI,                    // PI integral gain
+    PARAM_INNER_RATE_HZ,         // Pressure loop rate (Hz)
+    PARAM_OUTER_RATE_HZ,         // Supervisory loop rate (Hz)
+    PARAM_TELEMETRY_MODE,        // 0=raw, 1=summary, 2=both
+    PARAM_STATS_PERIOD_MS,       // Statistics summary window (ms)
+    PARAM_POWER_MODE,            // 0=performance, 1=DFS, 2=DFS + light sleep
+    PARAM_CTRL_LAW_1,            // Motor 1 control law: 0=PI, 1=PID, 2=LQI
+    PARAM_CTRL_LAW_2,
+    PARAM_CTRL_LAW_3,
+    PARAM_CTRL_LAW_4,
+    PARAM_CTRL_LAW_5,
+    PARAM_KD,                    // PID derivative gain
+    PARAM_D_FILTER_MS,           // PID derivative filter time constant (ms)
+    PARAM_SP_WEIGHT,             // PID setpoint weight of the P term
+    PARAM_LQI_Q_INT,             // LQI integral state weight
+    PARAM_LQI_R,                 // LQI duty weight
+    PARAM_SMITH_1,               // Motor 1 Smith predictor: 0=off, 1=on
+    PARAM_SMITH_2,
+    PARAM_SMITH_3,
+    PARAM_SMITH_4,
+    PARAM_SMITH_5,
+    PARAM_DECOUPLE,              // Pad cross-coupling compensation: 0=off, 1=on
+    PARAM_POWER_BUDGET_PCT,      // Sum of |duty| over the motors (500 = no limit)
+    PARAM_OVERPRESSURE_PCT,      // Sampler ISR brake level (% of maxstress, 0 = off)
+    PARAM_COUNT
+};
+
+/**
+ * @brief Storage type of a parameter
+ */
+enum ParamType : uint8_t {
+    PARAM_TYPE_U8,
+    PARAM_TYPE_U32,
+    PARAM_TYPE_F32
+};
+
+/**
+ * @brief Sweep mode values for PARAM_SWEEP_MODE
+ */
+enum SweepMode : uint8_t {
+    SWEEP_FORWARD = 0,
+    SWEEP_BIDIRECTIONAL = 1,
+    SWEEP_TRACKING = 2,          // Dither on the closest obstacle, refresh others
+    SWEEP_CONTINUOUS = 3         // Bidirectional without settle, lag-corrected binning
+};
+
+/**
+ * @brief Telemetry mode values for PARAM_TELEMETRY_MODE
+ */
+enum TelemetryMode : uint8_t {
+    TELEMETRY_RAW = 0,           // DataPacket every logging period
+    TELEMETRY_SUMMARY = 1,       // Statistics summary frames only
+    TELEMETRY_BOTH = 2
+};
+
+/**
+ * @brief Power mode values for PARAM_POWER_MODE (see utils/power_manager.h)
+ */
+enum PowerMode : uint8_t {
+    POWER_PERFORMANCE = 0,       // CPU fixed at maximum frequency
+    POWER_DFS = 1,               // Frequency scaling outside PM lock windows
+    POWER_DFS_LIGHT_SLEEP = 2    // Scaling plus automatic light sleep when idle
+};
+
+// ============================================================================
+// Snapshot
+// ============================================================================
+
+/**
+ * @brief One consistent copy of every parameter
+ *
+ * Field order is free: NVS stores (ID, value) records, not this struct.
+ */
+struct ParamSnapshot {
+    uint32_t log_period_ms;
+    uint8_t sweep_mode;
+    float setpoint_far;
+    float setpoint_medium;
+    float setpoint_close;
+    float safe_pressure_pct;
+    float reverse_duty_pct;
+    uint32_t release_time_ms;
+    uint32_t release_hold_ms;
+    float force_scale_min;
+    float force_scale_max;
+    float dist_scale_min;
+    float dist_scale_max;
+    float kp;
+    float ki;
+    uint32_t inner_rate_hz;
+    uint32_t outer_rate_hz;
+    uint8_t telemetry_mode;
+    uint32_t stats_period_ms;
+    uint8_t power_mode;
+    uint8_t ctrl_law[NUM_MOTORS];
+    float kd;
+    uint32_t d_filter_ms;
+    float sp_weight;
+    float lqi_q_int;
+    float lqi_r;
+    uint8_t smith[NUM_MOTORS];
+    uint8_t decouple;
+    float power_budget_pct;
+    float overpressure_pct;
+};
+
+/**
+ * @brief Parameter descriptor (one row of the registry table)
+ */
+struct ParamDesc {
+    ParamId id;
+    const char* name;            // Command name, e.g. "SETPOINT_FAR"
+    ParamType type;
+    float min_value;
+    float max_value;
+    float default_value;
+    size_t offset;               // offsetof(ParamSnapshot, field)
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Load defaults, then overlay the NVS copy if it is valid
+ *
+ * Must be called once at the start of setup(), before any module that
+ * reads parameters.
+ */
+void initParamRegistry();
+
+/**
+ * @brief Copy the current parameters (lock-free, safe from any task)
+ * @param out Output snapshot
+ */
+void paramSnapshot(ParamSnapshot* out);
+
+/**
+ * @brief Find a descriptor by name (case-sensitive) or numeric ID
+ * @param key Parameter name or decimal ID
+ * @return Descriptor, or NULL if not found
+ */
+const ParamDesc* paramFind(const String& key);
+
+/**
+ * @brief Get the descriptor table
+ * @param count Output number of entries
+ * @return Pointer to PARAM_COUNT descriptors
+ */
+const ParamDesc* paramTable(size_t* count);
+
+/**
+ * @brief Read one parameter as float
+ * @param id Parameter ID
+ * @return Current value (0 if id is invalid)
+ */
+float paramGet(ParamId id);
+
+/**
+ * @brief Write one parameter
+ *
+ * Integer parameters are rounded. Takes effect at the next tick of each
+ * reader. Not persisted until paramSave().
+ *
+ * @param id Parameter ID
+ * @param value New value
+ * @return false if id is invalid or value is outside [min, max]
+ */
+bool paramSet(ParamId id, float value);
+
+/**
+ * @brief Persist all parameters to NVS
+ * @return true on success
+ */
+bool paramSave();
+
+/**
+ * @brief Restore defaults and erase the NVS copy
+ */
+void paramResetDefaults();
+
+#endif // PARAM_REGISTRY_H
@@ -49,6 +49,8 @@ constexpr uint8_t M5_IN2  = 2;   // H-bridge input 2 (swapped)
 constexpr int NUM_MOTORS = 5;
 constexpr uint32_t PWM_FREQ_HZ = 20000;   // 20 kHz PWM frequency
 constexpr uint8_t PWM_RES_BITS = 10;      // 10-bit resolution (0-1023)
+constexpr uint16_t PWM_PERIOD_COUNTS = 1 << PWM_RES_BITS;  // LEDC counts per PWM period
+constexpr uint16_t PWM_SAMPLE_LEAD_COUNTS = 80;            // ~4 us from analogRead call to sample-and-hold
 
 // ============================================================================
 // TOF SENSOR PINS (Serial Communication + Servo)
@@ -98,6 +100,15 @@ constexpr uint8_t PP_CHANNELS[NUM_PRESSURE_PADS] = {
 // Number of ADC samples to average per reading
 constexpr int PP_SAMPLES = 8;
 
+// Samples per pad in the inner pressure loop (keeps one tick short at 200 Hz)
+constexpr int PP_SAMPLES_INNER = 2;
+
+// Trigger pad conversions at the quietest phase of the motor PWM period
+// (see getPwmQuietWindow()). Synchronous samples skip the switching spikes,
+// so fewer of them are needed and no spacing delay is added between them.
+constexpr bool PP_SAMPLE_SYNC = true;
+constexpr uint32_t PP_SYNC_TIMEOUT_US = 120;  // Give up on the phase after ~2 PWM periods
+
 // ============================================================================
 // POTENTIOMETER CHANNELS (Multiplexer Channel Assignments)
 // ============================================================================
@@ -63,6 +63,123 @@ constexpr uint32_t SERVO_SETTLE_MS = 10;
  */
 constexpr uint32_t SERVO_READING_DELAY_MS = 10;
 
+/**
+ * Early publication margin (cm)
+ * - A reading closer than the published sector minimum by more than this
+ *   is published at once instead of when the sweep leaves the sector
+ * - The end of the sector still publishes the final minimum (which may be
+ *   farther again if the obstacle left)
+ * - Must stay above the sensor noise, or every sample publishes
+ */
+constexpr float SWEEP_EARLY_PUBLISH_MARGIN_CM = 5.0f;
+
+// ============================================================================
+// TRACKING MODE (PARAM SWEEP_MODE = 2)
+// ============================================================================
+//
+// After a coarse acquisition sweep the servo dithers around the closest
+// obstacle and updates that sector at the TOF's native rate. Every
+// TRACK_REFRESH_MS one of the other sectors is swept once to keep it fresh.
+// ============================================================================
+
+/**
+ * Acquisition sweep step, as a multiple of the sweep step
+ * - Coarse on purpose: the dither refines the angle afterwards
+ */
+constexpr int TRACK_ACQUIRE_STEP_FACTOR = 2;
+
+/**
+ * Dither amplitude around the tracked angle (degrees)
+ * - The servo visits center, +amplitude, center, -amplitude
+ * - Must stay well below a sector width (34°)
+ */
+constexpr int TRACK_DITHER_DEG = 3;
+
+/**
+ * Settling time per dither step (milliseconds)
+ * - Dither steps are small, so this is shorter than SERVO_SETTLE_MS
+ */
+constexpr uint32_t TRACK_SETTLE_MS = 4;
+
+/**
+ * Servo slew allowance when jumping back from a refresh (ms per degree)
+ */
+constexpr uint32_t TRACK_SLEW_MS_PER_DEG = 2;
+
+/**
+ * Time spent dithering between two refresh sweeps (milliseconds)
+ */
+constexpr uint32_t TRACK_REFRESH_MS = 400;
+
+/**
+ * Consecutive invalid readings before the target is declared lost
+ * and a new acquisition sweep starts
+ */
+constexpr int TRACK_LOST_SAMPLES = 12;
+
+/**
+ * Retarget margin (cm): a refreshed sector takes over tracking when its
+ * minimum is closer than the tracked obstacle by more than this
+ */
+constexpr float TRACK_RETARGET_MARGIN_CM = 5.0f;
+
+// ============================================================================
+// CONTINUOUS SWEEP (PARAM SWEEP_MODE = 3)
+// ============================================================================
+//
+// Bidirectional sweep without settle: the command advances one step per
+// reading and the servo moves continuously. Samples are binned to sectors
+// at the commanded angle corrected by the learned per-direction lag
+// (src/sensors/sweep_lag.h), so both directions publish consistent minima.
+// ============================================================================
+
+/**
+ * Number of sweep speed bins in the lag table, and their width (deg/s)
+ * - Bin i covers [i, i+1) x width; the last bin is open-ended
+ */
+constexpr int SWEEP_LAG_SPEED_BINS = 4;
+constexpr float SWEEP_LAG_BIN_WIDTH_DPS = 100.0f;
+
+/**
+ * Servo lag time before anything is learned (seconds)
+ * - Default lag per direction = speed x this
+ */
+constexpr float SWEEP_LAG_DEFAULT_S = 0.02f;
+
+/**
+ * Largest lag searched per direction (degrees), and the search resolution
+ */
+constexpr float SWEEP_LAG_MAX_DEG = 12.0f;
+constexpr float SWEEP_LAG_SEARCH_STEP_DEG = 0.5f;
+
+/**
+ * Weight of a new pass pair in the learned lag (0-1)
+ */
+constexpr float SWEEP_LAG_LEARN_RATE = 0.25f;
+
+/**
+ * Profile structure required to learn from a pass pair
+ * - Flat scenes (a bare wall) carry no angle information
+ */
+constexpr int SWEEP_LAG_MIN_POINTS = 8;
+constexpr float SWEEP_LAG_MIN_CONTRAST_CM = 20.0f;
+
+/**
+ * Largest gap between two samples bridged by interpolation (degrees)
+ */
+constexpr int SWEEP_LAG_MAX_GAP_DEG = 8;
+
+/**
+ * Settling time per step of the calibration reference sweep (milliseconds)
+ * - Long on purpose: the reference must show the true angle
+ */
+constexpr uint32_t SWEEP_LAG_REF_SETTLE_MS = 60;
+
+/**
+ * Smoothing of the measured sweep speed per step (0-1)
+ */
+constexpr float SWEEP_SPEED_FILTER = 0.1f;
+
 // ============================================================================
 // MOTOR SECTOR ASSIGNMENTS
 // ============================================================================
@@ -160,6 +277,11 @@ static_assert(SERVO_MIN_ANGLE < SERVO_MAX_ANGLE,
 static_assert(SERVO_STEP > 0,
     "ERROR: SERVO_STEP must be > 0");
 
+static_assert(TRACK_DITHER_DEG > 0 && TRACK_DITHER_DEG < 17,
+    "ERROR: TRACK_DITHER_DEG must be > 0 and below half a sector");
+static_assert(SWEEP_LAG_SPEED_BINS > 0 && SWEEP_LAG_BIN_WIDTH_DPS > 0.0f,
+    "ERROR: Continuous sweep needs at least one speed bin");
+
 // Check sector continuity and coverage
 static_assert(SECTOR_MOTOR_1_MIN == SERVO_MIN_ANGLE,
     "WARNING: SECTOR_MOTOR_1_MIN should start at SERVO_MIN_ANGLE to avoid gaps");
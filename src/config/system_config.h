@@ -4,11 +4,107 @@
  *
  * This file defines the system configuration for the 4-motor PI control system
  * with servo sweep and TOF distance sensing.
+ *
+ * Logging rate, sweep mode and the potentiometer scaling below only set the
+ * power-on defaults. They can be changed at runtime and persisted with the
+ * PARAM:* commands (see config/param_registry.h).
  */
 
 #ifndef SYSTEM_CONFIG_H
 #define SYSTEM_CONFIG_H
 
+#include <stdint.h>
+
+// ============================================================================
+// CONTROL LOOP RATES (defaults, see PARAM:OUTER_RATE_HZ / PARAM:INNER_RATE_HZ)
+// ============================================================================
+
+/**
+ * Outer supervisory loop frequency (Hz)
+ * - loop() on Core 1: potentiometers, distance ranges, setpoints and the
+ *   safety state machine
+ * - Safety state machine timeouts are counted in outer ticks
+ */
+constexpr uint32_t CTRL_FREQ_HZ = 20;
+constexpr uint32_t CTRL_DT_MS = 1000 / CTRL_FREQ_HZ;  // 50 ms period
+
+/**
+ * Inner pressure loop frequency (Hz)
+ * - Pressure loop task on Core 1: reads the pads, runs PI, drives motors
+ * - The FreeRTOS tick is 1 ms, so the period is rounded to whole ms
+ * - Reported to clients as control_freq_hz in the device info frame
+ */
+constexpr uint32_t INNER_LOOP_FREQ_HZ = 200;
+
+// ============================================================================
+// CONTROL LOOP WATCHDOG
+// ============================================================================
+
+/**
+ * Deadline supervisor (see control/control_watchdog.h)
+ * - A hardware timer ISR checks the pressure loop heartbeat every
+ *   WATCHDOG_CHECK_US and brakes all motors if no tick arrived within
+ *   CONTROL_DEADLINE_MS
+ * - Worst-case brake latency: CONTROL_DEADLINE_MS + WATCHDOG_CHECK_US
+ * - A tick later than 1.5x the loop period is counted as late (no brake)
+ * - The same ISR checks the supervisory loop heartbeat against
+ *   OUTER_DEADLINE_PERIODS outer periods (250 ms at 20 Hz)
+ */
+constexpr uint32_t CONTROL_DEADLINE_MS = 50;                   // Missed deadline → brake
+constexpr uint32_t OUTER_DEADLINE_PERIODS = 5;                 // Supervisory loop deadline (outer periods)
+constexpr uint32_t WATCHDOG_CHECK_US = 5000;                   // ISR period (5 ms)
+constexpr uint8_t WATCHDOG_TIMER_NUM = 0;                      // Hardware timer group/index
+constexpr uint8_t OVERPRESSURE_TIMER_NUM = 1;                  // Over-pressure sampler (overpressure_guard.h)
+
+// ============================================================================
+// MOTOR ACTUATION ACCOUNTING
+// ============================================================================
+
+/**
+ * Per-motor counters (see actuators/motors.h)
+ * - Lifetime totals are saved to NVS every MOTOR_STATS_SAVE_MS, as soon as
+ *   every motor is braked or idle; while the motors keep being driven the
+ *   save waits, so a power cut can lose more than this much history
+ * - Each save is one NVS blob write (~450 bytes)
+ */
+constexpr uint32_t MOTOR_STATS_SAVE_MS = 600000;               // 10 minutes
+
+// ============================================================================
+// POWER MANAGEMENT (defaults, see PARAM:POWER_MODE)
+// ============================================================================
+
+/**
+ * ESP-IDF power management (see utils/power_manager.h), needs a core built
+ * with CONFIG_PM_ENABLE (light sleep also CONFIG_FREERTOS_USE_TICKLESS_IDLE):
+ * - 0 = performance: CPU fixed at PM_MAX_FREQ_MHZ
+ * - 1 = DFS: CPU drops to PM_MIN_FREQ_MHZ outside timing-critical windows
+ * - 2 = DFS + automatic light sleep while nothing is driven and the host is idle
+ * - PM_MIN_FREQ_MHZ = 80 keeps APB at 80 MHz, so LEDC PWM (motors, servo),
+ *   UART baud rates and the watchdog timer are unaffected by scaling
+ */
+constexpr uint8_t POWER_MODE_DEFAULT = 1;
+constexpr int PM_MAX_FREQ_MHZ = 240;
+constexpr int PM_MIN_FREQ_MHZ = 80;
+constexpr uint32_t PM_HOST_IDLE_MS = 60000;                    // No command for this long → host idle
+constexpr uint32_t LOOP_IDLE_POLL_MS = 5;                      // loop() sleep between command polls
+
+// ============================================================================
+// POTENTIOMETER SCALING (defaults, see PARAM:*_SCALE_*)
+// ============================================================================
+
+// Force scaling from potentiometer 1
+// Pot at min (0 mV)    → CLOSE=60%, scaled proportionally for MEDIUM and FAR
+// Pot at max (3300 mV) → CLOSE=100%, scaled proportionally for MEDIUM and FAR
+constexpr float FORCE_SCALE_MIN = 0.60f;   // Minimum scale (pot at 0%)
+constexpr float FORCE_SCALE_MAX = 1.00f;   // Maximum scale (pot at 100%)
+
+// Distance threshold scaling from potentiometer 2
+// Pot at 0%   → scale = 0.5 (FAR out at 150 cm)
+// Pot at 50%  → scale = 1.0 (FAR out at 300 cm - reference)
+// Pot at 100% → scale = 1.5 (FAR out at 450 cm)
+constexpr float DIST_SCALE_MIN = 0.50f;    // Minimum scale (pot at 0%)
+constexpr float DIST_SCALE_MAX = 1.50f;    // Maximum scale (pot at 100%)
+
 // ============================================================================
 // CONTROL MODE SELECTION
 // ============================================================================
@@ -81,7 +177,7 @@ constexpr const char* PROTOCOL_NAME = "Debug (no frontend)";
  * LOGGING_RATE_100HZ: 100 Hz (10ms) - Maximum detail (higher than control rate)
  */
 
-// Uncomment ONE of the following lines:
+// Uncomment ONE of the following lines (power-on default, see PARAM:SET:LOG_PERIOD_MS):
 //#define LOGGING_RATE_10HZ
 //#define LOGGING_RATE_25HZ
 #define LOGGING_RATE_50HZ   // Default: matches control loop rate
@@ -113,6 +209,19 @@ constexpr const char* PROTOCOL_NAME = "Debug (no frontend)";
     constexpr const char* LOGGING_RATE_NAME = "100 Hz";
 #endif
 
+// ============================================================================
+// TELEMETRY SUMMARIES (defaults, see PARAM:TELEMETRY_MODE / PARAM:STATS_PERIOD_MS)
+// ============================================================================
+
+/**
+ * Telemetry mode (see utils/telemetry_stats.h):
+ * - 0 = raw: one DataPacket per logging period (default, live charts)
+ * - 1 = summary: per-channel statistics frames every STATS_PERIOD_MS only
+ * - 2 = both
+ */
+constexpr uint8_t TELEMETRY_MODE_DEFAULT = 0;
+constexpr uint32_t STATS_PERIOD_MS = 1000;   // Summary window and frame period (1 Hz)
+
 
 // ============================================================================
 // SERVO SWEEP MODE CONFIGURATION
@@ -135,7 +244,7 @@ constexpr const char* PROTOCOL_NAME = "Debug (no frontend)";
  *   - More complete coverage, no need to return to start position
  */
 
-// Uncomment ONE of the following lines:
+// Uncomment ONE of the following lines (power-on default, see PARAM:SET:SWEEP_MODE):
 #define SWEEP_MODE_FORWARD        // Default: forward sweep only
 //#define SWEEP_MODE_BIDIRECTIONAL  // Bidirectional sweep
 
@@ -0,0 +1,228 @@
+/**
+ * @file control_law.cpp
+ * @brief Implementation of the PI, filtered PID and LQI control laws
+ */
+
+#include "control_law.h"
+#include <math.h>
+#include <algorithm>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr float DUTY_LIMIT = 100.0f;             // Integral terms are clamped to this duty
+constexpr float RLS_FORGETTING = 0.998f;         // ~500 tick memory
+constexpr float RLS_P_INIT = 100.0f;
+constexpr float RLS_P_MAX = 1.0e4f;              // Covariance windup guard (trace)
+constexpr float MODEL_TAU_MIN_S = 0.01f;         // Fits outside these bounds are not trusted
+constexpr float MODEL_TAU_MAX_S = 5.0f;
+constexpr float MODEL_GAIN_MIN = 0.2f;
+constexpr float MODEL_GAIN_MAX = 5.0f;
+constexpr int LQI_RICCATI_ITERATIONS = 1000;     // Cold start needs up to ~750 (LQI_Q_INT = 2)
+constexpr float GAIN_EPSILON = 0.0001f;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static float clampIntegrator(float integrator, float gain) {
+    float limit = DUTY_LIMIT / std::max(fabsf(gain), GAIN_EPSILON);
+    return std::min(std::max(integrator, -limit), limit);
+}
+
+// ============================================================================
+// PI
+// ============================================================================
+
+static float piStep(ControllerState& s, const ControlGains& g, float setpoint, float measurement, float dt_s) {
+    float error = setpoint - measurement;
+    s.integrator = clampIntegrator(s.integrator + error * dt_s, g.ki);
+    return g.kp * error + g.ki * s.integrator;
+}
+
+static void piPreload(ControllerState& s, const ControlGains& g, float setpoint, float measurement, float output) {
+    if (g.ki > GAIN_EPSILON) {
+        s.integrator = clampIntegrator((output - g.kp * (setpoint - measurement)) / g.ki, g.ki);
+    }
+}
+
+// ============================================================================
+// PID (filtered derivative on the measurement, weighted setpoint in P)
+// ============================================================================
+
+static float pidStep(ControllerState& s, const ControlGains& g, float setpoint, float measurement, float dt_s) {
+    float error = setpoint - measurement;
+    float proportional = g.kp * (g.sp_weight * setpoint - measurement);
+
+    // Backward difference of kd*s/(1 + Tf*s): setpoint steps never reach D
+    float tf = g.d_filter_s;
+    s.derivative = (tf * s.derivative - g.kd * (measurement - s.prev_measurement)) / (tf + dt_s);
+    s.prev_measurement = measurement;
+
+    s.integrator = clampIntegrator(s.integrator + error * dt_s, g.ki);
+    return proportional + g.ki * s.integrator + s.derivative;
+}
+
+static void pidPreload(ControllerState& s, const ControlGains& g, float setpoint, float measurement, float output) {
+    s.derivative = 0.0f;
+    s.prev_measurement = measurement;
+    if (g.ki > GAIN_EPSILON) {
+        float proportional = g.kp * (g.sp_weight * setpoint - measurement);
+        s.integrator = clampIntegrator((output - proportional) / g.ki, g.ki);
+    }
+}
+
+// ============================================================================
+// LQI (u = ff*r + k_e*e + k_i*integral(e), gains from lqiDesign())
+// ============================================================================
+
+static float lqiStep(ControllerState& s, const ControlGains& g, float setpoint, float measurement, float dt_s) {
+    (void)g;
+    float error = setpoint - measurement;
+    s.integrator = clampIntegrator(s.integrator + error * dt_s, s.lqi_k_i);
+    return s.lqi_ff * setpoint + s.lqi_k_e * error + s.lqi_k_i * s.integrator;
+}
+
+static void lqiPreload(ControllerState& s, const ControlGains& g, float setpoint, float measurement, float output) {
+    (void)g;
+    if (s.lqi_k_i > GAIN_EPSILON) {
+        float error = setpoint - measurement;
+        s.integrator = clampIntegrator((output - s.lqi_ff * setpoint - s.lqi_k_e * error) / s.lqi_k_i, s.lqi_k_i);
+    }
+}
+
+// ============================================================================
+// Law Table
+// ============================================================================
+
+// Indexed by ControlLaw
+static const ControlLawDesc LAW_TABLE[CTRL_LAW_COUNT] = {
+    {CTRL_LAW_PI,  "PI",  piStep,  piPreload},
+    {CTRL_LAW_PID, "PID", pidStep, pidPreload},
+    {CTRL_LAW_LQI, "LQI", lqiStep, lqiPreload},
+};
+
+const ControlLawDesc& controlLaw(uint8_t law) {
+    return LAW_TABLE[law < CTRL_LAW_COUNT ? law : (uint8_t)CTRL_LAW_PI];
+}
+
+// ============================================================================
+// Model Identification
+// ============================================================================
+
+void modelInit(PlantModel& model) {
+    model.a = 0.0f;
+    model.b = 0.0f;
+    model.p[0][0] = RLS_P_INIT;
+    model.p[0][1] = 0.0f;
+    model.p[1][0] = 0.0f;
+    model.p[1][1] = RLS_P_INIT;
+    model.period_s = 0.0f;
+    model.samples = 0;
+}
+
+void modelUpdate(PlantModel& model, float y_prev, float u_prev, float y, float dt_s) {
+    // Regressor phi = [y_prev, u_prev], target y
+    float p_phi0 = model.p[0][0] * y_prev + model.p[0][1] * u_prev;
+    float p_phi1 = model.p[1][0] * y_prev + model.p[1][1] * u_prev;
+    float denom = RLS_FORGETTING + y_prev * p_phi0 + u_prev * p_phi1;
+    if (denom <= GAIN_EPSILON) {
+        return;
+    }
+    float k0 = p_phi0 / denom;
+    float k1 = p_phi1 / denom;
+
+    float residual = y - (model.a * y_prev + model.b * u_prev);
+    model.a += k0 * residual;
+    model.b += k1 * residual;
+
+    // P = (P - k * phi' * P) / lambda
+    float p00 = (model.p[0][0] - k0 * p_phi0) / RLS_FORGETTING;
+    float p01 = (model.p[0][1] - k0 * p_phi1) / RLS_FORGETTING;
+    float p11 = (model.p[1][1] - k1 * p_phi1) / RLS_FORGETTING;
+    if (p00 + p11 > RLS_P_MAX || p00 < 0.0f || p11 < 0.0f) {
+        // Poorly excited (steady duty): restart the covariance, keep the fit
+        p00 = RLS_P_INIT;
+        p01 = 0.0f;
+        p11 = RLS_P_INIT;
+    }
+    model.p[0][0] = p00;
+    model.p[0][1] = p01;
+    model.p[1][0] = p01;
+    model.p[1][1] = p11;
+
+    model.period_s = (model.samples == 0) ? dt_s : model.period_s + 0.01f * (dt_s - model.period_s);
+    model.samples++;
+}
+
+ModelEstimate modelEstimate(const PlantModel& model) {
+    ModelEstimate estimate = {CTRL_MODEL_TAU_DEFAULT_S, CTRL_MODEL_GAIN_DEFAULT, false};
+    if (model.samples < CTRL_MODEL_MIN_SAMPLES || model.a <= 0.0f || model.a >= 1.0f || model.b <= 0.0f) {
+        return estimate;
+    }
+    float tau_s = -model.period_s / logf(model.a);
+    float gain = model.b / (1.0f - model.a);
+    if (tau_s < MODEL_TAU_MIN_S || tau_s > MODEL_TAU_MAX_S || gain < MODEL_GAIN_MIN || gain > MODEL_GAIN_MAX) {
+        return estimate;
+    }
+    estimate.tau_s = tau_s;
+    estimate.gain = gain;
+    estimate.identified = true;
+    return estimate;
+}
+
+// ============================================================================
+// LQI Design
+// ============================================================================
+
+void lqiDesign(ControllerState& state, const ModelEstimate& model, const ControlGains& gains, float dt_s) {
+    // Deviation state x = [y - r, integral(r - y)], input u - ff*r:
+    //   x+ = [[a, 0], [-dt, 1]] x + [b, 0]' (u - ff*r)
+    float a = expf(-dt_s / model.tau_s);
+    float b = (1.0f - a) * model.gain;
+    float q_int = gains.lqi_q_int;
+    float r = std::max(gains.lqi_r, GAIN_EPSILON);
+
+    float p00 = 1.0f, p01 = 0.0f, p11 = q_int;
+    if (state.lqi_p[0] > 0.0f) {
+        p00 = state.lqi_p[0];
+        p01 = state.lqi_p[1];
+        p11 = state.lqi_p[2];
+    }
+    float k0 = 0.0f, k1 = 0.0f;
+    for (int n = 0; n < LQI_RICCATI_ITERATIONS; ++n) {
+        // PA = P * A
+        float pa00 = p00 * a - p01 * dt_s;
+        float pa01 = p01;
+        float pa10 = p01 * a - p11 * dt_s;
+        float pa11 = p11;
+
+        // K = (R + B'PB)^-1 B'PA
+        float s = r + b * b * p00;
+        k0 = b * pa00 / s;
+        k1 = b * pa01 / s;
+
+        // P = Q + A'PA - (B'PA)' K
+        float n00 = 1.0f + a * pa00 - dt_s * pa10 - b * pa00 * k0;
+        float n01 = a * pa01 - dt_s * pa11 - b * pa00 * k1;
+        float n11 = q_int + pa11 - b * pa01 * k1;
+
+        bool converged = fabsf(n00 - p00) <= 1e-6f * n00 && fabsf(n11 - p11) <= 1e-6f * n11;
+        p00 = n00;
+        p01 = n01;
+        p11 = n11;
+        if (converged) {
+            break;
+        }
+    }
+
+    state.lqi_p[0] = p00;
+    state.lqi_p[1] = p01;
+    state.lqi_p[2] = p11;
+
+    // u = ff*r - k0*(y - r) - k1*integral(r - y)
+    state.lqi_k_e = k0;
+    state.lqi_k_i = -k1;
+    state.lqi_ff = 1.0f / model.gain;
+}
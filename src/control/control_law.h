@@ -0,0 +1,158 @@
+/**
+ * @file control_law.h
+ * @brief Selectable control laws for the normalized pressure loop
+ *
+ * Each motor runs one law, chosen at runtime with PARAM CTRL_LAW_1..5:
+ * - CTRL_LAW_PI   PI with integrator clamp (the original law)
+ * - CTRL_LAW_PID  PI plus a first-order filtered derivative on the
+ *                 measurement, proportional setpoint weighting (SP_WEIGHT)
+ * - CTRL_LAW_LQI  Integral LQR on the motor's identified first-order
+ *                 model, with model-inverse feedforward of the setpoint
+ *
+ * Every law implements the same two entry points (ControlLawDesc): one
+ * step, and a preload that sets the integral state so the next output
+ * equals a given duty (bumpless re-engagement, see PiMode).
+ *
+ * The plant model y[k+1] = a*y[k] + b*u[k] (pressure %, duty %) is fitted
+ * per motor by recursive least squares on forward-drive ticks, whatever law
+ * runs the motor, and kept as time constant and gain so it survives
+ * INNER_RATE_HZ changes. Until enough samples arrive the default model
+ * below is used.
+ */
+
+#ifndef CONTROL_LAW_H
+#define CONTROL_LAW_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+// Defaults of the extra gains, overridable via PARAM:SET
+constexpr float PID_KD_DEFAULT = 0.02f;            // Derivative gain (duty % per %/s)
+constexpr uint32_t PID_D_FILTER_MS_DEFAULT = 20;   // Derivative filter time constant
+constexpr float PID_SP_WEIGHT_DEFAULT = 1.0f;      // Setpoint weight of the P term
+constexpr float LQI_Q_INT_DEFAULT = 20.0f;         // Integral state weight (error weight = 1)
+constexpr float LQI_R_DEFAULT = 0.05f;             // Duty weight
+
+// Plant model used until identification converges
+constexpr float CTRL_MODEL_TAU_DEFAULT_S = 0.15f;
+constexpr float CTRL_MODEL_GAIN_DEFAULT = 1.0f;
+constexpr uint32_t CTRL_MODEL_MIN_SAMPLES = 400;   // Forward-drive ticks before trusting the fit
+constexpr uint32_t CTRL_REDESIGN_MS = 1000;        // LQI gain redesign period per motor
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Control law identifiers (values of PARAM CTRL_LAW_n)
+ */
+enum ControlLaw : uint8_t {
+    CTRL_LAW_PI = 0,
+    CTRL_LAW_PID,
+    CTRL_LAW_LQI,
+    CTRL_LAW_COUNT
+};
+
+/**
+ * @brief Gains shared by all motors (from the parameter snapshot)
+ */
+struct ControlGains {
+    float kp;
+    float ki;
+    float kd;
+    float d_filter_s;
+    float sp_weight;
+    float lqi_q_int;
+    float lqi_r;
+};
+
+/**
+ * @brief Per-motor controller state (owned by the pressure loop)
+ */
+struct ControllerState {
+    float integrator;          // Integral of (setpoint - measurement), %·s
+    float derivative;          // Filtered D term (PID)
+    float prev_measurement;    // Measurement of the previous RUN tick (PID)
+    float lqi_k_e;             // LQI gain on the error
+    float lqi_k_i;             // LQI gain on the integrator
+    float lqi_ff;              // LQI duty per % setpoint (1 / model gain)
+    float lqi_p[3];            // Riccati solution P00, P01, P11 (warm start, 0 = none)
+};
+
+/**
+ * @brief Recursive least squares fit of y[k+1] = a*y[k] + b*u[k]
+ */
+struct PlantModel {
+    float a;
+    float b;
+    float p[2][2];             // Parameter covariance
+    float period_s;            // Mean tick period of the fitted samples
+    uint32_t samples;
+};
+
+/**
+ * @brief Continuous-time view of a PlantModel
+ */
+struct ModelEstimate {
+    float tau_s;
+    float gain;                // Steady-state pressure % per duty %
+    bool identified;           // false = defaults in use
+};
+
+/**
+ * @brief One control law
+ */
+struct ControlLawDesc {
+    ControlLaw law;
+    const char* name;          // "PI", "PID", "LQI"
+
+    /** @brief One tick, returns the duty before saturation and deadband */
+    float (*step)(ControllerState& state, const ControlGains& gains,
+                  float setpoint, float measurement, float dt_s);
+
+    /** @brief Set the integral state so step() would return `output` now */
+    void (*preload)(ControllerState& state, const ControlGains& gains,
+                    float setpoint, float measurement, float output);
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Descriptor of a law (out-of-range values map to CTRL_LAW_PI)
+ */
+const ControlLawDesc& controlLaw(uint8_t law);
+
+/**
+ * @brief Start a model from the defaults with an empty fit
+ */
+void modelInit(PlantModel& model);
+
+/**
+ * @brief Add one forward-drive tick to the fit
+ * @param y_prev Measurement at the previous tick (%)
+ * @param u_prev Duty applied since the previous tick (%)
+ * @param y Measurement now (%)
+ * @param dt_s Time since the previous tick
+ */
+void modelUpdate(PlantModel& model, float y_prev, float u_prev, float y, float dt_s);
+
+/**
+ * @brief Time constant and gain of the fit, or the defaults if not yet valid
+ */
+ModelEstimate modelEstimate(const PlantModel& model);
+
+/**
+ * @brief Redesign the LQI gains of a motor for a model and tick period
+ *
+ * Iterates the discrete Riccati equation of the plant augmented with the
+ * error integrator: Q = diag(1, LQI_Q_INT), R = LQI_R. Starts from the
+ * previous solution, so a redesign after model drift takes few iterations.
+ */
+void lqiDesign(ControllerState& state, const ModelEstimate& model, const ControlGains& gains, float dt_s);
+
+#endif // CONTROL_LAW_H
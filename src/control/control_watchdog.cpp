@@ -0,0 +1,181 @@
+/**
+ * @file control_watchdog.cpp
+ * @brief Implementation of the control loop deadline supervisor
+ */
+
+#include "control_watchdog.h"
+#include "../actuators/motors.h"
+#include "../config/system_config.h"
+#include "pressure_loop.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr uint16_t TIMER_DIVIDER = 80;                        // 80 MHz APB → 1 µs ticks
+constexpr uint32_t DEADLINE_US = CONTROL_DEADLINE_MS * 1000UL;
+
+static_assert(OUTER_DEADLINE_PERIODS > PRESSURE_COMMAND_STALE_PERIODS,
+              "The supervisory deadline must back up the pressure loop's stale hold");
+
+// ============================================================================
+// State (shared between control task and ISR)
+// ============================================================================
+
+static hw_timer_t* watchdog_timer = NULL;
+
+static volatile bool wd_armed = false;
+static volatile bool wd_tripped = false;
+static volatile uint32_t last_kick_us = 0;
+static volatile uint32_t wd_kicks = 0;
+static volatile uint32_t wd_misses = 0;
+
+// Written only by the control task
+static volatile uint32_t wd_late_us = (1000000UL / INNER_LOOP_FREQ_HZ) * 3 / 2;
+static volatile uint32_t wd_late_ticks = 0;
+static volatile uint32_t wd_worst_gap_us = 0;
+static volatile uint32_t wd_last_gap_us = 0;
+
+// Supervisory loop heartbeat (written by loop(), checked by the ISR)
+static volatile bool outer_armed = false;
+static volatile bool outer_tripped = false;
+static volatile uint32_t outer_last_kick_us = 0;
+static volatile uint32_t outer_deadline_us = OUTER_DEADLINE_PERIODS * (1000000UL / CTRL_FREQ_HZ);
+static volatile uint32_t outer_kicks = 0;
+static volatile uint32_t outer_misses = 0;
+static volatile uint32_t outer_worst_gap_us = 0;
+
+// ============================================================================
+// Interrupt Handler
+// ============================================================================
+
+/**
+ * @brief Hardware timer ISR: brake all motors if either heartbeat is overdue
+ */
+static void IRAM_ATTR watchdogISR() {
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+
+    if (wd_armed && !wd_tripped && now_us - last_kick_us >= DEADLINE_US) {
+        motorsEmergencyBrakeFromISR();
+        wd_tripped = true;
+        wd_misses = wd_misses + 1;
+    }
+
+    if (outer_armed && !outer_tripped && now_us - outer_last_kick_us >= outer_deadline_us) {
+        motorsEmergencyBrakeFromISR();
+        outer_tripped = true;
+        outer_misses = outer_misses + 1;
+    }
+}
+
+/**
+ * @brief One-shot task that attaches the timer ISR on Core 0
+ *
+ * The timer interrupt is allocated on the core that attaches it. Doing it
+ * from Core 0 keeps the supervisor off the core running the control loop,
+ * so it still fires if that core spins with interrupts masked.
+ */
+static void watchdogSetupTask(void* parameter) {
+    (void)parameter;
+    watchdog_timer = timerBegin(WATCHDOG_TIMER_NUM, TIMER_DIVIDER, true);
+    timerAttachInterrupt(watchdog_timer, &watchdogISR, true);
+    timerAlarmWrite(watchdog_timer, WATCHDOG_CHECK_US, true);
+    timerAlarmEnable(watchdog_timer);
+
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void initControlWatchdog() {
+    if (watchdog_timer != NULL) {
+        return;
+    }
+
+    xTaskCreatePinnedToCore(
+        watchdogSetupTask,        // Task function
+        "WatchdogSetup",          // Task name
+        2048,                     // Stack size (bytes)
+        NULL,                     // Task parameter
+        configMAX_PRIORITIES - 1, // Run immediately
+        NULL,                     // Task handle
+        0                         // Core 0
+    );
+}
+
+void controlWatchdogKick() {
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+
+    if (wd_armed) {
+        uint32_t gap_us = now_us - last_kick_us;
+        wd_last_gap_us = gap_us;
+        if (gap_us > wd_worst_gap_us) {
+            wd_worst_gap_us = gap_us;
+        }
+        if (gap_us > wd_late_us) {
+            wd_late_ticks = wd_late_ticks + 1;
+        }
+    }
+
+    // Publish the new heartbeat before clearing the trip flag
+    last_kick_us = now_us;
+    wd_kicks = wd_kicks + 1;
+    wd_tripped = false;
+    wd_armed = true;
+}
+
+void setControlWatchdogPeriod(uint32_t period_us) {
+    wd_late_us = period_us + period_us / 2;
+}
+
+void outerWatchdogKick() {
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+
+    if (outer_armed) {
+        uint32_t gap_us = now_us - outer_last_kick_us;
+        if (gap_us > outer_worst_gap_us) {
+            outer_worst_gap_us = gap_us;
+        }
+    }
+
+    // Publish the new heartbeat before clearing the trip flag
+    outer_last_kick_us = now_us;
+    outer_kicks = outer_kicks + 1;
+    outer_tripped = false;
+    outer_armed = true;
+}
+
+void setOuterWatchdogPeriod(uint32_t period_us) {
+    outer_deadline_us = OUTER_DEADLINE_PERIODS * period_us;
+}
+
+void getControlWatchdogStats(ControlWatchdogStats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->armed = wd_armed;
+    stats->tripped = wd_tripped;
+    stats->kicks = wd_kicks;
+    stats->misses = wd_misses;
+    stats->late_ticks = wd_late_ticks;
+    stats->worst_gap_us = wd_worst_gap_us;
+    stats->last_gap_us = wd_last_gap_us;
+    stats->outer_tripped = outer_tripped;
+    stats->outer_kicks = outer_kicks;
+    stats->outer_misses = outer_misses;
+    stats->outer_worst_gap_us = outer_worst_gap_us;
+    stats->outer_deadline_us = outer_deadline_us;
+}
+
+void resetControlWatchdogStats() {
+    wd_misses = 0;
+    wd_late_ticks = 0;
+    wd_worst_gap_us = 0;
+    outer_misses = 0;
+    outer_worst_gap_us = 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file control_watchdog.h
+ * @brief Control loop deadline supervisor on a hardware timer
+ *
+ * The inner pressure loop (the task that drives the motors, see
+ * pressure_loop.h) calls controlWatchdogKick() once per tick. A hardware
+ * timer ISR, independent of every FreeRTOS task, checks the time since the
+ * last kick every WATCHDOG_CHECK_US. If it exceeds CONTROL_DEADLINE_MS
+ * the ISR brakes all H-bridges with direct register writes
+ * (motorsEmergencyBrakeFromISR) and counts a miss.
+ *
+ * The watchdog arms itself on the first kick, so the blocking calibration
+ * sequence in setup() is not supervised. When the loop resumes it drives
+ * the motors again on its next tick.
+ *
+ * The same ISR supervises the supervisory loop (loop(), OUTER_RATE_HZ)
+ * with a second heartbeat: outerWatchdogKick() once per outer tick, with a
+ * deadline of OUTER_DEADLINE_PERIODS outer periods. That is longer than
+ * the pressure loop's stale command hold, so by the time it fires the
+ * motors should already be braked; the ISR brake is the backstop if they
+ * are not. A blocking command handler in loop() counts as a miss.
+ *
+ * Counters are reported with DIAG:WATCHDOG and in a 1 Hz
+ * FRAME_WATCHDOG_DIAG frame.
+ */
+
+#ifndef CONTROL_WATCHDOG_H
+#define CONTROL_WATCHDOG_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Watchdog counters snapshot
+ */
+struct ControlWatchdogStats {
+    bool armed;                  // First kick received
+    bool tripped;                // Brake applied and loop not yet resumed
+    uint32_t kicks;              // Control ticks seen
+    uint32_t misses;             // Deadlines missed (brake applied)
+    uint32_t late_ticks;         // Ticks later than 1.5x the loop period
+    uint32_t worst_gap_us;       // Longest interval between two ticks
+    uint32_t last_gap_us;        // Interval before the latest tick
+    bool outer_tripped;          // Supervisory loop missed its deadline, not yet resumed
+    uint32_t outer_kicks;        // Supervisory ticks seen
+    uint32_t outer_misses;       // Supervisory deadlines missed (brake applied)
+    uint32_t outer_worst_gap_us; // Longest interval between two supervisory ticks
+    uint32_t outer_deadline_us;  // Current supervisory deadline
+};
+
+/**
+ * @brief Start the hardware timer that supervises the control loop
+ *
+ * Must be called once during setup, after initMotorSystem().
+ */
+void initControlWatchdog();
+
+/**
+ * @brief Signal that the control loop completed a tick
+ *
+ * Call once per control tick from the control task. Arms the watchdog on
+ * the first call and updates the late/worst-gap statistics.
+ */
+void controlWatchdogKick();
+
+/**
+ * @brief Set the expected interval between kicks
+ *
+ * Ticks more than 1.5x this period apart are counted as late. Called by
+ * the pressure loop whenever its rate changes.
+ *
+ * @param period_us Loop period in microseconds
+ */
+void setControlWatchdogPeriod(uint32_t period_us);
+
+/**
+ * @brief Signal that the supervisory loop completed a tick
+ *
+ * Call once per outer tick from loop(). Arms the supervisory deadline on
+ * the first call.
+ */
+void outerWatchdogKick();
+
+/**
+ * @brief Set the supervisory loop period
+ *
+ * The supervisory deadline is OUTER_DEADLINE_PERIODS times this period.
+ * Called by loop() whenever OUTER_RATE_HZ changes.
+ *
+ * @param period_us Outer loop period in microseconds
+ */
+void setOuterWatchdogPeriod(uint32_t period_us);
+
+/**
+ * @brief Copy the current counters
+ * @param stats Output snapshot
+ */
+void getControlWatchdogStats(ControlWatchdogStats* stats);
+
+/**
+ * @brief Clear miss, late and worst-gap counters
+ */
+void resetControlWatchdogStats();
+
+#endif // CONTROL_WATCHDOG_H
@@ -0,0 +1,108 @@
+/**
+ * @file decoupler.cpp
+ * @brief Implementation of the coupling identification and decoupler
+ */
+
+#include "decoupler.h"
+#include <math.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr float PIVOT_MIN = 1e-4f;               // Smaller pivots: G treated as singular
+constexpr float GAIN_MILLI_LIMIT = 32.0f;        // int16 range of gain_milli
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void couplingColumn(CouplingMatrix* matrix, int motor, const uint16_t before_mv[NUM_MOTORS],
+                    const uint16_t after_mv[NUM_MOTORS], float duty_step,
+                    const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS]) {
+    if (motor < 0 || motor >= NUM_MOTORS || duty_step <= 0.0f) {
+        return;
+    }
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        // Same scale as the pressure loop: prestress = 0%, 95% of maxstress = 100%
+        float span_mv = (float)maxstress_mv[i] * 0.95f - (float)prestress_mv[i];
+        float gain = 0.0f;
+        if (span_mv > 0.0f) {
+            gain = ((float)after_mv[i] - (float)before_mv[i]) / span_mv * 100.0f / duty_step;
+        }
+        gain = fmaxf(-GAIN_MILLI_LIMIT, fminf(gain, GAIN_MILLI_LIMIT));
+        matrix->gain_milli[i][motor] = (int16_t)lroundf(gain * 1000.0f);
+    }
+}
+
+bool decouplerDesign(const CouplingMatrix& matrix, float k[NUM_MOTORS][NUM_MOTORS]) {
+    // Augmented [G | diag(G)], solved in place by Gauss-Jordan elimination
+    float a[NUM_MOTORS][2 * NUM_MOTORS];
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        float diagonal = matrix.gain_milli[i][i] * 1e-3f;
+        if (diagonal < COUPLING_MIN_DIAGONAL) {
+            return false;
+        }
+        for (int j = 0; j < NUM_MOTORS; ++j) {
+            float gain = matrix.gain_milli[i][j] * 1e-3f;
+            // Off-diagonal noise would only inject noise into the neighbours
+            if (j != i && fabsf(gain) < COUPLING_NOISE_FRACTION * diagonal) {
+                gain = 0.0f;
+            }
+            a[i][j] = gain;
+            a[i][NUM_MOTORS + j] = 0.0f;
+        }
+    }
+    for (int j = 0; j < NUM_MOTORS; ++j) {
+        a[j][NUM_MOTORS + j] = matrix.gain_milli[j][j] * 1e-3f;
+    }
+
+    for (int col = 0; col < NUM_MOTORS; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < NUM_MOTORS; ++row) {
+            if (fabsf(a[row][col]) > fabsf(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (fabsf(a[pivot][col]) < PIVOT_MIN) {
+            return false;
+        }
+        if (pivot != col) {
+            for (int c = 0; c < 2 * NUM_MOTORS; ++c) {
+                float t = a[col][c];
+                a[col][c] = a[pivot][c];
+                a[pivot][c] = t;
+            }
+        }
+        float scale = 1.0f / a[col][col];
+        for (int c = 0; c < 2 * NUM_MOTORS; ++c) {
+            a[col][c] *= scale;
+        }
+        for (int row = 0; row < NUM_MOTORS; ++row) {
+            if (row == col || a[row][col] == 0.0f) {
+                continue;
+            }
+            float factor = a[row][col];
+            for (int c = 0; c < 2 * NUM_MOTORS; ++c) {
+                a[row][c] -= factor * a[col][c];
+            }
+        }
+    }
+
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        for (int j = 0; j < NUM_MOTORS; ++j) {
+            k[i][j] = a[i][NUM_MOTORS + j];
+        }
+    }
+    return true;
+}
+
+void decouplerApply(const float k[NUM_MOTORS][NUM_MOTORS], const float v[NUM_MOTORS], float u[NUM_MOTORS]) {
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        float sum = 0.0f;
+        for (int j = 0; j < NUM_MOTORS; ++j) {
+            sum += k[i][j] * v[j];
+        }
+        u[i] = sum;
+    }
+}
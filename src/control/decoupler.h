@@ -0,0 +1,79 @@
+/**
+ * @file decoupler.h
+ * @brief Static decoupling of the pad cross-coupling
+ *
+ * A motor pressing its pad also loads the neighbouring pads, so the five
+ * loops see each other's duty as a disturbance and fight. The boot
+ * calibration identifies the steady-state gain matrix G (pressure % of pad
+ * i per duty % of motor j) by stepping each motor in turn while all of
+ * them press at COUPLING_BASE_DUTY.
+ *
+ * The pre-compensator K = G^-1 * diag(G) maps the law outputs v to the
+ * applied duty vector u = K v, so that G K = diag(G): each loop sees only
+ * its own motor, with the gain it had without coupling. Enabled with
+ * PARAM DECOUPLE, applied once per pressure loop tick (5x5 multiply).
+ */
+
+#ifndef DECOUPLER_H
+#define DECOUPLER_H
+
+#include <Arduino.h>
+#include "../config/pins.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+// Coupling test (part of the boot calibration)
+constexpr uint8_t COUPLING_BASE_DUTY = 60;         // Duty every motor holds (%)
+constexpr uint8_t COUPLING_STEP_DUTY = 100;        // Duty of the stepped motor (%)
+constexpr uint32_t COUPLING_SETTLE_MS = 1500;      // All motors at base duty before the first step
+constexpr uint32_t COUPLING_STEP_MS = 1200;        // Stepped motor held at COUPLING_STEP_DUTY
+constexpr uint32_t COUPLING_RETURN_MS = 1000;      // Back at base duty before the next motor
+
+// Identification limits
+constexpr float COUPLING_MIN_DIAGONAL = 0.2f;      // Own-pad gain below this: test failed
+constexpr float COUPLING_NOISE_FRACTION = 0.03f;   // Off-diagonal gains below this share of the diagonal are 0
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Identified coupling gains, also the NVS layout
+ *
+ * gain_milli[i][j] = pressure % of pad i per duty % of motor j, x1000.
+ * An all-zero matrix means not identified.
+ */
+struct __attribute__((packed)) CouplingMatrix {
+    int16_t gain_milli[NUM_MOTORS][NUM_MOTORS];
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Fill column `motor` of the matrix from one step of the coupling test
+ * @param before_mv Pad readings before the step
+ * @param after_mv Pad readings at the end of the step
+ * @param duty_step Duty change of the stepped motor (%)
+ * @param prestress_mv Calibrated 0% per pad
+ * @param maxstress_mv Calibrated max stress per pad (100% = 95% of it)
+ */
+void couplingColumn(CouplingMatrix* matrix, int motor, const uint16_t before_mv[NUM_MOTORS],
+                    const uint16_t after_mv[NUM_MOTORS], float duty_step,
+                    const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS]);
+
+/**
+ * @brief Compute the pre-compensator K = G^-1 * diag(G)
+ * @return false if G is not identified or not invertible (k untouched)
+ */
+bool decouplerDesign(const CouplingMatrix& matrix, float k[NUM_MOTORS][NUM_MOTORS]);
+
+/**
+ * @brief u = K v
+ */
+void decouplerApply(const float k[NUM_MOTORS][NUM_MOTORS], const float v[NUM_MOTORS], float u[NUM_MOTORS]);
+
+#endif // DECOUPLER_H
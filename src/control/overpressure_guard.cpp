@@ -0,0 +1,192 @@
+/**
+ * @file overpressure_guard.cpp
+ * @brief Implementation of the over-pressure cutoff sampler
+ */
+
+#include "overpressure_guard.h"
+#include "../actuators/motors.h"
+#include "../config/system_config.h"
+#include "../utils/multiplexer.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <algorithm>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr uint16_t TIMER_DIVIDER = 80;   // 80 MHz APB → 1 µs ticks
+
+// ============================================================================
+// State (shared between the pressure loop, the command handler and the ISR)
+// ============================================================================
+
+static hw_timer_t* sampler_timer = NULL;
+static portMUX_TYPE guard_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Sampler position, ISR only
+static volatile uint8_t sampler_pad = 0;
+static volatile bool sampler_selected = false;
+
+static volatile uint16_t limit_mv[NUM_PRESSURE_PADS] = {0};
+static volatile uint16_t ceiling_mv[NUM_PRESSURE_PADS] = {0};
+static volatile uint16_t release_mv[NUM_PRESSURE_PADS] = {0};
+static volatile uint32_t trips[NUM_PRESSURE_PADS] = {0};
+static volatile uint16_t trip_mv[NUM_PRESSURE_PADS] = {0};
+static volatile uint32_t last_trip_ms[NUM_PRESSURE_PADS] = {0};
+static volatile uint16_t peak_mv[NUM_PRESSURE_PADS] = {0};
+static volatile uint32_t samples[NUM_PRESSURE_PADS] = {0};
+static volatile uint32_t mux_busy = 0;
+
+// ============================================================================
+// Interrupt Handler
+// ============================================================================
+
+/**
+ * @brief Check one conversion: brake and latch on a breach, release below
+ *        the release level once the hold time is over
+ */
+static void checkSample(uint8_t pad_index, uint16_t mv) {
+    portENTER_CRITICAL_ISR(&guard_lock);
+    samples[pad_index] = samples[pad_index] + 1;
+    if (mv > peak_mv[pad_index]) {
+        peak_mv[pad_index] = mv;
+    }
+
+    uint16_t limit = limit_mv[pad_index];
+    if (limit != 0) {
+        if (!motorBrakeLatched(pad_index)) {
+            if (mv >= limit) {
+                // Pins first, bookkeeping after
+                motorLatchBrakeFromISR(pad_index);
+                trips[pad_index] = trips[pad_index] + 1;
+                trip_mv[pad_index] = mv;
+                last_trip_ms[pad_index] = millis();
+            }
+        } else if (mv < release_mv[pad_index] &&
+                   millis() - last_trip_ms[pad_index] >= OVERPRESSURE_HOLD_MS) {
+            motorReleaseBrakeLatch(pad_index);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&guard_lock);
+}
+
+/**
+ * @brief Hardware timer ISR: select a pad, convert it on the next period
+ */
+static void overpressureISR() {
+    if (!sampler_selected) {
+        if (!muxSelectFromISR(PP_CHANNELS[sampler_pad])) {
+            mux_busy = mux_busy + 1;
+            return;
+        }
+        sampler_selected = true;   // Settles until the next period
+        return;
+    }
+
+    uint8_t pad = sampler_pad;
+    uint16_t mv = 0;
+    sampler_selected = false;
+    if (!muxConvertFromISR(&mv)) {
+        mux_busy = mux_busy + 1;   // A task read took the mux, retry this pad
+        return;
+    }
+    sampler_pad = (uint8_t)((pad + 1) % NUM_PRESSURE_PADS);
+    checkSample(pad, mv);
+}
+
+/**
+ * @brief One-shot task that attaches the timer ISR on Core 0
+ *
+ * Same placement as the control watchdog: the interrupt is allocated on
+ * the attaching core, away from the control loop on Core 1.
+ */
+static void samplerSetupTask(void* parameter) {
+    (void)parameter;
+    sampler_timer = timerBegin(OVERPRESSURE_TIMER_NUM, TIMER_DIVIDER, true);
+    timerAttachInterrupt(sampler_timer, &overpressureISR, true);
+    timerAlarmWrite(sampler_timer, OVERPRESSURE_SAMPLE_US, true);
+    timerAlarmEnable(sampler_timer);
+
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void initOverpressureGuard() {
+    if (sampler_timer != NULL) {
+        return;
+    }
+
+    xTaskCreatePinnedToCore(
+        samplerSetupTask,         // Task function
+        "OverpressureSetup",      // Task name
+        2048,                     // Stack size (bytes)
+        NULL,                     // Task parameter
+        configMAX_PRIORITIES - 1, // Run immediately
+        NULL,                     // Task handle
+        0                         // Core 0
+    );
+}
+
+void overpressureSetLimits(const uint16_t maxstress_mv[NUM_PRESSURE_PADS], float limit_pct) {
+    for (int i = 0; i < NUM_PRESSURE_PADS; ++i) {
+        float limit = (float)maxstress_mv[i] * limit_pct / 100.0f;
+        float ceiling = limit - (float)maxstress_mv[i] * OVERPRESSURE_HEADROOM_PCT / 100.0f;
+        float release = limit - (float)maxstress_mv[i] * OVERPRESSURE_RELEASE_PCT / 100.0f;
+        portENTER_CRITICAL(&guard_lock);
+        if (limit_pct <= 0.0f || limit < 1.0f) {
+            limit_mv[i] = 0;
+            ceiling_mv[i] = 0;
+            release_mv[i] = 0;
+            motorReleaseBrakeLatch(i);
+        } else {
+            limit_mv[i] = (uint16_t)std::min(limit, 65535.0f);
+            ceiling_mv[i] = (uint16_t)std::max(ceiling, 1.0f);
+            release_mv[i] = (uint16_t)std::max(release, 0.0f);
+        }
+        portEXIT_CRITICAL(&guard_lock);
+    }
+}
+
+uint16_t overpressureCeilingMv(uint8_t pad_index) {
+    return pad_index < NUM_PRESSURE_PADS ? ceiling_mv[pad_index] : 0;
+}
+
+uint16_t overpressureReleaseMv(uint8_t pad_index) {
+    return pad_index < NUM_PRESSURE_PADS ? release_mv[pad_index] : 0;
+}
+
+void getOverpressureStats(OverpressureStats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&guard_lock);
+    for (int i = 0; i < NUM_PRESSURE_PADS; ++i) {
+        stats->limit_mv[i] = limit_mv[i];
+        stats->ceiling_mv[i] = ceiling_mv[i];
+        stats->release_mv[i] = release_mv[i];
+        stats->latched[i] = motorBrakeLatched(i);
+        stats->trips[i] = trips[i];
+        stats->trip_mv[i] = trip_mv[i];
+        stats->last_trip_ms[i] = last_trip_ms[i];
+        stats->peak_mv[i] = peak_mv[i];
+        stats->samples[i] = samples[i];
+    }
+    stats->mux_busy = mux_busy;
+    portEXIT_CRITICAL(&guard_lock);
+}
+
+void resetOverpressureStats() {
+    portENTER_CRITICAL(&guard_lock);
+    for (int i = 0; i < NUM_PRESSURE_PADS; ++i) {
+        trips[i] = 0;
+        trip_mv[i] = 0;
+        peak_mv[i] = 0;
+        samples[i] = 0;
+    }
+    mux_busy = 0;
+    portEXIT_CRITICAL(&guard_lock);
+}
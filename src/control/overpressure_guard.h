@@ -0,0 +1,145 @@
+/**
+ * @file overpressure_guard.h
+ * @brief Over-pressure cutoff sampled by a hardware timer ISR
+ *
+ * The control loop only sees the pads once per tick, averaged. At 100%
+ * PWM a pad can overshoot a long way before the next tick reduces the
+ * duty, and a stalled control task would not look at all. The guard
+ * therefore samples the pads itself, from a hardware timer ISR on Core 0
+ * that no FreeRTOS task can delay. A conversion at or above the pad's
+ * limit brakes the matching motor inside the ISR with direct GPIO
+ * register writes (motorLatchBrakeFromISR).
+ *
+ * Sampling: every OVERPRESSURE_SAMPLE_US the ISR either selects the next
+ * pad on the mux or, one period later (settled), converts it. So each pad
+ * is checked every 2 x 5 x OVERPRESSURE_SAMPLE_US = 2.5 ms. The mux is
+ * shared with the task reads (see multiplexer.h): a task read never waits
+ * for the sampler, so a slot that finds a read in progress, or loses its
+ * settling channel to one, is skipped and counted as busy.
+ *
+ * - Limit: PARAM OVERPRESSURE_PCT % of the pad's maxstress (reading at
+ *   100% PWM during calibration); 0 disables the guard. The default sits
+ *   OVERPRESSURE_MARGIN_PCT above the loop's full scale
+ *   (PRESSURE_FULL_SCALE_PCT), so a pad pushed towards its calibrated
+ *   maximum trips.
+ * - Ceiling: OVERPRESSURE_HEADROOM_PCT of maxstress below the limit. The
+ *   pressure loop stops inflating a pad above its ceiling, so the
+ *   controller's own overshoot never reaches the limit; only an external
+ *   load or a fault does.
+ * - The motor stays latched (motorForward() brakes instead) until the pad
+ *   is OVERPRESSURE_RELEASE_PCT of maxstress below the limit and at least
+ *   OVERPRESSURE_HOLD_MS have passed since the trip. A setpoint above the
+ *   limit therefore re-trips at most about once per hold time.
+ * - A braked motor holds its force, so while latched the pressure loop
+ *   deflates it like a safety reverse (REVERSE_DUTY, controller tracking
+ *   from rest) down to the release level and brakes it there for the rest
+ *   of the hold time. The controller then takes over with a small step
+ *   instead of a restart from an empty pad, whose overshoot could reach
+ *   the limit again.
+ *
+ * The sampler runs from flash (the ADC HAL is not in IRAM, and the timer
+ * interrupt is allocated without ESP_INTR_FLAG_IRAM). It is deferred while
+ * the cache is off, so the guard stops for the length of every flash write
+ * (NVS commit, OTA block).
+ *
+ * The guard has no limits before the pressure loop starts, so the boot
+ * calibration, which drives every motor to 100%, is never cut.
+ *
+ * Trips are counted per pad, read with DIAG:OVERPRESSURE and logged by the
+ * supervisory loop.
+ */
+
+#ifndef OVERPRESSURE_GUARD_H
+#define OVERPRESSURE_GUARD_H
+
+#include <Arduino.h>
+#include "../config/pins.h"
+#include "pressure_loop.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr float OVERPRESSURE_MARGIN_PCT = 4.0f;      // Default limit above full scale (% of maxstress)
+constexpr float OVERPRESSURE_DEFAULT_PCT = PRESSURE_FULL_SCALE_PCT + OVERPRESSURE_MARGIN_PCT;
+constexpr float OVERPRESSURE_HEADROOM_PCT = 2.0f;    // Loop ceiling this far below the limit (% of maxstress)
+constexpr float OVERPRESSURE_RELEASE_PCT = 25.0f;    // Latch released this far below the limit (% of maxstress)
+constexpr uint32_t OVERPRESSURE_HOLD_MS = 2000;      // ... and no sooner than this after the trip
+constexpr uint32_t OVERPRESSURE_SAMPLE_US = 250;     // Sampler ISR period (select, then convert)
+
+static_assert(OVERPRESSURE_DEFAULT_PCT < 100.0f, "Default limit must trip below the calibrated maximum");
+static_assert(OVERPRESSURE_MARGIN_PCT > OVERPRESSURE_HEADROOM_PCT, "Default ceiling must sit above full scale");
+static_assert(OVERPRESSURE_SAMPLE_US >= MUX_SETTLE_US, "Sampler converts one period after selecting");
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Guard counters snapshot
+ */
+struct OverpressureStats {
+    uint16_t limit_mv[NUM_PRESSURE_PADS];       // Trip level (0 = guard off)
+    uint16_t ceiling_mv[NUM_PRESSURE_PADS];     // Pressure loop stops inflating above this
+    uint16_t release_mv[NUM_PRESSURE_PADS];     // Latch released below this
+    bool latched[NUM_PRESSURE_PADS];            // Motor held braked
+    uint32_t trips[NUM_PRESSURE_PADS];          // Trips since the last reset
+    uint16_t trip_mv[NUM_PRESSURE_PADS];        // Conversion that caused the last trip
+    uint32_t last_trip_ms[NUM_PRESSURE_PADS];   // millis() of the last trip
+    uint16_t peak_mv[NUM_PRESSURE_PADS];        // Highest conversion since the last reset
+    uint32_t samples[NUM_PRESSURE_PADS];        // ISR conversions since the last reset
+    uint32_t mux_busy;                          // Slots skipped, mux held by a task read
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Start the sampler timer ISR
+ *
+ * Must be called once during setup, after initPressurePads() and
+ * initMotorSystem(). Samples (peaks) are collected from then on; nothing
+ * trips until overpressureSetLimits() sets limits.
+ */
+void initOverpressureGuard();
+
+/**
+ * @brief Derive the per-pad limits from the calibration
+ *
+ * Called by the pressure loop at start-up and whenever the parameter
+ * changes. Setting 0 disables the guard and releases every latch.
+ *
+ * @param maxstress_mv Pad readings at 100% PWM (calibration)
+ * @param limit_pct Trip level in % of maxstress (0 = off)
+ */
+void overpressureSetLimits(const uint16_t maxstress_mv[NUM_PRESSURE_PADS], float limit_pct);
+
+/**
+ * @brief Level above which the pressure loop stops inflating a pad
+ * @param pad_index Pad index (0-4)
+ * @return Ceiling in mV (0 = guard off)
+ */
+uint16_t overpressureCeilingMv(uint8_t pad_index);
+
+/**
+ * @brief Latch release level of a pad
+ * @param pad_index Pad index (0-4)
+ * @return Release level in mV (0 = guard off)
+ */
+uint16_t overpressureReleaseMv(uint8_t pad_index);
+
+/**
+ * @brief Copy the current counters
+ * @param stats Output snapshot
+ */
+void getOverpressureStats(OverpressureStats* stats);
+
+/**
+ * @brief Clear trip counters, peaks and sample counts
+ *
+ * Limits, latches and their hold times are kept.
+ */
+void resetOverpressureStats();
+
+#endif // OVERPRESSURE_GUARD_H
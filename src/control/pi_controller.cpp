@@ -1,11 +1,15 @@
 /**
  * @file pi_controller.cpp
- * @brief Implementation of PI controller for 5 independent motors
+ * @brief Implementation of the per-motor pressure controllers
  */
 
 #include "pi_controller.h"
+#include "decoupler.h"
+#include "step_scorecard.h"
 #include "../actuators/motors.h"
 #include "../config/system_config.h"
+#include "../config/param_registry.h"
+#include <freertos/FreeRTOS.h>
 #include <algorithm>
 
 // ============================================================================
@@ -13,8 +17,7 @@
 // ============================================================================
 
 // Timing
-constexpr float CTRL_FREQ_HZ = 20.0f;                    // Control loop frequency
-constexpr float CTRL_DT_S = 1.0f / CTRL_FREQ_HZ;         // Time step (50 ms)
+constexpr float CTRL_DT_S = 1.0f / (float)CTRL_FREQ_HZ;  // Time step for the mV/N variants (50 ms)
 
 // Output limits
 constexpr float DUTY_MIN = -100.0f;                      // Minimum duty cycle (%)
@@ -34,37 +37,180 @@ constexpr float MIN_RUN = 40.0f;                         // Minimum duty to over
 
 // Gains for normalized mode (0-100 range)
 // Error range is 0-100, so gains should be scaled accordingly
-// Example: 50% error * Kp=2.0 = 100% duty cycle
-static float Kp = 1.0f;                                  // Proportional gain (for 0-100%)
-static float Ki = 4.0f;                                  // Integral gain (for 0-100%)
+// Runtime values come from the parameter registry (applied once per tick)
+static float Kp = PI_KP_DEFAULT;                         // Proportional gain (for 0-100%)
+static float Ki = PI_KI_DEFAULT;                         // Integral gain (for 0-100%)
 
 // ============================================================================
 // Controller State (5 Independent Controllers)
 // ============================================================================
 
-static float integrators[NUM_MOTORS] = {0};             // Integral terms for each motor
+static ControllerState states[NUM_MOTORS];              // Integral (and law) state for each motor
 static float last_duty[NUM_MOTORS] = {0};               // Last duty cycle outputs
 
+// Normalized mode only: previous mode and tracked duty per motor. Boot
+// counts as tracking a stopped motor, so the first engagement is bumpless.
+static PiMode last_mode[NUM_MOTORS] = {PI_MODE_TRACK, PI_MODE_TRACK, PI_MODE_TRACK, PI_MODE_TRACK, PI_MODE_TRACK};
+static float tracked_duty[NUM_MOTORS] = {0};
+
+// Normalized mode: law selection, extra gains and identified models
+static ControlGains gains = {PI_KP_DEFAULT, PI_KI_DEFAULT, PID_KD_DEFAULT, PID_D_FILTER_MS_DEFAULT * 1e-3f,
+                             PID_SP_WEIGHT_DEFAULT, LQI_Q_INT_DEFAULT, LQI_R_DEFAULT};
+static uint8_t laws[NUM_MOTORS] = {CTRL_LAW_PI, CTRL_LAW_PI, CTRL_LAW_PI, CTRL_LAW_PI, CTRL_LAW_PI};
+static uint8_t active_law[NUM_MOTORS] = {CTRL_LAW_PI, CTRL_LAW_PI, CTRL_LAW_PI, CTRL_LAW_PI, CTRL_LAW_PI};
+static PlantModel models[NUM_MOTORS];
+static float model_prev_y[NUM_MOTORS] = {0};            // Measurement of the previous RUN tick
+static float last_raw[NUM_MOTORS] = {0};                // Law output before saturation/deadband
+static float last_setpoint[NUM_MOTORS] = {0};
+static float last_measurement[NUM_MOTORS] = {0};
+static uint32_t designed_ms[NUM_MOTORS] = {0};
+static bool designed[NUM_MOTORS] = {false};
+static int design_slot = 0;
+
+// Normalized mode: dead-time compensation
+static StepModel step_models[NUM_MOTORS] = {};
+static SmithPredictor predictors[NUM_MOTORS];
+static bool smith_enabled[NUM_MOTORS] = {false};        // PARAM SMITH_n
+static bool smith_active[NUM_MOTORS] = {false};         // In use on the last RUN tick
+
+// Normalized mode: cross-coupling compensation
+static CouplingMatrix coupling = {};
+static float decoupler_k[NUM_MOTORS][NUM_MOTORS];
+static bool decoupler_valid = false;                    // coupling identified and invertible
+static bool decouple_enabled = false;                   // PARAM DECOUPLE
+static volatile bool decoupler_active = false;          // Applied on the last tick
+
+// Copy for DIAG:CTRL (other tasks)
+static ControllerInfo published_info[NUM_MOTORS];
+static portMUX_TYPE info_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief Redesign the LQI gains of a motor, keeping its output continuous
+ */
+static void redesignLqi(int i, float dt_s) {
+    lqiDesign(states[i], modelEstimate(models[i]), gains, dt_s);
+    designed[i] = true;
+    designed_ms[i] = millis();
+    if (last_mode[i] == PI_MODE_RUN && active_law[i] == CTRL_LAW_LQI) {
+        controlLaw(CTRL_LAW_LQI).preload(states[i], gains, last_setpoint[i], last_measurement[i], last_raw[i]);
+    }
+}
+
+static void publishInfo(int i) {
+    ModelEstimate model = modelEstimate(models[i]);
+    ControllerInfo info;
+    info.law = active_law[i];
+    info.model_tau_s = model.tau_s;
+    info.model_gain = model.gain;
+    info.model_identified = model.identified;
+    info.model_samples = models[i].samples;
+    info.lqi_k_e = states[i].lqi_k_e;
+    info.lqi_k_i = states[i].lqi_k_i;
+    info.lqi_ff = states[i].lqi_ff;
+    info.smith_active = smith_active[i];
+    info.step_model = step_models[i];
+
+    portENTER_CRITICAL(&info_mux);
+    published_info[i] = info;
+    portEXIT_CRITICAL(&info_mux);
+}
+
 // ============================================================================
 // Public Functions
 // ============================================================================
 
+void setStepModels(const StepModel models[NUM_MOTORS]) {
+    memcpy(step_models, models, sizeof(step_models));
+}
+
+void setCouplingMatrix(const CouplingMatrix& matrix) {
+    coupling = matrix;
+    decoupler_valid = decouplerDesign(coupling, decoupler_k);
+}
+
+bool getCouplingMatrix(CouplingMatrix* out) {
+    if (out != NULL) {
+        *out = coupling;
+    }
+    return decoupler_valid;
+}
+
+bool isDecouplerActive() {
+    return decoupler_active;
+}
+
 void initPIController() {
     resetIntegrators();
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        modelInit(models[i]);
+        publishInfo(i);
+    }
 }
 
 void resetIntegrators() {
     for (int i = 0; i < NUM_MOTORS; ++i) {
-        integrators[i] = 0.0f;
+        states[i].integrator = 0.0f;
+        states[i].derivative = 0.0f;
         last_duty[i] = 0.0f;
     }
 }
 
+void resetIntegrator(int motor_index) {
+    if (motor_index < 0 || motor_index >= NUM_MOTORS) {
+        return;
+    }
+    states[motor_index].integrator = 0.0f;
+    states[motor_index].derivative = 0.0f;
+    last_duty[motor_index] = 0.0f;
+}
+
+PiMode getPIMode(int motor_index) {
+    if (motor_index < 0 || motor_index >= NUM_MOTORS) {
+        return PI_MODE_HOLD;
+    }
+    return last_mode[motor_index];
+}
+
 void setPIGains(float kp, float ki) {
     Kp = kp;
     Ki = ki;
 }
 
+void setControlParams(const ParamSnapshot& params) {
+    Kp = params.kp;
+    Ki = params.ki;
+    if (params.lqi_q_int != gains.lqi_q_int || params.lqi_r != gains.lqi_r) {
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            designed[i] = false;   // Redesigned on the next tick each motor runs LQI
+        }
+    }
+    gains.kp = params.kp;
+    gains.ki = params.ki;
+    gains.kd = params.kd;
+    gains.d_filter_s = params.d_filter_ms * 1e-3f;
+    gains.sp_weight = params.sp_weight;
+    gains.lqi_q_int = params.lqi_q_int;
+    gains.lqi_r = params.lqi_r;
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        laws[i] = params.ctrl_law[i];
+        smith_enabled[i] = params.smith[i] != 0;
+    }
+    decouple_enabled = params.decouple != 0;
+}
+
+void getControllerInfo(int motor_index, ControllerInfo* out) {
+    if (motor_index < 0 || motor_index >= NUM_MOTORS || out == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&info_mux);
+    *out = published_info[motor_index];
+    portEXIT_CRITICAL(&info_mux);
+}
+
 void getPIGains(float* kp, float* ki) {
     if (kp) *kp = Kp;
     if (ki) *ki = Ki;
@@ -80,19 +226,19 @@ void controlStep(const float setpoints_mv[NUM_MOTORS], const uint16_t pressure_p
         float error = setpoints_mv[i] - current_pressure_mv;
 
         // Update integrator
-        integrators[i] += error * CTRL_DT_S;
+        states[i].integrator += error * CTRL_DT_S;
 
         // Anti-windup: clamp integrator based on output saturation
         float integrator_max = (DUTY_MAX / std::max(Ki, 0.0001f));
-        if (integrators[i] > integrator_max) {
-            integrators[i] = integrator_max;
+        if (states[i].integrator > integrator_max) {
+            states[i].integrator = integrator_max;
         }
-        if (integrators[i] < -integrator_max) {
-            integrators[i] = -integrator_max;
+        if (states[i].integrator < -integrator_max) {
+            states[i].integrator = -integrator_max;
         }
 
         // Compute PI output
-        float duty = Kp * error + Ki * integrators[i];
+        float duty = Kp * error + Ki * states[i].integrator;
 
         // Apply output saturation
         if (duty > DUTY_MAX) duty = DUTY_MAX;
@@ -126,50 +272,165 @@ void controlStep(const float setpoints_mv[NUM_MOTORS], const uint16_t pressure_p
     }
 }
 
-void controlStepNormalized(const float setpoints_pct[NUM_MOTORS], const float pressure_pct[NUM_MOTORS], float duty_out[NUM_MOTORS]) {
+void controlStepNormalized(const float setpoints_pct[NUM_MOTORS], const float pressure_pct[NUM_MOTORS],
+                           const PiMode modes[NUM_MOTORS], const float track_duty[NUM_MOTORS],
+                           DutyBudget* budget, float duty_out[NUM_MOTORS], float dt_s) {
+    // At most one LQI redesign per tick, round-robin over the motors
+    design_slot = (design_slot + 1) % NUM_MOTORS;
+    if (laws[design_slot] == CTRL_LAW_LQI && designed[design_slot] &&
+        millis() - designed_ms[design_slot] >= CTRL_REDESIGN_MS) {
+        redesignLqi(design_slot, dt_s);
+    }
+
+    // Law outputs of the RUN motors, before decoupling
+    float raw[NUM_MOTORS] = {0};
+    bool running[NUM_MOTORS] = {false};
+    bool smith_on[NUM_MOTORS] = {false};
+    float integrator_before[NUM_MOTORS] = {0};
+
     // Process each motor independently (using normalized 0-100% values)
     for (int i = 0; i < NUM_MOTORS; ++i) {
-        // Get current normalized pressure reading (0-100%)
+        PiMode mode = modes[i];
+        PiMode previous = last_mode[i];
+        last_mode[i] = mode;
+        scorecardRecord(i, mode == PI_MODE_RUN, setpoints_pct[i], pressure_pct[i], dt_s);
+        if (mode != PI_MODE_RUN) {
+            smithReset(predictors[i]);
+        }
+
+        switch (mode) {
+            case PI_MODE_RUN:
+                break;
+
+            case PI_MODE_TRACK:
+                tracked_duty[i] = track_duty[i];
+                continue;
+
+            case PI_MODE_RESET:
+                states[i].integrator = 0.0f;
+                states[i].derivative = 0.0f;
+                last_duty[i] = 0.0f;
+                continue;
+
+            case PI_MODE_HOLD:
+            default:
+                continue;
+        }
+
+        // Get current normalized pressure reading (0-100%) and setpoint
         float current_pressure_pct = pressure_pct[i];
+        float setpoint_pct = setpoints_pct[i];
 
-        // Calculate error (positive error means pressure too low, need to push harder)
-        float error = setpoints_pct[i] - current_pressure_pct;
+        // Identify the plant on forward-drive ticks (any law)
+        if (previous == PI_MODE_RUN && last_duty[i] > 0.0f) {
+            modelUpdate(models[i], model_prev_y[i], last_duty[i], current_pressure_pct, dt_s);
+        }
+        model_prev_y[i] = current_pressure_pct;
 
-        // Update integrator
-        integrators[i] += error * CTRL_DT_S;
+        // The law sees the dead-time compensated pressure if enabled
+        float feedback_pct = current_pressure_pct;
+        bool smith = smith_enabled[i] && stepModelValid(step_models[i]);
+        if (smith) {
+            feedback_pct = smithFeedback(predictors[i], step_models[i], current_pressure_pct, dt_s);
+        } else {
+            smithReset(predictors[i]);
+        }
 
-        // Anti-windup: clamp integrator based on output saturation
-        float integrator_max = (DUTY_MAX / std::max(Ki, 0.0001f));
-        if (integrators[i] > integrator_max) {
-            integrators[i] = integrator_max;
+        // Select the law; a switch hands over the previous output
+        uint8_t law = laws[i];
+        if (law == CTRL_LAW_LQI && !designed[i]) {
+            redesignLqi(i, dt_s);
         }
-        if (integrators[i] < -integrator_max) {
-            integrators[i] = -integrator_max;
+        const ControlLawDesc& desc = controlLaw(law);
+        if (previous != PI_MODE_RUN) {
+            states[i].derivative = 0.0f;
+            states[i].prev_measurement = feedback_pct;
         }
+        if (previous == PI_MODE_TRACK) {
+            // Bumpless re-engagement: start from the duty the motor had
+            desc.preload(states[i], gains, setpoint_pct, feedback_pct, tracked_duty[i]);
+        } else if (law != active_law[i] && previous == PI_MODE_RUN) {
+            desc.preload(states[i], gains, last_setpoint[i], last_measurement[i], last_raw[i]);
+            states[i].prev_measurement = last_measurement[i];
+        } else if (smith != smith_active[i] && previous == PI_MODE_RUN) {
+            // Predictor switched on or off: the feedback changes, the output must not
+            desc.preload(states[i], gains, setpoint_pct, feedback_pct, last_raw[i]);
+            states[i].prev_measurement = feedback_pct;
+        }
+        active_law[i] = law;
+        smith_active[i] = smith;
+
+        // Compute the law output
+        integrator_before[i] = states[i].integrator;
+        float duty = desc.step(states[i], gains, setpoint_pct, feedback_pct, dt_s);
+        last_raw[i] = duty;
+        last_setpoint[i] = setpoint_pct;
+        last_measurement[i] = feedback_pct;
+        raw[i] = duty;
+        running[i] = true;
+        smith_on[i] = smith;
+    }
 
-        // Compute PI output
-        float duty = Kp * error + Ki * integrators[i];
+    // Undo the pad cross-coupling: u = K v over the running motors
+    float applied[NUM_MOTORS];
+    bool decouple = decouple_enabled && decoupler_valid;
+    if (decouple) {
+        decouplerApply(decoupler_k, raw, applied);
+    } else {
+        memcpy(applied, raw, sizeof(applied));
+    }
+    decoupler_active = decouple;
+
+    // Saturation and deadband give the duty each running motor asks for
+    float requested[NUM_MOTORS] = {0};
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        if (!running[i]) {
+            continue;
+        }
+        float duty = applied[i];
 
         // Apply output saturation
         if (duty > DUTY_MAX) duty = DUTY_MAX;
         if (duty < DUTY_MIN) duty = DUTY_MIN;
 
         // Apply deadband to overcome static friction
-        float command = 0.0f;
         if (duty >= MIN_RUN) {
             // Forward direction
-            command = duty;
+            requested[i] = duty;
         } else if (duty <= -MIN_RUN) {
             // Reverse direction
-            command = duty;
+            requested[i] = duty;
         } else {
             // Within deadband - stop motor
-            command = 0.0f;
+            requested[i] = 0.0f;
+        }
+    }
+
+    // Share the actuation budget (most urgent motors first)
+    float granted[NUM_MOTORS];
+    if (budget != NULL) {
+        memcpy(budget->requested, requested, sizeof(requested));
+        allocateDuty(requested, budget->urgency, budget->limit_pct, MIN_RUN, granted);
+    } else {
+        memcpy(granted, requested, sizeof(granted));
+    }
+
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        if (!running[i]) {
+            continue;
+        }
+        float command = granted[i];
+        if (fabsf(command) < fabsf(requested[i])) {
+            // Cut by the budget: undo this tick's integration (no windup while starved)
+            states[i].integrator = integrator_before[i];
         }
 
         // Store duty cycle
         duty_out[i] = command;
         last_duty[i] = command;
+        if (smith_on[i]) {
+            smithAdvance(predictors[i], step_models[i], command, dt_s);
+        }
 
         // Apply to motor
         if (command > 0.0f) {
@@ -180,6 +441,8 @@ void controlStepNormalized(const float setpoints_pct[NUM_MOTORS], const float pr
             motorBrake(i);
         }
     }
+
+    publishInfo(design_slot);
 }
 
 void controlStepNewtons(const float setpoints_n[NUM_MOTORS], const float pressure_pads_n[NUM_MOTORS], float duty_out[NUM_MOTORS]) {
@@ -192,19 +455,19 @@ void controlStepNewtons(const float setpoints_n[NUM_MOTORS], const float pressur
         float error = setpoints_n[i] - current_force_n;
 
         // Update integrator
-        integrators[i] += error * CTRL_DT_S;
+        states[i].integrator += error * CTRL_DT_S;
 
         // Anti-windup: clamp integrator based on output saturation
         float integrator_max = (DUTY_MAX / std::max(Ki, 0.0001f));
-        if (integrators[i] > integrator_max) {
-            integrators[i] = integrator_max;
+        if (states[i].integrator > integrator_max) {
+            states[i].integrator = integrator_max;
         }
-        if (integrators[i] < -integrator_max) {
-            integrators[i] = -integrator_max;
+        if (states[i].integrator < -integrator_max) {
+            states[i].integrator = -integrator_max;
         }
 
         // Compute PI output
-        float duty = Kp * error + Ki * integrators[i];
+        float duty = Kp * error + Ki * states[i].integrator;
 
         // Apply output saturation
         if (duty > DUTY_MAX) duty = DUTY_MAX;
@@ -1,17 +1,88 @@
 /**
  * @file pi_controller.h
- * @brief PI (Proportional-Integral) controller for 5 independent motors
+ * @brief Pressure controllers for 5 independent motors
  *
- * Implements 5 parallel PI controllers with anti-windup, saturation, and deadband.
- * Each motor has its own integrator state for independent control.
+ * Implements 5 parallel controllers with anti-windup, saturation, and deadband.
+ * Each motor has its own integrator state for independent control. The
+ * normalized loop runs the control law selected per motor (PI, filtered
+ * PID or LQI, see control_law.h), optionally behind a Smith predictor
+ * (smith_predictor.h), with the duty vector optionally decoupled
+ * (decoupler.h) and shared out under the actuation budget
+ * (power_budget.h); the mV and Newton variants are PI only.
  */
 
 #ifndef PI_CONTROLLER_H
 #define PI_CONTROLLER_H
 
 #include <Arduino.h>
+#include "control_law.h"
+#include "smith_predictor.h"
+#include "decoupler.h"
+#include "power_budget.h"
 #include "../config/pins.h"
 
+struct ParamSnapshot;
+
+// Default gains for normalized mode (0-100 range), overridable via PARAM:SET:KP/KI
+// Example: 50% error * Kp=2.0 = 100% duty cycle
+constexpr float PI_KP_DEFAULT = 1.0f;
+constexpr float PI_KI_DEFAULT = 4.0f;
+
+/**
+ * @brief Per-motor controller mode for controlStepNormalized()
+ *
+ * Only RUN computes and drives the motor; in every other mode the caller
+ * owns the motor and duty_out is left untouched for that motor.
+ */
+enum PiMode : uint8_t {
+    PI_MODE_RUN = 0,   // Closed loop: compute PI and drive the motor
+    PI_MODE_HOLD,      // Skip: integrator frozen, resumes where it stopped
+    PI_MODE_TRACK,     // Skip: follow the externally applied duty, bumpless re-engage
+    PI_MODE_RESET      // Skip: integrator cleared, re-engage from zero
+};
+
+/**
+ * @brief Controller view of one motor for DIAG:CTRL
+ */
+struct ControllerInfo {
+    uint8_t law;                 // ControlLaw running the motor
+    float model_tau_s;           // Identified (or default) plant time constant
+    float model_gain;            // Identified (or default) plant gain
+    bool model_identified;
+    uint32_t model_samples;      // Forward-drive ticks fitted
+    float lqi_k_e;               // Current LQI gains (0 until first designed)
+    float lqi_k_i;
+    float lqi_ff;
+    bool smith_active;           // Law fed through the Smith predictor
+    StepModel step_model;        // Step test model (tau_ms = 0 if none)
+};
+
+/**
+ * @brief Set the step test models of the Smith predictors
+ *
+ * Call from setup() after the pad calibration, before the pressure loop
+ * starts. Motors without a valid model never use the predictor.
+ */
+void setStepModels(const StepModel models[NUM_MOTORS]);
+
+/**
+ * @brief Set the identified pad coupling and design the decoupler
+ *
+ * Same calling rules as setStepModels().
+ */
+void setCouplingMatrix(const CouplingMatrix& matrix);
+
+/**
+ * @brief Copy the pad coupling matrix
+ * @return true if the decoupler could be designed from it
+ */
+bool getCouplingMatrix(CouplingMatrix* out);
+
+/**
+ * @brief Check whether the duty vector was decoupled on the last tick
+ */
+bool isDecouplerActive();
+
 /**
  * @brief Initialize the PI controller system
  *
@@ -40,13 +111,28 @@ void controlStep(const float setpoints_mv[NUM_MOTORS], const uint16_t pressure_p
  * Uses normalized pressure values (0-100%) mapped from min/max calibration.
  * Setpoints are also in percentage (0-100%).
  *
- * This function should be called at a fixed frequency (default: 50 Hz).
+ * Called by the pressure loop at PARAM INNER_RATE_HZ with the measured
+ * time since its previous tick.
+ *
+ * Motors not in PI_MODE_RUN cost no computation and are not actuated.
+ * On the first RUN tick after TRACK the integrator is pre-loaded so the
+ * output equals the tracked duty at the current error (no kick).
+ *
+ * With a budget, the saturated and deadbanded duties of the RUN motors
+ * are passed through allocateDuty() before they are applied; the
+ * controllers (integrators, Smith models) see the granted duty.
  *
  * @param setpoints_pct Array of 5 target pressure setpoints in percent (0-100)
  * @param pressure_pct Array of 5 current normalized pressure readings (0-100)
- * @param duty_out Output array of 5 duty cycles (will be updated, range: -100 to 100)
+ * @param modes Controller mode per motor
+ * @param track_duty Duty applied by the caller per motor (read in PI_MODE_TRACK)
+ * @param budget Actuation budget of the RUN motors (NULL = unlimited), requests written back
+ * @param duty_out Output array of 5 duty cycles (updated for RUN motors only, range: -100 to 100)
+ * @param dt_s Integrator time step (seconds)
  */
-void controlStepNormalized(const float setpoints_pct[NUM_MOTORS], const float pressure_pct[NUM_MOTORS], float duty_out[NUM_MOTORS]);
+void controlStepNormalized(const float setpoints_pct[NUM_MOTORS], const float pressure_pct[NUM_MOTORS],
+                           const PiMode modes[NUM_MOTORS], const float track_duty[NUM_MOTORS],
+                           DutyBudget* budget, float duty_out[NUM_MOTORS], float dt_s);
 
 /**
  * @brief Execute one PI control step for all 5 motors (using Newtons)
@@ -70,6 +156,19 @@ void controlStepNewtons(const float setpoints_n[NUM_MOTORS], const float pressur
  */
 void resetIntegrators();
 
+/**
+ * @brief Reset the integrator of a single motor
+ *
+ * @param motor_index Motor index (0 to NUM_MOTORS-1)
+ */
+void resetIntegrator(int motor_index);
+
+/**
+ * @brief Mode a motor had on the last controlStepNormalized() call
+ * @param motor_index Motor index (0 to NUM_MOTORS-1)
+ */
+PiMode getPIMode(int motor_index);
+
 /**
  * @brief Set PI gains for all motors
  *
@@ -81,6 +180,22 @@ void resetIntegrators();
  */
 void setPIGains(float kp, float ki);
 
+/**
+ * @brief Apply gains and per-motor law selection from a parameter snapshot
+ *
+ * Called by the pressure loop once per tick (same task as
+ * controlStepNormalized()). A law change hands the previous output over
+ * to the new law, so switching at runtime is bumpless.
+ */
+void setControlParams(const ParamSnapshot& params);
+
+/**
+ * @brief Copy the law, model and LQI gains of a motor (safe from any task)
+ * @param motor_index Motor index (0 to NUM_MOTORS-1)
+ * @param out Output snapshot
+ */
+void getControllerInfo(int motor_index, ControllerInfo* out);
+
 /**
  * @brief Get current PI gains
  *
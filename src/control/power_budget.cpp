@@ -0,0 +1,128 @@
+/**
+ * @file power_budget.cpp
+ * @brief Implementation of the actuation budget allocator
+ */
+
+#include "power_budget.h"
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr float LIMITED_EPSILON_PCT = 0.01f;     // Grants this close to the request count as full
+
+// ============================================================================
+// State
+// ============================================================================
+
+/**
+ * @brief Running sums (|duty| summed per tick)
+ */
+struct BudgetTotals {
+    uint32_t ticks;
+    uint32_t limited_ticks;
+    float peak_requested_pct;
+    float peak_granted_pct;
+    float last_requested[NUM_MOTORS];
+    float last_granted[NUM_MOTORS];
+    double requested_sum[NUM_MOTORS];
+    double granted_sum[NUM_MOTORS];
+    uint32_t limited[NUM_MOTORS];
+};
+
+static BudgetTotals totals;
+static portMUX_TYPE budget_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+float budgetUrgency(uint8_t priority, float error_pct) {
+    return priority * POWER_PRIORITY_WEIGHT + fabsf(error_pct);
+}
+
+void allocateDuty(const float requested[NUM_MOTORS], const float urgency[NUM_MOTORS], float budget_pct,
+                  float min_run_pct, float granted[NUM_MOTORS]) {
+    // Serving order: insertion sort by urgency, ties keep the motor order
+    int order[NUM_MOTORS];
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        int k = i;
+        while (k > 0 && urgency[order[k - 1]] < urgency[i]) {
+            order[k] = order[k - 1];
+            --k;
+        }
+        order[k] = i;
+    }
+
+    float remaining = fmaxf(0.0f, budget_pct);
+    for (int n = 0; n < NUM_MOTORS; ++n) {
+        int i = order[n];
+        float want = fabsf(requested[i]);
+        float share = fminf(want, remaining);
+        if (share < min_run_pct) {
+            share = 0.0f;                           // Brake: holds the force, costs nothing
+        }
+        remaining -= share;
+        granted[i] = (requested[i] < 0.0f) ? -share : share;
+    }
+}
+
+void powerBudgetRecord(const float requested[NUM_MOTORS], const float granted[NUM_MOTORS]) {
+    float requested_total = 0.0f;
+    float granted_total = 0.0f;
+    bool limited[NUM_MOTORS];
+    bool any_limited = false;
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        requested_total += fabsf(requested[i]);
+        granted_total += fabsf(granted[i]);
+        limited[i] = fabsf(granted[i]) < fabsf(requested[i]) - LIMITED_EPSILON_PCT;
+        any_limited = any_limited || limited[i];
+    }
+
+    portENTER_CRITICAL(&budget_mux);
+    totals.ticks++;
+    if (any_limited) {
+        totals.limited_ticks++;
+    }
+    totals.peak_requested_pct = fmaxf(totals.peak_requested_pct, requested_total);
+    totals.peak_granted_pct = fmaxf(totals.peak_granted_pct, granted_total);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        totals.last_requested[i] = requested[i];
+        totals.last_granted[i] = granted[i];
+        totals.requested_sum[i] += fabsf(requested[i]);
+        totals.granted_sum[i] += fabsf(granted[i]);
+        if (limited[i]) {
+            totals.limited[i]++;
+        }
+    }
+    portEXIT_CRITICAL(&budget_mux);
+}
+
+void getPowerBudgetStats(PowerBudgetStats* out) {
+    if (out == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&budget_mux);
+    BudgetTotals t = totals;
+    portEXIT_CRITICAL(&budget_mux);
+
+    out->ticks = t.ticks;
+    out->limited_ticks = t.limited_ticks;
+    out->peak_requested_pct = t.peak_requested_pct;
+    out->peak_granted_pct = t.peak_granted_pct;
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        out->last_requested[i] = t.last_requested[i];
+        out->last_granted[i] = t.last_granted[i];
+        out->requested_avg_pct[i] = (t.ticks > 0) ? (float)(t.requested_sum[i] / t.ticks) : 0.0f;
+        out->granted_avg_pct[i] = (t.ticks > 0) ? (float)(t.granted_sum[i] / t.ticks) : 0.0f;
+        out->limited[i] = t.limited[i];
+    }
+}
+
+void resetPowerBudgetStats() {
+    portENTER_CRITICAL(&budget_mux);
+    memset(&totals, 0, sizeof(totals));
+    portEXIT_CRITICAL(&budget_mux);
+}
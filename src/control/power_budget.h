@@ -0,0 +1,112 @@
+/**
+ * @file power_budget.h
+ * @brief Global actuation budget shared by the five motors
+ *
+ * Each controller asks for its duty without knowing the others. When a
+ * range flip to CLOSE steps every setpoint at once, all five motors ask
+ * for full duty in the same tick and the supply sags. The pressure loop
+ * therefore passes the duty vector through an allocator once per tick,
+ * after the controllers and before the motors are driven:
+ *
+ * - The budget (PARAM POWER_BUDGET_PCT) is the sum of |duty| over the
+ *   motors; 500 = five motors at 100% = no limit.
+ * - Safety reverses (SAFETY_OUTPUT_REVERSE) are served first and in full,
+ *   the closed loop motors share what is left.
+ * - Closed loop motors are served in order of urgency: closest sector
+ *   first (CLOSE, MEDIUM, FAR), larger |error| first within a range. Each
+ *   gets its full request while the budget lasts; a motor whose share
+ *   would fall below the deadband is braked (it holds its force) and
+ *   leaves the remainder to the next one.
+ *
+ * Requested and granted duties are counted per motor, read with
+ * DIAG:BUDGET. The boot calibration drives the motors outside the loop:
+ * it starts them POWER_CAL_STAGGER_MS apart instead, so their inrush
+ * currents do not add up.
+ */
+
+#ifndef POWER_BUDGET_H
+#define POWER_BUDGET_H
+
+#include <Arduino.h>
+#include "../config/pins.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr float POWER_BUDGET_UNLIMITED_PCT = 100.0f * NUM_MOTORS;  // PARAM POWER_BUDGET_PCT default
+constexpr float POWER_PRIORITY_WEIGHT = 100.0f;  // One range step outweighs any error (0-100%)
+constexpr uint32_t POWER_CAL_STAGGER_MS = 150;   // Calibration: delay between motor starts
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Budget handed to controlStepNormalized() for the closed loop motors
+ */
+struct DutyBudget {
+    float limit_pct;                 // Sum of |duty| the closed loop motors may use
+    float urgency[NUM_MOTORS];       // Serving order, highest first (budgetUrgency())
+    float requested[NUM_MOTORS];     // Out: duty each closed loop motor asked for (0 otherwise)
+};
+
+/**
+ * @brief Requested versus granted duty since the last reset
+ */
+struct PowerBudgetStats {
+    uint32_t ticks;                          // Ticks recorded
+    uint32_t limited_ticks;                  // Ticks where some motor got less than requested
+    float peak_requested_pct;                // Highest sum of |duty| requested in one tick
+    float peak_granted_pct;                  // Highest sum of |duty| applied in one tick
+    float last_requested[NUM_MOTORS];        // Last tick, signed duty (%)
+    float last_granted[NUM_MOTORS];
+    float requested_avg_pct[NUM_MOTORS];     // Mean |duty| requested
+    float granted_avg_pct[NUM_MOTORS];       // Mean |duty| applied
+    uint32_t limited[NUM_MOTORS];            // Ticks the motor got less than requested
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Serving order of a motor
+ * @param priority Range priority: 3 = CLOSE, 2 = MEDIUM, 1 = FAR, 0 = none
+ * @param error_pct Setpoint - pressure (%)
+ */
+float budgetUrgency(uint8_t priority, float error_pct);
+
+/**
+ * @brief Share a budget between duty requests
+ *
+ * Requests are served whole in order of urgency while the budget lasts;
+ * a share below min_run_pct is granted as 0 and not consumed.
+ *
+ * @param requested Signed duty per motor (%), 0 = nothing asked
+ * @param urgency Serving order, highest first
+ * @param budget_pct Sum of |duty| available
+ * @param min_run_pct Smallest duty that moves a motor (deadband)
+ * @param granted Output signed duty per motor (may alias requested)
+ */
+void allocateDuty(const float requested[NUM_MOTORS], const float urgency[NUM_MOTORS], float budget_pct,
+                  float min_run_pct, float granted[NUM_MOTORS]);
+
+/**
+ * @brief Count one tick of the allocator (pressure loop only)
+ * @param requested Signed duty every motor asked for (%)
+ * @param granted Signed duty every motor was driven with (%)
+ */
+void powerBudgetRecord(const float requested[NUM_MOTORS], const float granted[NUM_MOTORS]);
+
+/**
+ * @brief Copy the counters (safe from any task)
+ */
+void getPowerBudgetStats(PowerBudgetStats* out);
+
+/**
+ * @brief Zero the counters
+ */
+void resetPowerBudgetStats();
+
+#endif // POWER_BUDGET_H
@@ -0,0 +1,360 @@
+/**
+ * @file pressure_loop.cpp
+ * @brief Implementation of the inner pressure regulation loop
+ */
+
+#include "pressure_loop.h"
+#include "pi_controller.h"
+#include "power_budget.h"
+#include "control_watchdog.h"
+#include "overpressure_guard.h"
+#include "safety_state_machine.h"
+#include "../actuators/motors.h"
+#include "../config/param_registry.h"
+#include "../sensors/pressure_pads.h"
+#include "../tasks/core0_tasks.h"
+#include "../utils/loop_timing.h"
+#include "../utils/multiplexer.h"
+#include "../utils/telemetry_stats.h"
+#include "../utils/ota_update.h"
+#include "../utils/power_manager.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <algorithm>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr uint32_t MUX_WAIT_MS = 1;              // Give up on the pads for this tick after this
+constexpr uint32_t MAX_DT_PERIODS = 4;           // Clamp integrator step after a stall
+
+// ============================================================================
+// State
+// ============================================================================
+
+// Calibration (copied once at init)
+static uint16_t prestress[NUM_MOTORS] = {0};
+static uint16_t maxstress[NUM_MOTORS] = {0};
+
+// Setpoint mailbox (written by the outer loop, sequence odd while writing)
+static PressureCommand mailbox;
+static volatile uint32_t mailbox_sequence = 0;
+static volatile uint32_t mailbox_ms = 0;
+
+// Latest readings (written by the inner loop)
+static volatile uint16_t latest_mv[NUM_MOTORS] = {0};
+static volatile float latest_pct[NUM_MOTORS] = {0.0f};
+
+// Counters
+static volatile uint32_t stat_ticks = 0;
+static volatile uint32_t stat_torn_reads = 0;
+static volatile uint32_t stat_stale_holds = 0;
+static volatile uint32_t stat_mux_busy = 0;
+static volatile uint32_t stat_ceiling_holds = 0;
+
+static TaskHandle_t pressure_task = NULL;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief Map a pad mV reading to 0-100% for a motor
+ *
+ * Uses prestress as 0% and PRESSURE_FULL_SCALE_PCT of maxstress as 100%,
+ * clamped to 0% .. maxstress (above 100%). The controllers must see an
+ * overshoot past full scale to take the duty back; the outer loop and
+ * telemetry get the value clamped to 100%.
+ */
+static float mapPressureToPercent(int motor_index, uint16_t mv_reading) {
+    float min_val = (float)prestress[motor_index];
+    float max_val = (float)maxstress[motor_index] * PRESSURE_FULL_SCALE_PCT / 100.0f;  // Margin below max
+
+    // Avoid division by zero
+    if (max_val <= min_val) {
+        return 0.0f;
+    }
+
+    float normalized = ((float)mv_reading - min_val) / (max_val - min_val) * 100.0f;
+    if (normalized < 0.0f) normalized = 0.0f;
+    if (normalized > PRESSURE_CALIBRATED_MAX_PCT) normalized = PRESSURE_CALIBRATED_MAX_PCT;
+    return normalized;
+}
+
+/**
+ * @brief Single attempt to copy the mailbox
+ * @return false if a publish was in progress (copy discarded)
+ */
+static bool readCommand(PressureCommand* out) {
+    uint32_t before = mailbox_sequence;
+    __sync_synchronize();
+    memcpy(out, (const void*)&mailbox, sizeof(PressureCommand));
+    __sync_synchronize();
+    uint32_t after = mailbox_sequence;
+    return before == after && !(before & 1);
+}
+
+static void holdAllMotors(float duties[NUM_MOTORS]) {
+    stopAllMotors();
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        duties[i] = 0.0f;
+    }
+}
+
+/**
+ * @brief Controller mode for a motor under a command
+ *
+ * Motors driven by the safety state machine are tracked at 0% rather than
+ * at their reverse duty: PI re-engages from rest, never resuming a
+ * deflation. An invalid setpoint under PI freezes the integrator instead
+ * of winding it against -1%.
+ */
+static PiMode modeForOutput(uint8_t output, float setpoint_pct) {
+    if (output != SAFETY_OUTPUT_PI) {
+        return PI_MODE_TRACK;
+    }
+    return (setpoint_pct >= 0.0f) ? PI_MODE_RUN : PI_MODE_HOLD;
+}
+
+// ============================================================================
+// Task
+// ============================================================================
+
+static void pressureLoopTask(void* parameter) {
+    (void)parameter;
+    PressureCommand command;
+    memset(&command, 0, sizeof(command));
+    uint16_t pads_mv[NUM_MOTORS] = {0};
+    float pressure_pct[NUM_MOTORS] = {0.0f};
+    float duties[NUM_MOTORS] = {0.0f};
+    PiMode modes[NUM_MOTORS];
+    const float track_duty[NUM_MOTORS] = {0.0f};   // Overridden motors re-engage from rest
+    uint8_t engage_seen[NUM_MOTORS] = {0};          // Last engage_seq acted upon
+
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t last_start_us = micros();
+    uint32_t period_ms = 0;
+    float overpressure_pct = -1.0f;
+
+    for (;;) {
+        // Full CPU speed from wake-up to the end of the tick
+        pmLockAcquire(PM_LOCK_CONTROL);
+        uint32_t start_us = micros();
+
+        // Rate and gains may change at runtime (PARAM:SET)
+        ParamSnapshot params;
+        paramSnapshot(&params);
+        uint32_t new_period_ms = std::max<uint32_t>(1, 1000 / params.inner_rate_hz);
+        if (new_period_ms != period_ms) {
+            period_ms = new_period_ms;
+            setControlWatchdogPeriod(period_ms * 1000UL);
+        }
+        if (params.overpressure_pct != overpressure_pct) {
+            overpressure_pct = params.overpressure_pct;
+            overpressureSetLimits(maxstress, overpressure_pct);
+        }
+
+        float dt_s = (float)(start_us - last_start_us) * 1e-6f;
+        dt_s = std::min(dt_s, (float)(MAX_DT_PERIODS * period_ms) * 1e-3f);
+        last_start_us = start_us;
+
+        // ====================================================================
+        // Pads
+        // ====================================================================
+
+        if (lockMux(MUX_WAIT_MS)) {
+            readAllPadsMilliVolts(pads_mv, PP_SAMPLES_INNER);
+            unlockMux();
+        } else {
+            stat_mux_busy = stat_mux_busy + 1;  // Keep last readings
+        }
+
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            pressure_pct[i] = mapPressureToPercent(i, pads_mv[i]);
+            latest_mv[i] = pads_mv[i];
+            latest_pct[i] = std::min(pressure_pct[i], 100.0f);
+            shared_pressure_pct[i] = latest_pct[i];
+        }
+
+        // ====================================================================
+        // Command from the outer loop
+        // ====================================================================
+
+        PressureCommand fresh;
+        if (readCommand(&fresh)) {
+            command = fresh;
+        } else {
+            stat_torn_reads = stat_torn_reads + 1;
+        }
+
+        uint32_t outer_period_ms = 1000 / params.outer_rate_hz;
+        bool never_published = (mailbox_sequence == 0);
+        bool stale = never_published ||
+                     (millis() - mailbox_ms > PRESSURE_COMMAND_STALE_PERIODS * outer_period_ms);
+
+        // ====================================================================
+        // Actuation
+        // ====================================================================
+
+        if (otaInProgress()) {
+            // Flash writes stall both cores: hold until OTA:END/ABORT, then
+            // start over (the plant moved on during the stall)
+            holdAllMotors(duties);
+            for (int i = 0; i < NUM_MOTORS; ++i) {
+                modes[i] = PI_MODE_RESET;
+            }
+            controlStepNormalized(command.setpoint_pct, pressure_pct, modes, track_duty, NULL, duties, dt_s);
+        } else if (stale) {
+            // Short outer loop gap: freeze, resume where the controller stopped
+            holdAllMotors(duties);
+            for (int i = 0; i < NUM_MOTORS; ++i) {
+                modes[i] = never_published ? PI_MODE_TRACK : PI_MODE_HOLD;
+            }
+            controlStepNormalized(command.setpoint_pct, pressure_pct, modes, track_duty, NULL, duties, dt_s);
+            if (!never_published) {
+                stat_stale_holds = stat_stale_holds + 1;
+            }
+        } else {
+            // Only motors in PI_MODE_RUN are computed and driven by PI
+            setControlParams(params);
+            // A motor braked by the over-pressure guard deflates like a
+            // safety reverse down to the release level, then holds there
+            // until the guard releases it (a requested reverse goes on).
+            // Above the guard's ceiling PI is braked and re-engages from
+            // rest, so the loop's own overshoot stays below the trip level.
+            uint8_t outputs[NUM_MOTORS];
+            for (int i = 0; i < NUM_MOTORS; ++i) {
+                outputs[i] = command.output[i];
+                uint16_t ceiling_mv = overpressureCeilingMv(i);
+                if (motorBrakeLatched(i) && outputs[i] != SAFETY_OUTPUT_REVERSE) {
+                    outputs[i] = (pads_mv[i] >= overpressureReleaseMv(i)) ? (uint8_t)SAFETY_OUTPUT_REVERSE
+                                                                         : (uint8_t)SAFETY_OUTPUT_BRAKE;
+                } else if (outputs[i] == SAFETY_OUTPUT_PI && ceiling_mv != 0 && pads_mv[i] >= ceiling_mv) {
+                    outputs[i] = SAFETY_OUTPUT_BRAKE;
+                    stat_ceiling_holds = stat_ceiling_holds + 1;
+                }
+                modes[i] = modeForOutput(outputs[i], command.setpoint_pct[i]);
+
+                // Re-engage requested by the NORMAL entry action: one
+                // tick at rest, PI_MODE_RUN preloads from it on the next
+                if (command.engage_seq[i] != engage_seen[i]) {
+                    engage_seen[i] = command.engage_seq[i];
+                    if (modes[i] == PI_MODE_RUN) {
+                        modes[i] = PI_MODE_TRACK;
+                    }
+                }
+            }
+
+            // Safety reverses are served first, PI shares the rest
+            DutyBudget budget;
+            budget.limit_pct = params.power_budget_pct;
+            for (int i = 0; i < NUM_MOTORS; ++i) {
+                if (modes[i] != PI_MODE_RUN && outputs[i] == SAFETY_OUTPUT_REVERSE) {
+                    budget.limit_pct -= command.reverse_duty_pct;
+                }
+                budget.urgency[i] = budgetUrgency(command.priority[i], command.setpoint_pct[i] - pressure_pct[i]);
+            }
+            controlStepNormalized(command.setpoint_pct, pressure_pct, modes, track_duty, &budget, duties, dt_s);
+
+            // Drive the motors PI skipped
+            float requested[NUM_MOTORS];
+            for (int i = 0; i < NUM_MOTORS; ++i) {
+                if (modes[i] == PI_MODE_RUN) {
+                    requested[i] = budget.requested[i];
+                    continue;
+                }
+                switch (outputs[i]) {
+
+                    case SAFETY_OUTPUT_REVERSE:
+                        duties[i] = -command.reverse_duty_pct;
+                        motorReverse(i, command.reverse_duty_pct);
+                        break;
+
+                    case SAFETY_OUTPUT_PI:     // Invalid setpoint (PI_MODE_HOLD)
+                    case SAFETY_OUTPUT_BRAKE:
+                    default:
+                        duties[i] = 0.0f;
+                        motorBrake(i);
+                        break;
+                }
+                requested[i] = duties[i];
+            }
+            powerBudgetRecord(requested, duties);
+        }
+
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            shared_duty_cycles[i] = duties[i];
+        }
+
+        // Summary statistics at the loop rate (error only for motors under PI)
+        float errors[NUM_MOTORS];
+        bool error_valid[NUM_MOTORS];
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            error_valid[i] = !stale && !otaInProgress() &&
+                             command.output[i] == SAFETY_OUTPUT_PI && command.setpoint_pct[i] >= 0.0f;
+            errors[i] = command.setpoint_pct[i] - pressure_pct[i];
+        }
+        statsRecord(STATS_PAD_PCT, pressure_pct, NULL);
+        statsRecord(STATS_DUTY, duties, NULL);
+        statsRecord(STATS_ERROR, errors, error_valid);
+
+        // Heartbeat for the deadline watchdog (brakes motors if ticks stop)
+        controlWatchdogKick();
+        stat_ticks = stat_ticks + 1;
+        loopTimingRecord(LOOP_INNER, start_us, micros(), params.inner_rate_hz);
+        pmLockRelease(PM_LOCK_CONTROL);
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(period_ms));
+    }
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void initPressureLoop(const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS]) {
+    if (pressure_task != NULL) {
+        return;
+    }
+    memcpy(prestress, prestress_mv, sizeof(prestress));
+    memcpy(maxstress, maxstress_mv, sizeof(maxstress));
+
+    xTaskCreatePinnedToCore(
+        pressureLoopTask,         // Task function
+        "PressureLoop",           // Task name
+        4096,                     // Stack size (bytes)
+        NULL,                     // Task parameter
+        PRESSURE_LOOP_PRIORITY,   // Priority
+        &pressure_task,           // Task handle
+        1                         // Core 1 (with loop())
+    );
+}
+
+void publishPressureCommand(const PressureCommand& command) {
+    // Single writer: only the outer loop publishes
+    mailbox_sequence = mailbox_sequence + 1;
+    __sync_synchronize();
+    memcpy((void*)&mailbox, &command, sizeof(PressureCommand));
+    mailbox_ms = millis();
+    __sync_synchronize();
+    mailbox_sequence = mailbox_sequence + 1;
+}
+
+void getPressureReadings(float pressure_pct[NUM_MOTORS], uint16_t pressure_mv[NUM_MOTORS]) {
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        if (pressure_pct) pressure_pct[i] = latest_pct[i];
+        if (pressure_mv) pressure_mv[i] = latest_mv[i];
+    }
+}
+
+void getPressureLoopStats(PressureLoopStats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->ticks = stat_ticks;
+    stats->torn_reads = stat_torn_reads;
+    stats->stale_holds = stat_stale_holds;
+    stats->mux_busy = stat_mux_busy;
+    stats->ceiling_holds = stat_ceiling_holds;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file pressure_loop.h
+ * @brief Inner pressure regulation loop (fast task on Core 1)
+ *
+ * The control work is split in two rates:
+ * - Inner loop (this task, PARAM INNER_RATE_HZ, default 200 Hz): reads the
+ *   pads, normalizes them, runs PI and drives the motors. Nothing else.
+ * - Outer loop (loop(), PARAM OUTER_RATE_HZ, default 20 Hz): potentiometers,
+ *   distance ranges, setpoints and the safety state machine.
+ *
+ * The outer loop hands its result to the inner loop through a setpoint
+ * mailbox: one PressureCommand protected by a sequence counter (single
+ * writer). The inner loop never waits for the writer. Both loops run on
+ * Core 1 and the inner loop has the higher priority, so a copy torn by a
+ * publish in progress is discarded and the previous command reused for
+ * that tick.
+ *
+ * Each motor's SafetyOutput selects its PI mode (pi_controller.h): PI
+ * runs only for motors under SAFETY_OUTPUT_PI with a valid setpoint.
+ * Motors reversed or braked by the state machine are tracked at 0%. When
+ * a motor's engage_seq changes (the state machine entered NORMAL) it is
+ * tracked at 0% for that tick too, so PI re-engages from rest without a
+ * proportional kick.
+ * A PI motor whose pad reads above the over-pressure ceiling
+ * (overpressure_guard.h) is braked and tracked the same way.
+ *
+ * The duty vector is shared out under PARAM POWER_BUDGET_PCT every tick
+ * (power_budget.h): safety reverses first, then the PI motors in order of
+ * range priority and error.
+ *
+ * If no command arrives for 3 outer periods the inner loop brakes every
+ * motor (counted as stale holds) and freezes the integrators until the
+ * outer loop publishes again.
+ * The inner loop kicks the control watchdog every tick.
+ */
+
+#ifndef PRESSURE_LOOP_H
+#define PRESSURE_LOOP_H
+
+#include <Arduino.h>
+#include "../config/pins.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr uint8_t PRESSURE_LOOP_PRIORITY = 3;   // Above loop() (priority 1) on Core 1
+constexpr uint32_t PRESSURE_COMMAND_STALE_PERIODS = 3;  // Outer periods before the hold
+constexpr float PRESSURE_FULL_SCALE_PCT = 95.0f;        // 100% pressure = this % of maxstress
+constexpr float PRESSURE_CALIBRATED_MAX_PCT = 100.0f * 100.0f / PRESSURE_FULL_SCALE_PCT;  // maxstress in pressure %
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief One outer loop result (setpoint mailbox contents)
+ */
+struct PressureCommand {
+    float setpoint_pct[NUM_MOTORS];  // Used with SAFETY_OUTPUT_PI
+    uint8_t output[NUM_MOTORS];      // SafetyOutput requested by the state machine
+    float reverse_duty_pct;          // Used with SAFETY_OUTPUT_REVERSE
+    uint8_t priority[NUM_MOTORS];    // Budget priority of the sector: 3 = CLOSE ... 0 = no range
+    uint8_t engage_seq[NUM_MOTORS];  // PI re-engage request from the state machine (changes on entering NORMAL)
+};
+
+/**
+ * @brief Inner loop counters
+ */
+struct PressureLoopStats {
+    uint32_t ticks;
+    uint32_t torn_reads;         // Mailbox copies discarded (previous command reused)
+    uint32_t stale_holds;        // Ticks braked because the outer loop went quiet
+    uint32_t mux_busy;           // Ticks that reused the previous pad readings
+    uint32_t ceiling_holds;      // Motor ticks braked above the over-pressure ceiling
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Start the pressure loop task
+ *
+ * Must be called at the end of setup(), after calibration: the task drives
+ * the motors as soon as the first command is published.
+ *
+ * @param prestress_mv Pad reading mapped to 0% per motor
+ * @param maxstress_mv Pad reading at full PWM per motor (95% maps to 100%)
+ */
+void initPressureLoop(const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS]);
+
+/**
+ * @brief Publish a new command to the inner loop (outer loop only)
+ * @param command Setpoints and modes for every motor
+ */
+void publishPressureCommand(const PressureCommand& command);
+
+/**
+ * @brief Latest pad readings from the inner loop
+ * @param pressure_pct Output normalized pressure per motor (0-100%)
+ * @param pressure_mv Output raw reading per motor (may be NULL)
+ */
+void getPressureReadings(float pressure_pct[NUM_MOTORS], uint16_t pressure_mv[NUM_MOTORS]);
+
+/**
+ * @brief Copy the inner loop counters
+ * @param stats Output snapshot
+ */
+void getPressureLoopStats(PressureLoopStats* stats);
+
+#endif // PRESSURE_LOOP_H
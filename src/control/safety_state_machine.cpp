@@ -0,0 +1,260 @@
+/**
+ * @file safety_state_machine.cpp
+ * @brief Implementation of the table-driven out-of-range state machine
+ */
+
+#include "safety_state_machine.h"
+#include "../config/system_config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr UBaseType_t EVENT_QUEUE_LENGTH = 16;   // Events buffered between log frames
+
+// Timeouts are compared in outer loop ticks
+static inline uint32_t msToTicks(uint32_t ms, const ParamSnapshot& params) {
+    uint32_t period_ms = 1000 / params.outer_rate_hz;
+    return (ms + period_ms - 1) / period_ms;
+}
+
+// ============================================================================
+// Per-Motor State
+// ============================================================================
+
+struct MotorSafetyContext {
+    SystemState state;
+    uint16_t ticks_in_state;     // Saturating tick counter, reset on entry
+    uint8_t engage_seq;          // Bumped on entering NORMAL (PI re-engage request)
+};
+
+static MotorSafetyContext contexts[NUM_MOTORS];
+static QueueHandle_t event_queue = NULL;
+static uint16_t dropped_events = 0;
+static portMUX_TYPE drops_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Guards
+// ============================================================================
+
+typedef bool (*SafetyGuard)(const MotorSafetyContext& ctx, const SafetyInputs& in,
+                            const ParamSnapshot& params);
+
+static bool guardOutOfBounds(const MotorSafetyContext& ctx, const SafetyInputs& in,
+                             const ParamSnapshot& params) {
+    (void)ctx;
+    (void)params;
+    return in.out_of_bounds;
+}
+
+static bool guardValid(const MotorSafetyContext& ctx, const SafetyInputs& in,
+                       const ParamSnapshot& params) {
+    (void)ctx;
+    (void)params;
+    return in.valid;
+}
+
+static bool guardPressureReleased(const MotorSafetyContext& ctx, const SafetyInputs& in,
+                                  const ParamSnapshot& params) {
+    (void)ctx;
+    return in.pressure_pct <= params.safe_pressure_pct;
+}
+
+static bool guardDeflateTimeout(const MotorSafetyContext& ctx, const SafetyInputs& in,
+                                const ParamSnapshot& params) {
+    (void)in;
+    return ctx.ticks_in_state >= msToTicks(params.release_time_ms, params);
+}
+
+static bool guardReleaseDone(const MotorSafetyContext& ctx, const SafetyInputs& in,
+                             const ParamSnapshot& params) {
+    (void)in;
+    return ctx.ticks_in_state >= msToTicks(params.release_hold_ms, params);
+}
+
+// ============================================================================
+// Entry / Exit Actions
+// ============================================================================
+
+// Called by safetyStep() on every transition: exit of the old state, then
+// entry of the new one. NULL means nothing to do. Actions only touch the
+// motor's context; motors are driven by the inner loop from the output.
+typedef void (*SafetyAction)(MotorSafetyContext& ctx);
+
+// Deflate and release timeouts count from entry
+static void startStateTimer(MotorSafetyContext& ctx) {
+    ctx.ticks_in_state = 0;
+}
+
+// Ask the inner loop to re-engage PI from rest (PI_MODE_TRACK for one tick,
+// then PI_MODE_RUN), whatever it applied while the motor was away
+static void enterNormal(MotorSafetyContext& ctx) {
+    startStateTimer(ctx);
+    ctx.engage_seq++;
+}
+
+// ============================================================================
+// Tables
+// ============================================================================
+
+// Motors are driven by the inner pressure loop from the published
+// SafetyOutput: a state names the output it requests and its actions.
+struct SafetyStateDesc {
+    SystemState state;
+    SafetyOutput output;
+    SafetyAction on_entry;
+    SafetyAction on_exit;
+};
+
+// Indexed by SystemState
+static const SafetyStateDesc STATE_TABLE[] = {
+    {NORMAL_OPERATION,          SAFETY_OUTPUT_PI,      enterNormal,     NULL},
+    {OUT_OF_RANGE_DEFLATING,    SAFETY_OUTPUT_REVERSE, startStateTimer, NULL},
+    {OUT_OF_RANGE_RELEASING,    SAFETY_OUTPUT_REVERSE, startStateTimer, NULL},
+    {WAITING_FOR_VALID_READING, SAFETY_OUTPUT_BRAKE,   startStateTimer, NULL},
+};
+
+constexpr int STATE_COUNT = sizeof(STATE_TABLE) / sizeof(STATE_TABLE[0]);
+static_assert(STATE_COUNT == WAITING_FOR_VALID_READING + 1, "STATE_TABLE must cover every SystemState");
+
+struct SafetyTransition {
+    SystemState from;
+    SafetyGuard guard;
+    SystemState to;
+    SafetyReason reason;
+};
+
+// Evaluated top to bottom, first matching row for the current state wins
+static const SafetyTransition TRANSITION_TABLE[] = {
+    {NORMAL_OPERATION,          guardOutOfBounds,      OUT_OF_RANGE_DEFLATING,    REASON_OUT_OF_BOUNDS},
+
+    {OUT_OF_RANGE_DEFLATING,    guardValid,            NORMAL_OPERATION,          REASON_VALID_READING},
+    {OUT_OF_RANGE_DEFLATING,    guardPressureReleased, OUT_OF_RANGE_RELEASING,    REASON_PRESSURE_RELEASED},
+    {OUT_OF_RANGE_DEFLATING,    guardDeflateTimeout,   WAITING_FOR_VALID_READING, REASON_DEFLATE_TIMEOUT},
+
+    {OUT_OF_RANGE_RELEASING,    guardValid,            NORMAL_OPERATION,          REASON_VALID_READING},
+    {OUT_OF_RANGE_RELEASING,    guardReleaseDone,      WAITING_FOR_VALID_READING, REASON_RELEASE_DONE},
+
+    {WAITING_FOR_VALID_READING, guardValid,            NORMAL_OPERATION,          REASON_VALID_READING},
+};
+
+constexpr int TRANSITION_COUNT = sizeof(TRANSITION_TABLE) / sizeof(TRANSITION_TABLE[0]);
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static void enterState(MotorSafetyContext& ctx, SystemState state) {
+    ctx.state = state;
+    if (STATE_TABLE[state].on_entry) {
+        STATE_TABLE[state].on_entry(ctx);
+    }
+}
+
+static void queueEvent(int motor_index, const SafetyTransition& t,
+                       const MotorSafetyContext& ctx, const SafetyInputs& in, uint32_t now_ms) {
+    if (event_queue == NULL) {
+        return;
+    }
+
+    SafetyEvent event;
+    event.timestamp_ms = now_ms;
+    event.motor = (uint8_t)motor_index;
+    event.from_state = (uint8_t)t.from;
+    event.to_state = (uint8_t)t.to;
+    event.reason = (uint8_t)t.reason;
+    event.pressure_pct = in.pressure_pct;
+    event.ticks_in_state = ctx.ticks_in_state;
+
+    // Never block the control loop on telemetry
+    if (xQueueSend(event_queue, &event, 0) != pdTRUE) {
+        portENTER_CRITICAL(&drops_mux);
+        if (dropped_events < UINT16_MAX) {
+            dropped_events++;
+        }
+        portEXIT_CRITICAL(&drops_mux);
+    }
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void initSafetyStateMachine() {
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        contexts[i].engage_seq = 0;
+        enterState(contexts[i], NORMAL_OPERATION);
+    }
+
+    if (event_queue == NULL) {
+        event_queue = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(SafetyEvent));
+    }
+    portENTER_CRITICAL(&drops_mux);
+    dropped_events = 0;
+    portEXIT_CRITICAL(&drops_mux);
+}
+
+void safetyStep(const SafetyInputs inputs[NUM_MOTORS], const ParamSnapshot& params, uint32_t now_ms) {
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        MotorSafetyContext& ctx = contexts[i];
+
+        if (ctx.ticks_in_state < UINT16_MAX) {
+            ctx.ticks_in_state++;
+        }
+
+        for (int t = 0; t < TRANSITION_COUNT; ++t) {
+            const SafetyTransition& row = TRANSITION_TABLE[t];
+            if (row.from != ctx.state || !row.guard(ctx, inputs[i], params)) {
+                continue;
+            }
+
+            queueEvent(i, row, ctx, inputs[i], now_ms);
+            if (STATE_TABLE[ctx.state].on_exit) {
+                STATE_TABLE[ctx.state].on_exit(ctx);
+            }
+            enterState(ctx, row.to);
+
+            // At most one transition per motor per tick
+            break;
+        }
+    }
+}
+
+SystemState getSafetyState(int motor_index) {
+    if (motor_index < 0 || motor_index >= NUM_MOTORS) {
+        return NORMAL_OPERATION;
+    }
+    return contexts[motor_index].state;
+}
+
+SafetyOutput getSafetyOutput(int motor_index) {
+    SystemState state = getSafetyState(motor_index);
+    if ((int)state < 0 || (int)state >= STATE_COUNT) {
+        return SAFETY_OUTPUT_BRAKE;
+    }
+    return STATE_TABLE[state].output;
+}
+
+uint8_t getSafetyEngageSeq(int motor_index) {
+    if (motor_index < 0 || motor_index >= NUM_MOTORS) {
+        return 0;
+    }
+    return contexts[motor_index].engage_seq;
+}
+
+bool popSafetyEvent(SafetyEvent* event) {
+    if (event_queue == NULL || event == NULL) {
+        return false;
+    }
+    return xQueueReceive(event_queue, event, 0) == pdTRUE;
+}
+
+uint16_t takeSafetyEventDrops() {
+    portENTER_CRITICAL(&drops_mux);
+    uint16_t dropped = dropped_events;
+    dropped_events = 0;
+    portEXIT_CRITICAL(&drops_mux);
+    return dropped;
+}
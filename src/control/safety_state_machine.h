@@ -0,0 +1,149 @@
+/**
+ * @file safety_state_machine.h
+ * @brief Table-driven out-of-range state machine for all motors
+ *
+ * Replaces the hand-written switch in the control loop. Behaviour is
+ * described by two tables in safety_state_machine.cpp:
+ * - State table: motor output requested in each state, entry/exit actions
+ * - Transition table: (from, guard, to) rows, first matching row wins
+ *
+ * Runs in the outer loop: timers count outer ticks (OUTER_RATE_HZ param).
+ * The state machine never drives a motor itself; the requested
+ * SafetyOutput is published to the inner pressure loop, which applies it.
+ * Thresholds and times come from the parameter registry snapshot
+ * (SAFE_PRESSURE, REVERSE_DUTY, RELEASE_TIME_MS, RELEASE_HOLD_MS).
+ * All motors are evaluated in one safetyStep() call per control tick.
+ * On every transition safetyStep() runs the exit action of the old state,
+ * then the entry action of the new one: entering any state restarts its
+ * timer, entering NORMAL also asks the inner loop to re-engage PI from
+ * rest (see getSafetyEngageSeq()).
+ * Every transition is queued as an event for the logging task, which
+ * sends it as a FRAME_STATE_EVENT frame.
+ *
+ * Flow (per motor):
+ *   NORMAL    --out of bounds------------------------------> DEFLATING
+ *   DEFLATING --valid reading------------------------------> NORMAL
+ *   DEFLATING --pressure <= SAFE_PRESSURE_THRESHOLD--------> RELEASING
+ *   DEFLATING --RELEASE_TIME_MS elapsed--------------------> WAITING
+ *   RELEASING --valid reading------------------------------> NORMAL
+ *   RELEASING --RELEASE_HOLD_MS elapsed--------------------> WAITING
+ *   WAITING   --valid reading------------------------------> NORMAL
+ */
+
+#ifndef SAFETY_STATE_MACHINE_H
+#define SAFETY_STATE_MACHINE_H
+
+#include <Arduino.h>
+#include "../config/pins.h"
+#include "../config/param_registry.h"
+#include "../sensors/tof_sensor.h"
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Motor output requested by a state
+ */
+enum SafetyOutput {
+    SAFETY_OUTPUT_PI,        // PI controller drives the motor
+    SAFETY_OUTPUT_REVERSE,   // Reverse at REVERSE_DUTY param (deflate)
+    SAFETY_OUTPUT_BRAKE      // Motor stopped
+};
+
+/**
+ * @brief Guard that caused a transition (reported in state events)
+ */
+enum SafetyReason : uint8_t {
+    REASON_OUT_OF_BOUNDS = 1,  // Distance out of bounds or invalid setpoint
+    REASON_VALID_READING,      // Distance back in a valid range
+    REASON_PRESSURE_RELEASED,  // Pressure dropped to SAFE_PRESSURE_THRESHOLD
+    REASON_DEFLATE_TIMEOUT,    // RELEASE_TIME_MS elapsed while deflating
+    REASON_RELEASE_DONE        // RELEASE_HOLD_MS elapsed while releasing
+};
+
+/**
+ * @brief Per-motor inputs sampled once per control tick
+ */
+struct SafetyInputs {
+    bool out_of_bounds;          // Range is OUT_OF_BOUNDS or setpoint invalid
+    bool valid;                  // Range is CLOSE/MEDIUM/FAR with a valid setpoint
+    float pressure_pct;          // Normalized pressure (0-100%)
+};
+
+/**
+ * @brief Transition event queued for telemetry
+ */
+struct SafetyEvent {
+    uint32_t timestamp_ms;
+    uint8_t motor;
+    uint8_t from_state;          // SystemState
+    uint8_t to_state;            // SystemState
+    uint8_t reason;              // SafetyReason
+    float pressure_pct;
+    uint16_t ticks_in_state;
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Initialize the state machine
+ *
+ * Puts every motor in NORMAL_OPERATION and creates the event queue.
+ * Must be called once during setup before safetyStep().
+ */
+void initSafetyStateMachine();
+
+/**
+ * @brief Advance the state machine for all motors by one control tick
+ *
+ * Evaluates the transition table for each motor and queues one event per
+ * transition that fires.
+ *
+ * @param inputs Array of NUM_MOTORS inputs for this tick
+ * @param params Parameter snapshot for this tick
+ * @param now_ms Current time (only used to timestamp events)
+ */
+void safetyStep(const SafetyInputs inputs[NUM_MOTORS], const ParamSnapshot& params, uint32_t now_ms);
+
+/**
+ * @brief Get the current state of a motor
+ * @param motor_index Motor index (0 to NUM_MOTORS-1)
+ * @return Current state (NORMAL_OPERATION if index is invalid)
+ */
+SystemState getSafetyState(int motor_index);
+
+/**
+ * @brief Get the output requested by a motor's current state
+ * @param motor_index Motor index (0 to NUM_MOTORS-1)
+ * @return Output for the control loop to apply
+ */
+SafetyOutput getSafetyOutput(int motor_index);
+
+/**
+ * @brief Get a motor's PI re-engage sequence
+ *
+ * Incremented by the NORMAL entry action. The inner loop re-engages PI
+ * from rest on the first tick it sees a new value.
+ *
+ * @param motor_index Motor index (0 to NUM_MOTORS-1)
+ * @return Sequence number (wraps, 0 if index is invalid)
+ */
+uint8_t getSafetyEngageSeq(int motor_index);
+
+/**
+ * @brief Pop the oldest queued transition event (non-blocking)
+ * @param event Output event
+ * @return true if an event was returned
+ */
+bool popSafetyEvent(SafetyEvent* event);
+
+/**
+ * @brief Get and clear the number of events dropped because the queue was full
+ * @return Dropped events since the last call
+ */
+uint16_t takeSafetyEventDrops();
+
+#endif // SAFETY_STATE_MACHINE_H
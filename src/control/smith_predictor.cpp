@@ -0,0 +1,129 @@
+/**
+ * @file smith_predictor.cpp
+ * @brief Implementation of the step test fit and the Smith predictor
+ */
+
+#include "smith_predictor.h"
+#include <math.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr int STEP_FIT_FINAL_SAMPLES = 20;       // Readings averaged for the final value
+constexpr float STEP_FIT_MIN_DELTA_PCT = 5.0f;   // Smaller responses are not fitted
+constexpr float STEP_FIT_MAX_TAU_MS = 5000.0f;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief Time the response first reaches a level, interpolated between readings
+ * @return -1 if never reached
+ */
+static float crossingMs(float level_mv, uint16_t start_mv, const uint16_t* samples_mv,
+                        const uint16_t* times_ms, int count) {
+    float prev_mv = (float)start_mv;
+    float prev_ms = 0.0f;
+    for (int k = 0; k < count; ++k) {
+        float mv = (float)samples_mv[k];
+        float ms = (float)times_ms[k];
+        if (mv >= level_mv) {
+            float fraction = (mv > prev_mv) ? (level_mv - prev_mv) / (mv - prev_mv) : 1.0f;
+            return prev_ms + fraction * (ms - prev_ms);
+        }
+        prev_mv = mv;
+        prev_ms = ms;
+    }
+    return -1.0f;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+bool fitStepModel(uint16_t start_mv, const uint16_t* samples_mv, const uint16_t* times_ms, int count,
+                  float duty_step, uint16_t prestress_mv, uint16_t maxstress_mv, StepModel* out) {
+    out->dead_time_ms = 0;
+    out->tau_ms = 0;
+    out->gain_milli = 0;
+
+    // Same scale as the pressure loop: prestress = 0%, 95% of maxstress = 100%
+    float span_mv = (float)maxstress_mv * 0.95f - (float)prestress_mv;
+    if (span_mv <= 0.0f || duty_step <= 0.0f || count <= STEP_FIT_FINAL_SAMPLES) {
+        return false;
+    }
+
+    float final_mv = 0.0f;
+    for (int k = count - STEP_FIT_FINAL_SAMPLES; k < count; ++k) {
+        final_mv += (float)samples_mv[k];
+    }
+    final_mv /= (float)STEP_FIT_FINAL_SAMPLES;
+
+    float delta_mv = final_mv - (float)start_mv;
+    if (delta_mv / span_mv * 100.0f < STEP_FIT_MIN_DELTA_PCT) {
+        return false;
+    }
+
+    float t28 = crossingMs((float)start_mv + 0.283f * delta_mv, start_mv, samples_mv, times_ms, count);
+    float t63 = crossingMs((float)start_mv + 0.632f * delta_mv, start_mv, samples_mv, times_ms, count);
+    if (t28 < 0.0f || t63 <= t28) {
+        return false;
+    }
+    float tau_ms = 1.5f * (t63 - t28);
+    float dead_ms = fmaxf(0.0f, t63 - tau_ms);
+    if (tau_ms < 1.0f || tau_ms > STEP_FIT_MAX_TAU_MS) {
+        return false;
+    }
+
+    float gain = delta_mv / span_mv * 100.0f / duty_step;
+    out->dead_time_ms = (uint16_t)lroundf(dead_ms);
+    out->tau_ms = (uint16_t)lroundf(tau_ms);
+    out->gain_milli = (uint16_t)lroundf(fminf(gain, 65.0f) * 1000.0f);
+    return true;
+}
+
+bool stepModelValid(const StepModel& model) {
+    return model.tau_ms > 0 && model.gain_milli > 0;
+}
+
+void smithReset(SmithPredictor& predictor) {
+    predictor.primed = false;
+}
+
+float smithFeedback(SmithPredictor& predictor, const StepModel& model, float measurement, float dt_s) {
+    if (!predictor.primed) {
+        // Start at rest on the measurement: no correction until the duty moves
+        predictor.model = measurement;
+        for (int k = 0; k < SMITH_DELAY_SLOTS; ++k) {
+            predictor.history[k] = measurement;
+        }
+        predictor.head = 0;
+        predictor.primed = true;
+    }
+
+    int delay_ticks = (int)lroundf(model.dead_time_ms * 1e-3f / dt_s);
+    if (delay_ticks > SMITH_DELAY_SLOTS - 1) {
+        delay_ticks = SMITH_DELAY_SLOTS - 1;
+    }
+    float delayed = predictor.history[(predictor.head + SMITH_DELAY_SLOTS - delay_ticks) % SMITH_DELAY_SLOTS];
+    return measurement + predictor.model - delayed;
+}
+
+void smithAdvance(SmithPredictor& predictor, const StepModel& model, float command, float dt_s) {
+    if (!predictor.primed) {
+        return;
+    }
+    float target = predictor.model;                 // Brake holds the force
+    if (command > 0.0f) {
+        target = model.gain_milli * 1e-3f * command;
+    } else if (command < 0.0f) {
+        target = 0.0f;
+    }
+    float alpha = 1.0f - expf(-dt_s / (model.tau_ms * 1e-3f));
+    predictor.model += alpha * (target - predictor.model);
+
+    predictor.head = (predictor.head + 1) % SMITH_DELAY_SLOTS;
+    predictor.history[predictor.head] = predictor.model;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file smith_predictor.h
+ * @brief Dead-time compensation of the pressure loop (Smith predictor)
+ *
+ * Between a duty change and the pad reading there is a transport delay
+ * (strap slack, pad compliance). A Smith predictor runs a model of the
+ * motor without that delay next to the real one and feeds the control law
+ *
+ *     y_fb = y + model(t) - model(t - dead_time)
+ *
+ * so the law reacts to the predicted pressure, and the model error still
+ * reaches it one dead time later. Enabled per motor with PARAM SMITH_n.
+ *
+ * The model is first order plus dead time (FOPDT), identified per motor by
+ * a step test during the boot calibration (STEP_TEST_FROM_DUTY to 100% while
+ * pressing) and stored with it (pad_calibration.h). Like the actuator, the
+ * model presses toward gain x duty on forward, holds on brake and releases
+ * toward 0 on reverse.
+ */
+
+#ifndef SMITH_PREDICTOR_H
+#define SMITH_PREDICTOR_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+// Step test (part of the boot calibration)
+constexpr uint8_t STEP_TEST_FROM_DUTY = 60;        // Duty held before the step (%)
+constexpr uint32_t STEP_TEST_PRELOAD_MS = 1500;    // Time at STEP_TEST_FROM_DUTY
+constexpr uint32_t STEP_TEST_PERIOD_MS = 10;       // Pad sample period during the step
+constexpr uint32_t STEP_TEST_DURATION_MS = 3000;   // Recording after the step to 100%
+constexpr int STEP_TEST_SAMPLES = STEP_TEST_DURATION_MS / STEP_TEST_PERIOD_MS;
+
+// Predictor
+constexpr int SMITH_DELAY_SLOTS = 128;             // Model history, dead time is capped to this many ticks
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief FOPDT model of one motor, from duty (%) to pad pressure (%)
+ *
+ * Also the NVS layout (inside the pad calibration blob).
+ */
+struct __attribute__((packed)) StepModel {
+    uint16_t dead_time_ms;
+    uint16_t tau_ms;             // 0 = not identified
+    uint16_t gain_milli;         // Pressure % per duty %, x1000
+};
+
+/**
+ * @brief Predictor state of one motor (owned by the pressure loop)
+ */
+struct SmithPredictor {
+    bool primed;                          // false = start from the next measurement
+    float model;                          // Undelayed model output (%)
+    float history[SMITH_DELAY_SLOTS];     // Past model outputs, one per tick
+    uint8_t head;                         // Slot of the newest output
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Fit a StepModel to a recorded step response
+ *
+ * Two-point method on the 28.3% and 63.2% crossings of the response:
+ * tau = 1.5 * (t63 - t28), dead time = t63 - tau.
+ *
+ * @param start_mv Pad reading just before the step
+ * @param samples_mv Pad readings after the step
+ * @param times_ms Time of each reading since the step
+ * @param count Number of readings
+ * @param duty_step Duty change of the step (%)
+ * @param prestress_mv Calibrated 0% (pre-stress)
+ * @param maxstress_mv Calibrated max stress (100% = 95% of it)
+ * @param out Fitted model; tau_ms = 0 if the response is unusable
+ * @return true if a model was fitted
+ */
+bool fitStepModel(uint16_t start_mv, const uint16_t* samples_mv, const uint16_t* times_ms, int count,
+                  float duty_step, uint16_t prestress_mv, uint16_t maxstress_mv, StepModel* out);
+
+/**
+ * @brief Check that a model can drive a predictor
+ */
+bool stepModelValid(const StepModel& model);
+
+/**
+ * @brief Forget the model history; the next smithFeedback() starts afresh
+ */
+void smithReset(SmithPredictor& predictor);
+
+/**
+ * @brief Measurement to feed the control law this tick
+ * @param measurement Pad pressure (%)
+ * @param dt_s Tick period (sets the dead time in ticks)
+ * @return y + model - delayed model (%)
+ */
+float smithFeedback(SmithPredictor& predictor, const StepModel& model, float measurement, float dt_s);
+
+/**
+ * @brief Advance the model by one tick with the duty applied this tick
+ * @param command Applied duty (%), after saturation and deadband
+ */
+void smithAdvance(SmithPredictor& predictor, const StepModel& model, float command, float dt_s);
+
+#endif // SMITH_PREDICTOR_H
@@ -0,0 +1,166 @@
+/**
+ * @file step_scorecard.cpp
+ * @brief Implementation of the step response scorecard
+ */
+
+#include "step_scorecard.h"
+#include "../config/pins.h"
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+
+// ============================================================================
+// State
+// ============================================================================
+
+/**
+ * @brief Open observation window (pressure loop only)
+ */
+struct StepWindow {
+    bool open;
+    float from;                  // Measurement when the step arrived
+    float target;                // Setpoint after the step
+    float elapsed_s;
+    float t10_s;                 // First time past 10% of the step (-1 = not yet)
+    float t90_s;                 // First time past 90% of the step (-1 = not yet)
+    float peak;                  // Furthest excursion past the target, signed along the step
+    float last_outside_s;        // Last time outside the settling band
+    float iae;
+};
+
+/**
+ * @brief Running sums of one motor
+ */
+struct StepTotals {
+    uint32_t steps;
+    uint32_t unsettled;
+    uint32_t risen;
+    float rise_s;
+    float overshoot_pct;
+    float overshoot_max_pct;
+    float settle_s;
+    float iae;
+};
+
+static StepWindow windows[NUM_MOTORS];
+static float last_setpoint[NUM_MOTORS] = {-1.0f, -1.0f, -1.0f, -1.0f, -1.0f};
+static StepTotals totals[NUM_MOTORS];
+static portMUX_TYPE score_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static void closeWindow(int i) {
+    StepWindow& w = windows[i];
+    float step = w.target - w.from;
+    float overshoot_pct = fmaxf(0.0f, w.peak) / fabsf(step) * 100.0f;
+    float window_s = STEP_WINDOW_MS * 1e-3f;
+    bool settled = w.last_outside_s < w.elapsed_s - 1e-6f;   // In the band on the last tick
+
+    portENTER_CRITICAL(&score_mux);
+    StepTotals& t = totals[i];
+    t.steps++;
+    if (w.t10_s >= 0.0f && w.t90_s >= 0.0f) {
+        t.risen++;
+        t.rise_s += w.t90_s - w.t10_s;
+    }
+    t.overshoot_pct += overshoot_pct;
+    if (overshoot_pct > t.overshoot_max_pct) {
+        t.overshoot_max_pct = overshoot_pct;
+    }
+    if (settled) {
+        t.settle_s += w.last_outside_s;
+    } else {
+        t.unsettled++;
+        t.settle_s += window_s;
+    }
+    t.iae += w.iae;
+    portEXIT_CRITICAL(&score_mux);
+
+    w.open = false;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void scorecardRecord(int motor_index, bool running, float setpoint, float measurement, float dt_s) {
+    if (motor_index < 0 || motor_index >= NUM_MOTORS) {
+        return;
+    }
+    StepWindow& w = windows[motor_index];
+
+    if (!running) {
+        w.open = false;
+        last_setpoint[motor_index] = -1.0f;   // Re-engagement is not a step
+        return;
+    }
+
+    float previous = last_setpoint[motor_index];
+    last_setpoint[motor_index] = setpoint;
+    if (previous >= 0.0f && fabsf(setpoint - previous) >= STEP_MIN_PCT) {
+        w.open = fabsf(setpoint - measurement) >= STEP_MIN_PCT;
+        w.from = measurement;
+        w.target = setpoint;
+        w.elapsed_s = 0.0f;
+        w.t10_s = -1.0f;
+        w.t90_s = -1.0f;
+        w.peak = -INFINITY;
+        w.last_outside_s = 0.0f;
+        w.iae = 0.0f;
+        return;
+    }
+    if (!w.open) {
+        return;
+    }
+
+    w.elapsed_s += dt_s;
+    float step = w.target - w.from;
+    float direction = (step > 0.0f) ? 1.0f : -1.0f;
+    float progress = (measurement - w.from) / step;   // 0 at start, 1 at target
+    if (w.t10_s < 0.0f && progress >= 0.1f) {
+        w.t10_s = w.elapsed_s;
+    }
+    if (w.t90_s < 0.0f && progress >= 0.9f) {
+        w.t90_s = w.elapsed_s;
+    }
+    float excursion = (measurement - w.target) * direction;
+    if (excursion > w.peak) {
+        w.peak = excursion;
+    }
+    float error = fabsf(w.target - measurement);
+    if (error > fmaxf(STEP_BAND_FRACTION * fabsf(step), STEP_BAND_MIN_PCT)) {
+        w.last_outside_s = w.elapsed_s;
+    }
+    w.iae += error * dt_s;
+
+    if (w.elapsed_s * 1000.0f >= (float)STEP_WINDOW_MS) {
+        closeWindow(motor_index);
+    }
+}
+
+void getStepScore(int motor_index, StepScore* out) {
+    if (motor_index < 0 || motor_index >= NUM_MOTORS || out == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&score_mux);
+    StepTotals t = totals[motor_index];
+    portEXIT_CRITICAL(&score_mux);
+
+    float steps = (t.steps > 0) ? (float)t.steps : 1.0f;
+    out->steps = t.steps;
+    out->unsettled = t.unsettled;
+    out->rise_ms = (t.risen > 0) ? t.rise_s * 1000.0f / (float)t.risen : 0.0f;
+    out->overshoot_pct = t.overshoot_pct / steps;
+    out->overshoot_max_pct = t.overshoot_max_pct;
+    out->settle_ms = t.settle_s * 1000.0f / steps;
+    out->iae = t.iae / steps;
+}
+
+void resetStepScores() {
+    portENTER_CRITICAL(&score_mux);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        totals[i] = StepTotals();
+    }
+    portEXIT_CRITICAL(&score_mux);
+}
@@ -0,0 +1,72 @@
+/**
+ * @file step_scorecard.h
+ * @brief Step response scorecard per motor (inner pressure loop)
+ *
+ * Every setpoint change of at least STEP_MIN_PCT while a motor runs closed
+ * loop opens a STEP_WINDOW_MS observation window. At its end the response
+ * is scored: 10-90% rise time, overshoot (% of the step), settling time
+ * into a band of STEP_BAND_FRACTION of the step (at least STEP_BAND_MIN_PCT),
+ * and the integral of the absolute error. A new step or leaving PI_MODE_RUN
+ * drops the window unscored.
+ *
+ * Read with DIAG:CTRL, cleared with DIAG:CTRL:RESET. Comparing laws
+ * (PARAM CTRL_LAW_n) on the same scene gives the controller benchmark,
+ * see scripts/ctrl_scorecard.py.
+ */
+
+#ifndef STEP_SCORECARD_H
+#define STEP_SCORECARD_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr float STEP_MIN_PCT = 5.0f;             // Smaller setpoint changes are not scored
+constexpr uint32_t STEP_WINDOW_MS = 3000;        // Observation window per step
+constexpr float STEP_BAND_FRACTION = 0.05f;      // Settling band (fraction of the step)
+constexpr float STEP_BAND_MIN_PCT = 1.0f;        // Settling band floor (pad noise)
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Scores of one motor since the last reset
+ */
+struct StepScore {
+    uint32_t steps;              // Scored windows
+    uint32_t unsettled;          // Windows ending outside the band
+    float rise_ms;               // Mean 10-90% rise time (steps that reached 90%)
+    float overshoot_pct;         // Mean overshoot, % of the step
+    float overshoot_max_pct;     // Worst overshoot
+    float settle_ms;             // Mean settling time (window length if unsettled)
+    float iae;                   // Mean integral of |error| over the window (%·s)
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Feed one inner loop tick of a motor (pressure loop only)
+ * @param motor_index Motor index (0 to NUM_MOTORS-1)
+ * @param running true if the motor is in PI_MODE_RUN this tick
+ * @param setpoint Setpoint (%)
+ * @param measurement Pad pressure (%)
+ * @param dt_s Time since the previous tick
+ */
+void scorecardRecord(int motor_index, bool running, float setpoint, float measurement, float dt_s);
+
+/**
+ * @brief Copy the scores of a motor
+ */
+void getStepScore(int motor_index, StepScore* out);
+
+/**
+ * @brief Clear the scores of every motor (open windows keep running)
+ */
+void resetStepScores();
+
+#endif // STEP_SCORECARD_H
@@ -8,7 +8,8 @@
  *
  * Architecture:
  * - Core 0: Servo sweep task (TOF scanning), Serial print task (CSV logging)
- * - Core 1: Main loop (PI control at 50 Hz for 4 motors)
+ * - Core 1: Pressure loop task (pads + PI, INNER_RATE_HZ, default 200 Hz)
+ * - Core 1: Main loop (pots, setpoints, safety, OUTER_RATE_HZ, default 20 Hz)
  *
  * Hardware:
  * - 4 DC motors with H-bridge drivers
@@ -26,28 +27,30 @@
 // Project modules
 #include "config/pins.h"
 #include "config/system_config.h"
+#include "config/param_registry.h"
 #include "sensors/tof_sensor.h"
 #include "sensors/ultrasonic_sensor.h"
 #include "sensors/pressure_pads.h"
+#include "sensors/pad_calibration.h"
 #include "actuators/motors.h"
 #include "control/pi_controller.h"
+#include "control/safety_state_machine.h"
+#include "control/control_watchdog.h"
+#include "control/overpressure_guard.h"
+#include "control/pressure_loop.h"
+#include "control/power_budget.h"
 #include "tasks/core0_tasks.h"
 #include "utils/command_handler.h"
+#include "utils/device_info.h"
+#include "utils/loop_timing.h"
 #include "utils/multiplexer.h"
+#include "utils/telemetry_stats.h"
+#include "utils/ota_update.h"
+#include "utils/power_manager.h"
+#include "utils/tlog.h"
 
-// ============================================================================
-// Control Loop Configuration
-// ============================================================================
-
-constexpr uint32_t CTRL_FREQ_HZ = 20;         // PI control frequency (Hz)
-constexpr uint32_t CTRL_DT_MS = 1000 / CTRL_FREQ_HZ;  // 50 ms period
-
-// ============================================================================
-// State Machine for Out-of-Range Handling (Per Motor)
-// ============================================================================
-
-static SystemState current_state[NUM_MOTORS] = {NORMAL_OPERATION, NORMAL_OPERATION, NORMAL_OPERATION, NORMAL_OPERATION, NORMAL_OPERATION};
-static uint32_t reverse_start_time[NUM_MOTORS] = {0, 0, 0, 0, 0};
+// The per-motor TLOG formats below spell out M1..M5
+static_assert(NUM_MOTORS == 5, "Update the per-motor TLOG formats");
 
 // ============================================================================
 // Distance Range Tracking (Per Motor)
@@ -60,36 +63,32 @@ static DistanceRange previous_range[NUM_MOTORS] = {RANGE_UNKNOWN, RANGE_UNKNOWN,
 // Local Variables (Core 1)
 // ============================================================================
 
-static uint16_t pressure_pads_mv[NUM_MOTORS] = {0};  // Raw mV readings (for logging)
 static uint16_t prestress_mv[NUM_MOTORS] = {0};       // Pre-stress values captured at init (mV)
 static uint16_t maxstress_mv[NUM_MOTORS] = {0};       // Max stress values at 100% PWM (mV)
-static float pressure_normalized[NUM_MOTORS] = {0.0f}; // Normalized pressure 0-100 per motor
-static float duty_cycles[NUM_MOTORS] = {0.0f};
+static bool calibration_ok = false;                   // Max stress above pre-stress for every motor
+static StepModel step_models[NUM_MOTORS] = {};        // Smith predictor models from the step test
+static CouplingMatrix coupling = {};                  // Pad cross-coupling from the coupling test
+static uint16_t step_samples_mv[NUM_MOTORS][STEP_TEST_SAMPLES]; // Step test response (boot only)
+static uint16_t step_times_ms[STEP_TEST_SAMPLES];     // Time of each step test reading since the step
+static float pressure_normalized[NUM_MOTORS] = {0.0f}; // Latest from the pressure loop (0-100%)
 static float setpoints[NUM_MOTORS] = {0.0f};         // Individual setpoints per motor (0-100%)
 static uint32_t last_control_ms = 0;
+static uint32_t last_motor_stats_save_ms = 0;
 
 // Potentiometer readings (0-3300 mV range for 10K pots with 3.3V reference)
 static uint16_t potentiometer_mv[NUM_POTENTIOMETERS] = {0};  // Raw mV readings
 
-// Force scaling from potentiometer 1
-// Pot at min (0 mV)    → CLOSE=60%, scaled proportionally for MEDIUM and FAR
-// Pot at max (3300 mV) → CLOSE=100%, scaled proportionally for MEDIUM and FAR
-constexpr float FORCE_SCALE_MIN = 0.60f;   // Minimum scale (pot at 0%)
-constexpr float FORCE_SCALE_MAX = 1.00f;   // Maximum scale (pot at 100%)
 constexpr float POT_MV_MIN = 0.0f;         // Potentiometer minimum voltage (mV)
 constexpr float POT_MV_MAX = 3300.0f;      // Potentiometer maximum voltage (mV)
 
 // Current force scale factor (updated from potentiometer 1)
+// Scale range defaults (FORCE_SCALE_MIN/MAX) are in system_config.h
 static float force_scale = 1.0f;
 
 // ============================================================================
 // Distance Threshold Scaling from Potentiometer 2
 // ============================================================================
-// Pot at 0%   → scale = 0.5 (FAR out at 150 cm)
-// Pot at 50%  → scale = 1.0 (FAR out at 300 cm - reference)
-// Pot at 100% → scale = 1.5 (FAR out at 450 cm)
-constexpr float DIST_SCALE_MIN = 0.50f;    // Minimum scale (pot at 0%)
-constexpr float DIST_SCALE_MAX = 1.50f;    // Maximum scale (pot at 100%)
+// Scale range defaults (DIST_SCALE_MIN/MAX) are in system_config.h
 
 // Current distance scale factor (updated from potentiometer 2)
 static float distance_scale = 1.0f;
@@ -97,14 +96,16 @@ static float distance_scale = 1.0f;
 /**
  * @brief Calculate distance scale factor from potentiometer 2 reading
  * @param pot_mv Potentiometer reading in millivolts (0-3300)
- * @return Scale factor (DIST_SCALE_MIN to DIST_SCALE_MAX)
+ * @param scale_min Scale at pot 0% (PARAM DIST_SCALE_MIN)
+ * @param scale_max Scale at pot 100% (PARAM DIST_SCALE_MAX)
+ * @return Scale factor (scale_min to scale_max)
  *
  * Maps potentiometer position to distance threshold scaling:
  * - Pot at 0 mV    → scale = 0.5 (closer detection, FAR out at 150cm)
  * - Pot at 1650 mV → scale = 1.0 (reference values)
  * - Pot at 3300 mV → scale = 1.5 (farther detection, FAR out at 450cm)
  */
-float calculateDistanceScale(uint16_t pot_mv) {
+float calculateDistanceScale(uint16_t pot_mv, float scale_min, float scale_max) {
     float pot_normalized = (float)pot_mv / POT_MV_MAX;
 
     // Clamp to 0-1 range
@@ -112,50 +113,25 @@ float calculateDistanceScale(uint16_t pot_mv) {
     if (pot_normalized > 1.0f) pot_normalized = 1.0f;
 
     // Linear interpolation between min and max scale
-    return DIST_SCALE_MIN + pot_normalized * (DIST_SCALE_MAX - DIST_SCALE_MIN);
+    return scale_min + pot_normalized * (scale_max - scale_min);
 }
 
 // ============================================================================
 // Helper Functions
 // ============================================================================
 
-/**
- * @brief Map pressure pad mV reading to 0-100 range for a specific motor
- * @param motor_index Motor index (0 to NUM_MOTORS-1)
- * @param mv_reading Current millivolt reading
- * @return Normalized value 0-100 (clamped)
- *
- * Uses prestress_mv as min (0%) and maxstress_mv * 0.95 as max (100%)
- * Each motor has its own calibration based on captured values
- */
-float mapPressureToPercent(int motor_index, uint16_t mv_reading) {
-    float min_val = (float)prestress_mv[motor_index];
-    float max_val = (float)maxstress_mv[motor_index] * 0.95f;  // 95% of max for margin
-
-    // Avoid division by zero
-    if (max_val <= min_val) {
-        return 0.0f;
-    }
-
-    float normalized = ((float)mv_reading - min_val) / (max_val - min_val) * 100.0f;
-
-    // Clamp to 0-100 range
-    if (normalized < 0.0f) normalized = 0.0f;
-    if (normalized > 100.0f) normalized = 100.0f;
-
-    return normalized;
-}
-
 /**
  * @brief Calculate force scale factor from potentiometer 1 reading
  * @param pot_mv Potentiometer reading in millivolts (0-3300)
- * @return Scale factor (FORCE_SCALE_MIN to FORCE_SCALE_MAX)
+ * @param scale_min Scale at pot 0% (PARAM FORCE_SCALE_MIN)
+ * @param scale_max Scale at pot 100% (PARAM FORCE_SCALE_MAX)
+ * @return Scale factor (scale_min to scale_max)
  *
  * Maps potentiometer position to force scaling:
  * - Pot at 0 mV    → scale = 0.60 (60% of base setpoints)
  * - Pot at 3300 mV → scale = 1.00 (100% of base setpoints)
  */
-float calculateForceScale(uint16_t pot_mv) {
+float calculateForceScale(uint16_t pot_mv, float scale_min, float scale_max) {
     float pot_normalized = (float)pot_mv / POT_MV_MAX;
 
     // Clamp to 0-1 range
@@ -163,7 +139,213 @@ float calculateForceScale(uint16_t pot_mv) {
     if (pot_normalized > 1.0f) pot_normalized = 1.0f;
 
     // Linear interpolation between min and max scale
-    return FORCE_SCALE_MIN + pot_normalized * (FORCE_SCALE_MAX - FORCE_SCALE_MIN);
+    return scale_min + pot_normalized * (scale_max - scale_min);
+}
+
+/**
+ * @brief Actuation budget priority of a sector (closest first)
+ */
+static uint8_t budgetPriority(DistanceRange range) {
+    switch (range) {
+        case RANGE_CLOSE:  return 3;
+        case RANGE_MEDIUM: return 2;
+        case RANGE_FAR:    return 1;
+        default:           return 0;
+    }
+}
+
+// ============================================================================
+// Pad Calibration
+// ============================================================================
+
+/**
+ * @brief Drive every motor forward from rest, POWER_CAL_STAGGER_MS apart
+ *
+ * The calibration runs outside the pressure loop and its budget; spreading
+ * the starts keeps the inrush currents from adding up. The hold time of
+ * each phase counts from the last start.
+ */
+static void startAllForward(uint8_t duty_pct) {
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        if (i > 0) {
+            delay(POWER_CAL_STAGGER_MS);
+        }
+        motorForward(i, duty_pct);
+    }
+}
+
+/**
+ * @brief Record the pads every STEP_TEST_PERIOD_MS for STEP_TEST_DURATION_MS
+ */
+static void recordStepResponse() {
+    uint32_t start_ms = millis();
+    uint16_t pads_mv[NUM_MOTORS];
+    for (int k = 0; k < STEP_TEST_SAMPLES; ++k) {
+        uint32_t due_ms = start_ms + (uint32_t)(k + 1) * STEP_TEST_PERIOD_MS;
+        while ((int32_t)(millis() - due_ms) < 0) {
+            delay(1);
+        }
+        step_times_ms[k] = (uint16_t)(millis() - start_ms);
+        readAllPadsMilliVolts(pads_mv, PP_SAMPLES_INNER);
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            step_samples_mv[i][k] = pads_mv[i];
+        }
+    }
+}
+
+/**
+ * @brief Identify the pad coupling matrix (~15 s, needs the final pre/max stress)
+ *
+ * All motors press at COUPLING_BASE_DUTY; each one in turn steps to
+ * COUPLING_STEP_DUTY and the change of every pad gives its column. Only
+ * run when the decoupler is enabled and no matrix is stored.
+ */
+static void runCouplingTest() {
+    TLOG("Coupling test: stepping each motor %u%% -> %u%% PWM...", COUPLING_BASE_DUTY, COUPLING_STEP_DUTY);
+    startAllForward(COUPLING_BASE_DUTY);
+    delay(COUPLING_SETTLE_MS);
+
+    uint16_t before_mv[NUM_MOTORS];
+    uint16_t after_mv[NUM_MOTORS];
+    for (int j = 0; j < NUM_MOTORS; ++j) {
+        readAllPadsMilliVolts(before_mv, PP_SAMPLES);
+        motorForward(j, COUPLING_STEP_DUTY);
+        delay(COUPLING_STEP_MS);
+        readAllPadsMilliVolts(after_mv, PP_SAMPLES);
+        motorForward(j, COUPLING_BASE_DUTY);
+        couplingColumn(&coupling, j, before_mv, after_mv, (float)(COUPLING_STEP_DUTY - COUPLING_BASE_DUTY),
+                       prestress_mv, maxstress_mv);
+        delay(COUPLING_RETURN_MS);
+    }
+
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        TLOG("Coupling pad %d (x1000): M1=%d, M2=%d, M3=%d, M4=%d, M5=%d", i + 1,
+             coupling.gain_milli[i][0], coupling.gain_milli[i][1], coupling.gain_milli[i][2],
+             coupling.gain_milli[i][3], coupling.gain_milli[i][4]);
+    }
+
+    TLOG("Releasing pressure...");
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorReverse(i, 60);
+    }
+    delay(500);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorBrake(i);
+    }
+}
+
+/**
+ * @brief Capture pre-stress and max stress for every motor (~39 s)
+ *
+ * Drives all motors into the head, releases, stores pre-stress, then
+ * averages two max-stress readings at 100% PWM. The second one is reached
+ * by a step from STEP_TEST_FROM_DUTY while pressing, which identifies the
+ * Smith predictor model of each motor.
+ */
+static void runPadCalibration() {
+    TLOG("Put all motors in contact with the head");
+    startAllForward(60);
+    delay(3000);
+    TLOG("Release the pressure");
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorBrake(i);
+        motorReverse(i,60);
+    }
+    delay(500);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorBrake(i);
+    }
+    TLOG("Store pretension value");
+    readAllPadsMilliVolts(prestress_mv, PP_SAMPLES);
+
+    // Print prestress values
+    TLOG("Prestress (mV): M1=%u, M2=%u, M3=%u, M4=%u, M5=%u",
+         prestress_mv[0], prestress_mv[1], prestress_mv[2], prestress_mv[3], prestress_mv[4]);
+
+    // ========================================================================
+    // Capture max stress at 100% PWM (2 measurements averaged)
+    // ========================================================================
+    uint16_t maxstress_measure1[NUM_MOTORS] = {0};
+    uint16_t maxstress_measure2[NUM_MOTORS] = {0};
+
+    // First measurement
+    TLOG("[1/2] Applying 100%% PWM to capture max stress...");
+    startAllForward(100);  // 100% PWM
+    delay(3000);  // Wait for pressure to stabilize
+
+    // Read first max stress values
+    readAllPadsMilliVolts(maxstress_measure1, PP_SAMPLES);
+
+    // Print first measurement
+    TLOG("Maxstress #1 (mV): M1=%u, M2=%u, M3=%u, M4=%u, M5=%u",
+         maxstress_measure1[0], maxstress_measure1[1], maxstress_measure1[2], maxstress_measure1[3], maxstress_measure1[4]);
+
+    // Release pressure
+    TLOG("Releasing pressure...");
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorBrake(i);
+        motorReverse(i, 60);
+    }
+    delay(500);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorBrake(i);
+    }
+    delay(1000);  // Wait before second measurement
+
+    // Second measurement, reached by the step test: press at a partial duty,
+    // then step to 100% and record the response while it stabilizes
+    TLOG("[2/2] Step test %u%% -> 100%% PWM to capture max stress...", STEP_TEST_FROM_DUTY);
+    startAllForward(STEP_TEST_FROM_DUTY);
+    delay(STEP_TEST_PRELOAD_MS);
+    uint16_t step_start_mv[NUM_MOTORS] = {0};
+    readAllPadsMilliVolts(step_start_mv, PP_SAMPLES);
+    // Not staggered: the motors already run, and the fit needs one step time
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorForward(i, 100);  // 100% PWM
+    }
+    recordStepResponse();  // 3 s, pressure stabilizes meanwhile
+
+    // Read second max stress values
+    readAllPadsMilliVolts(maxstress_measure2, PP_SAMPLES);
+
+    // Print second measurement
+    TLOG("Maxstress #2 (mV): M1=%u, M2=%u, M3=%u, M4=%u, M5=%u",
+         maxstress_measure2[0], maxstress_measure2[1], maxstress_measure2[2], maxstress_measure2[3], maxstress_measure2[4]);
+
+    // Stop all motors
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorBrake(i);
+    }
+
+    // Calculate average of both measurements
+    for (int i = 0; i < NUM_MOTORS; i++) {
+        maxstress_mv[i] = (maxstress_measure1[i] + maxstress_measure2[i]) / 2;
+    }
+
+    // Print averaged maxstress values
+    TLOG("Maxstress AVG (mV): M1=%u, M2=%u, M3=%u, M4=%u, M5=%u",
+         maxstress_mv[0], maxstress_mv[1], maxstress_mv[2], maxstress_mv[3], maxstress_mv[4]);
+
+    // Fit the step responses on the final 0-100% scale
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        if (fitStepModel(step_start_mv[i], step_samples_mv[i], step_times_ms, STEP_TEST_SAMPLES,
+                         100.0f - STEP_TEST_FROM_DUTY, prestress_mv[i], maxstress_mv[i], &step_models[i])) {
+            TLOG("Step model M%d: dead time %u ms, tau %u ms, gain %u/1000",
+                 i + 1, step_models[i].dead_time_ms, step_models[i].tau_ms, step_models[i].gain_milli);
+        } else {
+            TLOG("WARNING: step test of M%d not usable, Smith predictor unavailable", i + 1);
+        }
+    }
+
+    // Release pressure after max stress capture
+    TLOG("Releasing pressure...");
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorReverse(i, 60);
+    }
+    delay(500);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        motorBrake(i);
+    }
 }
 
 // ============================================================================
@@ -171,39 +353,42 @@ float calculateForceScale(uint16_t pot_mv) {
 // ============================================================================
 
 void setup() {
-    // Initialize serial communication
+    // Initialize serial communication (RX buffer sized for OTA:CHUNK lines)
+    Serial.setRxBufferSize(1024);
     Serial.begin(115200);
     delay(3000);  // Allow time to open serial monitor
 
-    Serial.println();
-    Serial.println();
-    Serial.println("==================================================");
-    Serial.println("ESP32-S3 BOOT SEQUENCE STARTED");
-    Serial.println("==================================================");
+    TLOG("ESP32-S3 BOOT SEQUENCE STARTED");
     Serial.flush();
     delay(100);
 
-    Serial.println("4-Motor Independent PI Control System");
-    Serial.println("With Servo Sweep and TOF Distance Sensing");
-    Serial.println("========================================");
-    Serial.print("Control Mode: ");
-    Serial.println(CONTROL_MODE_NAME);
-    Serial.print("Protocol: ");
-    Serial.println(PROTOCOL_NAME);
-    Serial.print("Logging Rate: ");
-    Serial.println(LOGGING_RATE_NAME);
-    Serial.print("Sweep Mode: ");
-    Serial.println(SWEEP_MODE_NAME);
-    Serial.println("========================================");
-    Serial.println();
+    // Roll back a freshly written image that keeps failing to boot
+    initOtaUpdate();
+
+    // Load runtime parameters (defaults + NVS) before anything reads them
+    initParamRegistry();
+
+    TLOG("4-Motor Independent PI Control System");
+    TLOG("With Servo Sweep and TOF Distance Sensing");
+    TLOG("Control Mode: %s", CONTROL_MODE_NAME);
+    TLOG("Protocol: %s", PROTOCOL_NAME);
+    ParamSnapshot boot_params;
+    paramSnapshot(&boot_params);
+    TLOG("Logging Period: %u ms", boot_params.log_period_ms);
+    TLOG("Sweep Mode: %s", boot_params.sweep_mode == SWEEP_CONTINUOUS ? "Continuous" :
+                           boot_params.sweep_mode == SWEEP_TRACKING ? "Tracking" :
+                           boot_params.sweep_mode == SWEEP_BIDIRECTIONAL ? "Bidirectional" : "Forward");
     Serial.flush();
 
     // Initialize command handler for runtime configuration
-    Serial.println("Initializing command handler...");
+    TLOG("Initializing command handler...");
     initCommandHandler();
     Serial.flush();
     delay(100);
 
+    // DFS / light sleep and the PM locks taken by the timing-critical windows
+    initPowerManagement(boot_params.power_mode);
+
     // ========================================================================
     // HARDWARE INITIALIZATION - DIAGNOSTIC MODE
     // ========================================================================
@@ -218,253 +403,157 @@ void setup() {
     const bool ENABLE_PI = true;            // Test 5: PI controllers
     const bool ENABLE_CORE0_TASKS = true;   // Test 6: Core 0 tasks
 
-    Serial.println("\n========================================");
-    Serial.println("DIAGNOSTIC MODE - Hardware Test");
-    Serial.println("========================================");
-    Serial.print("TOF Sensor:     "); Serial.println(ENABLE_TOF ? "ENABLED" : "DISABLED");
-    Serial.print("Ultrasonic:     "); Serial.println(ENABLE_ULTRASONIC ? "ENABLED" : "DISABLED");
-    Serial.print("Pressure Pads:  "); Serial.println(ENABLE_PRESSURE_PADS ? "ENABLED" : "DISABLED");
-    Serial.print("Motors:         "); Serial.println(ENABLE_MOTORS ? "ENABLED" : "DISABLED");
-    Serial.print("PI Controllers: "); Serial.println(ENABLE_PI ? "ENABLED" : "DISABLED");
-    Serial.print("Core 0 Tasks:   "); Serial.println(ENABLE_CORE0_TASKS ? "ENABLED" : "DISABLED");
-    Serial.println("========================================\n");
+    // One message for the whole table: enabled flags as 0/1
+    TLOG("DIAGNOSTIC MODE - TOF=%d US=%d PADS=%d MOTORS=%d PI=%d CORE0=%d",
+         ENABLE_TOF, ENABLE_ULTRASONIC, ENABLE_PRESSURE_PADS,
+         ENABLE_MOTORS, ENABLE_PI, ENABLE_CORE0_TASKS);
     Serial.flush();
     delay(1000);
 
     // Initialize hardware modules
-    Serial.println("Initializing hardware...\n");
+    TLOG("Initializing hardware...");
     Serial.flush();
     delay(100);
 
     // Test 1: TOF sensor and servo
     if (ENABLE_TOF) {
-        Serial.print("  [1/6] TOF sensor and servo... ");
+        TLOG("  [1/6] TOF sensor and servo...");
         Serial.flush();
         initTOFSensor();
-        Serial.println("OK");
+        TLOG("  [1/6] TOF sensor and servo: OK");
         Serial.flush();
         delay(500);
     } else {
-        Serial.println("  [1/6] TOF sensor: SKIPPED");
+        TLOG("  [1/6] TOF sensor: SKIPPED");
         Serial.flush();
         delay(100);
     }
 
     // Test 2: Ultrasonic sensor
     if (ENABLE_ULTRASONIC) {
-        Serial.print("  [2/6] Ultrasonic sensor... ");
+        TLOG("  [2/6] Ultrasonic sensor...");
         Serial.flush();
         initUltrasonicSensor();
-        Serial.println("OK");
+        TLOG("  [2/6] Ultrasonic sensor: OK");
         Serial.flush();
         delay(500);
     } else {
-        Serial.println("  [2/6] Ultrasonic sensor: SKIPPED");
+        TLOG("  [2/6] Ultrasonic sensor: SKIPPED");
         Serial.flush();
         delay(100);
     }
 
     // Test 3: Pressure pads (and multiplexer)
     if (ENABLE_PRESSURE_PADS) {
-        Serial.print("  [3/6] Pressure pads... ");
+        TLOG("  [3/6] Pressure pads...");
         Serial.flush();
         initPressurePads();
-        Serial.println("OK");
+        TLOG("  [3/6] Pressure pads: OK");
 
         // Capture pre-stress values at initialization
-        Serial.print("       Capturing pre-stress values... ");
+        TLOG("       Capturing pre-stress values...");
         Serial.flush();
         readAllPadsMilliVolts(prestress_mv, PP_SAMPLES);
-        Serial.println("OK");
+        TLOG("       Pre-stress captured");
 
         // Print captured pre-stress values
-        Serial.print("       Pre-stress (mV): ");
-        for (int i = 0; i < NUM_MOTORS; i++) {
-            Serial.print(prestress_mv[i]);
-            if (i < NUM_MOTORS - 1) Serial.print(", ");
-        }
-        Serial.println();
+        TLOG("       Pre-stress (mV): %u, %u, %u, %u, %u",
+             prestress_mv[0], prestress_mv[1], prestress_mv[2], prestress_mv[3], prestress_mv[4]);
 
         Serial.flush();
         delay(500);
     } else {
-        Serial.println("  [3/6] Pressure pads: SKIPPED");
+        TLOG("  [3/6] Pressure pads: SKIPPED");
         Serial.flush();
         delay(100);
     }
 
     // Test 4: Motors
     if (ENABLE_MOTORS) {
-        Serial.print("  [4/6] Motors... ");
+        TLOG("  [4/6] Motors...");
         Serial.flush();
         initMotorSystem();
-        Serial.println("OK");
+        initControlWatchdog();  // Arms on the first control tick
+        initOverpressureGuard();  // Samples the pads; trips once the pressure loop sets limits
+        TLOG("  [4/6] Motors: OK");
         Serial.flush();
         delay(500);
     } else {
-        Serial.println("  [4/6] Motors: SKIPPED");
+        TLOG("  [4/6] Motors: SKIPPED");
         Serial.flush();
         delay(100);
     }
 
     // Test 5: PI controllers
     if (ENABLE_PI) {
-        Serial.print("  [5/6] PI controllers... ");
+        TLOG("  [5/6] PI controllers...");
         Serial.flush();
         initPIController();
-        Serial.println("OK");
+        initSafetyStateMachine();
+        TLOG("  [5/6] PI controllers: OK");
         Serial.flush();
         delay(500);
     } else {
-        Serial.println("  [5/6] PI controllers: SKIPPED");
+        TLOG("  [5/6] PI controllers: SKIPPED");
         Serial.flush();
         delay(100);
     }
 
     // Test 6: Core 0 tasks
     if (ENABLE_CORE0_TASKS) {
-        Serial.println("\n  [6/6] Starting Core 0 tasks...");
+        TLOG("  [6/6] Starting Core 0 tasks...");
         Serial.flush();
         initCore0Tasks();
-        Serial.println("       Core 0 tasks: OK");
+        TLOG("       Core 0 tasks: OK");
         Serial.flush();
         delay(500);
     } else {
-        Serial.println("  [6/6] Core 0 tasks: SKIPPED");
+        TLOG("  [6/6] Core 0 tasks: SKIPPED");
         Serial.flush();
         delay(100);
     }
 
-    Serial.println();
-    Serial.println("Initialization complete!");
-    Serial.println("Starting PI control loop on Core 1 at 50 Hz...");
-    Serial.println();
+    TLOG("Initialization complete!");
+    TLOG("Starting pressure loop at %u Hz, supervisory loop at %u Hz on Core 1...",
+         boot_params.inner_rate_hz, boot_params.outer_rate_hz);
     Serial.flush();
-        Serial.println("Put all motors in contact with the head");
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorForward(i,60);
-    }
-    delay(3000);
-    Serial.println("Release the pressure");
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorBrake(i);
-        motorReverse(i,60);
-    }
-    delay(500);
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorBrake(i);
-    }
-    Serial.println("Store pretension value");
-    readAllPadsMilliVolts(prestress_mv, PP_SAMPLES);
-
-    // Print prestress values
-    Serial.print("Prestress (mV): ");
-    for (int i = 0; i < NUM_MOTORS; i++) {
-        Serial.print("M");
-        Serial.print(i + 1);
-        Serial.print("=");
-        Serial.print(prestress_mv[i]);
-        if (i < NUM_MOTORS - 1) Serial.print(", ");
-    }
-    Serial.println();
-
-    // ========================================================================
-    // Capture max stress at 100% PWM (2 measurements averaged)
-    // ========================================================================
-    uint16_t maxstress_measure1[NUM_MOTORS] = {0};
-    uint16_t maxstress_measure2[NUM_MOTORS] = {0};
-
-    // First measurement
-    Serial.println("\n[1/2] Applying 100% PWM to capture max stress...");
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorForward(i, 100);  // 100% PWM
-    }
-    delay(3000);  // Wait for pressure to stabilize
-
-    // Read first max stress values
-    readAllPadsMilliVolts(maxstress_measure1, PP_SAMPLES);
-
-    // Print first measurement
-    Serial.print("Maxstress #1 (mV): ");
-    for (int i = 0; i < NUM_MOTORS; i++) {
-        Serial.print("M");
-        Serial.print(i + 1);
-        Serial.print("=");
-        Serial.print(maxstress_measure1[i]);
-        if (i < NUM_MOTORS - 1) Serial.print(", ");
-    }
-    Serial.println();
-
-    // Release pressure
-    Serial.println("Releasing pressure...");
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorBrake(i);
-        motorReverse(i, 60);
-    }
-    delay(500);
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorBrake(i);
-    }
-    delay(1000);  // Wait before second measurement
-
-    // Second measurement
-    Serial.println("\n[2/2] Applying 100% PWM to capture max stress...");
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorForward(i, 100);  // 100% PWM
-    }
-    delay(3000);  // Wait for pressure to stabilize
-
-    // Read second max stress values
-    readAllPadsMilliVolts(maxstress_measure2, PP_SAMPLES);
-
-    // Print second measurement
-    Serial.print("Maxstress #2 (mV): ");
-    for (int i = 0; i < NUM_MOTORS; i++) {
-        Serial.print("M");
-        Serial.print(i + 1);
-        Serial.print("=");
-        Serial.print(maxstress_measure2[i]);
-        if (i < NUM_MOTORS - 1) Serial.print(", ");
-    }
-    Serial.println();
-
-    // Stop all motors
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorBrake(i);
-    }
-
-    // Calculate average of both measurements
-    for (int i = 0; i < NUM_MOTORS; i++) {
-        maxstress_mv[i] = (maxstress_measure1[i] + maxstress_measure2[i]) / 2;
-    }
-
-    // Print averaged maxstress values
-    Serial.print("Maxstress AVG (mV): ");
-    for (int i = 0; i < NUM_MOTORS; i++) {
-        Serial.print("M");
-        Serial.print(i + 1);
-        Serial.print("=");
-        Serial.print(maxstress_mv[i]);
-        if (i < NUM_MOTORS - 1) Serial.print(", ");
-    }
-    Serial.println();
-
-    // Release pressure after max stress capture
-    Serial.println("Releasing pressure...");
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorReverse(i, 60);
+    // A freshly written image restores the stored calibration instead of
+    // driving the motors through the ~20 s sequence again
+    if (otaIsUpdateBoot() && loadPadCalibration(prestress_mv, maxstress_mv, step_models)) {
+        TLOG("Pad calibration restored from NVS (firmware update boot)");
+    } else {
+        runPadCalibration();
+        if (!savePadCalibration(prestress_mv, maxstress_mv, step_models)) {
+            TLOG("WARNING: could not store pad calibration");
+        }
     }
-    delay(500);
-    for (int i = 0; i < NUM_MOTORS; ++i) {
-        motorBrake(i);
+    calibration_ok = padCalibrationUsable(prestress_mv, maxstress_mv);
+
+    // The coupling matrix is only needed by the decoupler: measured once,
+    // then kept in NVS until DIAG:COUPLING:RESET
+    if (loadCouplingMatrix(&coupling)) {
+        TLOG("Coupling matrix restored from NVS");
+    } else if (boot_params.decouple && calibration_ok) {
+        runCouplingTest();
+        if (!saveCouplingMatrix(coupling)) {
+            TLOG("WARNING: could not store coupling matrix");
+        }
     }
+    setStepModels(step_models);
+    setCouplingMatrix(coupling);
 
     // Small delay before starting control loop
     delay(3000);
+
+    // Motors stay braked until loop() publishes the first command
+    initPressureLoop(prestress_mv, maxstress_mv);
+
+    // Announce build info and packet layout to any connected client
+    sendDeviceInfo();
 }
 
 // ============================================================================
-// Main Loop (Core 1 - PI Control)
+// Main Loop (Core 1 - Supervisory Loop)
 // ============================================================================
 
 void loop() {
@@ -473,58 +562,82 @@ void loop() {
 
     uint32_t current_time = millis();
 
-    // Run control loop at fixed frequency (50 Hz)
-    if (current_time - last_control_ms >= CTRL_DT_MS) {
+    // Take one consistent copy of the runtime parameters for this tick
+    ParamSnapshot params;
+    paramSnapshot(&params);
+
+    // Run the supervisory loop at OUTER_RATE_HZ (pads and PI run in the
+    // pressure loop task, see control/pressure_loop.h)
+    if (current_time - last_control_ms >= 1000 / params.outer_rate_hz) {
         last_control_ms = current_time;
+        uint32_t start_us = micros();
+
+        // Heartbeat for the supervisory deadline (also while OTA holds the
+        // motors: loop() keeps serving chunks)
+        static uint32_t supervised_rate_hz = 0;
+        if (params.outer_rate_hz != supervised_rate_hz) {
+            supervised_rate_hz = params.outer_rate_hz;
+            setOuterWatchdogPeriod(1000000UL / supervised_rate_hz);
+        }
+        outerWatchdogKick();
+
+        // The pressure loop holds all motors while a firmware image is
+        // written; nothing is published until OTA:END or OTA:ABORT
+        if (otaInProgress()) {
+            return;
+        }
+
+        // Full CPU speed for the tick body (released below)
+        pmLockAcquire(PM_LOCK_CONTROL);
 
         // ====================================================================
-        // Step 1: Read all pressure pads
+        // Step 1: Latest pressures from the pressure loop
         // ====================================================================
 
-        readAllPadsMilliVolts(pressure_pads_mv, PP_SAMPLES);
-
-        // Map each pressure pad to normalized 0-100 range
-        for (int i = 0; i < NUM_MOTORS; ++i) {
-            pressure_normalized[i] = mapPressureToPercent(i, pressure_pads_mv[i]);
-        }
+        getPressureReadings(pressure_normalized, NULL);
 
         // Print normalized pressure values (0-100%)
-        Serial.print("Pressure (%): ");
-        for (int i = 0; i < NUM_MOTORS; i++) {
-            Serial.print("M");
-            Serial.print(i + 1);
-            Serial.print("=");
-            Serial.print(pressure_normalized[i], 1);  // 1 decimal place
-            if (i < NUM_MOTORS - 1) Serial.print(", ");
+        TLOG("Pressure (%%): M1=%.1f, M2=%.1f, M3=%.1f, M4=%.1f, M5=%.1f",
+             pressure_normalized[0], pressure_normalized[1], pressure_normalized[2], pressure_normalized[3], pressure_normalized[4]);
+
+        // Over-pressure trips since the last tick (the sampler ISR brakes, we log)
+        static uint32_t logged_trips[NUM_PRESSURE_PADS] = {0};
+        OverpressureStats overpressure;
+        getOverpressureStats(&overpressure);
+        for (int i = 0; i < NUM_PRESSURE_PADS; ++i) {
+            if (overpressure.trips[i] != logged_trips[i]) {
+                if (overpressure.trips[i] > logged_trips[i]) {
+                    TLOG("Over-pressure M%d: %u mV >= %u mV, braked (%u trips)", i + 1,
+                         overpressure.trip_mv[i], overpressure.limit_mv[i], overpressure.trips[i]);
+                }
+                logged_trips[i] = overpressure.trips[i];  // Also follows DIAG:OVERPRESSURE:RESET
+            }
         }
-        Serial.println();
 
         // ====================================================================
         // Step 1b: Read potentiometers and calculate force scale
         // ====================================================================
 
-        for (int i = 0; i < NUM_POTENTIOMETERS; ++i) {
-            potentiometer_mv[i] = readMuxMilliVoltsAveraged(POT_CHANNELS[i], POT_SAMPLES);
+        // The mux is shared with the pressure loop: keep the previous
+        // readings if it is busy
+        if (lockMux(10)) {
+            for (int i = 0; i < NUM_POTENTIOMETERS; ++i) {
+                potentiometer_mv[i] = readMuxMilliVoltsAveraged(POT_CHANNELS[i], POT_SAMPLES);
+            }
+            unlockMux();
         }
 
         // DEBUG: Print potentiometer raw values
-        Serial.print("POT mV: P1=");
-        Serial.print(potentiometer_mv[0]);
-        Serial.print(" (ch");
-        Serial.print(POT_CHANNELS[0]);
-        Serial.print("), P2=");
-        Serial.print(potentiometer_mv[1]);
-        Serial.print(" (ch");
-        Serial.print(POT_CHANNELS[1]);
-        Serial.println(")");
+        TLOG("POT mV: P1=%u (ch%u), P2=%u (ch%u)",
+             potentiometer_mv[0], POT_CHANNELS[0], potentiometer_mv[1], POT_CHANNELS[1]);
 
         // Calculate force scale from potentiometer 1 (index 0)
         // Scale ranges from 0.60 (pot at min) to 1.00 (pot at max)
-        force_scale = calculateForceScale(potentiometer_mv[0]);
+        force_scale = calculateForceScale(potentiometer_mv[0], params.force_scale_min, params.force_scale_max);
 
         // Calculate distance scale from potentiometer 2 (index 1)
         // Scale ranges from 0.50 (pot at min) to 1.50 (pot at max)
-        distance_scale = calculateDistanceScale(potentiometer_mv[1]);
+        distance_scale = calculateDistanceScale(potentiometer_mv[1], params.dist_scale_min, params.dist_scale_max);
 
         // Update dynamic distance thresholds based on potentiometer 2
         // Formula: threshold = 50 + (base - 50) * scale
@@ -568,7 +681,7 @@ void loop() {
             // ================================================================
 
             // Get base setpoint and apply force scale from potentiometer
-            float base_setpoint = calculateSetpoint(current_range[i], 0.0f);
+            float base_setpoint = calculateSetpoint(current_range[i], 0.0f, params);
             if (base_setpoint > 0.0f) {
                 setpoints[i] = base_setpoint * force_scale;
             } else {
@@ -583,106 +696,55 @@ void loop() {
         // Step 6: State machine for out-of-range handling (per motor)
         // ====================================================================
 
-        // Independent state machine per motor
-        // Prepare arrays for PI control (only motors in NORMAL_OPERATION)
-        float temp_setpoints[NUM_MOTORS];
-        float temp_pressures[NUM_MOTORS];
-        float temp_duties[NUM_MOTORS] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        // Evaluate all motors in one pass (see safety_state_machine.h)
+        SafetyInputs safety_inputs[NUM_MOTORS];
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            safety_inputs[i].out_of_bounds = (current_range[i] == RANGE_OUT_OF_BOUNDS ||
+                                              setpoints[i] < 0.0f);
+            safety_inputs[i].valid = !(current_range[i] == RANGE_OUT_OF_BOUNDS ||
+                                       current_range[i] == RANGE_UNKNOWN ||
+                                       setpoints[i] < 0.0f);
+            safety_inputs[i].pressure_pct = pressure_normalized[i];
+        }
+        safetyStep(safety_inputs, params, current_time);
 
-        // Track state transitions for each motor
-        // Simplified: OUT_OF_BOUNDS -> reverse for RELEASE_TIME_MS -> wait for valid
+        // Actuation time is counted against the state each motor is in
+        static_assert(WAITING_FOR_VALID_READING + 1 == MOTOR_STATE_SLOTS,
+                      "MOTOR_STATE_SLOTS must cover every SystemState");
         for (int i = 0; i < NUM_MOTORS; ++i) {
-            int state_index = i;  // Each motor uses own state
-
-            // Check if this motor is out of bounds or has invalid setpoint
-            bool is_out_of_bounds = (current_range[i] == RANGE_OUT_OF_BOUNDS ||
-                                     setpoints[i] < 0.0f);
-            bool is_valid = !(current_range[i] == RANGE_OUT_OF_BOUNDS ||
-                             current_range[i] == RANGE_UNKNOWN ||
-                             setpoints[i] < 0.0f);
-
-            switch (current_state[state_index]) {
-                case NORMAL_OPERATION:
-                    if (is_out_of_bounds) {
-                        // Transition to deflating state and start timer immediately
-                        current_state[state_index] = OUT_OF_RANGE_DEFLATING;
-                        reverse_start_time[state_index] = current_time;
-                        duty_cycles[i] = -REVERSE_DUTY_PCT;
-                    }
-                    else {
-                        // Prepare for PI control (using normalized values 0-100%)
-                        temp_setpoints[i] = setpoints[i];
-                        temp_pressures[i] = pressure_normalized[i];
-                    }
-                    break;
-
-                case OUT_OF_RANGE_DEFLATING:
-                    // Priority 1: If distance is now valid, return to normal operation
-                    if (is_valid) {
-                        current_state[state_index] = NORMAL_OPERATION;
-                        duty_cycles[i] = 0.0f;
-                    }
-                    // Priority 2: Reverse for fixed time, then wait
-                    else if (current_time - reverse_start_time[state_index] >= RELEASE_TIME_MS) {
-                        current_state[state_index] = WAITING_FOR_VALID_READING;
-                        duty_cycles[i] = 0.0f;
-                    }
-                    // Still deflating
-                    else {
-                        duty_cycles[i] = -REVERSE_DUTY_PCT;
-                    }
-                    break;
-
-                case OUT_OF_RANGE_RELEASING:
-                    // State no longer used, but kept for compatibility
-                    // Immediately transition to waiting
-                    current_state[state_index] = WAITING_FOR_VALID_READING;
-                    duty_cycles[i] = 0.0f;
-                    break;
-
-                case WAITING_FOR_VALID_READING:
-                    // Return to normal when distance is valid
-                    if (is_valid) {
-                        current_state[state_index] = NORMAL_OPERATION;
-                    }
-                    else {
-                        // Still waiting - motor stopped
-                        duty_cycles[i] = 0.0f;
-                    }
-                    break;
-            }
+            motorSetAccountingState(i, (uint8_t)getSafetyState(i));
         }
 
-        // Run PI control only for motors in NORMAL_OPERATION state
-        // Using normalized values (0-100%) for both setpoints and pressure readings
-        controlStepNormalized(temp_setpoints, temp_pressures, temp_duties);
+        // Distance summary (readings not yet initialized are skipped)
+        float distances[NUM_MOTORS];
+        bool distance_valid[NUM_MOTORS];
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            distances[i] = shared_tof_distances[i];
+            distance_valid[i] = distances[i] < 999.0f;
+        }
+        statsRecord(STATS_DISTANCE, distances, distance_valid);
 
-        // Apply motor commands based on state (AFTER PI control to override for non-NORMAL motors)
+        // ====================================================================
+        // Step 7: Hand setpoints and motor outputs to the pressure loop
+        // ====================================================================
+
+        PressureCommand command;
         for (int i = 0; i < NUM_MOTORS; ++i) {
-            if (current_state[i] == NORMAL_OPERATION) {
-                // Use PI controller output
-                duty_cycles[i] = temp_duties[i];
-                // PI controller already applied motor commands in controlStep
-            }
-            else if (current_state[i] == OUT_OF_RANGE_DEFLATING ||
-                     current_state[i] == OUT_OF_RANGE_RELEASING) {
-                // Override with deflation/release command (all reverse)
-                motorReverse(i, REVERSE_DUTY_PCT);
-            }
-            else {
-                // WAITING_FOR_VALID_READING - motor stopped
-                motorBrake(i);
-            }
+            command.setpoint_pct[i] = setpoints[i];
+            command.output[i] = (uint8_t)getSafetyOutput(i);
+            command.priority[i] = budgetPriority(current_range[i]);
+            command.engage_seq[i] = getSafetyEngageSeq(i);
         }
+        command.reverse_duty_pct = params.reverse_duty_pct;
+        publishPressureCommand(command);
 
         // ====================================================================
-        // Step 7: Update shared variables for logging (Core 0 task)
+        // Step 8: Update shared variables for logging (Core 0 task)
         // ====================================================================
 
+        // Pressure and duty are written by the pressure loop
         for (int i = 0; i < NUM_MOTORS; ++i) {
             shared_setpoints_pct[i] = setpoints[i];        // Setpoint in % (0-100)
-            shared_pressure_pct[i] = pressure_normalized[i];  // Normalized pressure (0-100%)
-            shared_duty_cycles[i] = duty_cycles[i];
         }
 
         // Update potentiometer scales and distance thresholds for logging
@@ -691,8 +753,40 @@ void loop() {
         shared_dist_close_max = distance_close_max;
         shared_dist_medium_max = distance_medium_max;
         shared_dist_far_max = distance_far_max;
+
+        // Validate or roll back a freshly written image after a few seconds
+        otaSelfTestTick(calibration_ok);
+
+        // Persist the actuation counters (one NVS write per period). The
+        // write stalls both cores, so a due save waits until every motor is
+        // braked or idle.
+        if (current_time - last_motor_stats_save_ms >= MOTOR_STATS_SAVE_MS && motorsAtRest()) {
+            last_motor_stats_save_ms = current_time;
+            if (!saveMotorCounters()) {
+                TLOG("Motor stats: NVS save failed");
+            }
+        }
+
+        // Light sleep only while nothing is driven (LEDC and sensor UARTs stop)
+        bool outputs_active = sweep_enabled;
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            outputs_active = outputs_active || shared_duty_cycles[i] != 0.0f;
+        }
+        powerTick(params.power_mode, outputs_active);
+
+        loopTimingRecord(LOOP_OUTER, start_us, micros(), params.outer_rate_hz);
+        pmLockRelease(PM_LOCK_CONTROL);
     }
 
-    // Small delay to prevent watchdog triggers
-    delay(1);
+    // Sleep until the next tick, polling commands every LOOP_IDLE_POLL_MS
+    // (every 1 ms while an OTA transfer streams chunks)
+    uint32_t period_ms = 1000 / params.outer_rate_hz;
+    uint32_t elapsed_ms = millis() - last_control_ms;
+    uint32_t wait_ms = elapsed_ms < period_ms ? period_ms - elapsed_ms : 1;
+    if (otaInProgress()) {
+        wait_ms = 1;
+    } else if (wait_ms > LOOP_IDLE_POLL_MS) {
+        wait_ms = LOOP_IDLE_POLL_MS;
+    }
+    delay(wait_ms);
 }
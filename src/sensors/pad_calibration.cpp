@@ -0,0 +1,138 @@
+/**
+ * @file pad_calibration.cpp
+ * @brief Implementation of the pressure pad calibration store
+ */
+
+#include "pad_calibration.h"
+#include "../utils/binary_protocol.h"
+#include <Preferences.h>
+
+// ============================================================================
+// NVS Storage
+// ============================================================================
+
+constexpr const char* NVS_NAMESPACE = "padcal";
+constexpr const char* NVS_KEY = "blob";
+constexpr const char* NVS_COUPLING_KEY = "coupling";
+constexpr uint16_t PAD_CAL_VERSION = 4;         // 2: step test models, 3: coupling matrix, 4: matrix moved out
+constexpr uint16_t COUPLING_VERSION = 1;
+
+struct __attribute__((packed)) PadCalibrationBlob {
+    uint16_t version;            // PAD_CAL_VERSION
+    uint8_t num_motors;          // NUM_MOTORS when stored
+    uint16_t prestress_mv[NUM_MOTORS];
+    uint16_t maxstress_mv[NUM_MOTORS];
+    StepModel step_models[NUM_MOTORS];
+    uint16_t crc;                // CRC-16 over everything above
+};
+
+struct __attribute__((packed)) CouplingBlob {
+    uint16_t version;            // COUPLING_VERSION
+    uint8_t num_motors;          // NUM_MOTORS when stored
+    CouplingMatrix coupling;
+    uint16_t crc;                // CRC-16 over everything above
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+bool savePadCalibration(const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS],
+                        const StepModel step_models[NUM_MOTORS]) {
+    PadCalibrationBlob blob;
+    blob.version = PAD_CAL_VERSION;
+    blob.num_motors = NUM_MOTORS;
+    memcpy(blob.prestress_mv, prestress_mv, sizeof(blob.prestress_mv));
+    memcpy(blob.maxstress_mv, maxstress_mv, sizeof(blob.maxstress_mv));
+    memcpy(blob.step_models, step_models, sizeof(blob.step_models));
+    blob.crc = calculateCRC16((const uint8_t*)&blob, offsetof(PadCalibrationBlob, crc));
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+    size_t written = prefs.putBytes(NVS_KEY, &blob, sizeof(blob));
+    prefs.end();
+    return written == sizeof(blob);
+}
+
+bool loadPadCalibration(uint16_t prestress_mv[NUM_MOTORS], uint16_t maxstress_mv[NUM_MOTORS],
+                        StepModel step_models[NUM_MOTORS]) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        return false;
+    }
+
+    PadCalibrationBlob blob;
+    bool ok = prefs.getBytesLength(NVS_KEY) == sizeof(blob) &&
+              prefs.getBytes(NVS_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    if (!ok || blob.version != PAD_CAL_VERSION || blob.num_motors != NUM_MOTORS) {
+        return false;
+    }
+    if (calculateCRC16((const uint8_t*)&blob, offsetof(PadCalibrationBlob, crc)) != blob.crc) {
+        return false;
+    }
+
+    memcpy(prestress_mv, blob.prestress_mv, sizeof(blob.prestress_mv));
+    memcpy(maxstress_mv, blob.maxstress_mv, sizeof(blob.maxstress_mv));
+    memcpy(step_models, blob.step_models, sizeof(blob.step_models));
+    return true;
+}
+
+bool saveCouplingMatrix(const CouplingMatrix& coupling) {
+    CouplingBlob blob;
+    blob.version = COUPLING_VERSION;
+    blob.num_motors = NUM_MOTORS;
+    blob.coupling = coupling;
+    blob.crc = calculateCRC16((const uint8_t*)&blob, offsetof(CouplingBlob, crc));
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+    size_t written = prefs.putBytes(NVS_COUPLING_KEY, &blob, sizeof(blob));
+    prefs.end();
+    return written == sizeof(blob);
+}
+
+bool loadCouplingMatrix(CouplingMatrix* coupling) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        return false;
+    }
+
+    CouplingBlob blob;
+    bool ok = prefs.getBytesLength(NVS_COUPLING_KEY) == sizeof(blob) &&
+              prefs.getBytes(NVS_COUPLING_KEY, &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    if (!ok || blob.version != COUPLING_VERSION || blob.num_motors != NUM_MOTORS) {
+        return false;
+    }
+    if (calculateCRC16((const uint8_t*)&blob, offsetof(CouplingBlob, crc)) != blob.crc) {
+        return false;
+    }
+
+    *coupling = blob.coupling;
+    return true;
+}
+
+void eraseCouplingMatrix() {
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(NVS_COUPLING_KEY);
+        prefs.end();
+    }
+}
+
+bool padCalibrationUsable(const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS]) {
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        // Same margin as mapPressureToPercent() (95% of max)
+        if ((float)maxstress_mv[i] * 0.95f <= (float)prestress_mv[i]) {
+            return false;
+        }
+    }
+    return true;
+}
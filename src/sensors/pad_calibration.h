@@ -0,0 +1,72 @@
+/**
+ * @file pad_calibration.h
+ * @brief NVS copy of the pressure pad calibration
+ *
+ * The boot calibration (pre-stress and max-stress per motor) takes about
+ * 20 s of motor movement. Its result is stored after every calibration so
+ * that a reboot into a freshly written firmware image (see ota_update.h)
+ * can restore it instead of running the sequence again. The step test
+ * models of the Smith predictors (control/smith_predictor.h) are part of
+ * the same sequence and stored with it.
+ *
+ * The pad coupling matrix (control/decoupler.h) has its own key: it is
+ * only measured when the decoupler is enabled and no stored matrix exists,
+ * and is kept across every boot until DIAG:COUPLING:RESET erases it.
+ */
+
+#ifndef PAD_CALIBRATION_H
+#define PAD_CALIBRATION_H
+
+#include <Arduino.h>
+#include "../config/pins.h"
+#include "../control/smith_predictor.h"
+#include "../control/decoupler.h"
+
+/**
+ * @brief Store the calibration in NVS
+ * @param prestress_mv Pre-stress per motor (mV)
+ * @param maxstress_mv Max stress per motor (mV)
+ * @param step_models Step test model per motor
+ * @return true on success
+ */
+bool savePadCalibration(const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS],
+                        const StepModel step_models[NUM_MOTORS]);
+
+/**
+ * @brief Load the stored calibration
+ *
+ * Outputs are only written when a valid copy is found.
+ *
+ * @param prestress_mv Output pre-stress per motor (mV)
+ * @param maxstress_mv Output max stress per motor (mV)
+ * @param step_models Output step test model per motor
+ * @return true if a valid copy was loaded
+ */
+bool loadPadCalibration(uint16_t prestress_mv[NUM_MOTORS], uint16_t maxstress_mv[NUM_MOTORS],
+                        StepModel step_models[NUM_MOTORS]);
+
+/**
+ * @brief Store the pad coupling matrix in NVS
+ * @return true on success
+ */
+bool saveCouplingMatrix(const CouplingMatrix& coupling);
+
+/**
+ * @brief Load the stored pad coupling matrix
+ * @param coupling Output matrix, only written when a valid copy is found
+ * @return true if a valid copy was loaded
+ */
+bool loadCouplingMatrix(CouplingMatrix* coupling);
+
+/**
+ * @brief Erase the stored pad coupling matrix (measured again at next boot)
+ */
+void eraseCouplingMatrix();
+
+/**
+ * @brief Check that a calibration can be used for normalization
+ * @return true if every motor's max stress is above its pre-stress
+ */
+bool padCalibrationUsable(const uint16_t prestress_mv[NUM_MOTORS], const uint16_t maxstress_mv[NUM_MOTORS]);
+
+#endif // PAD_CALIBRATION_H
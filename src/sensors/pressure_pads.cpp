@@ -6,6 +6,58 @@
 #include "pressure_pads.h"
 #include "../utils/multiplexer.h"
 #include "../config/pins.h"
+#include "../actuators/motors.h"
+#include <math.h>
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief One conversion at the quietest PWM phase
+ *
+ * Falls back to an immediate conversion if the phase is not reached in
+ * PP_SYNC_TIMEOUT_US (counted in phase_misses when provided).
+ */
+static uint16_t readPhaseSyncedMilliVolts(uint16_t* phase_misses) {
+    uint16_t center, half_width;
+    if (getPwmQuietWindow(&center, &half_width) &&
+        !waitForPwmPhase(center, half_width, PP_SYNC_TIMEOUT_US) &&
+        phase_misses != NULL) {
+        (*phase_misses)++;
+    }
+    return analogReadMilliVolts(MUX_SIG);
+}
+
+/**
+ * @brief Average of conversions on one pad
+ *
+ * Holds the mux claim for this pad only, so the over-pressure sampler
+ * gets its slots between pads.
+ */
+static uint16_t readChannel(uint8_t pad_index, int samples) {
+    muxBeginRead();
+    setMuxChannel(PP_CHANNELS[pad_index]);
+    delayMicroseconds(MUX_SETTLE_US);  // Wait for multiplexer to settle
+
+    uint32_t accumulator = 0;
+    for (int i = 0; i < samples; ++i) {
+        uint16_t mv;
+        if (PP_SAMPLE_SYNC) {
+            mv = readPhaseSyncedMilliVolts(NULL);
+        } else {
+            mv = analogReadMilliVolts(MUX_SIG);
+            delayMicroseconds(50);  // Same spacing as readMuxMilliVoltsAveraged()
+        }
+        accumulator += mv;
+    }
+    muxEndRead();
+    return static_cast<uint16_t>(accumulator / samples);
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
 
 void initPressurePads() {
     // Initialize the multiplexer (handles all ADC configuration)
@@ -15,8 +67,7 @@ void initPressurePads() {
 void readAllPadsMilliVolts(uint16_t* dest, int samples) {
     // Read each pressure pad sequentially through multiplexer
     for (int i = 0; i < NUM_PRESSURE_PADS; ++i) {
-        uint8_t channel = PP_CHANNELS[i];
-        dest[i] = readMuxMilliVoltsAveraged(channel, samples);
+        dest[i] = readChannel(i, samples);
     }
 }
 
@@ -27,8 +78,7 @@ uint16_t readSinglePadMilliVolts(uint8_t pad_index, int samples) {
     }
 
     // Read the specified pressure pad
-    uint8_t channel = PP_CHANNELS[pad_index];
-    return readMuxMilliVoltsAveraged(channel, samples);
+    return readChannel(pad_index, samples);
 }
 
 float millivoltsToNewtons(uint8_t pad_index, uint16_t millivolts) {
@@ -84,3 +134,49 @@ float readSinglePadNewtons(uint8_t pad_index, int samples) {
     uint16_t mv = readSinglePadMilliVolts(pad_index, samples);
     return millivoltsToNewtons(pad_index, mv);
 }
+
+void measurePadNoise(uint8_t pad_index, int samples, bool synchronous, PadNoiseStats* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->mean_mv = 0.0f;
+    stats->stddev_mv = 0.0f;
+    stats->min_mv = 0xFFFF;
+    stats->max_mv = 0;
+    stats->phase_misses = 0;
+    if (pad_index >= NUM_PRESSURE_PADS || samples <= 0) {
+        return;
+    }
+
+    // Welford's running mean/variance
+    float mean = 0.0f;
+    float m2 = 0.0f;
+    for (int i = 0; i < samples; ++i) {
+        // Claim the mux in blocks of PP_SAMPLES so the over-pressure sampler
+        // keeps running during long measurements
+        if (i % PP_SAMPLES == 0) {
+            if (i > 0) {
+                muxEndRead();
+            }
+            muxBeginRead();
+            setMuxChannel(PP_CHANNELS[pad_index]);
+            delayMicroseconds(MUX_SETTLE_US);  // Wait for multiplexer to settle
+        }
+        uint16_t mv;
+        if (synchronous) {
+            mv = readPhaseSyncedMilliVolts(&stats->phase_misses);
+        } else {
+            mv = analogReadMilliVolts(MUX_SIG);
+            delayMicroseconds(50);  // Same spacing as readMuxMilliVoltsAveraged()
+        }
+        float delta = (float)mv - mean;
+        mean += delta / (float)(i + 1);
+        m2 += delta * ((float)mv - mean);
+        if (mv < stats->min_mv) stats->min_mv = mv;
+        if (mv > stats->max_mv) stats->max_mv = mv;
+    }
+    muxEndRead();
+
+    stats->mean_mv = mean;
+    stats->stddev_mv = (samples > 1) ? sqrtf(m2 / (float)(samples - 1)) : 0.0f;
+}
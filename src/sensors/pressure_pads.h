@@ -8,6 +8,10 @@
  *
  * Force calibration formula: Force (N) = S × (mV_read - Ro) × 9.81 × 10⁻³
  * where S is the slope and Ro is the offset for each pressure pad.
+ *
+ * With PP_SAMPLE_SYNC each conversion is started at the quietest phase of
+ * the motor PWM period instead of at an arbitrary time, so the averaged
+ * samples no longer have to absorb switching spikes.
  */
 
 #ifndef PRESSURE_PADS_H
@@ -52,6 +56,21 @@ constexpr float GRAVITY_MPS2 = 9.81f;
 // Conversion factor: grams to Newtons (× 10⁻³)
 constexpr float GRAMS_TO_NEWTONS = 0.001f;
 
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Spread of single (unaveraged) conversions on one pad
+ */
+struct PadNoiseStats {
+    float mean_mv;
+    float stddev_mv;
+    uint16_t min_mv;
+    uint16_t max_mv;
+    uint16_t phase_misses;       // Synchronous samples taken after a phase timeout
+};
+
 // ============================================================================
 // Public Functions
 // ============================================================================
@@ -127,4 +146,18 @@ void readAllPadsNewtons(float* dest, int samples = 8);
  */
 float readSinglePadNewtons(uint8_t pad_index, int samples = 8);
 
+/**
+ * @brief Measure conversion noise on one pad (DIAG:ADCNOISE)
+ *
+ * Takes single conversions without averaging, either phase-synchronized
+ * to the motor PWM or free-running with the usual spacing, so both modes
+ * can be compared on the running rig. The caller holds the mux lock.
+ *
+ * @param pad_index Pressure pad index (0 to NUM_PRESSURE_PADS-1)
+ * @param samples Number of conversions
+ * @param synchronous true for PWM-synchronized sampling
+ * @param stats Output statistics
+ */
+void measurePadNoise(uint8_t pad_index, int samples, bool synchronous, PadNoiseStats* stats);
+
 #endif // PRESSURE_PADS_H
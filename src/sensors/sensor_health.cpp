@@ -0,0 +1,281 @@
+/**
+ * @file sensor_health.cpp
+ * @brief Implementation of the range sensor health monitor
+ */
+
+#include "sensor_health.h"
+#include "ultrasonic_sensor.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+/**
+ * @brief Per-sensor stuck detector settings
+ *
+ * The HRLV clamps anything closer than its minimum to that minimum, and
+ * the serial output of the cm variants has 1 cm steps: both can
+ * legitimately repeat.
+ */
+struct StuckLimits {
+    bool enabled;
+    float floor_cm;                // Values at or below this are never stuck
+};
+
+static const StuckLimits STUCK_LIMITS[HEALTH_SENSOR_COUNT] = {
+    {true, 0.0f},                                        // TOF: mm resolution, always jitters
+    {ULTRASONIC_MODE != MODE_SERIAL, ULTRASONIC_MIN_CM}  // Ultrasonic
+};
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct HealthState {
+    SensorStatus status;
+    SensorFault fault;
+    uint32_t reads;
+    uint32_t timeouts;
+    uint32_t checksum_errors;
+    uint32_t out_of_range;
+    uint32_t stuck_events;
+    uint32_t failures;
+
+    // Last HEALTH_WINDOW reads, one bit per read (bit 0 = newest)
+    uint32_t window_timeout;
+    uint32_t window_checksum;
+    uint32_t window_out_of_range;
+    uint8_t window_fill;
+
+    uint8_t hard_in_row;           // Timeouts/checksum errors in a row
+    uint8_t ok_in_row;             // Good reads in a row while FAILED
+    uint16_t out_of_range_in_row;
+
+    float stuck_value;
+    uint32_t stuck_since_ms;
+    uint16_t stuck_reads;
+
+    uint32_t rate_start_ms;
+    uint16_t rate_count;
+    float rate_hz;
+
+    uint32_t last_probe_ms;
+    bool probe_due;
+};
+
+static HealthState state[HEALTH_SENSOR_COUNT];
+static portMUX_TYPE health_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static void declareFailed(HealthState& s, SensorFault fault, uint32_t now) {
+    s.status = SENSOR_STATUS_FAILED;
+    s.fault = fault;
+    s.failures++;
+    s.ok_in_row = 0;
+    s.last_probe_ms = now;
+    s.probe_due = false;
+}
+
+/**
+ * @brief Percentage of set bits over the filled part of the window
+ */
+static uint8_t windowPct(uint32_t bits, uint8_t fill) {
+    if (fill == 0) {
+        return 0;
+    }
+    return (uint8_t)(__builtin_popcount(bits) * 100 / fill);
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void sensorHealthRecord(HealthSensor sensor, ReadOutcome outcome, float value) {
+    if (sensor >= HEALTH_SENSOR_COUNT) {
+        return;
+    }
+    uint32_t now = millis();
+    const StuckLimits& limits = STUCK_LIMITS[sensor];
+
+    portENTER_CRITICAL(&health_mux);
+    HealthState& s = state[sensor];
+    s.reads++;
+
+    s.window_timeout = (s.window_timeout << 1) | (outcome == READ_TIMEOUT ? 1u : 0u);
+    s.window_checksum = (s.window_checksum << 1) | (outcome == READ_CHECKSUM ? 1u : 0u);
+    s.window_out_of_range = (s.window_out_of_range << 1) | (outcome == READ_OUT_OF_RANGE ? 1u : 0u);
+    if (s.window_fill < HEALTH_WINDOW) {
+        s.window_fill++;
+    }
+
+    // Read rate: valid reads per HEALTH_RATE_PERIOD_MS
+    if (now - s.rate_start_ms >= HEALTH_RATE_PERIOD_MS) {
+        s.rate_hz = s.rate_count * 1000.0f / (float)(now - s.rate_start_ms);
+        s.rate_start_ms = now;
+        s.rate_count = 0;
+    }
+
+    bool hard = (outcome == READ_TIMEOUT || outcome == READ_CHECKSUM);
+    if (outcome == READ_TIMEOUT) {
+        s.timeouts++;
+    } else if (outcome == READ_CHECKSUM) {
+        s.checksum_errors++;
+    } else if (outcome == READ_OUT_OF_RANGE) {
+        s.out_of_range++;
+    } else {
+        s.rate_count++;
+    }
+
+    s.hard_in_row = hard ? (uint8_t)(s.hard_in_row + 1) : 0;
+    s.out_of_range_in_row = (outcome == READ_OUT_OF_RANGE) ? (uint16_t)(s.out_of_range_in_row + 1) : 0;
+
+    // Stuck detector: bit-identical valid values
+    bool stuck = false;
+    bool fresh_value = true;   // OK read that differs from the frozen one
+    if (outcome == READ_OK && limits.enabled && value > limits.floor_cm) {
+        if (s.stuck_reads > 0 && value == s.stuck_value) {
+            fresh_value = false;
+            if (s.stuck_reads < 0xFFFF) {
+                s.stuck_reads++;
+            }
+            stuck = s.stuck_reads >= HEALTH_STUCK_READS && now - s.stuck_since_ms >= HEALTH_STUCK_MS;
+        } else {
+            s.stuck_value = value;
+            s.stuck_since_ms = now;
+            s.stuck_reads = 1;
+        }
+    } else if (outcome != READ_OK) {
+        s.stuck_reads = 0;
+    }
+
+    if (s.status == SENSOR_STATUS_FAILED) {
+        // Recovery: good probes in a row, a stuck sensor must move again
+        bool good = outcome == READ_OK && (s.fault != SENSOR_FAULT_STUCK || fresh_value);
+        s.ok_in_row = good ? (uint8_t)(s.ok_in_row + 1) : 0;
+        s.probe_due = good;
+        if (s.ok_in_row >= HEALTH_RECOVER_READS) {
+            s.status = SENSOR_STATUS_OK;
+            s.hard_in_row = 0;
+            s.window_timeout = 0;
+            s.window_checksum = 0;
+            s.window_fill = 0;
+            s.stuck_reads = 0;
+        }
+    } else {
+        uint32_t window_mask = (s.window_fill >= 32) ? 0xFFFFFFFFu : ((1u << s.window_fill) - 1u);
+        int hard_in_window = __builtin_popcount((s.window_timeout | s.window_checksum) & window_mask);
+        if (s.hard_in_row >= HEALTH_FAIL_CONSECUTIVE || hard_in_window >= HEALTH_FAIL_WINDOW) {
+            int checksums = __builtin_popcount(s.window_checksum & window_mask);
+            int timeouts = __builtin_popcount(s.window_timeout & window_mask);
+            declareFailed(s, checksums > timeouts ? SENSOR_FAULT_CHECKSUMS : SENSOR_FAULT_TIMEOUTS, now);
+        } else if (stuck) {
+            s.stuck_events++;
+            declareFailed(s, SENSOR_FAULT_STUCK, now);
+        } else {
+            s.status = (s.out_of_range_in_row >= HEALTH_NO_TARGET_READS) ? SENSOR_STATUS_NO_TARGET
+                                                                          : SENSOR_STATUS_OK;
+        }
+    }
+    portEXIT_CRITICAL(&health_mux);
+}
+
+bool sensorHealthShouldRead(HealthSensor sensor) {
+    if (sensor >= HEALTH_SENSOR_COUNT) {
+        return false;
+    }
+    uint32_t now = millis();
+    bool read = true;
+    portENTER_CRITICAL(&health_mux);
+    HealthState& s = state[sensor];
+    if (s.status == SENSOR_STATUS_FAILED) {
+        read = s.probe_due || now - s.last_probe_ms >= HEALTH_PROBE_MS;
+        if (read) {
+            s.last_probe_ms = now;
+            s.probe_due = false;
+        }
+    }
+    portEXIT_CRITICAL(&health_mux);
+    return read;
+}
+
+bool sensorHealthOk(HealthSensor sensor) {
+    if (sensor >= HEALTH_SENSOR_COUNT) {
+        return false;
+    }
+    portENTER_CRITICAL(&health_mux);
+    bool ok = state[sensor].status != SENSOR_STATUS_FAILED;
+    portEXIT_CRITICAL(&health_mux);
+    return ok;
+}
+
+SweepHealthMode sensorHealthSweepMode() {
+    bool tof_ok = sensorHealthOk(HEALTH_TOF);
+    bool us_ok = sensorHealthOk(HEALTH_ULTRASONIC);
+    if (tof_ok && us_ok) {
+        return SWEEP_HEALTH_NORMAL;
+    }
+    if (us_ok) {
+        return SWEEP_HEALTH_ULTRASONIC_ONLY;
+    }
+    if (tof_ok) {
+        return SWEEP_HEALTH_TOF_ONLY;
+    }
+    return SWEEP_HEALTH_BLIND;
+}
+
+void getSensorHealth(HealthSensor sensor, SensorHealth* out) {
+    if (sensor >= HEALTH_SENSOR_COUNT || out == NULL) {
+        return;
+    }
+    uint32_t now = millis();
+    portENTER_CRITICAL(&health_mux);
+    HealthState s = state[sensor];
+    portEXIT_CRITICAL(&health_mux);
+
+    out->status = s.status;
+    out->fault = s.fault;
+    // A sensor that is no longer read (skipped, or sweep stopped) has no rate
+    out->rate_hz = (now - s.rate_start_ms < 2 * HEALTH_RATE_PERIOD_MS) ? s.rate_hz : 0.0f;
+    out->timeout_pct = windowPct(s.window_timeout, s.window_fill);
+    out->checksum_pct = windowPct(s.window_checksum, s.window_fill);
+    out->out_of_range_pct = windowPct(s.window_out_of_range, s.window_fill);
+    out->reads = s.reads;
+    out->timeouts = s.timeouts;
+    out->checksum_errors = s.checksum_errors;
+    out->out_of_range = s.out_of_range;
+    out->stuck_events = s.stuck_events;
+    out->failures = s.failures;
+}
+
+const char* sensorStatusName(SensorStatus status) {
+    switch (status) {
+        case SENSOR_STATUS_OK:        return "OK";
+        case SENSOR_STATUS_NO_TARGET: return "NO_TARGET";
+        case SENSOR_STATUS_FAILED:    return "FAILED";
+        default:                      return "UNKNOWN";
+    }
+}
+
+const char* sensorFaultName(SensorFault fault) {
+    switch (fault) {
+        case SENSOR_FAULT_NONE:      return "NONE";
+        case SENSOR_FAULT_TIMEOUTS:  return "TIMEOUTS";
+        case SENSOR_FAULT_CHECKSUMS: return "CHECKSUMS";
+        case SENSOR_FAULT_STUCK:     return "STUCK";
+        default:                     return "UNKNOWN";
+    }
+}
+
+const char* sweepHealthModeName(SweepHealthMode mode) {
+    switch (mode) {
+        case SWEEP_HEALTH_NORMAL:          return "NORMAL";
+        case SWEEP_HEALTH_ULTRASONIC_ONLY: return "ULTRASONIC_ONLY";
+        case SWEEP_HEALTH_TOF_ONLY:        return "TOF_ONLY";
+        case SWEEP_HEALTH_BLIND:           return "BLIND";
+        default:                           return "UNKNOWN";
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file sensor_health.h
+ * @brief Health monitor of the two range sensors and degraded sweep modes
+ *
+ * Every TOF and ultrasonic read reports its outcome here. A sensor is
+ * declared FAILED when:
+ * - HEALTH_FAIL_CONSECUTIVE reads in a row time out or fail the checksum,
+ * - or half of the last HEALTH_WINDOW reads did,
+ * - or it returns the exact same value for HEALTH_STUCK_MS (a frozen
+ *   output; real readings always jitter by a few mm or ADC counts).
+ *
+ * Out-of-range reads are normal in an empty room: a long run of them only
+ * marks the sensor NO_TARGET for telemetry and never degrades the sweep.
+ *
+ * The sweep skips a failed sensor instead of waiting on it (a dead TOF
+ * costs a 1 s timeout per angle) and probes it every HEALTH_PROBE_MS with
+ * a short timeout; HEALTH_RECOVER_READS good probes in a row restore it:
+ *
+ * | TOF    | Ultrasonic | Sweep mode      | Effect                             |
+ * |--------|------------|-----------------|------------------------------------|
+ * | ok     | ok         | NORMAL          | Both fused                         |
+ * | FAILED | ok         | ULTRASONIC_ONLY | Fast scan, step x SWEEP_DEGRADED_STEP_FACTOR |
+ * | ok     | FAILED     | TOF_ONLY        | No ultrasonic waits                |
+ * | FAILED | FAILED     | BLIND           | Probes only, every sector 999 cm   |
+ *
+ * Read with DIAG:SENSORS and FRAME_SENSOR_HEALTH (1 Hz).
+ */
+
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr uint8_t HEALTH_FAIL_CONSECUTIVE = 3;     // Timeouts/checksum errors in a row -> FAILED
+constexpr uint8_t HEALTH_WINDOW = 32;              // Reads in the rate window
+constexpr uint8_t HEALTH_FAIL_WINDOW = 16;         // Hard failures in the window -> FAILED
+constexpr uint16_t HEALTH_NO_TARGET_READS = 20;    // Out-of-range reads in a row -> NO_TARGET
+constexpr uint32_t HEALTH_STUCK_MS = 10000;        // Identical value this long -> FAILED
+constexpr uint16_t HEALTH_STUCK_READS = 50;        // ...and over at least this many reads
+constexpr uint32_t HEALTH_PROBE_MS = 2000;         // Probe period of a failed sensor
+constexpr uint8_t HEALTH_RECOVER_READS = 3;        // Good probes in a row -> recovered
+constexpr uint32_t HEALTH_RATE_PERIOD_MS = 1000;   // Read rate measurement period
+constexpr int SWEEP_DEGRADED_STEP_FACTOR = 3;      // Step multiplier of the ultrasonic-only scan
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Monitored sensors
+ */
+enum HealthSensor : uint8_t {
+    HEALTH_TOF = 0,
+    HEALTH_ULTRASONIC = 1,
+    HEALTH_SENSOR_COUNT = 2
+};
+
+/**
+ * @brief Outcome of one read
+ */
+enum ReadOutcome : uint8_t {
+    READ_OK = 0,               // Valid distance
+    READ_TIMEOUT = 1,          // No frame / pulse / signal
+    READ_CHECKSUM = 2,         // Frame received but corrupt
+    READ_OUT_OF_RANGE = 3      // Valid frame, no target in range
+};
+
+/**
+ * @brief Sensor status
+ */
+enum SensorStatus : uint8_t {
+    SENSOR_STATUS_OK = 0,
+    SENSOR_STATUS_NO_TARGET = 1,   // Working, nothing in range (informational)
+    SENSOR_STATUS_FAILED = 2       // Skipped by the sweep, probed
+};
+
+/**
+ * @brief Why a sensor was declared FAILED
+ */
+enum SensorFault : uint8_t {
+    SENSOR_FAULT_NONE = 0,
+    SENSOR_FAULT_TIMEOUTS = 1,
+    SENSOR_FAULT_CHECKSUMS = 2,
+    SENSOR_FAULT_STUCK = 3
+};
+
+/**
+ * @brief Sweep mode chosen from the sensor health
+ */
+enum SweepHealthMode : uint8_t {
+    SWEEP_HEALTH_NORMAL = 0,
+    SWEEP_HEALTH_ULTRASONIC_ONLY = 1,
+    SWEEP_HEALTH_TOF_ONLY = 2,
+    SWEEP_HEALTH_BLIND = 3
+};
+
+/**
+ * @brief Health of one sensor (copy)
+ */
+struct SensorHealth {
+    SensorStatus status;
+    SensorFault fault;             // Last failure cause (kept after recovery)
+    float rate_hz;                 // Valid reads per second (0 if no read lately)
+    uint8_t timeout_pct;           // Share of the last HEALTH_WINDOW reads
+    uint8_t checksum_pct;
+    uint8_t out_of_range_pct;
+    uint32_t reads;                // Counters since boot
+    uint32_t timeouts;
+    uint32_t checksum_errors;
+    uint32_t out_of_range;
+    uint32_t stuck_events;
+    uint32_t failures;             // Transitions to FAILED
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Record the outcome of one read
+ * @param value Distance read (cm), used by the stuck detector when READ_OK
+ */
+void sensorHealthRecord(HealthSensor sensor, ReadOutcome outcome, float value);
+
+/**
+ * @brief Whether the sweep should read the sensor now
+ *
+ * Always true for a working sensor; for a FAILED one, true once per
+ * HEALTH_PROBE_MS (and right after a good probe, to finish recovering).
+ */
+bool sensorHealthShouldRead(HealthSensor sensor);
+
+/**
+ * @brief false while the sensor is FAILED
+ */
+bool sensorHealthOk(HealthSensor sensor);
+
+/**
+ * @brief Sweep mode matching the current sensor health
+ */
+SweepHealthMode sensorHealthSweepMode();
+
+/**
+ * @brief Copy the health of one sensor (safe from any task)
+ */
+void getSensorHealth(HealthSensor sensor, SensorHealth* out);
+
+/**
+ * @brief Names for logs and DIAG output
+ */
+const char* sensorStatusName(SensorStatus status);
+const char* sensorFaultName(SensorFault fault);
+const char* sweepHealthModeName(SweepHealthMode mode);
+
+#endif // SENSOR_HEALTH_H
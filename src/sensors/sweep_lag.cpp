@@ -0,0 +1,254 @@
+/**
+ * @file sweep_lag.cpp
+ * @brief Implementation of the continuous sweep lag model
+ */
+
+#include "sweep_lag.h"
+#include "../config/servo_config.h"
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+
+// ============================================================================
+// State
+// ============================================================================
+
+constexpr int PROFILE_SLOTS = 181;          // One slot per degree, 0-180
+constexpr float NO_SAMPLE = 999.0f;
+
+// Distance profiles indexed by commanded angle (servoSweepTask only)
+static float profiles[SWEEP_DIR_COUNT][PROFILE_SLOTS];
+static float reference[PROFILE_SLOTS];
+static bool reference_valid = false;
+
+// Lag table, shared with the command handler
+static SweepLagBin bins[SWEEP_LAG_SPEED_BINS];
+static float forward_share = 0.5f;          // Fraction of the total lag on the forward pass
+static portMUX_TYPE lag_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool calibration_requested = false;
+
+// ============================================================================
+// Internal Helper Functions
+// ============================================================================
+
+static int binForSpeed(float speed_dps) {
+    int bin = (int)(speed_dps / SWEEP_LAG_BIN_WIDTH_DPS);
+    if (bin < 0) {
+        return 0;
+    }
+    return bin < SWEEP_LAG_SPEED_BINS ? bin : SWEEP_LAG_SPEED_BINS - 1;
+}
+
+static void clearProfile(float* profile) {
+    for (int i = 0; i < PROFILE_SLOTS; i++) {
+        profile[i] = NO_SAMPLE;
+    }
+}
+
+static void storeSample(float* profile, int angle, float distance_cm) {
+    if (angle < 0 || angle >= PROFILE_SLOTS) {
+        return;
+    }
+    profile[angle] = (distance_cm > 0.0f && distance_cm < NO_SAMPLE) ? distance_cm : NO_SAMPLE;
+}
+
+/**
+ * @brief Profile value at a fractional angle (linear between the nearest samples)
+ * @return false if no samples within SWEEP_LAG_MAX_GAP_DEG on both sides
+ */
+static bool interpolate(const float* profile, float angle, float* value) {
+    int below = (int)floorf(angle);
+    int above = below + 1;
+    while (below >= 0 && angle - below <= SWEEP_LAG_MAX_GAP_DEG && profile[below] >= NO_SAMPLE) {
+        below--;
+    }
+    while (above < PROFILE_SLOTS && above - angle <= SWEEP_LAG_MAX_GAP_DEG && profile[above] >= NO_SAMPLE) {
+        above++;
+    }
+    bool has_below = below >= 0 && angle - below <= SWEEP_LAG_MAX_GAP_DEG && profile[below] < NO_SAMPLE;
+    bool has_above = above < PROFILE_SLOTS && above - angle <= SWEEP_LAG_MAX_GAP_DEG && profile[above] < NO_SAMPLE;
+
+    if (has_below && angle == (float)below) {
+        *value = profile[below];
+        return true;
+    }
+    if (!has_below || !has_above) {
+        return false;
+    }
+    float t = (angle - below) / (float)(above - below);
+    *value = profile[below] + t * (profile[above] - profile[below]);
+    return true;
+}
+
+/**
+ * @brief Find the shift that best maps probe onto ref
+ *
+ * Compares probe[a] with ref(a + sign * shift) for shift in
+ * [0, max_shift] and keeps the smallest mean absolute difference.
+ *
+ * @return false if the probe is too flat or the profiles barely overlap
+ */
+static bool alignProfiles(const float* probe, const float* ref, float sign, float max_shift,
+                          float* shift) {
+    float lo = NO_SAMPLE;
+    float hi = 0.0f;
+    int valid = 0;
+    for (int a = 0; a < PROFILE_SLOTS; a++) {
+        if (probe[a] < NO_SAMPLE) {
+            lo = fminf(lo, probe[a]);
+            hi = fmaxf(hi, probe[a]);
+            valid++;
+        }
+    }
+    if (valid < SWEEP_LAG_MIN_POINTS || hi - lo < SWEEP_LAG_MIN_CONTRAST_CM) {
+        return false;
+    }
+
+    float best_cost = NO_SAMPLE;
+    float best_shift = 0.0f;
+    for (float s = 0.0f; s <= max_shift + 0.001f; s += SWEEP_LAG_SEARCH_STEP_DEG) {
+        float sum = 0.0f;
+        int count = 0;
+        for (int a = 0; a < PROFILE_SLOTS; a++) {
+            float r;
+            if (probe[a] < NO_SAMPLE && interpolate(ref, a + sign * s, &r)) {
+                sum += fabsf(probe[a] - r);
+                count++;
+            }
+        }
+        if (count >= SWEEP_LAG_MIN_POINTS && sum / count < best_cost) {
+            best_cost = sum / count;
+            best_shift = s;
+        }
+    }
+    if (best_cost >= NO_SAMPLE) {
+        return false;
+    }
+    *shift = best_shift;
+    return true;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void sweepLagReset() {
+    portENTER_CRITICAL(&lag_mux);
+    for (int i = 0; i < SWEEP_LAG_SPEED_BINS; i++) {
+        bins[i].speed_max_dps = (i + 1) * SWEEP_LAG_BIN_WIDTH_DPS;
+        bins[i].offset_deg[SWEEP_DIR_FORWARD] = 0.0f;
+        bins[i].offset_deg[SWEEP_DIR_BACKWARD] = 0.0f;
+        bins[i].passes = 0;
+        bins[i].calibrated = false;
+    }
+    forward_share = 0.5f;
+    portEXIT_CRITICAL(&lag_mux);
+}
+
+float sweepLagOffset(SweepDirection dir, float speed_dps) {
+    if (dir >= SWEEP_DIR_COUNT) {
+        return 0.0f;
+    }
+    int bin = binForSpeed(speed_dps);
+
+    portENTER_CRITICAL(&lag_mux);
+    bool learned = bins[bin].passes > 0;
+    float offset = bins[bin].offset_deg[dir];
+    float share = dir == SWEEP_DIR_FORWARD ? forward_share : 1.0f - forward_share;
+    portEXIT_CRITICAL(&lag_mux);
+
+    if (!learned) {
+        // Default model: total lag 2 x speed x lag time, split like the calibration
+        offset = 2.0f * share * speed_dps * SWEEP_LAG_DEFAULT_S;
+    }
+    return fminf(offset, SWEEP_LAG_MAX_DEG);
+}
+
+void sweepLagBeginPass(SweepDirection dir) {
+    if (dir < SWEEP_DIR_COUNT) {
+        clearProfile(profiles[dir]);
+    }
+}
+
+void sweepLagAddSample(SweepDirection dir, int commanded_angle, float distance_cm) {
+    if (dir < SWEEP_DIR_COUNT) {
+        storeSample(profiles[dir], commanded_angle, distance_cm);
+    }
+}
+
+bool sweepLagEndPair(float speed_dps) {
+    int bin = binForSpeed(speed_dps);
+    const float* fwd = profiles[SWEEP_DIR_FORWARD];
+    const float* bwd = profiles[SWEEP_DIR_BACKWARD];
+
+    // Calibration: forward saw ref(a - lag_fwd), backward ref(a + lag_bwd)
+    if (reference_valid) {
+        reference_valid = false;
+        float lag_fwd, lag_bwd;
+        if (!alignProfiles(fwd, reference, -1.0f, SWEEP_LAG_MAX_DEG, &lag_fwd) ||
+            !alignProfiles(bwd, reference, 1.0f, SWEEP_LAG_MAX_DEG, &lag_bwd)) {
+            return false;
+        }
+        portENTER_CRITICAL(&lag_mux);
+        bins[bin].offset_deg[SWEEP_DIR_FORWARD] = lag_fwd;
+        bins[bin].offset_deg[SWEEP_DIR_BACKWARD] = lag_bwd;
+        bins[bin].passes++;
+        bins[bin].calibrated = true;
+        if (lag_fwd + lag_bwd > 0.0f) {
+            forward_share = lag_fwd / (lag_fwd + lag_bwd);
+        }
+        portEXIT_CRITICAL(&lag_mux);
+        return true;
+    }
+
+    // Learning: fwd[a] = bwd(a - (lag_fwd + lag_bwd))
+    float total;
+    if (!alignProfiles(fwd, bwd, -1.0f, 2.0f * SWEEP_LAG_MAX_DEG, &total)) {
+        return false;
+    }
+    portENTER_CRITICAL(&lag_mux);
+    SweepLagBin& b = bins[bin];
+    float target[SWEEP_DIR_COUNT] = {total * forward_share, total * (1.0f - forward_share)};
+    for (int d = 0; d < SWEEP_DIR_COUNT; d++) {
+        if (b.passes == 0) {
+            b.offset_deg[d] = target[d];
+        } else {
+            b.offset_deg[d] += SWEEP_LAG_LEARN_RATE * (target[d] - b.offset_deg[d]);
+        }
+    }
+    b.passes++;
+    portEXIT_CRITICAL(&lag_mux);
+    return true;
+}
+
+void sweepLagRequestCalibration() {
+    calibration_requested = true;
+}
+
+bool sweepLagTakeCalibrationRequest() {
+    if (!calibration_requested) {
+        return false;
+    }
+    calibration_requested = false;
+    return true;
+}
+
+void sweepLagBeginReference() {
+    clearProfile(reference);
+    reference_valid = false;
+}
+
+void sweepLagAddReference(int angle, float distance_cm) {
+    storeSample(reference, angle, distance_cm);
+    reference_valid = true;
+}
+
+float getSweepLagBins(SweepLagBin* out) {
+    portENTER_CRITICAL(&lag_mux);
+    for (int i = 0; i < SWEEP_LAG_SPEED_BINS; i++) {
+        out[i] = bins[i];
+    }
+    float share = forward_share;
+    portEXIT_CRITICAL(&lag_mux);
+    return share;
+}
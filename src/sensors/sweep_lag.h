@@ -0,0 +1,115 @@
+/**
+ * @file sweep_lag.h
+ * @brief Direction- and speed-dependent servo lag model for continuous sweeps
+ *
+ * Without a settle time the servo trails its command: a forward sample
+ * taken at commanded angle a was really measured at a - lag_fwd, a backward
+ * one at a + lag_bwd. The lag grows with sweep speed and includes
+ * backlash, so it is kept per direction in a table of speed bins.
+ *
+ * Learning: every forward/backward pass pair sees the same scene, so the
+ * backward distance profile matches the forward one shifted by
+ * lag_fwd + lag_bwd. The shift with the smallest mean distance difference
+ * updates the bin (exponential average). The split between the directions
+ * comes from a calibration against a settled reference sweep (DIAG:SWEEPLAG:CAL),
+ * symmetric until one has run.
+ *
+ * Profiles and learning belong to servoSweepTask; the bin table is also
+ * read by the command handler.
+ */
+
+#ifndef SWEEP_LAG_H
+#define SWEEP_LAG_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Sweep direction of a continuous pass
+ */
+enum SweepDirection : uint8_t {
+    SWEEP_DIR_FORWARD = 0,       // Increasing angle
+    SWEEP_DIR_BACKWARD,          // Decreasing angle
+    SWEEP_DIR_COUNT
+};
+
+/**
+ * @brief One speed bin of the lag table
+ */
+struct SweepLagBin {
+    float speed_max_dps;                     // Upper edge of the bin (last bin: open)
+    float offset_deg[SWEEP_DIR_COUNT];       // Servo lag behind the command (degrees)
+    uint32_t passes;                         // Accepted pass pairs (0 = default model)
+    bool calibrated;                         // Direction split measured against a reference
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Forget everything learned (default lag model in every bin)
+ */
+void sweepLagReset();
+
+/**
+ * @brief Current lag estimate for a direction and sweep speed
+ * @param dir Sweep direction
+ * @param speed_dps Commanded sweep speed (degrees per second)
+ * @return Degrees the servo trails the command (subtract going forward, add going backward)
+ */
+float sweepLagOffset(SweepDirection dir, float speed_dps);
+
+/**
+ * @brief Start recording the distance profile of a pass
+ */
+void sweepLagBeginPass(SweepDirection dir);
+
+/**
+ * @brief Record one sample of the current pass at its commanded angle
+ */
+void sweepLagAddSample(SweepDirection dir, int commanded_angle, float distance_cm);
+
+/**
+ * @brief Learn from the last forward and backward pass
+ *
+ * Consumes a pending reference sweep: with one, each direction is aligned
+ * against it and the bin is set directly (calibration).
+ *
+ * @param speed_dps Sweep speed of both passes
+ * @return true if the profiles had enough structure and the bin was updated
+ */
+bool sweepLagEndPair(float speed_dps);
+
+/**
+ * @brief Ask servoSweepTask for a reference sweep (command handler)
+ */
+void sweepLagRequestCalibration();
+
+/**
+ * @brief Take a pending calibration request (servoSweepTask)
+ * @return true if a settled reference sweep should run now
+ */
+bool sweepLagTakeCalibrationRequest();
+
+/**
+ * @brief Start recording a settled reference sweep
+ */
+void sweepLagBeginReference();
+
+/**
+ * @brief Record one settled reference sample (commanded = actual angle)
+ */
+void sweepLagAddReference(int angle, float distance_cm);
+
+/**
+ * @brief Copy the lag table
+ * @param out SWEEP_LAG_SPEED_BINS entries
+ * @return Fraction of the total lag assigned to the forward direction
+ */
+float getSweepLagBins(SweepLagBin* out);
+
+#endif // SWEEP_LAG_H
@@ -5,10 +5,16 @@
 
 #include "tof_sensor.h"
 #include "ultrasonic_sensor.h"
+#include "sensor_health.h"
+#include "sweep_lag.h"
 #include "../config/pins.h"
 #include "../config/system_config.h"
 #include "../config/servo_config.h"
 #include "../utils/command_handler.h"
+#include "../utils/instrumented_lock.h"
+#include "../utils/power_manager.h"
+#include "../utils/spsc_queue.h"
+#include "../utils/tlog.h"
 
 // ============================================================================
 // Internal Variables
@@ -36,9 +42,9 @@ static bool servo_channels_allocated = false;
 // Shared Variables (Extern declarations in header)
 // ============================================================================
 
-SemaphoreHandle_t distanceMutex = NULL;
 volatile float shared_min_distance[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
 volatile int shared_best_angle[5] = {SERVO_MIN_ANGLE, SERVO_MIN_ANGLE, SERVO_MIN_ANGLE, SERVO_MIN_ANGLE, SERVO_MIN_ANGLE};
+volatile uint32_t shared_sector_ms[5] = {0, 0, 0, 0, 0};
 volatile bool sweep_active = false;
 volatile ActiveSensor shared_active_sensor = SENSOR_NONE;
 
@@ -46,6 +52,10 @@ volatile ActiveSensor shared_active_sensor = SENSOR_NONE;
 volatile float shared_tof_raw_cm = 999.0f;
 volatile float shared_ultrasonic_raw_cm = 999.0f;
 
+// Every sweep measurement, servoSweepTask -> serialPrintTask
+static SpscQueue<ScanSample, SCAN_QUEUE_SLOTS> scan_queue;
+static uint32_t scan_seq = 0;
+
 // Dynamic distance thresholds (initialized to base values, updated by potentiometer 2)
 float distance_close_max = DISTANCE_CLOSE_MAX_BASE;    // 100 cm at scale=1.0
 float distance_medium_max = DISTANCE_MEDIUM_MAX_BASE;  // 200 cm at scale=1.0
@@ -116,30 +126,122 @@ static size_t tof_readN(uint8_t* buf, size_t len, uint16_t timeout = 1500) {
     while (offset < len) {
         if (tofSerial.available()) {
             buf[offset++] = tofSerial.read();
+            continue;
         }
         if (millis() - startTime > timeout) {
             break;
         }
+        vTaskDelay(1);  // Block instead of spinning (lets the CPU scale down)
     }
 
     return offset;
 }
 
+/**
+ * @brief Read both range sensors for one sweep step
+ *
+ * A FAILED sensor is not read (reads -1) except for its periodic recovery
+ * probe, which uses a short timeout and is not fused until the sensor
+ * has recovered. Logs sweep mode changes.
+ */
+static void readRangeSensors(float* tof_distance, float* ultrasonic_distance) {
+    static SweepHealthMode logged_mode = SWEEP_HEALTH_NORMAL;
+
+    *tof_distance = -1.0f;
+    *ultrasonic_distance = -1.0f;
+    if (sensorHealthShouldRead(HEALTH_TOF)) {
+        bool probe = !sensorHealthOk(HEALTH_TOF);
+        float distance = tofGetDistance(probe ? TOF_PROBE_TIMEOUT_MS : TOF_READ_TIMEOUT_MS);
+        if (sensorHealthOk(HEALTH_TOF)) {
+            *tof_distance = distance;
+        }
+    }
+    if (sensorHealthShouldRead(HEALTH_ULTRASONIC)) {
+        float distance = ultrasonicGetDistance();
+        if (sensorHealthOk(HEALTH_ULTRASONIC)) {
+            *ultrasonic_distance = distance;
+        }
+    }
+
+    SweepHealthMode mode = sensorHealthSweepMode();
+    if (mode != logged_mode) {
+        TLOG("Sweep: %s mode (TOF %s, ultrasonic %s)", sweepHealthModeName(mode),
+             sensorHealthOk(HEALTH_TOF) ? "ok" : "failed",
+             sensorHealthOk(HEALTH_ULTRASONIC) ? "ok" : "failed");
+        logged_mode = mode;
+    }
+}
+
+/**
+ * @brief Fuse one sweep measurement, publish it and queue it
+ *
+ * Uses the smaller valid distance of both sensors and records which one
+ * provided it. The shared_* values feed the periodic DataPacket; the
+ * queued ScanSample carries every measurement to the telemetry task.
+ *
+ * @return Fused distance in cm (999.0 if neither sensor is valid)
+ */
+static float recordSweepSample(int angle, float tof_distance, float ultrasonic_distance) {
+    float distance;
+    ActiveSensor sensor;
+    bool tof_valid = (tof_distance > 0 && tof_distance < 999.0f);
+    bool us_valid = (ultrasonic_distance > 0 && ultrasonic_distance < 999.0f);
+
+    if (!tof_valid && !us_valid) {
+        distance = 999.0f;
+        sensor = SENSOR_NONE;
+    } else if (!tof_valid) {
+        distance = ultrasonic_distance;
+        sensor = SENSOR_ULTRASONIC;
+    } else if (!us_valid) {
+        distance = tof_distance;
+        sensor = SENSOR_TOF;
+    } else if (tof_distance < ultrasonic_distance) {
+        distance = tof_distance;
+        sensor = SENSOR_TOF;
+    } else if (ultrasonic_distance < tof_distance) {
+        distance = ultrasonic_distance;
+        sensor = SENSOR_ULTRASONIC;
+    } else {
+        distance = tof_distance;  // Equal
+        sensor = SENSOR_BOTH_EQUAL;
+    }
+
+    // Raw readings and live distance for the DataPacket and radar display
+    shared_tof_raw_cm = tof_distance;
+    shared_ultrasonic_raw_cm = ultrasonic_distance;
+    shared_active_sensor = sensor;
+    extern volatile float shared_tof_current;
+    shared_tof_current = distance;
+
+    ScanSample sample;
+    sample.seq = scan_seq++;
+    sample.timestamp_ms = millis();
+    sample.tof_cm = tof_distance;
+    sample.ultrasonic_cm = ultrasonic_distance;
+    sample.distance_cm = distance;
+    sample.angle = (int16_t)angle;
+    sample.active_sensor = (uint8_t)sensor;
+    scan_queue.push(sample);   // Counted as an overflow when full
+
+    return distance;
+}
+
 // ============================================================================
 // Public Function Implementations
 // ============================================================================
 
 void initTOFSensor() {
-    Serial.println("    [Step 1/5] Starting TOF Serial...");
+    TLOG("    [Step 1/5] Starting TOF Serial...");
     Serial.flush();
 
     // Initialize TOF serial communication
     tofSerial.begin(TOF_BAUDRATE, SERIAL_8N1, TOF_RX_PIN, TOF_TX_PIN);
     delay(100);
-    Serial.println("    [Step 1/5] TOF Serial: OK");
+    TLOG("    [Step 1/5] TOF Serial: OK");
     Serial.flush();
 
-    Serial.println("    [Step 2/5] Allocating PWM timer...");
+    TLOG("    [Step 2/5] Allocating PWM timer...");
     Serial.flush();
 
     // Allocate timer for servo (motors use timers 0-2 for channels 0-4)
@@ -149,45 +251,48 @@ void initTOFSensor() {
         ESP32PWM::allocateTimer(3);  // Use timer 3 for servo (free timer)
         servo_channels_allocated = true;
     }
-    Serial.println("    [Step 2/5] PWM Timer: OK");
+    TLOG("    [Step 2/5] PWM Timer: OK");
     Serial.flush();
 
-    Serial.println("    [Step 3/5] Setting servo frequency...");
+    TLOG("    [Step 3/5] Setting servo frequency...");
     Serial.flush();
 
     // Initialize servo using ESP32Servo library
     tofServo.setPeriodHertz(50);    // Standard 50Hz servo
-    Serial.println("    [Step 3/5] Servo frequency: OK");
+    TLOG("    [Step 3/5] Servo frequency: OK");
     Serial.flush();
 
-    Serial.println("    [Step 4/5] Attaching servo to pin...");
+    TLOG("    [Step 4/5] Attaching servo to pin...");
     Serial.flush();
 
     tofServo.attach(SERVO_PIN);
-    Serial.println("    [Step 4/5] Servo attached: OK");
+    TLOG("    [Step 4/5] Servo attached: OK");
     Serial.flush();
 
-    Serial.println("    [Step 5/5] Writing servo position...");
+    TLOG("    [Step 5/5] Writing servo position...");
     Serial.flush();
 
     tofServo.write(SERVO_MIN_ANGLE);  // Start at minimum sweep angle
     delay(500);
-    Serial.println("    [Step 5/5] Servo position: OK");
+    TLOG("    [Step 5/5] Servo position: OK");
     Serial.flush();
 
-    // Create mutex for thread-safe access to shared variables
-    distanceMutex = xSemaphoreCreateMutex();
-    if (distanceMutex == NULL) {
-        Serial.println("ERROR: Failed to create distance mutex!");
+    // Create lock for thread-safe access to shared variables
+    if (!lockCreate(LOCK_DISTANCE)) {
+        TLOG("ERROR: Failed to create distance lock!");
     }
+
+    // Continuous sweep starts from the default lag model
+    sweepLagReset();
 }
 
-float tofGetDistance() {
+float tofGetDistance(uint16_t timeout_ms) {
     uint8_t rx_buf[16];
     uint8_t ch;
     uint8_t checksum = 0;
-    const uint16_t timeout = 1000;
     bool success = false;
+    bool bad_checksum = false;
+    bool frame_window = false;
 
     // Clear any old data from serial buffer
     while (tofSerial.available() > 0) {
@@ -197,10 +302,14 @@ float tofGetDistance() {
     unsigned long startTime = millis();
 
     // Try to read a valid frame within timeout period
-    while (millis() - startTime < timeout) {
+    while (millis() - startTime < timeout_ms) {
         // Look for frame start byte (0x57)
         if (tof_readN(&ch, 1, 100) == 1 && ch == 0x57) {
             rx_buf[0] = ch;
+            if (!frame_window) {
+                pmLockAcquire(PM_LOCK_SWEEP);  // Rest of the frame at full speed
+                frame_window = true;
+            }
 
             // Check second byte (0x00)
             if (tof_readN(&ch, 1, 100) == 1 && ch == 0x00) {
@@ -235,14 +344,22 @@ float tofGetDistance() {
                         success = true;
                         break;
                     }
+                    bad_checksum = true;
                 }
             }
         }
     }
 
+    if (frame_window) {
+        pmLockRelease(PM_LOCK_SWEEP);
+    }
+
     if (success) {
-        return tof_distance * 100.0f;  // Convert meters to centimeters
+        float distance_cm = tof_distance * 100.0f;  // Convert meters to centimeters
+        sensorHealthRecord(HEALTH_TOF, distance_cm > 0.0f ? READ_OK : READ_OUT_OF_RANGE, distance_cm);
+        return distance_cm;
     } else {
+        sensorHealthRecord(HEALTH_TOF, bad_checksum ? READ_CHECKSUM : READ_TIMEOUT, -1.0f);
         return -1.0f;  // Return error value
     }
 }
@@ -271,7 +388,7 @@ DistanceRange getDistanceRange(float distance) {
     }
 }
 
-float calculateSetpoint(DistanceRange range, float baseline_force_n) {
+float calculateSetpoint(DistanceRange range, float baseline_force_n, const ParamSnapshot& params) {
     switch (range) {
         case RANGE_FAR:
             // Dynamic setpoint: baseline force (captured when entering FAR range) + security offset
@@ -280,64 +397,456 @@ float calculateSetpoint(DistanceRange range, float baseline_force_n) {
             if (baseline_force_n > 0.0f) {
                 return baseline_force_n + SECURITY_OFFSET_N;
             }
-            return SETPOINT_FAR_N;
+            return params.setpoint_far;
 
         case RANGE_MEDIUM:
-            return SETPOINT_MEDIUM_N;
+            return params.setpoint_medium;
 
         case RANGE_CLOSE:
-            return SETPOINT_CLOSE_N;
+            return params.setpoint_close;
 
         default:
             return -1.0f;  // Invalid setpoint
     }
 }
 
-float getMinDistance(int motor_index) {
-    float distance = 999.0f;
+// Last good reading per sector, served when LOCK_DISTANCE times out
+static SectorReading last_reading[5] = {
+    {999.0f, SERVO_MIN_ANGLE, 0, false}, {999.0f, SERVO_MIN_ANGLE, 0, false},
+    {999.0f, SERVO_MIN_ANGLE, 0, false}, {999.0f, SERVO_MIN_ANGLE, 0, false},
+    {999.0f, SERVO_MIN_ANGLE, 0, false}};
+static uint32_t last_reading_ms[5] = {0, 0, 0, 0, 0};
+static uint32_t reading_fallbacks = 0;
+static portMUX_TYPE reading_mux = portMUX_INITIALIZER_UNLOCKED;
+
+SectorReading readSectorDistance(int motor_index) {
+    SectorReading reading = {999.0f, SERVO_MIN_ANGLE, 0, false};
 
     if (motor_index < 0 || motor_index >= NUM_MOTORS) {
-        return distance;  // Invalid index
+        return reading;  // Invalid index
     }
 
-    if (xSemaphoreTake(distanceMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        distance = shared_min_distance[motor_index];
-        xSemaphoreGive(distanceMutex);
+    uint32_t now_ms = millis();
+    if (lockTake(LOCK_DISTANCE, 10)) {
+        reading.distance_cm = shared_min_distance[motor_index];
+        reading.angle = shared_best_angle[motor_index];
+        uint32_t published_ms = shared_sector_ms[motor_index];
+        lockGive(LOCK_DISTANCE);
+
+        reading.age_ms = (published_ms != 0) ? now_ms - published_ms : 0;
+        portENTER_CRITICAL(&reading_mux);
+        last_reading[motor_index] = reading;
+        last_reading_ms[motor_index] = published_ms;
+        portEXIT_CRITICAL(&reading_mux);
+        return reading;
     }
 
-    return distance;
+    // Sweep task holds the lock: the previous value is still the newest
+    // one this reader has seen, only older
+    portENTER_CRITICAL(&reading_mux);
+    reading = last_reading[motor_index];
+    uint32_t published_ms = last_reading_ms[motor_index];
+    reading_fallbacks++;
+    portEXIT_CRITICAL(&reading_mux);
+
+    reading.age_ms = (published_ms != 0) ? now_ms - published_ms : 0;
+    reading.from_cache = true;
+    return reading;
+}
+
+uint32_t getDistanceReadFallbacks() {
+    portENTER_CRITICAL(&reading_mux);
+    uint32_t count = reading_fallbacks;
+    portEXIT_CRITICAL(&reading_mux);
+    return count;
+}
+
+float getMinDistance(int motor_index) {
+    return readSectorDistance(motor_index).distance_cm;
 }
 
 int getBestAngle(int motor_index) {
-    int angle = SERVO_MIN_ANGLE;
+    return readSectorDistance(motor_index).angle;
+}
 
-    if (motor_index < 0 || motor_index >= NUM_MOTORS) {
-        return angle;  // Invalid index
+// ============================================================================
+// Tracking Mode
+// ============================================================================
+
+/**
+ * @brief Tracking mode state (servoSweepTask only)
+ */
+struct TrackingState {
+    bool acquired;               // false = acquisition sweep pending
+    int angle;                   // Dither center (closest obstacle)
+    int sector;                  // Tracked sector (critical motor)
+    float distance;              // Latest tracked minimum (cm)
+    int next_refresh;            // Round-robin index of the next sector to refresh
+    int misses;                  // Consecutive samples without a valid reading
+};
+
+static TrackingState tracking = {false, SERVO_MIN_ANGLE, -1, 999.0f, 0, 0};
+static int last_servo_angle = SERVO_MIN_ANGLE;
+
+static const int SECTOR_MIN[5] = {SECTOR_MOTOR_1_MIN, SECTOR_MOTOR_2_MIN, SECTOR_MOTOR_3_MIN,
+                                  SECTOR_MOTOR_4_MIN, SECTOR_MOTOR_5_MIN};
+static const int SECTOR_MAX[5] = {SECTOR_MOTOR_1_MAX, SECTOR_MOTOR_2_MAX, SECTOR_MOTOR_3_MAX,
+                                  SECTOR_MOTOR_4_MAX, SECTOR_MOTOR_5_MAX};
+
+// Dither sequence: center is visited twice per cycle
+static const int DITHER_OFFSETS[4] = {0, TRACK_DITHER_DEG, 0, -TRACK_DITHER_DEG};
+
+// Copy of shared_min_distance kept by the sweep task (no lock to compare)
+static float published_cm[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
+
+static bool publishSectorMinimum(int sector, float distance, int angle) {
+    if (sector < 0 || distance <= 0.0f || distance >= 999.0f) {
+        return false;
+    }
+    if (!lockTake(LOCK_DISTANCE, 10)) {
+        return false;  // Counted as a timeout; caller retries at its next boundary
+    }
+    shared_min_distance[sector] = distance;
+    shared_best_angle[sector] = angle;
+    shared_sector_ms[sector] = millis() | 1;  // 0 is reserved for "never published"
+    lockGive(LOCK_DISTANCE);
+    published_cm[sector] = distance;
+    return true;
+}
+
+/**
+ * @brief Publish a single reading at once if it is clearly closer
+ *
+ * An approaching obstacle reaches its motor one sample after it is seen
+ * instead of when the sweep leaves the sector (up to a full sweep after
+ * a wrap-around). The end-of-sector publication still sets the final value.
+ */
+static void publishIfCloser(int sector, float distance, int angle) {
+    if (sector >= 0 && distance > 0.0f &&
+        distance < published_cm[sector] - SWEEP_EARLY_PUBLISH_MARGIN_CM) {
+        publishSectorMinimum(sector, distance, angle);
+    }
+}
+
+/**
+ * @brief Move the servo, wait for it and take one fused measurement
+ *
+ * The wait grows with the jump size so returning from a refresh sweep
+ * does not read while the servo is still travelling.
+ */
+static float measureAt(int angle, uint32_t settle_ms) {
+    uint32_t slew_ms = (uint32_t)abs(angle - last_servo_angle) * TRACK_SLEW_MS_PER_DEG;
+    tofServo.write(angle);
+    last_servo_angle = angle;
+
+    extern volatile int shared_servo_angle;
+    shared_servo_angle = angle;
+    vTaskDelay(pdMS_TO_TICKS(slew_ms > settle_ms ? slew_ms : settle_ms));
+
+    float tof_distance, ultrasonic_distance;
+    readRangeSensors(&tof_distance, &ultrasonic_distance);
+    float distance = recordSweepSample(angle, tof_distance, ultrasonic_distance);
+
+    int sector_index = getSectorForAngle(angle);
+    if (sector_index >= 0 && distance > 0) {
+        extern volatile float shared_tof_distances[5];
+        shared_tof_distances[sector_index] = distance;
+    }
+    publishIfCloser(sector_index, distance, angle);
+    return distance;
+}
+
+/**
+ * @brief Sweep [from, to] once and publish the sector minima found
+ *
+ * @param only_sector Publish this sector only (-1 = every sector visited)
+ * @param best_distance Output: smallest valid distance (999 if none)
+ * @return Angle of the smallest valid distance, or -1 if none
+ */
+static int sweepSpan(int from, int to, int step, uint32_t settle_ms, uint32_t delay_ms,
+                     int only_sector, float* best_distance) {
+    float sector_min[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
+    int sector_angle[5] = {from, from, from, from, from};
+    float best = 999.0f;
+    int best_angle = -1;
+
+    for (int angle = from; angle <= to; angle += step) {
+        float distance = measureAt(angle, settle_ms);
+        int sector_index = getSectorForAngle(angle);
+        if (sector_index >= 0 && distance > 0 && distance < sector_min[sector_index]) {
+            sector_min[sector_index] = distance;
+            sector_angle[sector_index] = angle;
+        }
+        if (distance > 0 && distance < best) {
+            best = distance;
+            best_angle = angle;
+        }
+        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    }
+
+    for (int i = 0; i < 5; i++) {
+        if (only_sector < 0 || only_sector == i) {
+            publishSectorMinimum(i, sector_min[i], sector_angle[i]);
+        }
+    }
+    *best_distance = best;
+    return best_angle;
+}
+
+/**
+ * @brief One tracking slice: dither for TRACK_REFRESH_MS, then refresh one other sector
+ *
+ * Returns to servoSweepTask after each slice so configuration and mode
+ * changes are picked up.
+ */
+static void runTrackingSlice(int min_angle, int max_angle, int step_size,
+                             uint32_t settle_time, uint32_t reading_delay) {
+    // Coarse acquisition sweep: publishes every sector, tracks the closest
+    if (!tracking.acquired) {
+        float best = 999.0f;
+        int angle = sweepSpan(min_angle, max_angle, step_size * TRACK_ACQUIRE_STEP_FACTOR,
+                              settle_time, reading_delay, -1, &best);
+        if (angle < 0) {
+            vTaskDelay(pdMS_TO_TICKS(100));   // Nothing in range, sweep again
+            return;
+        }
+        tracking.acquired = true;
+        tracking.angle = angle;
+        tracking.sector = getSectorForAngle(angle);
+        tracking.distance = best;
+        tracking.misses = 0;
+        TLOG("Tracking: acquired M%d at %d deg, %.1f cm", tracking.sector + 1, angle, best);
+        return;
+    }
+
+    // Dither around the obstacle. window[] holds the latest reading at
+    // -dither, center and +dither; the tracked sector gets their minimum
+    // after every sample, i.e. at the TOF's native rate.
+    float window[3] = {999.0f, 999.0f, 999.0f};
+    int phase = 0;
+    uint32_t start_ms = millis();
+
+    while (millis() - start_ms < TRACK_REFRESH_MS) {
+        int offset = DITHER_OFFSETS[phase];
+        phase = (phase + 1) % 4;
+        int slot = offset < 0 ? 0 : (offset > 0 ? 2 : 1);
+        int angle = constrain(tracking.angle + offset, min_angle, max_angle);
+
+        float distance = measureAt(angle, TRACK_SETTLE_MS);
+        if (distance > 0 && distance < 999.0f) {
+            window[slot] = distance;
+            tracking.misses = 0;
+        } else {
+            window[slot] = 999.0f;
+            if (++tracking.misses >= TRACK_LOST_SAMPLES) {
+                tracking.acquired = false;
+                TLOG("Tracking: M%d target lost, re-acquiring", tracking.sector + 1);
+                return;
+            }
+        }
+
+        int best_slot = 1;
+        for (int i = 0; i < 3; i++) {
+            if (window[i] < window[best_slot]) {
+                best_slot = i;
+            }
+        }
+        int best_angle = constrain(tracking.angle + (best_slot - 1) * TRACK_DITHER_DEG,
+                                   min_angle, max_angle);
+        if (window[best_slot] < 999.0f) {
+            tracking.distance = window[best_slot];
+            publishSectorMinimum(tracking.sector, window[best_slot], best_angle);
+        }
+
+        // After a full cycle, re-center on the closer side
+        if (phase == 0 && best_slot != 1 && best_angle != tracking.angle) {
+            tracking.angle = best_angle;
+            int sector_index = getSectorForAngle(best_angle);
+            if (sector_index >= 0 && sector_index != tracking.sector) {
+                tracking.sector = sector_index;
+                TLOG("Tracking: obstacle moved to M%d (%d deg)", sector_index + 1, best_angle);
+            }
+            window[0] = window[1] = window[2] = 999.0f;
+        }
+    }
+
+    // Refresh the next other sector (round robin)
+    int sector_index = tracking.next_refresh;
+    if (sector_index == tracking.sector) {
+        sector_index = (sector_index + 1) % 5;
+    }
+    tracking.next_refresh = (sector_index + 1) % 5;
+
+    int from = max(SECTOR_MIN[sector_index], min_angle);
+    int to = min(SECTOR_MAX[sector_index], max_angle);
+    if (from > to) {
+        return;   // Sector outside the configured sweep range
+    }
+    float best = 999.0f;
+    int angle = sweepSpan(from, to, step_size, settle_time, reading_delay, sector_index, &best);
+
+    // A closer obstacle elsewhere becomes the new critical sector
+    if (angle >= 0 && best < tracking.distance - TRACK_RETARGET_MARGIN_CM) {
+        TLOG("Tracking: retarget M%d -> M%d (%.1f cm < %.1f cm)",
+             tracking.sector + 1, sector_index + 1, best, tracking.distance);
+        tracking.angle = angle;
+        tracking.sector = sector_index;
+        tracking.distance = best;
+        tracking.misses = 0;
+    }
+}
+
+// ============================================================================
+// Continuous Bidirectional Mode
+// ============================================================================
+
+// Measured sweep speed, carried across passes (servoSweepTask only)
+static float continuous_speed_dps = 0.0f;
+
+/**
+ * @brief One continuous pass: no settle, samples binned at the lag-corrected angle
+ *
+ * The command advances one step per reading while the servo is still
+ * moving. Each sample is attributed to commanded angle -/+ the learned lag
+ * for this direction and speed, and each sector minimum is published as
+ * soon as the corrected angle leaves the sector, so both directions
+ * refresh every sector.
+ */
+static void runContinuousPass(SweepDirection dir, int min_angle, int max_angle, int step_size) {
+    float sector_min[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
+    int sector_angle[5] = {min_angle, min_angle, min_angle, min_angle, min_angle};
+    int current_sector = -1;
+    int delta = dir == SWEEP_DIR_FORWARD ? step_size : -step_size;
+    int angle = dir == SWEEP_DIR_FORWARD ? min_angle : max_angle;
+    uint32_t last_us = micros();
+    bool first = true;
+
+    sweepLagBeginPass(dir);
+    for (; angle >= min_angle && angle <= max_angle; angle += delta) {
+        tofServo.write(angle);
+        last_servo_angle = angle;
+
+        extern volatile int shared_servo_angle;
+        shared_servo_angle = angle;
+
+        float tof_distance, ultrasonic_distance;
+        readRangeSensors(&tof_distance, &ultrasonic_distance);
+
+        // Sweep speed = one step per reading (the first step includes the turnaround)
+        uint32_t now_us = micros();
+        if (!first && now_us != last_us) {
+            float speed = step_size * 1000000.0f / (float)(now_us - last_us);
+            continuous_speed_dps = continuous_speed_dps <= 0.0f ? speed :
+                continuous_speed_dps + SWEEP_SPEED_FILTER * (speed - continuous_speed_dps);
+        }
+        first = false;
+        last_us = now_us;
+
+        float lag = sweepLagOffset(dir, continuous_speed_dps);
+        int actual = (int)lroundf(dir == SWEEP_DIR_FORWARD ? angle - lag : angle + lag);
+        float distance = recordSweepSample(actual, tof_distance, ultrasonic_distance);
+        sweepLagAddSample(dir, angle, distance);
+
+        int sector_index = getSectorForAngle(actual);
+        if (sector_index >= 0 && distance > 0) {
+            extern volatile float shared_tof_distances[5];
+            shared_tof_distances[sector_index] = distance;
+        }
+        publishIfCloser(sector_index, distance, actual);
+        if (sector_index != current_sector) {
+            if (current_sector >= 0) {
+                publishSectorMinimum(current_sector, sector_min[current_sector], sector_angle[current_sector]);
+            }
+            current_sector = sector_index;
+            if (sector_index >= 0) {
+                sector_min[sector_index] = 999.0f;
+            }
+        }
+        if (sector_index >= 0 && distance > 0 && distance < sector_min[sector_index]) {
+            sector_min[sector_index] = distance;
+            sector_angle[sector_index] = actual;
+        }
+
+        vTaskDelay(1);   // Yield only, the servo keeps moving
+    }
+    if (current_sector >= 0) {
+        publishSectorMinimum(current_sector, sector_min[current_sector], sector_angle[current_sector]);
     }
+}
 
-    if (xSemaphoreTake(distanceMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        angle = shared_best_angle[motor_index];
-        xSemaphoreGive(distanceMutex);
+/**
+ * @brief Settled sweep of the full range as lag calibration reference
+ */
+static void runLagReferenceSweep(int min_angle, int max_angle, int step_size) {
+    TLOG("Sweep lag: reference sweep %d-%d deg", min_angle, max_angle);
+    sweepLagBeginReference();
+    for (int angle = min_angle; angle <= max_angle; angle += step_size) {
+        float distance = measureAt(angle, SWEEP_LAG_REF_SETTLE_MS);
+        sweepLagAddReference(angle, distance);
     }
+}
 
-    return angle;
+/**
+ * @brief One forward and one backward continuous pass, then learn the lag
+ */
+static void runContinuousCycle(int min_angle, int max_angle, int step_size) {
+    bool calibrating = sweepLagTakeCalibrationRequest();
+    if (calibrating) {
+        runLagReferenceSweep(min_angle, max_angle, step_size);
+    }
+
+    runContinuousPass(SWEEP_DIR_FORWARD, min_angle, max_angle, step_size);
+    runContinuousPass(SWEEP_DIR_BACKWARD, min_angle, max_angle, step_size);
+
+    bool learned = sweepLagEndPair(continuous_speed_dps);
+    if (calibrating) {
+        if (learned) {
+            TLOG("Sweep lag: calibrated at %.0f deg/s, fwd %.1f deg, bwd %.1f deg",
+                 continuous_speed_dps, sweepLagOffset(SWEEP_DIR_FORWARD, continuous_speed_dps),
+                 sweepLagOffset(SWEEP_DIR_BACKWARD, continuous_speed_dps));
+        } else {
+            TLOG("Sweep lag: calibration failed, scene too flat");
+        }
+    }
+}
+
+// ============================================================================
+// Public Function Implementations (Sweep Stream and Task)
+// ============================================================================
+
+bool popScanSample(ScanSample* sample) {
+    if (sample == NULL) {
+        return false;
+    }
+    return scan_queue.pop(sample);
+}
+
+uint32_t getScanSampleOverflows() {
+    return scan_queue.overflows();
 }
 
 void servoSweepTask(void* parameter) {
+    // Runtime configuration, kept across iterations: a LOCK_CONFIG timeout
+    // reuses the last values read instead of reverting to the defaults
+    bool is_sweep_enabled = false;
+    int manual_angle = 90;
+    int min_angle = SERVO_MIN_ANGLE;
+    int max_angle = SERVO_MAX_ANGLE;
+    int step_size = SERVO_STEP;
+    int settle_time = SERVO_SETTLE_MS;
+    int reading_delay = SERVO_READING_DELAY_MS;
+
     for (;;) {
         // ====================================================================
         // Check if sweep is enabled (runtime configuration)
         // ====================================================================
-        bool is_sweep_enabled = false;
-        int manual_angle = 90;
-        int min_angle = SERVO_MIN_ANGLE;
-        int max_angle = SERVO_MAX_ANGLE;
-        int step_size = SERVO_STEP;
-        int settle_time = SERVO_SETTLE_MS;
-        int reading_delay = SERVO_READING_DELAY_MS;
-
-        // Read runtime configuration with mutex protection
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+
+        // Sweep mode is a runtime parameter (checked once per sweep)
+        ParamSnapshot params;
+        paramSnapshot(&params);
+
+        // Read runtime configuration under LOCK_CONFIG
+        if (lockTake(LOCK_CONFIG, 10)) {
             is_sweep_enabled = sweep_enabled;
             manual_angle = servo_manual_angle;
             min_angle = servo_min_angle;
@@ -345,7 +854,18 @@ void servoSweepTask(void* parameter) {
             step_size = servo_step;
             settle_time = servo_settle_ms;
             reading_delay = servo_reading_delay_ms;
-            xSemaphoreGive(configMutex);
+            lockGive(LOCK_CONFIG);
+        }
+
+        // TOF failed: the wide ultrasonic beam needs no fine steps
+        int sweep_step = step_size;
+        if (sensorHealthSweepMode() == SWEEP_HEALTH_ULTRASONIC_ONLY) {
+            sweep_step = step_size * SWEEP_DEGRADED_STEP_FACTOR;
+        }
+
+        // Leaving tracking mode drops the target: re-acquire on return
+        if (!is_sweep_enabled || params.sweep_mode != SWEEP_TRACKING) {
+            tracking.acquired = false;
         }
 
         // ====================================================================
@@ -354,49 +874,19 @@ void servoSweepTask(void* parameter) {
         if (!is_sweep_enabled) {
             // Move servo to manual position
             tofServo.write(manual_angle);
+            last_servo_angle = manual_angle;
 
             // Update shared servo angle
             extern volatile int shared_servo_angle;
-            extern volatile float shared_tof_current;
             shared_servo_angle = manual_angle;
 
-            // Read TOF distance at manual position
+            // Read both sensors at manual position
             vTaskDelay(pdMS_TO_TICKS(settle_time));
-            float tof_distance = tofGetDistance();
-
-            // Read ultrasonic distance
-            float ultrasonic_distance = ultrasonicGetDistance();
-
-            // Store raw sensor readings for CSV logging
-            shared_tof_raw_cm = tof_distance;
-            shared_ultrasonic_raw_cm = ultrasonic_distance;
-
-            // Use the smaller valid distance and track which sensor
-            float distance;
-            bool tof_valid = (tof_distance > 0 && tof_distance < 999.0f);
-            bool us_valid = (ultrasonic_distance > 0 && ultrasonic_distance < 999.0f);
-
-            if (!tof_valid && !us_valid) {
-                distance = 999.0f;
-                shared_active_sensor = SENSOR_NONE;
-            } else if (!tof_valid) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else if (!us_valid) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (tof_distance < ultrasonic_distance) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (ultrasonic_distance < tof_distance) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else {
-                distance = tof_distance;  // Equal
-                shared_active_sensor = SENSOR_BOTH_EQUAL;
-            }
+            float tof_distance, ultrasonic_distance;
+            readRangeSensors(&tof_distance, &ultrasonic_distance);
 
-            shared_tof_current = distance;
+            // Fuse, publish for the DataPacket and queue the sample
+            float distance = recordSweepSample(manual_angle, tof_distance, ultrasonic_distance);
 
             // Determine sector for this angle using robust nearest-center algorithm
             int sector_index = getSectorForAngle(manual_angle);
@@ -412,6 +902,22 @@ void servoSweepTask(void* parameter) {
             continue;  // Skip sweep code, restart loop
         }
 
+        // ====================================================================
+        // Tracking mode: dither on the closest obstacle, refresh the others
+        // ====================================================================
+        if (params.sweep_mode == SWEEP_TRACKING) {
+            runTrackingSlice(min_angle, max_angle, sweep_step, settle_time, reading_delay);
+            continue;
+        }
+
+        // ====================================================================
+        // Continuous mode: bidirectional without settle, lag-corrected binning
+        // ====================================================================
+        if (params.sweep_mode == SWEEP_CONTINUOUS) {
+            runContinuousCycle(min_angle, max_angle, sweep_step);
+            continue;
+        }
+
         // ====================================================================
         // Automatic servo sweep mode (5 sectors, one per motor)
         // ====================================================================
@@ -422,309 +928,216 @@ void servoSweepTask(void* parameter) {
         // Motor 5: 141° - 175°
         // ====================================================================
 
-#ifdef SWEEP_MODE_FORWARD
-        // ====================================================================
-        // FORWARD SWEEP MODE: 0° to 120°, then restart at 0°
-        // ====================================================================
-
-        // Track minimum distance per sector (one per motor)
-        float min_distance_sector[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
-        int angle_of_min_sector[5] = {SECTOR_MOTOR_1_MIN, SECTOR_MOTOR_2_MIN,
-                                       SECTOR_MOTOR_3_MIN, SECTOR_MOTOR_4_MIN,
-                                       SECTOR_MOTOR_5_MIN};
-
-        // Track which sectors have been completed and updated
-        bool sector_updated[5] = {false, false, false, false, false};
+        if (params.sweep_mode == SWEEP_FORWARD) {
+            // ====================================================================
+            // FORWARD SWEEP MODE: 0° to 120°, then restart at 0°
+            // ====================================================================
 
-        // Sweep from min to max angle (using runtime configuration)
-        for (int angle = min_angle; angle <= max_angle; angle += step_size) {
-            // Move servo to current angle
-            tofServo.write(angle);
+            // Track minimum distance per sector (one per motor)
+            float min_distance_sector[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
+            int angle_of_min_sector[5] = {SECTOR_MOTOR_1_MIN, SECTOR_MOTOR_2_MIN,
+                                           SECTOR_MOTOR_3_MIN, SECTOR_MOTOR_4_MIN,
+                                           SECTOR_MOTOR_5_MIN};
 
-            // Update shared servo angle (for live radar display)
-            extern volatile int shared_servo_angle;
-            extern volatile float shared_tof_current;
-            shared_servo_angle = angle;
+            // Track which sectors have been completed and updated
+            bool sector_updated[5] = {false, false, false, false, false};
 
-            // Wait for servo to settle (using runtime configuration)
-            vTaskDelay(pdMS_TO_TICKS(settle_time));
+            // Sweep from min to max angle (using runtime configuration)
+            for (int angle = min_angle; angle <= max_angle; angle += sweep_step) {
+                // Move servo to current angle
+                tofServo.write(angle);
+                last_servo_angle = angle;
 
-            // Read TOF distance at this angle
-            float tof_distance = tofGetDistance();
-
-            // Read ultrasonic distance
-            float ultrasonic_distance = ultrasonicGetDistance();
-
-            // Store raw sensor readings for CSV logging
-            shared_tof_raw_cm = tof_distance;
-            shared_ultrasonic_raw_cm = ultrasonic_distance;
-
-            // Use the smaller valid distance and track which sensor
-            float distance;
-            bool tof_valid = (tof_distance > 0 && tof_distance < 999.0f);
-            bool us_valid = (ultrasonic_distance > 0 && ultrasonic_distance < 999.0f);
-
-            if (!tof_valid && !us_valid) {
-                distance = 999.0f;
-                shared_active_sensor = SENSOR_NONE;
-            } else if (!tof_valid) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else if (!us_valid) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (tof_distance < ultrasonic_distance) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (ultrasonic_distance < tof_distance) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else {
-                distance = tof_distance;  // Equal
-                shared_active_sensor = SENSOR_BOTH_EQUAL;
-            }
+                // Update shared servo angle (for live radar display)
+                extern volatile int shared_servo_angle;
+                shared_servo_angle = angle;
 
-            // Update live TOF reading for radar display
-            shared_tof_current = distance;
+                // Wait for servo to settle (using runtime configuration)
+                vTaskDelay(pdMS_TO_TICKS(settle_time));
 
-            // Determine which sector (motor) this angle belongs to using robust algorithm
-            int sector_index = getSectorForAngle(angle);
+                // Read both sensors (a failed one is skipped, see sensor_health.h)
+                float tof_distance, ultrasonic_distance;
+                readRangeSensors(&tof_distance, &ultrasonic_distance);
 
-            // Update shared TOF distance for the corresponding sector (for live radar display)
-            if (sector_index >= 0 && distance > 0) {
-                extern volatile float shared_tof_distances[5];
-                shared_tof_distances[sector_index] = distance;
-            }
+                // Fuse, publish for the DataPacket and queue the sample
+                float distance = recordSweepSample(angle, tof_distance, ultrasonic_distance);
 
-            // Update minimum distance for this sector
-            if (sector_index >= 0 && distance > 0 && distance < min_distance_sector[sector_index]) {
-                min_distance_sector[sector_index] = distance;
-                angle_of_min_sector[sector_index] = angle;
-            }
+                // Determine which sector (motor) this angle belongs to using robust algorithm
+                int sector_index = getSectorForAngle(angle);
 
-            // FORWARD sweep: detect sector transition by comparing current vs next angle's sector
-            // This is more robust than checking against fixed boundary values
-            int next_sector = getSectorForAngle(angle + step_size);
-
-            // If we're about to move to a different sector (or end of sweep), update current sector
-            if (sector_index >= 0 && (next_sector != sector_index || angle + step_size > max_angle)) {
-                if (!sector_updated[sector_index] && min_distance_sector[sector_index] < 999.0f) {
-                    if (xSemaphoreTake(distanceMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                        shared_min_distance[sector_index] = min_distance_sector[sector_index];
-                        shared_best_angle[sector_index] = angle_of_min_sector[sector_index];
-                        xSemaphoreGive(distanceMutex);
-                        sector_updated[sector_index] = true;
-                    }
+                // Update shared TOF distance for the corresponding sector (for live radar display)
+                if (sector_index >= 0 && distance > 0) {
+                    extern volatile float shared_tof_distances[5];
+                    shared_tof_distances[sector_index] = distance;
                 }
-            }
-
-            // Small delay between readings (using runtime configuration)
-            vTaskDelay(pdMS_TO_TICKS(reading_delay));
-        }
-
-        // Position servo at center position (90°) for next sweep
-        tofServo.write(90);
-        vTaskDelay(pdMS_TO_TICKS(SERVO_SETTLE_MS));
 
-        // Brief pause before starting next sweep
-        vTaskDelay(pdMS_TO_TICKS(100));
+                // Approaching obstacle: publish now, the sector end finalizes
+                publishIfCloser(sector_index, distance, angle);
 
-#endif // SWEEP_MODE_FORWARD
-
-#ifdef SWEEP_MODE_BIDIRECTIONAL
-        // ====================================================================
-        // BIDIRECTIONAL SWEEP MODE: 0° to 120° to 0°
-        // ====================================================================
-
-        // Track minimum distance per sector (one per motor)
-        float min_distance_sector[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
-        int angle_of_min_sector[5] = {SECTOR_MOTOR_1_MIN, SECTOR_MOTOR_2_MIN,
-                                       SECTOR_MOTOR_3_MIN, SECTOR_MOTOR_4_MIN,
-                                       SECTOR_MOTOR_5_MIN};
+                // Update minimum distance for this sector
+                if (sector_index >= 0 && distance > 0 && distance < min_distance_sector[sector_index]) {
+                    min_distance_sector[sector_index] = distance;
+                    angle_of_min_sector[sector_index] = angle;
+                }
 
-        // Track which sectors have been updated during forward and backward sweeps
-        bool sector_updated_forward[5] = {false, false, false, false, false};
-        bool sector_updated_backward[5] = {false, false, false, false, false};
+                // FORWARD sweep: detect sector transition by comparing current vs next angle's sector
+                // This is more robust than checking against fixed boundary values
+                int next_sector = getSectorForAngle(angle + sweep_step);
+
+                // If we're about to move to a different sector (or end of sweep), update current sector
+                if (sector_index >= 0 && (next_sector != sector_index || angle + sweep_step > max_angle)) {
+                    if (!sector_updated[sector_index] && min_distance_sector[sector_index] < 999.0f) {
+                        if (publishSectorMinimum(sector_index, min_distance_sector[sector_index],
+                                                 angle_of_min_sector[sector_index])) {
+                            sector_updated[sector_index] = true;
+                        }
+                    }
+                }
 
-        // FORWARD SWEEP: min to max angle (using runtime configuration)
-        for (int angle = min_angle; angle <= max_angle; angle += step_size) {
-            // Move servo to current angle
-            tofServo.write(angle);
+                // Small delay between readings (using runtime configuration)
+                vTaskDelay(pdMS_TO_TICKS(reading_delay));
+            }
 
-            // Update shared servo angle (for live radar display)
-            extern volatile int shared_servo_angle;
-            extern volatile float shared_tof_current;
-            shared_servo_angle = angle;
+            // Position servo at center position (90°) for next sweep
+            tofServo.write(90);
+            last_servo_angle = 90;
+            vTaskDelay(pdMS_TO_TICKS(SERVO_SETTLE_MS));
 
-            // Wait for servo to settle (using runtime configuration)
-            vTaskDelay(pdMS_TO_TICKS(settle_time));
+            // Brief pause before starting next sweep
+            vTaskDelay(pdMS_TO_TICKS(100));
+        } else {
+            // ====================================================================
+            // BIDIRECTIONAL SWEEP MODE: 0° to 120° to 0°
+            // ====================================================================
+
+            // Track minimum distance per sector (one per motor)
+            float min_distance_sector[5] = {999.0f, 999.0f, 999.0f, 999.0f, 999.0f};
+            int angle_of_min_sector[5] = {SECTOR_MOTOR_1_MIN, SECTOR_MOTOR_2_MIN,
+                                           SECTOR_MOTOR_3_MIN, SECTOR_MOTOR_4_MIN,
+                                           SECTOR_MOTOR_5_MIN};
+
+            // Track which sectors have been updated during forward and backward sweeps
+            bool sector_updated_forward[5] = {false, false, false, false, false};
+            bool sector_updated_backward[5] = {false, false, false, false, false};
+
+            // FORWARD SWEEP: min to max angle (using runtime configuration)
+            for (int angle = min_angle; angle <= max_angle; angle += sweep_step) {
+                // Move servo to current angle
+                tofServo.write(angle);
+                last_servo_angle = angle;
+
+                // Update shared servo angle (for live radar display)
+                extern volatile int shared_servo_angle;
+                shared_servo_angle = angle;
+
+                // Wait for servo to settle (using runtime configuration)
+                vTaskDelay(pdMS_TO_TICKS(settle_time));
+
+                // Read both sensors (a failed one is skipped, see sensor_health.h)
+                float tof_distance, ultrasonic_distance;
+                readRangeSensors(&tof_distance, &ultrasonic_distance);
+
+                // Fuse, publish for the DataPacket and queue the sample
+                float distance = recordSweepSample(angle, tof_distance, ultrasonic_distance);
+
+                // Determine which sector (motor) this angle belongs to using robust algorithm
+                int sector_index = getSectorForAngle(angle);
+
+                // Update shared TOF distance for the corresponding sector (for live radar display)
+                if (sector_index >= 0 && distance > 0) {
+                    extern volatile float shared_tof_distances[5];
+                    shared_tof_distances[sector_index] = distance;
+                }
 
-            // Read TOF distance at this angle
-            float tof_distance = tofGetDistance();
-
-            // Read ultrasonic distance
-            float ultrasonic_distance = ultrasonicGetDistance();
-
-            // Store raw sensor readings for CSV logging
-            shared_tof_raw_cm = tof_distance;
-            shared_ultrasonic_raw_cm = ultrasonic_distance;
-
-            // Use the smaller valid distance and track which sensor
-            float distance;
-            bool tof_valid = (tof_distance > 0 && tof_distance < 999.0f);
-            bool us_valid = (ultrasonic_distance > 0 && ultrasonic_distance < 999.0f);
-
-            if (!tof_valid && !us_valid) {
-                distance = 999.0f;
-                shared_active_sensor = SENSOR_NONE;
-            } else if (!tof_valid) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else if (!us_valid) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (tof_distance < ultrasonic_distance) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (ultrasonic_distance < tof_distance) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else {
-                distance = tof_distance;  // Equal
-                shared_active_sensor = SENSOR_BOTH_EQUAL;
-            }
+                // Approaching obstacle: publish now, the sector end finalizes
+                publishIfCloser(sector_index, distance, angle);
 
-            // Update live TOF reading for radar display
-            shared_tof_current = distance;
+                // Update minimum distance for this sector
+                if (sector_index >= 0 && distance > 0 && distance < min_distance_sector[sector_index]) {
+                    min_distance_sector[sector_index] = distance;
+                    angle_of_min_sector[sector_index] = angle;
+                }
 
-            // Determine which sector (motor) this angle belongs to using robust algorithm
-            int sector_index = getSectorForAngle(angle);
+                // FORWARD sweep: detect sector transition by comparing current vs next angle's sector
+                int next_sector = getSectorForAngle(angle + sweep_step);
 
-            // Update shared TOF distance for the corresponding sector (for live radar display)
-            if (sector_index >= 0 && distance > 0) {
-                extern volatile float shared_tof_distances[5];
-                shared_tof_distances[sector_index] = distance;
-            }
+                // If we're about to move to a different sector (or end of sweep), update current sector
+                if (sector_index >= 0 && (next_sector != sector_index || angle + sweep_step > max_angle)) {
+                    if (!sector_updated_forward[sector_index] && min_distance_sector[sector_index] < 999.0f) {
+                        if (publishSectorMinimum(sector_index, min_distance_sector[sector_index],
+                                                 angle_of_min_sector[sector_index])) {
+                            sector_updated_forward[sector_index] = true;
+                        }
+                    }
+                }
 
-            // Update minimum distance for this sector
-            if (sector_index >= 0 && distance > 0 && distance < min_distance_sector[sector_index]) {
-                min_distance_sector[sector_index] = distance;
-                angle_of_min_sector[sector_index] = angle;
+                // Small delay between readings (using runtime configuration)
+                vTaskDelay(pdMS_TO_TICKS(reading_delay));
             }
 
-            // FORWARD sweep: detect sector transition by comparing current vs next angle's sector
-            int next_sector = getSectorForAngle(angle + step_size);
-
-            // If we're about to move to a different sector (or end of sweep), update current sector
-            if (sector_index >= 0 && (next_sector != sector_index || angle + step_size > max_angle)) {
-                if (!sector_updated_forward[sector_index] && min_distance_sector[sector_index] < 999.0f) {
-                    if (xSemaphoreTake(distanceMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                        shared_min_distance[sector_index] = min_distance_sector[sector_index];
-                        shared_best_angle[sector_index] = angle_of_min_sector[sector_index];
-                        xSemaphoreGive(distanceMutex);
-                        sector_updated_forward[sector_index] = true;
-                    }
-                }
+            // Reset sector tracking for backward sweep
+            for (int i = 0; i < 5; i++) {
+                min_distance_sector[i] = 999.0f;
+                angle_of_min_sector[i] = SERVO_MAX_ANGLE;
             }
 
-            // Small delay between readings (using runtime configuration)
-            vTaskDelay(pdMS_TO_TICKS(reading_delay));
-        }
+            // BACKWARD SWEEP: max to min angle (using runtime configuration)
+            for (int angle = max_angle; angle >= min_angle; angle -= sweep_step) {
+                // Move servo to current angle
+                tofServo.write(angle);
+                last_servo_angle = angle;
 
-        // Reset sector tracking for backward sweep
-        for (int i = 0; i < 5; i++) {
-            min_distance_sector[i] = 999.0f;
-            angle_of_min_sector[i] = SERVO_MAX_ANGLE;
-        }
+                // Update shared servo angle (for live radar display)
+                extern volatile int shared_servo_angle;
+                shared_servo_angle = angle;
 
-        // BACKWARD SWEEP: max to min angle (using runtime configuration)
-        for (int angle = max_angle; angle >= min_angle; angle -= step_size) {
-            // Move servo to current angle
-            tofServo.write(angle);
+                // Wait for servo to settle (using runtime configuration)
+                vTaskDelay(pdMS_TO_TICKS(settle_time));
 
-            // Update shared servo angle (for live radar display)
-            extern volatile int shared_servo_angle;
-            extern volatile float shared_tof_current;
-            shared_servo_angle = angle;
+                // Read both sensors (a failed one is skipped, see sensor_health.h)
+                float tof_distance, ultrasonic_distance;
+                readRangeSensors(&tof_distance, &ultrasonic_distance);
 
-            // Wait for servo to settle (using runtime configuration)
-            vTaskDelay(pdMS_TO_TICKS(settle_time));
+                // Fuse, publish for the DataPacket and queue the sample
+                float distance = recordSweepSample(angle, tof_distance, ultrasonic_distance);
 
-            // Read TOF distance at this angle
-            float tof_distance = tofGetDistance();
-
-            // Read ultrasonic distance
-            float ultrasonic_distance = ultrasonicGetDistance();
-
-            // Store raw sensor readings for CSV logging
-            shared_tof_raw_cm = tof_distance;
-            shared_ultrasonic_raw_cm = ultrasonic_distance;
-
-            // Use the smaller valid distance and track which sensor
-            float distance;
-            bool tof_valid = (tof_distance > 0 && tof_distance < 999.0f);
-            bool us_valid = (ultrasonic_distance > 0 && ultrasonic_distance < 999.0f);
-
-            if (!tof_valid && !us_valid) {
-                distance = 999.0f;
-                shared_active_sensor = SENSOR_NONE;
-            } else if (!tof_valid) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else if (!us_valid) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (tof_distance < ultrasonic_distance) {
-                distance = tof_distance;
-                shared_active_sensor = SENSOR_TOF;
-            } else if (ultrasonic_distance < tof_distance) {
-                distance = ultrasonic_distance;
-                shared_active_sensor = SENSOR_ULTRASONIC;
-            } else {
-                distance = tof_distance;  // Equal
-                shared_active_sensor = SENSOR_BOTH_EQUAL;
-            }
+                // Determine which sector (motor) this angle belongs to using robust algorithm
+                int sector_index = getSectorForAngle(angle);
 
-            // Update live TOF reading for radar display
-            shared_tof_current = distance;
+                // Update shared TOF distance for the corresponding sector (for live radar display)
+                if (sector_index >= 0 && distance > 0) {
+                    extern volatile float shared_tof_distances[5];
+                    shared_tof_distances[sector_index] = distance;
+                }
 
-            // Determine which sector (motor) this angle belongs to using robust algorithm
-            int sector_index = getSectorForAngle(angle);
+                // Approaching obstacle: publish now, the sector end finalizes
+                publishIfCloser(sector_index, distance, angle);
 
-            // Update shared TOF distance for the corresponding sector (for live radar display)
-            if (sector_index >= 0 && distance > 0) {
-                extern volatile float shared_tof_distances[5];
-                shared_tof_distances[sector_index] = distance;
-            }
+                // Update minimum distance for this sector
+                if (sector_index >= 0 && distance > 0 && distance < min_distance_sector[sector_index]) {
+                    min_distance_sector[sector_index] = distance;
+                    angle_of_min_sector[sector_index] = angle;
+                }
 
-            // Update minimum distance for this sector
-            if (sector_index >= 0 && distance > 0 && distance < min_distance_sector[sector_index]) {
-                min_distance_sector[sector_index] = distance;
-                angle_of_min_sector[sector_index] = angle;
-            }
+                // BACKWARD sweep: detect sector transition by comparing current vs previous angle's sector
+                int prev_sector = getSectorForAngle(angle - sweep_step);
 
-            // BACKWARD sweep: detect sector transition by comparing current vs previous angle's sector
-            int prev_sector = getSectorForAngle(angle - step_size);
-
-            // If we're about to move to a different sector (or end of sweep), update current sector
-            if (sector_index >= 0 && (prev_sector != sector_index || angle - step_size < min_angle)) {
-                if (!sector_updated_backward[sector_index] && min_distance_sector[sector_index] < 999.0f) {
-                    if (xSemaphoreTake(distanceMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                        shared_min_distance[sector_index] = min_distance_sector[sector_index];
-                        shared_best_angle[sector_index] = angle_of_min_sector[sector_index];
-                        xSemaphoreGive(distanceMutex);
-                        sector_updated_backward[sector_index] = true;
+                // If we're about to move to a different sector (or end of sweep), update current sector
+                if (sector_index >= 0 && (prev_sector != sector_index || angle - sweep_step < min_angle)) {
+                    if (!sector_updated_backward[sector_index] && min_distance_sector[sector_index] < 999.0f) {
+                        if (publishSectorMinimum(sector_index, min_distance_sector[sector_index],
+                                                 angle_of_min_sector[sector_index])) {
+                            sector_updated_backward[sector_index] = true;
+                        }
                     }
                 }
+
+                // Small delay between readings (using runtime configuration)
+                vTaskDelay(pdMS_TO_TICKS(reading_delay));
             }
 
-            // Small delay between readings (using runtime configuration)
-            vTaskDelay(pdMS_TO_TICKS(reading_delay));
+            // Brief pause before starting next sweep (already at min angle)
+            vTaskDelay(pdMS_TO_TICKS(100));
         }
-
-        // Brief pause before starting next sweep (already at min angle)
-        vTaskDelay(pdMS_TO_TICKS(100));
-
-#endif // SWEEP_MODE_BIDIRECTIONAL
     }
 }
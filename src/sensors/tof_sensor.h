@@ -15,8 +15,8 @@
 #include <ESP32PWM.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
-#include <freertos/semphr.h>
 #include "../config/system_config.h"
+#include "../config/param_registry.h"
 
 // ============================================================================
 // Distance Ranges and Setpoints
@@ -53,7 +53,7 @@ constexpr float DISTANCE_CLOSE_MIN = 50.0f;  // Always 50 cm (sensor minimum)
 // 0% = prestress (no pressure), 100% = 95% of maxstress
 // ============================================================================
 
-// Maximum force output when potentiometer is at 100%
+// Maximum force output when potentiometer is at 100% (defaults, see PARAM:SET:SETPOINT_*)
 // Adjust these values to change the ratio between ranges
 // The potentiometer scales all of them proportionally (master volume)
 constexpr float SETPOINT_FAR = 50.0f;           // Setpoint for FAR range (200-300cm) - 50%
@@ -73,10 +73,15 @@ constexpr float SETPOINT_MEDIUM_N = SETPOINT_MEDIUM;
 constexpr float SETPOINT_CLOSE_N = SETPOINT_CLOSE;
 constexpr float SAFE_PRESSURE_THRESHOLD_N = SAFE_PRESSURE_THRESHOLD;
 
-// Out-of-range safety parameters (mode-independent)
-constexpr uint32_t RELEASE_TIME_MS = 600;          // Additional reverse time after reaching threshold (ms)
+// Out-of-range safety parameters (mode-independent, defaults for PARAM:SET)
+constexpr uint32_t RELEASE_TIME_MS = 600;          // Maximum reverse time if threshold is never reached (ms)
+constexpr uint32_t RELEASE_HOLD_MS = 100;          // Additional reverse time after reaching threshold (ms)
 constexpr float REVERSE_DUTY_PCT = 60.0f;           // Reverse duty cycle for deflation (%)
 
+// TOF frame wait (see sensor_health.h)
+constexpr uint16_t TOF_READ_TIMEOUT_MS = 1000;     // Working sensor
+constexpr uint16_t TOF_PROBE_TIMEOUT_MS = 150;     // Recovery probe of a failed sensor
+
 // ============================================================================
 // Enumerations
 // ============================================================================
@@ -98,7 +103,7 @@ enum DistanceRange {
 enum SystemState {
     NORMAL_OPERATION,          // Normal PI control active
     OUT_OF_RANGE_DEFLATING,    // Actively deflating (reverse until pressure <= threshold)
-    OUT_OF_RANGE_RELEASING,    // Continue reversing for 500ms after reaching threshold
+    OUT_OF_RANGE_RELEASING,    // Continue reversing for RELEASE_HOLD_MS after reaching threshold
     WAITING_FOR_VALID_READING  // Motors stopped, waiting for sensor to return to valid range
 };
 
@@ -113,15 +118,14 @@ enum ActiveSensor {
 };
 
 // ============================================================================
-// Shared Variables (Protected by Mutex)
+// Shared Variables (Protected by LOCK_DISTANCE)
 // ============================================================================
 
-extern SemaphoreHandle_t distanceMutex;
-
 // MODE_A: Single distance/angle for fixed servo
 // MODE_B: Array of 5 distances/angles (one per motor sector)
 extern volatile float shared_min_distance[5];  // Minimum distance per motor sector
 extern volatile int shared_best_angle[5];      // Angle of minimum distance per motor sector
+extern volatile uint32_t shared_sector_ms[5];  // millis() of the last publish (0 = never)
 extern volatile bool sweep_active;
 
 // Active sensor tracking (which sensor provided the minimum distance)
@@ -131,6 +135,29 @@ extern volatile ActiveSensor shared_active_sensor;  // Current sensor providing
 extern volatile float shared_tof_raw_cm;         // Raw TOF reading at current servo angle
 extern volatile float shared_ultrasonic_raw_cm;  // Raw ultrasonic reading
 
+// ============================================================================
+// Sweep Sample Stream
+// ============================================================================
+
+constexpr uint32_t SCAN_QUEUE_SLOTS = 64;   // Power of two, ~1 s of sweep steps at the fastest settings
+
+/**
+ * @brief One sweep measurement (every step, manual mode included)
+ *
+ * Queued by servoSweepTask and drained by the telemetry task, so the host
+ * sees every measurement exactly once. seq counts every sample taken, a gap
+ * in seq means samples were lost to a full queue.
+ */
+struct ScanSample {
+    uint32_t seq;              // Sample number since boot
+    uint32_t timestamp_ms;     // millis() after both sensors were read
+    float tof_cm;              // Raw TOF reading (-1 = error)
+    float ultrasonic_cm;       // Raw ultrasonic reading
+    float distance_cm;         // Fused minimum (999 = no valid reading)
+    int16_t angle;             // Servo angle (degrees)
+    uint8_t active_sensor;     // ActiveSensor that provided distance_cm
+};
+
 // ============================================================================
 // Public Functions
 // ============================================================================
@@ -139,7 +166,7 @@ extern volatile float shared_ultrasonic_raw_cm;  // Raw ultrasonic reading
  * @brief Initialize TOF sensor and servo system
  *
  * Configures serial communication with TOF sensor and initializes servo.
- * Creates mutex for thread-safe access to shared variables.
+ * Creates LOCK_DISTANCE for thread-safe access to shared variables.
  * Must be called once during setup.
  */
 void initTOFSensor();
@@ -149,10 +176,12 @@ void initTOFSensor();
  *
  * Reads a single distance measurement from the TOF sensor.
  * Handles serial communication protocol and checksum verification.
+ * The outcome is reported to the sensor health monitor.
  *
+ * @param timeout_ms Longest wait for a valid frame
  * @return Distance in centimeters, or -1.0 on error
  */
-float tofGetDistance();
+float tofGetDistance(uint16_t timeout_ms = TOF_READ_TIMEOUT_MS);
 
 /**
  * @brief Classify distance into range category
@@ -170,9 +199,37 @@ DistanceRange getDistanceRange(float distance);
  *
  * @param range Current distance range
  * @param baseline_force_n Baseline force captured when entering FAR range (N)
+ * @param params Parameter snapshot for this tick (SETPOINT_FAR/MEDIUM/CLOSE)
  * @return Setpoint in Newtons, or -1.0 if invalid
  */
-float calculateSetpoint(DistanceRange range, float baseline_force_n);
+float calculateSetpoint(DistanceRange range, float baseline_force_n, const ParamSnapshot& params);
+
+/**
+ * @brief Sector distance with its age
+ */
+struct SectorReading {
+    float distance_cm;   // Sector minimum (999.0 = no valid reading yet)
+    int angle;           // Servo angle of that minimum
+    uint32_t age_ms;     // Time since the sweep published it (0 = never published)
+    bool from_cache;     // true = LOCK_DISTANCE timed out, last good value served
+};
+
+/**
+ * @brief Read a sector's minimum distance without ever failing (thread-safe)
+ *
+ * Takes LOCK_DISTANCE with a 10 ms timeout. On timeout the last value this
+ * function returned for the sector is served again with its grown age, so
+ * a busy sweep task never turns into a 999 cm "no obstacle" reading.
+ *
+ * @param motor_index Motor index (0-4)
+ * @return Reading; distance 999.0 only if the sector was never published
+ */
+SectorReading readSectorDistance(int motor_index);
+
+/**
+ * @brief Number of readSectorDistance() calls served from the cache
+ */
+uint32_t getDistanceReadFallbacks();
 
 /**
  * @brief Get minimum distance for a specific motor (thread-safe)
@@ -182,6 +239,7 @@ float calculateSetpoint(DistanceRange range, float baseline_force_n);
  *
  * @param motor_index Motor index (0-4)
  * @return Minimum distance in centimeters for that motor's sector
+ *         (see readSectorDistance() for the timeout behavior)
  */
 float getMinDistance(int motor_index);
 
@@ -196,12 +254,28 @@ float getMinDistance(int motor_index);
  */
 int getBestAngle(int motor_index);
 
+/**
+ * @brief Pop the oldest queued sweep sample (consumer side, non-blocking)
+ *
+ * Single consumer: only the telemetry task may call this.
+ *
+ * @param sample Output sample
+ * @return false if no sample is waiting
+ */
+bool popScanSample(ScanSample* sample);
+
+/**
+ * @brief Total sweep samples dropped because the queue was full
+ */
+uint32_t getScanSampleOverflows();
+
 /**
  * @brief Servo sweep task (runs on Core 0)
  *
  * FreeRTOS task that continuously sweeps the servo from min to max angle,
  * reading TOF distance at each step. Updates shared_min_distance and
- * shared_best_angle variables with mutex protection.
+ * shared_best_angle variables under LOCK_DISTANCE and queues every
+ * measurement as a ScanSample (see popScanSample()).
  *
  * @param parameter Task parameter (unused)
  */
@@ -4,6 +4,8 @@
  */
 
 #include "ultrasonic_sensor.h"
+#include "sensor_health.h"
+#include "../utils/tlog.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
@@ -46,31 +48,85 @@ float readDistanceAnalog() {
     return distance_cm;
 }
 
-float readDistanceSerial() {
-    // Check if data available
-    if (Serial2.available() < 1) {
-        return -1.0f;
+/**
+ * @brief MaxSonar line parser state ("R" + 3 or 4 digits + CR)
+ */
+struct SonarParser {
+    bool in_line;
+    uint8_t digits;
+    uint16_t value;
+};
+
+static SonarParser sonar_parser = {false, 0, 0};
+static UltrasonicSample sonar_sample = {-1.0f, 0, 0};
+static portMUX_TYPE sonar_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Feed one byte to the parser
+ * @param distance_cm Output when a line completes
+ * @return true if the byte completed a valid line
+ */
+static bool sonarParseByte(SonarParser& parser, uint8_t byte, float* distance_cm) {
+    if (byte == 'R') {
+        parser.in_line = true;           // Also resyncs after a corrupt line
+        parser.digits = 0;
+        parser.value = 0;
+        return false;
+    }
+    if (!parser.in_line) {
+        return false;
+    }
+    if (byte >= '0' && byte <= '9' && parser.digits < 4) {
+        parser.value = (uint16_t)(parser.value * 10 + (byte - '0'));
+        parser.digits++;
+        return false;
+    }
+    // CR, or anything unexpected: the line ends here
+    parser.in_line = false;
+    if (byte != '\r' || parser.digits < 3) {
+        return false;
     }
+    *distance_cm = (parser.digits == 4) ? parser.value * 0.1f : (float)parser.value;
+    return true;
+}
 
-    // Read until 'R' character (start of range data)
-    while (Serial2.available()) {
-        char c = Serial2.read();
-        if (c == 'R') {
-            // Read 3-digit range (e.g., "R123\r")
-            String rangeStr = "";
-            for (int i = 0; i < 3; i++) {
-                if (Serial2.available()) {
-                    rangeStr += (char)Serial2.read();
-                }
-            }
-
-            // Convert to integer (range in cm)
-            int distance_cm = rangeStr.toInt();
-            return (float)distance_cm;
+float readDistanceSerial() {
+    float newest_cm = -1.0f;
+    uint32_t bytes_after = 0;            // Bytes received after the newest line
+    for (size_t n = 0; n < US_SERIAL_RX_BUFFER && Serial2.available() > 0; ++n) {
+        int byte = Serial2.read();
+        if (byte < 0) {
+            break;
+        }
+        float distance_cm;
+        if (sonarParseByte(sonar_parser, (uint8_t)byte, &distance_cm)) {
+            newest_cm = distance_cm;
+            bytes_after = 0;
+        } else {
+            bytes_after++;
         }
     }
+    if (newest_cm < 0.0f) {
+        return -1.0f;
+    }
 
-    return -1.0f;
+    portENTER_CRITICAL(&sonar_mux);
+    sonar_sample.distance_cm = newest_cm;
+    sonar_sample.timestamp_ms = millis() - bytes_after * US_SERIAL_BYTE_US / 1000;
+    sonar_sample.seq++;
+    portEXIT_CRITICAL(&sonar_mux);
+    return newest_cm;
+}
+
+bool ultrasonicGetSample(UltrasonicSample* out) {
+    portENTER_CRITICAL(&sonar_mux);
+    UltrasonicSample sample = sonar_sample;
+    portEXIT_CRITICAL(&sonar_mux);
+    if (sample.seq == 0) {
+        return false;
+    }
+    *out = sample;
+    return true;
 }
 
 // ============================================================================
@@ -81,43 +137,61 @@ void initUltrasonicSensor() {
 #if ULTRASONIC_MODE == MODE_PWM
     // Configure pin as input for PWM reading
     pinMode(ULTRASONIC_PIN, INPUT);
-    Serial.println("    Ultrasonic sensor initialized (PWM mode)");
+    TLOG("    Ultrasonic sensor initialized (PWM mode)");
 
 #elif ULTRASONIC_MODE == MODE_ANALOG
     // Configure pin as analog input
     pinMode(ULTRASONIC_PIN, INPUT);
     analogReadResolution(12); // 12-bit resolution
-    Serial.println("    Ultrasonic sensor initialized (Analog mode)");
+    TLOG("    Ultrasonic sensor initialized (Analog mode)");
 
 #elif ULTRASONIC_MODE == MODE_SERIAL
     // Configure Serial2 for MaxSonar communication
+    Serial2.setRxBufferSize(US_SERIAL_RX_BUFFER);
     Serial2.begin(US_SERIAL_BAUD, SERIAL_8N1, ULTRASONIC_PIN, -1); // RX only
-    Serial.println("    Ultrasonic sensor initialized (Serial mode)");
+    TLOG("    Ultrasonic sensor initialized (Serial mode)");
 
 #else
     #error "Invalid ULTRASONIC_MODE. Use: MODE_PWM, MODE_ANALOG, or MODE_SERIAL"
 #endif
 
-    Serial.printf("    Pin: GPIO %d, Range: 30-500cm\n", ULTRASONIC_PIN);
+    TLOG("    Pin: GPIO %d, Range: 30-500cm", ULTRASONIC_PIN);
     delay(250); // Give sensor time to stabilize
 }
 
 float ultrasonicGetDistance() {
     float distance = -1.0f;
+    ReadOutcome outcome = READ_OK;
 
 #if ULTRASONIC_MODE == MODE_PWM
     distance = readDistancePWM();
+    if (distance < 0.0f) {
+        outcome = READ_TIMEOUT;   // No pulse
+    }
 #elif ULTRASONIC_MODE == MODE_ANALOG
     distance = readDistanceAnalog();
+    if (distance < US_NO_SIGNAL_CM) {
+        outcome = READ_TIMEOUT;   // Output pulled low: sensor unpowered or unplugged
+    }
 #elif ULTRASONIC_MODE == MODE_SERIAL
+    static uint32_t last_line_ms = millis();   // Silence counts from the first read
     distance = readDistanceSerial();
+    if (distance >= 0.0f) {
+        last_line_ms = millis();
+    } else if (millis() - last_line_ms < US_SERIAL_SILENT_MS) {
+        return -1.0f;             // Next line not sent yet: not a read
+    } else {
+        outcome = READ_TIMEOUT;
+    }
 #endif
 
     // Validate range
     if (distance < ULTRASONIC_MIN_CM || distance > ULTRASONIC_MAX_CM) {
+        sensorHealthRecord(HEALTH_ULTRASONIC, outcome == READ_OK ? READ_OUT_OF_RANGE : outcome, distance);
         return -1.0f;  // Out of valid range
     }
 
+    sensorHealthRecord(HEALTH_ULTRASONIC, READ_OK, distance);
     return distance;
 }
 
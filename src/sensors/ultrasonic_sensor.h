@@ -5,7 +5,8 @@
  * This sensor supports 3 output modes (only one pin needed):
  * - Analog (AN): Voltage output (Vcc/512 per cm)
  * - PWM (PW): Pulse width output (147μs per cm)
- * - Serial (TX): Serial output at 9600 baud
+ * - Serial (TX): Serial output at 9600 baud, "R####\r" in mm (HRLV) or
+ *   "R###\r" in cm (LV/XL variants), parsed byte by byte
  *
  * Default: ANALOG mode on GPIO 5
  * Range: 30cm - 500cm (HRLV model)
@@ -44,11 +45,17 @@ constexpr uint32_t US_PWM_TIMEOUT_US = 100000; // 100ms timeout
 
 // Serial mode
 constexpr uint32_t US_SERIAL_BAUD = 9600;
+constexpr size_t US_SERIAL_RX_BUFFER = 256;     // Driver ring (must exceed the 128-byte FIFO): ~40 lines, ~270 ms at 9600 baud
+constexpr uint32_t US_SERIAL_BYTE_US = 1000000UL * 10 / US_SERIAL_BAUD;  // 8N1: 10 bits per byte
 
 // Sensor range limits
 constexpr float ULTRASONIC_MIN_CM = 30.0f;    // Minimum reliable range
 constexpr float ULTRASONIC_MAX_CM = 500.0f;   // Maximum range
 
+// Health classification (see sensor_health.h)
+constexpr float US_NO_SIGNAL_CM = 15.0f;          // Analog: HRLV never reports below 30 cm
+constexpr uint32_t US_SERIAL_SILENT_MS = 500;     // Serial: no line for this long = timeout
+
 // ============================================================================
 // Shared Variables
 // ============================================================================
@@ -56,6 +63,19 @@ constexpr float ULTRASONIC_MAX_CM = 500.0f;   // Maximum range
 // Current ultrasonic distance reading (updated by Core 0 task)
 extern volatile float shared_ultrasonic_distance;
 
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Latest complete serial line (MODE_SERIAL)
+ */
+struct UltrasonicSample {
+    float distance_cm;           // 0.1 cm steps from mm sensors, 1 cm from cm sensors
+    uint32_t timestamp_ms;       // millis() when the line's CR arrived
+    uint32_t seq;                // Lines parsed since boot
+};
+
 // ============================================================================
 // Public Functions
 // ============================================================================
@@ -82,14 +102,26 @@ float readDistanceAnalog();
 
 /**
  * @brief Read distance using serial output
- * @return Distance in centimeters, or -1 if error
+ *
+ * Feeds the bytes received since the last call through the line parser
+ * (constant time per byte, no allocation; a line split across calls is
+ * completed on the next one) and publishes the newest complete line.
+ *
+ * @return Distance in centimeters, or -1 if no new line arrived
  */
 float readDistanceSerial();
 
+/**
+ * @brief Copy the newest serial sample (safe from any task)
+ * @return false if no line was parsed yet
+ */
+bool ultrasonicGetSample(UltrasonicSample* out);
+
 /**
  * @brief Read distance from ultrasonic sensor (uses configured mode)
  *
  * Reads the sensor based on ULTRASONIC_MODE setting.
+ * The outcome is reported to the sensor health monitor.
  *
  * @return Distance in centimeters, or -1.0 if error/out of range
  */
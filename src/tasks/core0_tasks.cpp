@@ -6,9 +6,19 @@
 #include "core0_tasks.h"
 #include "../sensors/tof_sensor.h"
 #include "../sensors/ultrasonic_sensor.h"
+#include "../sensors/sensor_health.h"
+#include "../actuators/motors.h"
 #include "../config/pins.h"
 #include "../config/system_config.h"
+#include "../control/control_watchdog.h"
+#include "../control/pressure_loop.h"
+#include "../control/safety_state_machine.h"
+#include "../config/param_registry.h"
 #include "../utils/binary_protocol.h"
+#include "../utils/loop_timing.h"
+#include "../utils/telemetry_stats.h"
+#include "../utils/ota_update.h"
+#include <stddef.h>
 
 // ============================================================================
 // Shared Variables (Extern declarations in header)
@@ -30,18 +40,205 @@ volatile float shared_dist_close_max = 100.0f;  // CLOSE/MEDIUM boundary
 volatile float shared_dist_medium_max = 200.0f; // MEDIUM/FAR boundary
 volatile float shared_dist_far_max = 300.0f;    // FAR/OUT boundary
 
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+#ifdef PROTOCOL_BINARY
+static inline uint16_t clampU16(uint32_t value) {
+    return value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+}
+
+/**
+ * @brief Take one loop's timing window into a frame entry
+ */
+static void fillLoopTimingEntry(LoopTimingEntry* entry, LoopId id) {
+    LoopTimingSnapshot snapshot;
+    takeLoopTiming(id, &snapshot);
+    entry->rate_hz = clampU16(snapshot.rate_hz);
+    entry->ticks = clampU16(snapshot.ticks);
+    entry->late_ticks = clampU16(snapshot.late_ticks);
+    entry->overruns = clampU16(snapshot.overruns);
+    entry->exec_avg_us = clampU16(snapshot.exec_avg_us);
+    entry->exec_max_us = clampU16(snapshot.exec_max_us);
+    entry->period_max_us = snapshot.period_max_us;
+}
+
+/**
+ * @brief Take the statistics window of one kind and send it as a frame
+ */
+static void sendStatsSummary(StatsKind kind, uint32_t window_ms) {
+    static_assert(STATS_BUCKETS == 8, "StatsChannelSummary.histogram must match STATS_BUCKETS");
+    static_assert(NUM_MOTORS == 5, "StatsSummaryPayload.channels must match NUM_MOTORS");
+
+    ChannelStatsSnapshot stats[NUM_MOTORS];
+    takeStatsWindow(kind, stats);
+
+    StatsSummaryPayload payload;
+    payload.kind = (uint8_t)kind;
+    payload.channel_count = NUM_MOTORS;
+    payload.window_ms = clampU16(window_ms);
+    float bucket_min = 0.0f, bucket_width = 0.0f;
+    getStatsBuckets(kind, &bucket_min, &bucket_width);
+    payload.bucket_min = bucket_min;
+    payload.bucket_width = bucket_width;
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        StatsChannelSummary& ch = payload.channels[i];
+        ch.count = clampU16(stats[i].count);
+        ch.mean = stats[i].mean;
+        ch.stddev = stats[i].stddev;
+        ch.min = stats[i].min;
+        ch.max = stats[i].max;
+        ch.p95 = stats[i].p95;
+        for (int b = 0; b < STATS_BUCKETS; ++b) {
+            ch.histogram[b] = clampU16(stats[i].histogram[b]);
+        }
+    }
+    sendFrame(FRAME_STATS_SUMMARY, &payload, sizeof(payload));
+}
+
+static inline int16_t toCmX10(float cm) {
+    float scaled = cm * 10.0f;
+    if (scaled > 32767.0f) return 32767;
+    if (scaled < -32768.0f) return -32768;
+    return (int16_t)lroundf(scaled);
+}
+
+/**
+ * @brief Send every queued sweep sample as FRAME_SCAN_SAMPLES frames
+ *
+ * Consecutive samples share a frame; a gap in seq (queue overflow) starts
+ * a new one so first_seq + i always holds.
+ */
+static void sendScanSamples() {
+    ScanSamplesPayload payload;
+    payload.count = 0;
+    uint32_t next_seq = 0;
+
+    ScanSample sample;
+    while (popScanSample(&sample)) {
+        if (payload.count > 0 && sample.seq != next_seq) {
+            payload.overflows = getScanSampleOverflows();
+            sendFrame(FRAME_SCAN_SAMPLES, &payload,
+                      offsetof(ScanSamplesPayload, samples) + payload.count * sizeof(ScanSampleWire));
+            payload.count = 0;
+        }
+        if (payload.count == 0) {
+            payload.first_seq = sample.seq;
+        }
+        ScanSampleWire& wire = payload.samples[payload.count++];
+        wire.timestamp_ms = sample.timestamp_ms;
+        wire.tof_cm_x10 = toCmX10(sample.tof_cm);
+        wire.ultrasonic_cm_x10 = toCmX10(sample.ultrasonic_cm);
+        wire.distance_cm_x10 = toCmX10(sample.distance_cm);
+        wire.angle = (uint8_t)sample.angle;  // SERVO_MIN_ANGLE..SERVO_MAX_ANGLE
+        wire.active_sensor = sample.active_sensor;
+        next_seq = sample.seq + 1;
+
+        if (payload.count == SCAN_SAMPLES_PER_FRAME) {
+            payload.overflows = getScanSampleOverflows();
+            sendFrame(FRAME_SCAN_SAMPLES, &payload, sizeof(payload));
+            payload.count = 0;
+        }
+    }
+
+    if (payload.count > 0) {
+        payload.overflows = getScanSampleOverflows();
+        sendFrame(FRAME_SCAN_SAMPLES, &payload,
+                  offsetof(ScanSamplesPayload, samples) + payload.count * sizeof(ScanSampleWire));
+    }
+}
+
+static inline uint32_t toDeciseconds(uint64_t us) {
+    uint64_t ds = us / 100000ULL;
+    return ds > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t)ds;
+}
+
+/**
+ * @brief Send the lifetime actuation counters as a FRAME_MOTOR_STATS frame
+ */
+static void sendMotorStats(uint32_t time_ms) {
+    static_assert(NUM_MOTORS == 5, "MotorStatsPayload.motors must match NUM_MOTORS");
+    static_assert(MOTOR_MODE_COUNT == 4 && MOTOR_STATE_SLOTS == 4,
+                  "MotorStatsEntry arrays must match motors.h");
+
+    MotorStatsPayload payload;
+    payload.uptime_ms = time_ms;
+    payload.emergency_brakes = getEmergencyBrakeCount();
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        MotorCounters counters;
+        getMotorCounters(i, &counters);
+        MotorStatsEntry& entry = payload.motors[i];
+        for (int m = 0; m < MOTOR_MODE_COUNT; ++m) {
+            entry.mode_ds[m] = toDeciseconds(counters.mode_us[m]);
+        }
+        for (int s = 0; s < MOTOR_STATE_SLOTS; ++s) {
+            entry.state_ds[s] = toDeciseconds(counters.state_us[s]);
+        }
+        entry.duty_ds = toDeciseconds(counters.duty_us);
+        entry.saturated_ds = toDeciseconds(counters.saturated_us);
+        entry.reversals = counters.reversals;
+        entry.brake_events = counters.brake_events;
+    }
+    sendFrame(FRAME_MOTOR_STATS, &payload, sizeof(payload));
+}
+
+/**
+ * @brief Send the range sensor health frame
+ */
+static void sendSensorHealth(uint32_t time_ms) {
+    static_assert(HEALTH_SENSOR_COUNT == 2, "SensorHealthPayload.sensors must match HEALTH_SENSOR_COUNT");
+
+    SensorHealthPayload payload;
+    payload.uptime_ms = time_ms;
+    payload.sweep_mode = (uint8_t)sensorHealthSweepMode();
+    for (int i = 0; i < HEALTH_SENSOR_COUNT; ++i) {
+        SensorHealth health;
+        getSensorHealth((HealthSensor)i, &health);
+        SensorHealthEntry& entry = payload.sensors[i];
+        entry.status = (uint8_t)health.status;
+        entry.fault = (uint8_t)health.fault;
+        entry.rate_dhz = (uint16_t)lroundf(fminf(health.rate_hz * 10.0f, 65535.0f));
+        entry.timeout_pct = health.timeout_pct;
+        entry.checksum_pct = health.checksum_pct;
+        entry.out_of_range_pct = health.out_of_range_pct;
+        entry.reads = health.reads;
+        entry.timeouts = health.timeouts;
+        entry.checksum_errors = health.checksum_errors;
+        entry.out_of_range = health.out_of_range;
+        entry.stuck_events = health.stuck_events;
+        entry.failures = health.failures;
+    }
+    sendFrame(FRAME_SENSOR_HEALTH, &payload, sizeof(payload));
+}
+#endif
+
 // ============================================================================
 // Task Implementations
 // ============================================================================
 
 void serialPrintTask(void* parameter) {
     TickType_t lastWakeTime = xTaskGetTickCount();
-    const TickType_t frequency = pdMS_TO_TICKS(LOGGING_PERIOD_MS);
+
+    // Diagnostic frames are sent at 1 Hz
+    uint32_t last_diag_ms = 0;
+    PressureLoopStats last_loop_stats = {0, 0, 0, 0, 0};
+    uint32_t last_stats_ms = 0;
 
     for (;;) {
+        // Keep the link free for OTA:* replies while an image is written
+        if (otaInProgress()) {
+            vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(LOGGING_PERIOD_MS));
+            continue;
+        }
+
         // Get current time
         uint32_t time_ms = millis();
 
+        // Logging period and telemetry mode may change at runtime (PARAM:SET)
+        ParamSnapshot params;
+        paramSnapshot(&params);
+
         // Local copies of arrays (all values now in percentage 0-100%)
         float setpoints[NUM_MOTORS];
         float pp_pct[NUM_MOTORS];
@@ -74,22 +271,95 @@ void serialPrintTask(void* parameter) {
         // ====================================================================
         // Binary Protocol Output (for frontend)
         // ====================================================================
-        DataPacket packet;
-        // Mode is always 1 (sweep mode)
-        uint8_t mode_byte = 1;
-        uint8_t active_sensor = (uint8_t)shared_active_sensor;
-        buildDataPacket(&packet, time_ms, setpoints, pp_pct, duty, tof_dist,
-                        (uint8_t)servo_angle, tof_current, mode_byte, active_sensor,
-                        ultrasonic_cm, tof_raw_cm,
-                        force_scale, distance_scale,
-                        dist_close_max, dist_medium_max, dist_far_max);
-        sendBinaryPacket(&packet);
+        if (params.telemetry_mode != TELEMETRY_SUMMARY) {
+            DataPacket packet;
+            // Mode is always 1 (sweep mode)
+            uint8_t mode_byte = 1;
+            uint8_t active_sensor = (uint8_t)shared_active_sensor;
+            buildDataPacket(&packet, time_ms, setpoints, pp_pct, duty, tof_dist,
+                            (uint8_t)servo_angle, tof_current, mode_byte, active_sensor,
+                            ultrasonic_cm, tof_raw_cm,
+                            force_scale, distance_scale,
+                            dist_close_max, dist_medium_max, dist_far_max);
+            sendBinaryPacket(&packet);
+        }
+
+        // Statistics windows are always taken so a mode switch starts fresh
+        if (time_ms - last_stats_ms >= params.stats_period_ms) {
+            uint32_t window_ms = time_ms - last_stats_ms;
+            last_stats_ms = time_ms;
+            for (int kind = 0; kind < STATS_KIND_COUNT; ++kind) {
+                if (params.telemetry_mode == TELEMETRY_RAW) {
+                    ChannelStatsSnapshot discard[NUM_MOTORS];
+                    takeStatsWindow((StatsKind)kind, discard);
+                } else {
+                    sendStatsSummary((StatsKind)kind, window_ms);
+                }
+            }
+        }
+
+        // Every sweep measurement since the last cycle, exactly once
+        sendScanSamples();
+
+        // Forward safety state transitions queued by the control loop
+        SafetyEvent event;
+        while (popSafetyEvent(&event)) {
+            StateEventPayload payload;
+            payload.timestamp_ms = event.timestamp_ms;
+            payload.motor = event.motor;
+            payload.from_state = event.from_state;
+            payload.to_state = event.to_state;
+            payload.reason = event.reason;
+            payload.pressure_pct = event.pressure_pct;
+            payload.ticks_in_state = event.ticks_in_state;
+            payload.dropped = takeSafetyEventDrops();
+            sendFrame(FRAME_STATE_EVENT, &payload, sizeof(payload));
+        }
+
+        if (time_ms - last_diag_ms >= 1000) {
+            last_diag_ms = time_ms;
+
+            ControlWatchdogStats stats;
+            getControlWatchdogStats(&stats);
+
+            WatchdogDiagPayload diag;
+            diag.kicks = stats.kicks;
+            diag.misses = stats.misses;
+            diag.late_ticks = stats.late_ticks;
+            diag.worst_gap_us = stats.worst_gap_us;
+            diag.last_gap_us = stats.last_gap_us;
+            diag.deadline_ms = (uint16_t)CONTROL_DEADLINE_MS;
+            diag.armed = stats.armed ? 1 : 0;
+            diag.tripped = stats.tripped ? 1 : 0;
+            diag.outer_kicks = stats.outer_kicks;
+            diag.outer_misses = stats.outer_misses;
+            diag.outer_worst_gap_us = stats.outer_worst_gap_us;
+            diag.outer_deadline_ms = (uint16_t)(stats.outer_deadline_us / 1000);
+            diag.outer_tripped = stats.outer_tripped ? 1 : 0;
+            diag.reserved = 0;
+            sendFrame(FRAME_WATCHDOG_DIAG, &diag, sizeof(diag));
+
+            LoopTimingPayload timing;
+            fillLoopTimingEntry(&timing.inner, LOOP_INNER);
+            fillLoopTimingEntry(&timing.outer, LOOP_OUTER);
+
+            PressureLoopStats loop_stats;
+            getPressureLoopStats(&loop_stats);
+            timing.torn_reads = clampU16(loop_stats.torn_reads - last_loop_stats.torn_reads);
+            timing.stale_holds = clampU16(loop_stats.stale_holds - last_loop_stats.stale_holds);
+            timing.mux_busy = clampU16(loop_stats.mux_busy - last_loop_stats.mux_busy);
+            last_loop_stats = loop_stats;
+            sendFrame(FRAME_LOOP_TIMING, &timing, sizeof(timing));
+
+            sendMotorStats(time_ms);
+            sendSensorHealth(time_ms);
+        }
 #endif
         // When PROTOCOL_BINARY is not defined, this task does nothing
         // allowing Serial.println() debug messages to be visible
 
-        // Wait for next period
-        vTaskDelayUntil(&lastWakeTime, frequency);
+        // Wait for next period (LOG_PERIOD_MS parameter, re-read every cycle)
+        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(params.log_period_ms));
     }
 }
 
@@ -51,6 +51,9 @@ extern volatile float shared_dist_far_max;      // FAR/OUT boundary (150-450 cm)
  *
  * FreeRTOS task that periodically prints system data in CSV format.
  * Prints setpoint, 5 pressure pad values, and 5 duty cycles at fixed frequency.
+ * In binary mode it also forwards queued safety state machine transitions
+ * as FRAME_STATE_EVENT frames, drains the sweep sample queue into
+ * FRAME_SCAN_SAMPLES frames and sends a FRAME_WATCHDOG_DIAG frame at 1 Hz.
  *
  * CSV Format:
  * time_ms,setpoint_mv,pp1_mv,pp2_mv,pp3_mv,pp4_mv,pp5_mv,duty1_pct,duty2_pct,duty3_pct,duty4_pct,duty5_pct,tof_dist_cm
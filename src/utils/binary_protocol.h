@@ -19,6 +19,9 @@
  * - Active Sensor: 1 byte (uint8_t: 0=none, 1=TOF, 2=ultrasonic, 3=both)
  * - CRC: 2 bytes (CRC-16 for error detection)
  * - Total: 85 bytes per packet
+ *
+ * Non-periodic data (device info, events, diagnostics) uses typed frames
+ * with their own header, see "Typed Frames" below.
  */
 
 #ifndef BINARY_PROTOCOL_H
@@ -258,4 +261,436 @@ inline void sendBinaryPacket(const DataPacket* packet) {
     Serial.write((const uint8_t*)packet, sizeof(DataPacket));
 }
 
+// ============================================================================
+// Typed Frames (device info, events, diagnostics)
+// ============================================================================
+//
+// Everything that is not the periodic DataPacket is sent as a typed frame:
+// - Header: 2 bytes (0xAA66) - distinct from the DataPacket header
+// - Type: 1 byte (FrameType)
+// - Length: 2 bytes (payload length in bytes)
+// - Payload: <length> bytes (packed struct, little-endian)
+// - CRC: 2 bytes (CRC-16 over type, length and payload)
+//
+// Parsers that only know the DataPacket skip typed frames as garbage
+// between 0xAA55 headers, so new frame types never break older clients.
+// ============================================================================
+
+constexpr uint16_t FRAME_HEADER = 0xAA66;      // Typed frame sync header
+constexpr uint8_t PROTOCOL_VERSION = 2;        // Bumped on any layout change
+constexpr uint16_t FRAME_MAX_PAYLOAD = 256;    // Largest payload we ever send
+
+/**
+ * @brief Typed frame identifiers
+ */
+enum FrameType : uint8_t {
+    FRAME_DEVICE_INFO = 0x01,  // Build info and capability descriptor
+    FRAME_STATE_EVENT = 0x02,  // Safety state machine transition
+    FRAME_WATCHDOG_DIAG = 0x03, // Control loop watchdog counters (1 Hz)
+    FRAME_LOOP_TIMING = 0x04,  // Inner/outer loop timing (1 Hz)
+    FRAME_STATS_SUMMARY = 0x05, // Per-channel statistics window (STATS_PERIOD_MS)
+    FRAME_LOG = 0x06,          // Tokenized log message (see tlog.h)
+    FRAME_SCAN_SAMPLES = 0x07, // Every sweep measurement, batched (see tof_sensor.h)
+    FRAME_MOTOR_STATS = 0x08,  // Per-motor lifetime actuation counters (1 Hz)
+    FRAME_SENSOR_HEALTH = 0x09 // Range sensor health and sweep mode (1 Hz)
+};
+
+/**
+ * @brief Typed frame header (payload and CRC follow)
+ */
+struct __attribute__((packed)) FrameHeader {
+    uint16_t header;             // 0xAA66
+    uint8_t type;                // FrameType
+    uint16_t length;             // Payload length in bytes
+};
+
+static_assert(sizeof(FrameHeader) == 5, "FrameHeader must be exactly 5 bytes");
+
+/**
+ * @brief Send a typed frame via Serial
+ *
+ * Assembles header, payload and CRC in one buffer and writes it with a
+ * single Serial.write() so frames from different tasks never interleave.
+ *
+ * @param type Frame type (FrameType)
+ * @param payload Pointer to payload bytes
+ * @param length Payload length (max FRAME_MAX_PAYLOAD)
+ */
+inline void sendFrame(uint8_t type, const void* payload, uint16_t length) {
+    if (length > FRAME_MAX_PAYLOAD) {
+        return;
+    }
+
+    uint8_t buffer[sizeof(FrameHeader) + FRAME_MAX_PAYLOAD + 2];
+
+    FrameHeader* frame = (FrameHeader*)buffer;
+    frame->header = FRAME_HEADER;
+    frame->type = type;
+    frame->length = length;
+    memcpy(buffer + sizeof(FrameHeader), payload, length);
+
+    // CRC covers type, length and payload (everything after the sync header)
+    size_t crc_offset = sizeof(FrameHeader) + length;
+    uint16_t crc = calculateCRC16(buffer + 2, crc_offset - 2);
+    memcpy(buffer + crc_offset, &crc, sizeof(crc));
+
+    Serial.write(buffer, crc_offset + 2);
+}
+
+// ============================================================================
+// Device Info Frame (FRAME_DEVICE_INFO)
+// ============================================================================
+
+/**
+ * @brief DataPacket field identifiers (for the field layout table)
+ */
+enum DataField : uint8_t {
+    FIELD_TIMESTAMP_MS = 1,
+    FIELD_SETPOINT_PCT,
+    FIELD_PRESSURE_PCT,
+    FIELD_DUTY_PCT,
+    FIELD_TOF_CM,
+    FIELD_SERVO_ANGLE,
+    FIELD_TOF_CURRENT_CM,
+    FIELD_MODE,
+    FIELD_ACTIVE_SENSOR,
+    FIELD_ULTRASONIC_CM,
+    FIELD_TOF_RAW_CM,
+    FIELD_FORCE_SCALE,
+    FIELD_DISTANCE_SCALE,
+    FIELD_DIST_CLOSE_MAX_CM,
+    FIELD_DIST_MEDIUM_MAX_CM,
+    FIELD_DIST_FAR_MAX_CM,
+    FIELD_CRC
+};
+
+/**
+ * @brief Wire type of a DataPacket field
+ */
+enum FieldType : uint8_t {
+    FIELD_TYPE_U8 = 1,
+    FIELD_TYPE_U16 = 2,
+    FIELD_TYPE_U32 = 3,
+    FIELD_TYPE_F32 = 4
+};
+
+/**
+ * @brief One entry of the DataPacket layout table
+ *
+ * Array fields (e.g. 5 setpoints) are described once with count = 5;
+ * elements are contiguous starting at offset.
+ */
+struct __attribute__((packed)) FieldDescriptor {
+    uint8_t id;                  // DataField
+    uint8_t type;                // FieldType
+    uint8_t offset;              // Byte offset from start of packet
+    uint8_t count;               // Number of consecutive elements
+};
+
+/**
+ * @brief Layout of the DataPacket, as sent in the device info frame
+ */
+constexpr FieldDescriptor DATA_PACKET_LAYOUT[] = {
+    {FIELD_TIMESTAMP_MS,       FIELD_TYPE_U32, offsetof(DataPacket, timestamp_ms),       1},
+    {FIELD_SETPOINT_PCT,       FIELD_TYPE_F32, offsetof(DataPacket, setpoint1_pct),      5},
+    {FIELD_PRESSURE_PCT,       FIELD_TYPE_F32, offsetof(DataPacket, pp1_pct),            5},
+    {FIELD_DUTY_PCT,           FIELD_TYPE_F32, offsetof(DataPacket, duty1_pct),          5},
+    {FIELD_TOF_CM,             FIELD_TYPE_F32, offsetof(DataPacket, tof1_cm),            5},
+    {FIELD_SERVO_ANGLE,        FIELD_TYPE_U8,  offsetof(DataPacket, servo_angle),        1},
+    {FIELD_TOF_CURRENT_CM,     FIELD_TYPE_F32, offsetof(DataPacket, tof_current_cm),     1},
+    {FIELD_MODE,               FIELD_TYPE_U8,  offsetof(DataPacket, current_mode),       1},
+    {FIELD_ACTIVE_SENSOR,      FIELD_TYPE_U8,  offsetof(DataPacket, active_sensor),      1},
+    {FIELD_ULTRASONIC_CM,      FIELD_TYPE_F32, offsetof(DataPacket, ultrasonic_cm),      1},
+    {FIELD_TOF_RAW_CM,         FIELD_TYPE_F32, offsetof(DataPacket, tof_raw_cm),         1},
+    {FIELD_FORCE_SCALE,        FIELD_TYPE_F32, offsetof(DataPacket, force_scale),        1},
+    {FIELD_DISTANCE_SCALE,     FIELD_TYPE_F32, offsetof(DataPacket, distance_scale),     1},
+    {FIELD_DIST_CLOSE_MAX_CM,  FIELD_TYPE_F32, offsetof(DataPacket, dist_close_max_cm),  1},
+    {FIELD_DIST_MEDIUM_MAX_CM, FIELD_TYPE_F32, offsetof(DataPacket, dist_medium_max_cm), 1},
+    {FIELD_DIST_FAR_MAX_CM,    FIELD_TYPE_F32, offsetof(DataPacket, dist_far_max_cm),    1},
+    {FIELD_CRC,                FIELD_TYPE_U16, offsetof(DataPacket, crc),                1}
+};
+
+constexpr uint8_t DATA_PACKET_FIELD_COUNT = sizeof(DATA_PACKET_LAYOUT) / sizeof(DATA_PACKET_LAYOUT[0]);
+
+/**
+ * @brief Build info and capability descriptor
+ *
+ * Sent once at the end of setup() and whenever the host sends INFO:GET.
+ * Lets clients learn the packet layout and runtime configuration without
+ * reading firmware sources.
+ */
+struct __attribute__((packed)) DeviceInfoPayload {
+    // Protocol and hardware (6 bytes)
+    uint8_t protocol_version;    // PROTOCOL_VERSION
+    uint8_t motor_count;         // NUM_MOTORS
+    uint8_t pad_count;           // NUM_PRESSURE_PADS
+    uint8_t pot_count;           // NUM_POTENTIOMETERS
+    uint8_t control_mode;        // 0=millivolts, 1=newtons
+    uint8_t sweep_mode;          // 0=forward, 1=bidirectional, 2=tracking
+
+    // Rates (12 bytes)
+    uint16_t control_freq_hz;    // Inner (PI) pressure loop frequency
+    uint16_t logging_period_ms;  // DataPacket period
+    uint32_t pwm_freq_hz;        // Motor PWM frequency
+    uint8_t pwm_res_bits;        // Motor PWM resolution
+    uint8_t outer_freq_hz;       // Outer supervisory loop frequency (0 on older firmware)
+    uint16_t sweep_estimated_ms; // Estimated full sweep time at defaults
+
+    // Runtime sweep configuration (8 bytes)
+    uint8_t sweep_enabled;       // 1=automatic sweep, 0=manual angle
+    uint8_t servo_min_angle;     // Degrees
+    uint8_t servo_max_angle;     // Degrees
+    uint8_t servo_step;          // Degrees
+    uint8_t servo_manual_angle;  // Degrees (used when sweep disabled)
+    uint8_t servo_settle_ms;     // Milliseconds
+    uint8_t servo_reading_delay_ms; // Milliseconds
+    uint8_t sector_count;        // Number of sectors (one per motor)
+
+    // Sector boundaries (10 bytes)
+    uint8_t sector_min_angle[5]; // Degrees
+    uint8_t sector_max_angle[5]; // Degrees
+
+    // Build info (12 bytes)
+    char git_hash[12];           // Short git hash, NUL padded
+
+    // DataPacket layout (5 + 4*N bytes)
+    uint16_t data_packet_header; // PACKET_HEADER
+    uint16_t data_packet_size;   // sizeof(DataPacket)
+    uint8_t field_count;         // DATA_PACKET_FIELD_COUNT
+    FieldDescriptor fields[DATA_PACKET_FIELD_COUNT];
+};
+
+static_assert(sizeof(DeviceInfoPayload) <= FRAME_MAX_PAYLOAD, "DeviceInfoPayload exceeds FRAME_MAX_PAYLOAD");
+
+// ============================================================================
+// State Event Frame (FRAME_STATE_EVENT)
+// ============================================================================
+
+/**
+ * @brief One safety state machine transition (see safety_state_machine.h)
+ */
+struct __attribute__((packed)) StateEventPayload {
+    uint32_t timestamp_ms;       // millis() at the control tick that fired
+    uint8_t motor;               // Motor index (0-4)
+    uint8_t from_state;          // SystemState before the transition
+    uint8_t to_state;            // SystemState after the transition
+    uint8_t reason;              // SafetyReason (guard that fired)
+    float pressure_pct;          // Normalized pressure at the transition
+    uint16_t ticks_in_state;     // Control ticks spent in from_state
+    uint16_t dropped;            // Events lost to a full queue since last frame
+};
+
+static_assert(sizeof(StateEventPayload) == 16, "StateEventPayload must be exactly 16 bytes");
+
+// ============================================================================
+// Watchdog Diagnostics Frame (FRAME_WATCHDOG_DIAG)
+// ============================================================================
+
+/**
+ * @brief Control loop watchdog counters (see control_watchdog.h)
+ */
+struct __attribute__((packed)) WatchdogDiagPayload {
+    uint32_t kicks;              // Control ticks seen
+    uint32_t misses;             // Deadlines missed (motors braked)
+    uint32_t late_ticks;         // Ticks later than 1.5x the loop period
+    uint32_t worst_gap_us;       // Longest interval between ticks
+    uint32_t last_gap_us;        // Interval before the latest tick
+    uint16_t deadline_ms;        // CONTROL_DEADLINE_MS
+    uint8_t armed;               // 1 once the first tick arrived
+    uint8_t tripped;             // 1 while motors are held by the watchdog
+    uint32_t outer_kicks;        // Supervisory loop ticks seen
+    uint32_t outer_misses;       // Supervisory deadlines missed (motors braked)
+    uint32_t outer_worst_gap_us; // Longest interval between supervisory ticks
+    uint16_t outer_deadline_ms;  // OUTER_DEADLINE_PERIODS outer periods
+    uint8_t outer_tripped;       // 1 while the supervisory loop is overdue
+    uint8_t reserved;
+};
+
+static_assert(sizeof(WatchdogDiagPayload) == 40, "WatchdogDiagPayload must be exactly 40 bytes");
+
+// ============================================================================
+// Loop Timing Frame (FRAME_LOOP_TIMING)
+// ============================================================================
+
+/**
+ * @brief Timing of one loop over the last window (see loop_timing.h)
+ */
+struct __attribute__((packed)) LoopTimingEntry {
+    uint16_t rate_hz;            // Configured rate
+    uint16_t ticks;              // Ticks in the window
+    uint16_t late_ticks;         // Ticks started more than 1.5x the period late
+    uint16_t overruns;           // Ticks that took longer than the period
+    uint16_t exec_avg_us;        // Mean execution time
+    uint16_t exec_max_us;        // Longest execution time
+    uint32_t period_max_us;      // Longest interval between tick starts
+};
+
+/**
+ * @brief Inner and outer loop timing plus setpoint mailbox counters
+ */
+struct __attribute__((packed)) LoopTimingPayload {
+    LoopTimingEntry inner;       // Pressure loop task
+    LoopTimingEntry outer;       // Supervisory loop
+    uint16_t torn_reads;         // Mailbox copies discarded in the window
+    uint16_t stale_holds;        // Inner ticks braked for a stale command in the window
+    uint16_t mux_busy;           // Inner ticks that reused old pad readings in the window
+};
+
+static_assert(sizeof(LoopTimingPayload) == 38, "LoopTimingPayload must be exactly 38 bytes");
+
+// ============================================================================
+// Statistics Summary Frame (FRAME_STATS_SUMMARY)
+// ============================================================================
+
+/**
+ * @brief One channel over the window (see telemetry_stats.h)
+ */
+struct __attribute__((packed)) StatsChannelSummary {
+    uint16_t count;              // Samples in the window (saturating)
+    float mean;
+    float stddev;
+    float min;
+    float max;
+    float p95;                   // Interpolated from the histogram
+    uint16_t histogram[8];       // STATS_BUCKETS counts (saturating)
+};
+
+/**
+ * @brief All motors of one channel kind, one frame per kind per window
+ */
+struct __attribute__((packed)) StatsSummaryPayload {
+    uint8_t kind;                // StatsKind: 0=pad %, 1=duty %, 2=error %, 3=distance cm
+    uint8_t channel_count;       // NUM_MOTORS
+    uint16_t window_ms;          // Window length (STATS_PERIOD_MS param)
+    float bucket_min;            // Lower edge of bucket 0
+    float bucket_width;          // Bucket width (first/last buckets are open-ended)
+    StatsChannelSummary channels[5];
+};
+
+static_assert(sizeof(StatsChannelSummary) == 38, "StatsChannelSummary must be exactly 38 bytes");
+static_assert(sizeof(StatsSummaryPayload) == 202, "StatsSummaryPayload must be exactly 202 bytes");
+static_assert(sizeof(StatsSummaryPayload) <= FRAME_MAX_PAYLOAD, "StatsSummaryPayload exceeds FRAME_MAX_PAYLOAD");
+
+// ============================================================================
+// Log Frame (FRAME_LOG)
+// ============================================================================
+
+/**
+ * @brief Tokenized log message (see tlog.h)
+ *
+ * Variable length: only the used part of args is sent. The host looks the
+ * token up in tlog_tokens.json and decodes args by the format specifiers.
+ */
+struct __attribute__((packed)) LogPayload {
+    uint32_t timestamp_ms;       // millis() when logged
+    uint32_t token;              // FNV-1a hash of the format string
+    uint8_t args[64];            // TLOG_MAX_ARGS_BYTES packed arguments
+};
+
+static_assert(sizeof(LogPayload) == 72, "LogPayload must be exactly 72 bytes");
+
+// ============================================================================
+// Scan Samples Frame (FRAME_SCAN_SAMPLES)
+// ============================================================================
+
+constexpr uint8_t SCAN_SAMPLES_PER_FRAME = 16;
+
+/**
+ * @brief One sweep measurement (ScanSample in tof_sensor.h, compacted)
+ */
+struct __attribute__((packed)) ScanSampleWire {
+    uint32_t timestamp_ms;       // millis() after both sensors were read
+    int16_t tof_cm_x10;          // Raw TOF (cm x 10, -10 = error)
+    int16_t ultrasonic_cm_x10;   // Raw ultrasonic (cm x 10)
+    int16_t distance_cm_x10;     // Fused minimum (cm x 10, 9990 = none valid)
+    uint8_t angle;               // Servo angle (degrees)
+    uint8_t active_sensor;       // 0=none, 1=TOF, 2=ultrasonic, 3=both equal
+};
+
+/**
+ * @brief Consecutive sweep samples, drained from the sweep queue
+ *
+ * Variable length: only count samples are sent. Sample i has sequence
+ * number first_seq + i; a jump in first_seq between frames means samples
+ * were dropped (also counted in overflows).
+ */
+struct __attribute__((packed)) ScanSamplesPayload {
+    uint32_t first_seq;          // Sequence number of samples[0]
+    uint32_t overflows;          // Samples dropped by the full queue since boot
+    uint8_t count;               // Samples in this frame (1-SCAN_SAMPLES_PER_FRAME)
+    ScanSampleWire samples[SCAN_SAMPLES_PER_FRAME];
+};
+
+static_assert(sizeof(ScanSampleWire) == 12, "ScanSampleWire must be exactly 12 bytes");
+static_assert(sizeof(ScanSamplesPayload) == 201, "ScanSamplesPayload must be exactly 201 bytes");
+static_assert(sizeof(ScanSamplesPayload) <= FRAME_MAX_PAYLOAD, "ScanSamplesPayload exceeds FRAME_MAX_PAYLOAD");
+
+// ============================================================================
+// Motor Stats Frame (FRAME_MOTOR_STATS)
+// ============================================================================
+
+/**
+ * @brief Lifetime counters of one motor (MotorCounters in motors.h)
+ *
+ * Times are in 0.1 s units (_ds). Rates such as reversals per minute
+ * are the difference between two frames over the uptime difference.
+ */
+struct __attribute__((packed)) MotorStatsEntry {
+    uint32_t mode_ds[4];         // Forward, reverse, brake, coast
+    uint32_t duty_ds;            // Duty integral while driven (100% for 1 s = 10)
+    uint32_t saturated_ds;       // Driven at 100% duty
+    uint32_t state_ds[4];        // Time per SystemState (NORMAL .. WAITING)
+    uint32_t reversals;          // Forward <-> reverse direction changes
+    uint32_t brake_events;       // Entries into brake
+};
+
+/**
+ * @brief Actuation counters of every motor
+ */
+struct __attribute__((packed)) MotorStatsPayload {
+    uint32_t uptime_ms;          // millis() when the counters were read
+    uint32_t emergency_brakes;   // Watchdog ISR brakes (all motors at once)
+    MotorStatsEntry motors[5];
+};
+
+static_assert(sizeof(MotorStatsEntry) == 48, "MotorStatsEntry must be exactly 48 bytes");
+static_assert(sizeof(MotorStatsPayload) == 248, "MotorStatsPayload must be exactly 248 bytes");
+static_assert(sizeof(MotorStatsPayload) <= FRAME_MAX_PAYLOAD, "MotorStatsPayload exceeds FRAME_MAX_PAYLOAD");
+
+// ============================================================================
+// Sensor Health Frame (FRAME_SENSOR_HEALTH)
+// ============================================================================
+
+/**
+ * @brief Health of one range sensor (SensorHealth in sensor_health.h)
+ *
+ * Percentages cover the last HEALTH_WINDOW reads, counters are since boot.
+ */
+struct __attribute__((packed)) SensorHealthEntry {
+    uint8_t status;              // SensorStatus: 0=OK, 1=NO_TARGET, 2=FAILED
+    uint8_t fault;               // SensorFault of the last failure: 0=NONE, 1=TIMEOUTS, 2=CHECKSUMS, 3=STUCK
+    uint16_t rate_dhz;           // Valid reads per second x10
+    uint8_t timeout_pct;
+    uint8_t checksum_pct;
+    uint8_t out_of_range_pct;
+    uint32_t reads;
+    uint32_t timeouts;
+    uint32_t checksum_errors;
+    uint32_t out_of_range;
+    uint32_t stuck_events;
+    uint32_t failures;           // Transitions to FAILED
+};
+
+/**
+ * @brief Health of the TOF and ultrasonic sensors
+ */
+struct __attribute__((packed)) SensorHealthPayload {
+    uint32_t uptime_ms;          // millis() when the health was read
+    uint8_t sweep_mode;          // SweepHealthMode: 0=NORMAL, 1=ULTRASONIC_ONLY, 2=TOF_ONLY, 3=BLIND
+    SensorHealthEntry sensors[2]; // TOF, ultrasonic
+};
+
+static_assert(sizeof(SensorHealthEntry) == 31, "SensorHealthEntry must be exactly 31 bytes");
+static_assert(sizeof(SensorHealthPayload) == 67, "SensorHealthPayload must be exactly 67 bytes");
+
 #endif // BINARY_PROTOCOL_H
@@ -4,9 +4,36 @@
  */
 
 #include "command_handler.h"
+#include "device_info.h"
+#include "instrumented_lock.h"
+#include "multiplexer.h"
+#include "ota_update.h"
+#include "power_manager.h"
+#include "../config/param_registry.h"
+#include "../control/control_watchdog.h"
+#include "../control/overpressure_guard.h"
+#include "../control/pi_controller.h"
+#include "../control/power_budget.h"
+#include "../control/pressure_loop.h"
+#include "../control/step_scorecard.h"
 #include "../config/servo_config.h"
+#include "../actuators/motors.h"
+#include "../sensors/pad_calibration.h"
+#include "../sensors/pressure_pads.h"
+#include "../sensors/tof_sensor.h"
+#include "../sensors/sensor_health.h"
+#include "../sensors/sweep_lag.h"
 #include <freertos/FreeRTOS.h>
-#include <freertos/semphr.h>
+#include <mbedtls/base64.h>
+#include <stdlib.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr int ADC_NOISE_DEFAULT_SAMPLES = 64;   // DIAG:ADCNOISE conversions per pad and mode
+constexpr int ADC_NOISE_MAX_SAMPLES = 256;      // Keeps each pad under ~40 ms of mux time
+constexpr size_t COMMAND_LINE_MAX = 384;        // Longest command line (OTA:CHUNK carries 256 base64 chars)
 
 // ============================================================================
 // Runtime Configuration Variables
@@ -25,22 +52,21 @@ volatile int servo_reading_delay_ms = SERVO_READING_DELAY_MS;
 // Manual angle control (used when sweep disabled)
 volatile int servo_manual_angle = 90;  // Default to center position
 
-// Configuration mutex
-SemaphoreHandle_t configMutex = nullptr;
+// Command line received so far (completed over several loop() calls)
+static char command_line[COMMAND_LINE_MAX + 1];
+static size_t command_length = 0;
+static bool command_overflow = false;
 
 // ============================================================================
 // Initialization
 // ============================================================================
 
 void initCommandHandler() {
-    // Create mutex for config access
-    if (configMutex == nullptr) {
-        configMutex = xSemaphoreCreateMutex();
-        if (configMutex == nullptr) {
-            Serial.println("ERR:INIT:Failed to create config mutex");
-        } else {
-            Serial.println("ACK:INIT:Command handler initialized");
-        }
+    // Lock for config access
+    if (!lockCreate(LOCK_CONFIG)) {
+        Serial.println("ERR:INIT:Failed to create config mutex");
+    } else {
+        Serial.println("ACK:INIT:Command handler initialized");
     }
 }
 
@@ -83,9 +109,9 @@ void sendError(const String& errorType, const String& detail) {
 void handleSweepCommand(const String& subCommand) {
     // SWEEP:ENABLE
     if (subCommand == "ENABLE") {
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (lockTake(LOCK_CONFIG, 10)) {
             sweep_enabled = true;
-            xSemaphoreGive(configMutex);
+            lockGive(LOCK_CONFIG);
             sendAck("SWEEP:ENABLED");
         } else {
             sendError("MUTEX", "SWEEP:ENABLE");
@@ -93,9 +119,9 @@ void handleSweepCommand(const String& subCommand) {
     }
     // SWEEP:DISABLE
     else if (subCommand == "DISABLE") {
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (lockTake(LOCK_CONFIG, 10)) {
             sweep_enabled = false;
-            xSemaphoreGive(configMutex);
+            lockGive(LOCK_CONFIG);
             sendAck("SWEEP:DISABLED");
         } else {
             sendError("MUTEX", "SWEEP:DISABLE");
@@ -109,14 +135,14 @@ void handleSweepCommand(const String& subCommand) {
             return;
         }
 
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (lockTake(LOCK_CONFIG, 10)) {
             int max = servo_max_angle;
             if (validateSweepRange(angle, max)) {
                 servo_min_angle = angle;
-                xSemaphoreGive(configMutex);
+                lockGive(LOCK_CONFIG);
                 sendAck("SWEEP:MIN:" + String(angle));
             } else {
-                xSemaphoreGive(configMutex);
+                lockGive(LOCK_CONFIG);
                 sendError("INVALID_RANGE", "MIN:" + String(angle) + " >= MAX:" + String(max));
             }
         } else {
@@ -131,14 +157,14 @@ void handleSweepCommand(const String& subCommand) {
             return;
         }
 
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (lockTake(LOCK_CONFIG, 10)) {
             int min = servo_min_angle;
             if (validateSweepRange(min, angle)) {
                 servo_max_angle = angle;
-                xSemaphoreGive(configMutex);
+                lockGive(LOCK_CONFIG);
                 sendAck("SWEEP:MAX:" + String(angle));
             } else {
-                xSemaphoreGive(configMutex);
+                lockGive(LOCK_CONFIG);
                 sendError("INVALID_RANGE", "MIN:" + String(min) + " >= MAX:" + String(angle));
             }
         } else {
@@ -153,9 +179,9 @@ void handleSweepCommand(const String& subCommand) {
             return;
         }
 
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (lockTake(LOCK_CONFIG, 10)) {
             servo_step = step;
-            xSemaphoreGive(configMutex);
+            lockGive(LOCK_CONFIG);
             sendAck("SWEEP:STEP:" + String(step));
         } else {
             sendError("MUTEX", "SWEEP:STEP");
@@ -163,13 +189,13 @@ void handleSweepCommand(const String& subCommand) {
     }
     // SWEEP:STATUS (query current configuration)
     else if (subCommand == "STATUS") {
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (lockTake(LOCK_CONFIG, 10)) {
             bool enabled = sweep_enabled;
             int min = servo_min_angle;
             int max = servo_max_angle;
             int step = servo_step;
             int manual = servo_manual_angle;
-            xSemaphoreGive(configMutex);
+            lockGive(LOCK_CONFIG);
 
             if (enabled) {
                 Serial.print("STATUS:SWEEP:ENABLED:");
@@ -203,18 +229,18 @@ void handleServoCommand(const String& subCommand) {
         }
 
         // Only allow manual angle control when sweep is disabled
-        if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (lockTake(LOCK_CONFIG, 10)) {
             bool enabled = sweep_enabled;
 
             if (enabled) {
-                xSemaphoreGive(configMutex);
+                lockGive(LOCK_CONFIG);
                 sendError("SWEEP_ACTIVE", "SERVO:ANGLE");
                 return;
             }
 
             // Set manual angle
             servo_manual_angle = angle;
-            xSemaphoreGive(configMutex);
+            lockGive(LOCK_CONFIG);
             sendAck("SERVO:ANGLE:" + String(angle));
         } else {
             sendError("MUTEX", "SERVO:ANGLE");
@@ -225,15 +251,675 @@ void handleServoCommand(const String& subCommand) {
     }
 }
 
+void handleInfoCommand(const String& subCommand) {
+    // INFO:GET (request build info and capability descriptor frame)
+    if (subCommand == "GET") {
+        sendDeviceInfo();
+    }
+    else {
+        sendError("INVALID_COMMAND", "INFO:" + subCommand);
+    }
+}
+
+void handleDiagCommand(const String& subCommand) {
+    // DIAG:WATCHDOG (report control loop deadline counters)
+    if (subCommand == "WATCHDOG") {
+        ControlWatchdogStats stats;
+        getControlWatchdogStats(&stats);
+
+        Serial.print("ACK:DIAG:WATCHDOG:ARMED=");
+        Serial.print(stats.armed ? 1 : 0);
+        Serial.print(",TRIPPED=");
+        Serial.print(stats.tripped ? 1 : 0);
+        Serial.print(",KICKS=");
+        Serial.print(stats.kicks);
+        Serial.print(",MISSES=");
+        Serial.print(stats.misses);
+        Serial.print(",LATE=");
+        Serial.print(stats.late_ticks);
+        Serial.print(",WORST_US=");
+        Serial.print(stats.worst_gap_us);
+        Serial.print(",LAST_US=");
+        Serial.print(stats.last_gap_us);
+        Serial.print(",OUTER_TRIPPED=");
+        Serial.print(stats.outer_tripped ? 1 : 0);
+        Serial.print(",OUTER_KICKS=");
+        Serial.print(stats.outer_kicks);
+        Serial.print(",OUTER_MISSES=");
+        Serial.print(stats.outer_misses);
+        Serial.print(",OUTER_WORST_US=");
+        Serial.print(stats.outer_worst_gap_us);
+        Serial.print(",OUTER_DEADLINE_MS=");
+        Serial.println(stats.outer_deadline_us / 1000);
+    }
+    // DIAG:WATCHDOG:RESET (clear miss/late/worst counters)
+    else if (subCommand == "WATCHDOG:RESET") {
+        resetControlWatchdogStats();
+        sendAck("DIAG:WATCHDOG:RESET");
+    }
+    // DIAG:ADCNOISE[:<samples>] (pad noise, PWM-synchronous vs free-running)
+    else if (subCommand == "ADCNOISE" || subCommand.startsWith("ADCNOISE:")) {
+        int samples = ADC_NOISE_DEFAULT_SAMPLES;
+        if (subCommand.length() > 9) {
+            samples = subCommand.substring(9).toInt();
+        }
+        if (samples < 2 || samples > ADC_NOISE_MAX_SAMPLES) {
+            sendError("OUT_OF_RANGE", "ADCNOISE:" + String(samples));
+            return;
+        }
+
+        // One line per pad, both modes back to back at the same motor duties
+        for (int i = 0; i < NUM_PRESSURE_PADS; ++i) {
+            PadNoiseStats sync_stats, async_stats;
+            if (!lockMux(50)) {
+                sendError("BUSY", "ADCNOISE:MUX");
+                return;
+            }
+            measurePadNoise(i, samples, true, &sync_stats);
+            measurePadNoise(i, samples, false, &async_stats);
+            unlockMux();
+
+            Serial.print("ADCNOISE:");
+            Serial.print(i + 1);
+            Serial.print(":SYNC_MEAN=");
+            Serial.print(sync_stats.mean_mv, 1);
+            Serial.print(",SYNC_SD=");
+            Serial.print(sync_stats.stddev_mv, 2);
+            Serial.print(",SYNC_PP=");
+            Serial.print(sync_stats.max_mv - sync_stats.min_mv);
+            Serial.print(",SYNC_MISS=");
+            Serial.print(sync_stats.phase_misses);
+            Serial.print(",ASYNC_MEAN=");
+            Serial.print(async_stats.mean_mv, 1);
+            Serial.print(",ASYNC_SD=");
+            Serial.print(async_stats.stddev_mv, 2);
+            Serial.print(",ASYNC_PP=");
+            Serial.println(async_stats.max_mv - async_stats.min_mv);
+        }
+        sendAck("DIAG:ADCNOISE:" + String(samples));
+    }
+    // DIAG:POWER (PM lock duty since the previous DIAG:POWER)
+    else if (subCommand == "POWER") {
+        static const char* const LOCK_LABELS[PM_LOCK_COUNT] = {"CONTROL", "ADC", "SWEEP", "IO"};
+        PowerStats stats;
+        takePowerStats(&stats);
+        float window = stats.window_us > 0 ? (float)stats.window_us : 1.0f;
+
+        Serial.print("ACK:DIAG:POWER:PM=");
+        Serial.print(stats.pm_available ? 1 : 0);
+        Serial.print(",MODE=");
+        Serial.print(stats.mode);
+        Serial.print(",CPU_MHZ=");
+        Serial.print(getCpuFrequencyMhz());
+        Serial.print(",WINDOW_MS=");
+        Serial.print(stats.window_us / 1000);
+        Serial.print(",FULL_SPEED_PCT=");
+        Serial.print(100.0f * stats.full_speed_us / window, 1);
+        for (int i = 0; i < PM_LOCK_COUNT; ++i) {
+            Serial.print(",");
+            Serial.print(LOCK_LABELS[i]);
+            Serial.print("_PCT=");
+            Serial.print(100.0f * stats.held_us[i] / window, 1);
+            Serial.print(",");
+            Serial.print(LOCK_LABELS[i]);
+            Serial.print("_N=");
+            Serial.print(stats.acquires[i]);
+        }
+        Serial.println();
+    }
+    // DIAG:SWEEPLAG (continuous sweep lag table, one line per speed bin)
+    else if (subCommand == "SWEEPLAG") {
+        SweepLagBin lag_bins[SWEEP_LAG_SPEED_BINS];
+        float forward_share = getSweepLagBins(lag_bins);
+
+        for (int i = 0; i < SWEEP_LAG_SPEED_BINS; ++i) {
+            Serial.print("SWEEPLAG:");
+            Serial.print(i);
+            Serial.print(":SPEED_MAX=");
+            if (i == SWEEP_LAG_SPEED_BINS - 1) {
+                Serial.print("INF");
+            } else {
+                Serial.print(lag_bins[i].speed_max_dps, 0);
+            }
+            Serial.print(",FWD_DEG=");
+            Serial.print(lag_bins[i].offset_deg[SWEEP_DIR_FORWARD], 2);
+            Serial.print(",BWD_DEG=");
+            Serial.print(lag_bins[i].offset_deg[SWEEP_DIR_BACKWARD], 2);
+            Serial.print(",PASSES=");
+            Serial.print(lag_bins[i].passes);
+            Serial.print(",CAL=");
+            Serial.println(lag_bins[i].calibrated ? 1 : 0);
+        }
+        sendAck("DIAG:SWEEPLAG:FWD_SHARE=" + String(forward_share, 2));
+    }
+    // DIAG:SWEEPLAG:RESET (back to the default lag model)
+    else if (subCommand == "SWEEPLAG:RESET") {
+        sweepLagReset();
+        sendAck("DIAG:SWEEPLAG:RESET");
+    }
+    // DIAG:SWEEPLAG:CAL (settled reference sweep, then per-direction lag)
+    else if (subCommand == "SWEEPLAG:CAL") {
+        ParamSnapshot params;
+        paramSnapshot(&params);
+        if (params.sweep_mode != SWEEP_CONTINUOUS || !sweep_enabled) {
+            sendError("INVALID_STATE", "SWEEPLAG:CAL:SWEEP_MODE");
+            return;
+        }
+        sweepLagRequestCalibration();
+        sendAck("DIAG:SWEEPLAG:CAL");
+    }
+    // DIAG:MOTORSTATS (lifetime actuation counters, one line per motor)
+    else if (subCommand == "MOTORSTATS") {
+        static const char* const MODE_LABELS[MOTOR_MODE_COUNT] = {"FWD", "REV", "BRAKE", "COAST"};
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            MotorCounters counters;
+            getMotorCounters(i, &counters);
+
+            Serial.print("MOTORSTATS:");
+            Serial.print(i + 1);
+            Serial.print(":");
+            for (int m = 0; m < MOTOR_MODE_COUNT; ++m) {
+                Serial.print(MODE_LABELS[m]);
+                Serial.print("_S=");
+                Serial.print(counters.mode_us[m] / 1000000ULL);
+                Serial.print(",");
+            }
+            Serial.print("DUTY_S=");
+            Serial.print(counters.duty_us / 1000000ULL);
+            Serial.print(",SAT_S=");
+            Serial.print(counters.saturated_us / 1000000ULL);
+            for (int s = 0; s < MOTOR_STATE_SLOTS; ++s) {
+                Serial.print(",STATE");
+                Serial.print(s);
+                Serial.print("_S=");
+                Serial.print(counters.state_us[s] / 1000000ULL);
+            }
+            Serial.print(",REVERSALS=");
+            Serial.print(counters.reversals);
+            Serial.print(",BRAKES=");
+            Serial.println(counters.brake_events);
+        }
+        MotorStatsSaveTiming timing;
+        getMotorStatsSaveTiming(&timing);
+        sendAck("DIAG:MOTORSTATS:EMERGENCY_BRAKES=" + String(getEmergencyBrakeCount()) +
+                ",SAVES=" + String(timing.saves) +
+                ",SAVE_FAILS=" + String(timing.failures) +
+                ",LAST_SAVE_US=" + String(timing.last_us) +
+                ",MAX_SAVE_US=" + String(timing.max_us));
+    }
+    // DIAG:MOTORSTATS:SAVE (write the counters to NVS now)
+    else if (subCommand == "MOTORSTATS:SAVE") {
+        if (!saveMotorCounters()) {
+            sendError("NVS", "WRITE_FAILED");
+            return;
+        }
+        sendAck("DIAG:MOTORSTATS:SAVE");
+    }
+    // DIAG:MOTORSTATS:RESET (zero the counters and the stored copy)
+    else if (subCommand == "MOTORSTATS:RESET") {
+        resetMotorCounters();
+        sendAck("DIAG:MOTORSTATS:RESET");
+    }
+    // DIAG:LOCKS (cross-task lock contention, one line per lock)
+    else if (subCommand == "LOCKS") {
+        static const char* const BUCKET_LABELS[LOCK_WAIT_BUCKETS] = {"W10US", "W100US", "W1MS", "W10MS", "WSLOW"};
+        for (int i = 0; i < LOCK_COUNT; ++i) {
+            LockStats stats;
+            getLockStats((LockId)i, &stats);
+
+            Serial.print("LOCKS:");
+            Serial.print(lockName((LockId)i));
+            Serial.print(":ACQ=");
+            Serial.print(stats.acquires);
+            Serial.print(",TIMEOUTS=");
+            Serial.print(stats.timeouts);
+            for (int b = 0; b < LOCK_WAIT_BUCKETS; ++b) {
+                Serial.print(",");
+                Serial.print(BUCKET_LABELS[b]);
+                Serial.print("=");
+                Serial.print(stats.wait_hist[b]);
+            }
+            Serial.print(",WAIT_MAX_US=");
+            Serial.print(stats.wait_max_us);
+            Serial.print(",HOLD_MAX_US=");
+            Serial.println(stats.hold_max_us);
+        }
+        sendAck("DIAG:LOCKS:DISTANCE_CACHED=" + String(getDistanceReadFallbacks()));
+    }
+    // DIAG:LOCKS:RESET (zero the lock counters)
+    else if (subCommand == "LOCKS:RESET") {
+        resetLockStats();
+        sendAck("DIAG:LOCKS:RESET");
+    }
+    // DIAG:CTRL (control law, identified model and step scorecard per motor)
+    else if (subCommand == "CTRL") {
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            ControllerInfo info;
+            StepScore score;
+            getControllerInfo(i, &info);
+            getStepScore(i, &score);
+
+            Serial.print("CTRL:");
+            Serial.print(i + 1);
+            Serial.print(":LAW=");
+            Serial.print(controlLaw(info.law).name);
+            Serial.print(",TAU_MS=");
+            Serial.print(info.model_tau_s * 1000.0f, 0);
+            Serial.print(",GAIN=");
+            Serial.print(info.model_gain, 2);
+            Serial.print(",MODEL=");
+            Serial.print(info.model_identified ? "FIT" : "DEFAULT");
+            Serial.print(",MODEL_N=");
+            Serial.print(info.model_samples);
+            Serial.print(",LQI_KE=");
+            Serial.print(info.lqi_k_e, 3);
+            Serial.print(",LQI_KI=");
+            Serial.print(info.lqi_k_i, 3);
+            Serial.print(",SMITH=");
+            Serial.print(info.smith_active ? "ON" : (stepModelValid(info.step_model) ? "OFF" : "NO_MODEL"));
+            Serial.print(",DEAD_MS=");
+            Serial.print(info.step_model.dead_time_ms);
+            Serial.print(",STEP_TAU_MS=");
+            Serial.print(info.step_model.tau_ms);
+            Serial.print(",STEP_GAIN=");
+            Serial.print(info.step_model.gain_milli * 1e-3f, 2);
+            Serial.print(",STEPS=");
+            Serial.print(score.steps);
+            Serial.print(",RISE_MS=");
+            Serial.print(score.rise_ms, 0);
+            Serial.print(",OVERSHOOT_PCT=");
+            Serial.print(score.overshoot_pct, 1);
+            Serial.print(",OVERSHOOT_MAX_PCT=");
+            Serial.print(score.overshoot_max_pct, 1);
+            Serial.print(",SETTLE_MS=");
+            Serial.print(score.settle_ms, 0);
+            Serial.print(",IAE=");
+            Serial.print(score.iae, 2);
+            Serial.print(",UNSETTLED=");
+            Serial.println(score.unsettled);
+        }
+        sendAck("DIAG:CTRL");
+    }
+    // DIAG:CTRL:RESET (clear the step scorecard, models are kept)
+    else if (subCommand == "CTRL:RESET") {
+        resetStepScores();
+        sendAck("DIAG:CTRL:RESET");
+    }
+    // DIAG:COUPLING (pad coupling matrix, one row per pad)
+    else if (subCommand == "COUPLING") {
+        CouplingMatrix matrix;
+        bool valid = getCouplingMatrix(&matrix);
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            Serial.print("COUPLING:");
+            Serial.print(i + 1);
+            for (int j = 0; j < NUM_MOTORS; ++j) {
+                Serial.print(j == 0 ? ":M" : ",M");
+                Serial.print(j + 1);
+                Serial.print("=");
+                Serial.print(matrix.gain_milli[i][j] * 1e-3f, 3);
+            }
+            Serial.println();
+        }
+        const char* state = isDecouplerActive() ? "ON" : (valid ? "OFF" : "NO_MODEL");
+        sendAck("DIAG:COUPLING:DECOUPLE=" + String(state));
+    }
+    // DIAG:COUPLING:RESET (erase the stored matrix, measured again at next boot)
+    else if (subCommand == "COUPLING:RESET") {
+        eraseCouplingMatrix();
+        sendAck("DIAG:COUPLING:RESET");
+    }
+    // DIAG:BUDGET (requested vs granted duty per motor under POWER_BUDGET_PCT)
+    else if (subCommand == "BUDGET") {
+        PowerBudgetStats stats;
+        getPowerBudgetStats(&stats);
+        for (int i = 0; i < NUM_MOTORS; ++i) {
+            Serial.print("BUDGET:");
+            Serial.print(i + 1);
+            Serial.print(":REQ=");
+            Serial.print(stats.last_requested[i], 1);
+            Serial.print(",GRANT=");
+            Serial.print(stats.last_granted[i], 1);
+            Serial.print(",REQ_AVG=");
+            Serial.print(stats.requested_avg_pct[i], 1);
+            Serial.print(",GRANT_AVG=");
+            Serial.print(stats.granted_avg_pct[i], 1);
+            Serial.print(",LIMITED=");
+            Serial.println(stats.limited[i]);
+        }
+        sendAck("DIAG:BUDGET:LIMIT=" + String(paramGet(PARAM_POWER_BUDGET_PCT), 0) +
+                ",TICKS=" + String(stats.ticks) +
+                ",LIMITED=" + String(stats.limited_ticks) +
+                ",PEAK_REQ=" + String(stats.peak_requested_pct, 1) +
+                ",PEAK_GRANT=" + String(stats.peak_granted_pct, 1));
+    }
+    // DIAG:BUDGET:RESET (zero the budget counters)
+    else if (subCommand == "BUDGET:RESET") {
+        resetPowerBudgetStats();
+        sendAck("DIAG:BUDGET:RESET");
+    }
+    // DIAG:SENSORS (range sensor health and degraded sweep mode)
+    else if (subCommand == "SENSORS") {
+        static const char* const NAMES[HEALTH_SENSOR_COUNT] = {"TOF", "US"};
+        for (int i = 0; i < HEALTH_SENSOR_COUNT; ++i) {
+            SensorHealth health;
+            getSensorHealth((HealthSensor)i, &health);
+            Serial.print("SENSOR:");
+            Serial.print(NAMES[i]);
+            Serial.print(":STATUS=");
+            Serial.print(sensorStatusName(health.status));
+            Serial.print(",FAULT=");
+            Serial.print(sensorFaultName(health.fault));
+            Serial.print(",RATE=");
+            Serial.print(health.rate_hz, 1);
+            Serial.print(",TIMEOUT_PCT=");
+            Serial.print(health.timeout_pct);
+            Serial.print(",CHECKSUM_PCT=");
+            Serial.print(health.checksum_pct);
+            Serial.print(",OOR_PCT=");
+            Serial.print(health.out_of_range_pct);
+            Serial.print(",READS=");
+            Serial.print(health.reads);
+            Serial.print(",TIMEOUTS=");
+            Serial.print(health.timeouts);
+            Serial.print(",CHECKSUMS=");
+            Serial.print(health.checksum_errors);
+            Serial.print(",OOR=");
+            Serial.print(health.out_of_range);
+            Serial.print(",STUCK=");
+            Serial.print(health.stuck_events);
+            Serial.print(",FAILURES=");
+            Serial.println(health.failures);
+        }
+        sendAck("DIAG:SENSORS:SWEEP=" + String(sweepHealthModeName(sensorHealthSweepMode())));
+    }
+    // DIAG:OVERPRESSURE (sampler ISR cutoff: limits, latches, trips)
+    else if (subCommand == "OVERPRESSURE") {
+        OverpressureStats stats;
+        getOverpressureStats(&stats);
+        uint32_t total = 0;
+        for (int i = 0; i < NUM_PRESSURE_PADS; ++i) {
+            Serial.print("OVERPRESSURE:");
+            Serial.print(i + 1);
+            Serial.print(":LIMIT=");
+            Serial.print(stats.limit_mv[i]);
+            Serial.print(",CEILING=");
+            Serial.print(stats.ceiling_mv[i]);
+            Serial.print(",RELEASE=");
+            Serial.print(stats.release_mv[i]);
+            Serial.print(",LATCHED=");
+            Serial.print(stats.latched[i] ? 1 : 0);
+            Serial.print(",TRIPS=");
+            Serial.print(stats.trips[i]);
+            Serial.print(",TRIP_MV=");
+            Serial.print(stats.trip_mv[i]);
+            Serial.print(",PEAK_MV=");
+            Serial.print(stats.peak_mv[i]);
+            Serial.print(",SAMPLES=");
+            Serial.println(stats.samples[i]);
+            total += stats.trips[i];
+        }
+        PressureLoopStats loop_stats;
+        getPressureLoopStats(&loop_stats);
+        sendAck("DIAG:OVERPRESSURE:PCT=" + String(paramGet(PARAM_OVERPRESSURE_PCT), 0) +
+                ",TRIPS=" + String(total) + ",BUSY=" + String(stats.mux_busy) +
+                ",CEILING_HOLDS=" + String(loop_stats.ceiling_holds));
+    }
+    // DIAG:OVERPRESSURE:RESET (zero the trip counters, peaks and sample counts)
+    else if (subCommand == "OVERPRESSURE:RESET") {
+        resetOverpressureStats();
+        sendAck("DIAG:OVERPRESSURE:RESET");
+    }
+    else {
+        sendError("INVALID_COMMAND", "DIAG:" + subCommand);
+    }
+}
+
+/**
+ * @brief Format a parameter value for replies (integers without decimals)
+ */
+static String formatParamValue(const ParamDesc* desc, float value) {
+    if (desc->type == PARAM_TYPE_F32) {
+        return String(value, 3);
+    }
+    return String((long)lroundf(value));
+}
+
+/**
+ * @brief Parse a parameter value, rejecting anything but a complete number
+ * @return false if the text is empty or has trailing characters
+ */
+static bool parseParamValue(const String& text, float* value) {
+    const char* start = text.c_str();
+    char* end = NULL;
+    *value = strtof(start, &end);
+    return end != start && *end == '\0';
+}
+
+void handleParamCommand(const String& subCommand) {
+    // PARAM:LIST (one line per parameter, then ACK)
+    if (subCommand == "LIST") {
+        size_t count = 0;
+        const ParamDesc* table = paramTable(&count);
+        for (size_t i = 0; i < count; ++i) {
+            const ParamDesc* desc = &table[i];
+            Serial.print("PARAM:");
+            Serial.print(desc->id);
+            Serial.print(":");
+            Serial.print(desc->name);
+            Serial.print("=");
+            Serial.print(formatParamValue(desc, paramGet(desc->id)));
+            Serial.print(":MIN=");
+            Serial.print(formatParamValue(desc, desc->min_value));
+            Serial.print(":MAX=");
+            Serial.print(formatParamValue(desc, desc->max_value));
+            Serial.print(":DEFAULT=");
+            Serial.println(formatParamValue(desc, desc->default_value));
+        }
+        sendAck("PARAM:LIST:" + String((int)count));
+    }
+    // PARAM:GET:<name|id>
+    else if (subCommand.startsWith("GET:")) {
+        const ParamDesc* desc = paramFind(subCommand.substring(4));
+        if (desc == NULL) {
+            sendError("UNKNOWN_PARAM", subCommand.substring(4));
+            return;
+        }
+        sendAck("PARAM:" + String(desc->name) + "=" + formatParamValue(desc, paramGet(desc->id)));
+    }
+    // PARAM:SET:<name|id>:<value>
+    else if (subCommand.startsWith("SET:")) {
+        String rest = subCommand.substring(4);
+        int sep = rest.indexOf(':');
+        if (sep <= 0) {
+            sendError("INVALID_COMMAND", "PARAM:" + subCommand);
+            return;
+        }
+
+        const ParamDesc* desc = paramFind(rest.substring(0, sep));
+        if (desc == NULL) {
+            sendError("UNKNOWN_PARAM", rest.substring(0, sep));
+            return;
+        }
+
+        float value;
+        if (!parseParamValue(rest.substring(sep + 1), &value)) {
+            sendError("INVALID_VALUE", String(desc->name) + ":" + rest.substring(sep + 1));
+            return;
+        }
+        if (!paramSet(desc->id, value)) {
+            sendError("OUT_OF_RANGE", String(desc->name) + ":" + rest.substring(sep + 1));
+            return;
+        }
+        sendAck("PARAM:" + String(desc->name) + "=" + formatParamValue(desc, paramGet(desc->id)));
+    }
+    // PARAM:SAVE (persist to NVS)
+    else if (subCommand == "SAVE") {
+        if (paramSave()) {
+            sendAck("PARAM:SAVE");
+        } else {
+            sendError("NVS", "WRITE_FAILED");
+        }
+    }
+    // PARAM:RESET (defaults, erase NVS copy)
+    else if (subCommand == "RESET") {
+        paramResetDefaults();
+        sendAck("PARAM:RESET");
+    }
+    else {
+        sendError("INVALID_COMMAND", "PARAM:" + subCommand);
+    }
+}
+
+static const char* otaStateName(OtaState state) {
+    switch (state) {
+        case OTA_IDLE:      return "IDLE";
+        case OTA_RECEIVING: return "RECEIVING";
+        case OTA_FAILED:    return "FAILED";
+    }
+    return "UNKNOWN";
+}
+
+void handleOtaCommand(const String& subCommand) {
+    // OTA:BEGIN:<size>:<crc32 hex>
+    if (subCommand.startsWith("BEGIN:")) {
+        String rest = subCommand.substring(6);
+        int sep = rest.indexOf(':');
+        if (sep <= 0) {
+            sendError("INVALID_COMMAND", "OTA:" + subCommand);
+            return;
+        }
+        uint32_t size = strtoul(rest.substring(0, sep).c_str(), NULL, 10);
+        uint32_t crc32 = strtoul(rest.substring(sep + 1).c_str(), NULL, 16);
+
+        OtaResult result = otaBegin(size, crc32);
+        if (result != OTA_OK) {
+            sendError("OTA", otaResultName(result));
+            return;
+        }
+        sendAck("OTA:BEGIN:" + String(size) + ":" + String(OTA_CHUNK_MAX));
+    }
+    // OTA:CHUNK:<offset>:<crc16 hex>:<base64 data>
+    else if (subCommand.startsWith("CHUNK:")) {
+        String rest = subCommand.substring(6);
+        int sep1 = rest.indexOf(':');
+        int sep2 = (sep1 > 0) ? rest.indexOf(':', sep1 + 1) : -1;
+        if (sep2 <= sep1 + 1) {
+            sendError("INVALID_COMMAND", "OTA:CHUNK");
+            return;
+        }
+        uint32_t offset = strtoul(rest.substring(0, sep1).c_str(), NULL, 10);
+        uint16_t crc16 = (uint16_t)strtoul(rest.substring(sep1 + 1, sep2).c_str(), NULL, 16);
+        String encoded = rest.substring(sep2 + 1);
+
+        uint8_t data[OTA_CHUNK_MAX + 3];  // Slack for base64 rounding (otaWriteChunk checks len)
+        size_t len = 0;
+        if (mbedtls_base64_decode(data, sizeof(data), &len,
+                                  (const unsigned char*)encoded.c_str(), encoded.length()) != 0) {
+            sendError("OTA", "DECODE:" + String(offset));
+            return;
+        }
+
+        OtaResult result = otaWriteChunk(offset, data, len, crc16);
+        if (result != OTA_OK) {
+            // Report the resume point so the host can resend from there
+            OtaStatus status;
+            getOtaStatus(&status);
+            sendError("OTA", String(otaResultName(result)) + ":" + String(status.next_offset));
+            return;
+        }
+        sendAck("OTA:CHUNK:" + String(offset + len));
+    }
+    // OTA:STATUS (state and resume offset)
+    else if (subCommand == "STATUS") {
+        OtaStatus status;
+        getOtaStatus(&status);
+
+        Serial.print("ACK:OTA:STATUS:STATE=");
+        Serial.print(otaStateName(status.state));
+        Serial.print(",OFFSET=");
+        Serial.print(status.next_offset);
+        Serial.print(",SIZE=");
+        Serial.print(status.image_size);
+        Serial.print(",CRC=");
+        Serial.print(status.image_crc, HEX);
+        Serial.print(",ERROR=");
+        Serial.print(otaResultName(status.last_error));
+        Serial.print(",RUNNING=");
+        Serial.print(status.running_label);
+        Serial.print(",PENDING=");
+        Serial.print(status.pending_verify ? 1 : 0);
+        Serial.print(",ATTEMPTS=");
+        Serial.println(status.boot_attempts);
+    }
+    // OTA:END (verify, select new slot, reboot)
+    else if (subCommand == "END") {
+        OtaResult result = otaEnd();
+        if (result != OTA_OK) {
+            sendError("OTA", otaResultName(result));
+            return;
+        }
+        sendAck("OTA:END:REBOOTING");
+        otaRestart();
+    }
+    // OTA:ABORT
+    else if (subCommand == "ABORT") {
+        otaAbort();
+        sendAck("OTA:ABORT");
+    }
+    else {
+        sendError("INVALID_COMMAND", "OTA:" + subCommand);
+    }
+}
+
 // ============================================================================
 // Main Command Processing
 // ============================================================================
 
+/**
+ * @brief Append the bytes already received to the command line
+ *
+ * Never waits for the rest of a line: a partial line stays buffered until
+ * a later call sees its '\n'. A line longer than COMMAND_LINE_MAX is
+ * dropped with ERR:INVALID_COMMAND:LINE_TOO_LONG.
+ *
+ * @param line Output: the completed line, without the '\n'
+ * @return true if a line was completed (remaining bytes are left unread)
+ */
+static bool readCommandLine(String* line) {
+    while (Serial.available() > 0) {
+        char c = (char)Serial.read();
+        if (c != '\n') {
+            if (command_length < COMMAND_LINE_MAX) {
+                command_line[command_length++] = c;
+            } else {
+                command_overflow = true;
+            }
+            continue;
+        }
+
+        command_line[command_length] = '\0';
+        bool overflow = command_overflow;
+        command_length = 0;
+        command_overflow = false;
+        if (overflow) {
+            sendError("INVALID_COMMAND", "LINE_TOO_LONG");
+            continue;
+        }
+        *line = command_line;
+        return true;
+    }
+    return false;
+}
+
 void processSerialCommand() {
     // Check if data available (non-blocking)
     if (Serial.available() > 0) {
-        String command = Serial.readStringUntil('\n');
-        command.trim();  // Remove whitespace and newline characters
+        powerNoteHostActivity();
+        String command;
+        if (!readCommandLine(&command)) {
+            return;
+        }
+        command.trim();  // Remove whitespace and carriage return
 
         // Ignore empty commands
         if (command.length() == 0) {
@@ -250,6 +936,18 @@ void processSerialCommand() {
         else if (command.startsWith("SERVO:")) {
             handleServoCommand(command.substring(6));
         }
+        else if (command.startsWith("INFO:")) {
+            handleInfoCommand(command.substring(5));
+        }
+        else if (command.startsWith("PARAM:")) {
+            handleParamCommand(command.substring(6));
+        }
+        else if (command.startsWith("DIAG:")) {
+            handleDiagCommand(command.substring(5));
+        }
+        else if (command.startsWith("OTA:")) {
+            handleOtaCommand(command.substring(4));
+        }
         else if (command.startsWith("MODE:")) {
             // MODE command already handled elsewhere (mode_control.h)
             // Just acknowledge to avoid "unknown command" error
@@ -6,6 +6,15 @@
  * - SWEEP:ENABLE / SWEEP:DISABLE
  * - SERVO:ANGLE:<n>
  * - SWEEP:MIN:<n> / SWEEP:MAX:<n> / SWEEP:STEP:<n>
+ * - INFO:GET
+ * - DIAG:WATCHDOG / DIAG:WATCHDOG:RESET / DIAG:ADCNOISE
+ * - DIAG:SWEEPLAG / DIAG:SWEEPLAG:RESET / DIAG:SWEEPLAG:CAL / DIAG:POWER
+ * - DIAG:LOCKS / DIAG:LOCKS:RESET / DIAG:CTRL / DIAG:CTRL:RESET
+ * - DIAG:COUPLING / DIAG:COUPLING:RESET
+ * - DIAG:BUDGET / DIAG:BUDGET:RESET / DIAG:SENSORS
+ * - DIAG:OVERPRESSURE / DIAG:OVERPRESSURE:RESET
+ * - PARAM:LIST / PARAM:GET / PARAM:SET / PARAM:SAVE / PARAM:RESET
+ * - OTA:BEGIN / OTA:CHUNK / OTA:STATUS / OTA:END / OTA:ABORT
  *
  * See docs/command-protocol.md for full command specification
  */
@@ -32,8 +41,8 @@ extern volatile int servo_reading_delay_ms;
 // Manual servo angle (used when sweep is disabled)
 extern volatile int servo_manual_angle;
 
-// Configuration mutex for thread-safe access
-extern SemaphoreHandle_t configMutex;
+// Access to the variables above is serialized by LOCK_CONFIG
+// (utils/instrumented_lock.h)
 
 // ============================================================================
 // Command Processing Functions
@@ -51,7 +60,8 @@ void initCommandHandler();
  * @brief Process incoming serial commands
  *
  * Call this function in main loop to check for and process serial commands.
- * Non-blocking - returns immediately if no data available.
+ * Non-blocking - bytes are collected into a line buffer across calls and
+ * at most one complete line is dispatched per call.
  *
  * Supported commands:
  * - SWEEP:ENABLE
@@ -60,6 +70,27 @@ void initCommandHandler();
  * - SWEEP:MIN:<n>
  * - SWEEP:MAX:<n>
  * - SWEEP:STEP:<n>
+ * - INFO:GET (replies with a binary FRAME_DEVICE_INFO frame)
+ * - DIAG:WATCHDOG (replies with control loop watchdog counters)
+ * - DIAG:WATCHDOG:RESET
+ * - DIAG:ADCNOISE[:<samples>] (synchronous vs free-running pad sampling noise)
+ * - DIAG:SWEEPLAG (continuous sweep lag table) / DIAG:SWEEPLAG:RESET
+ * - DIAG:SWEEPLAG:CAL (calibrate the lag against a settled reference sweep)
+ * - DIAG:POWER (PM lock duty and power mode)
+ * - DIAG:LOCKS (cross-task lock contention) / DIAG:LOCKS:RESET
+ * - DIAG:CTRL (control law, plant model, step scorecard) / DIAG:CTRL:RESET
+ * - DIAG:COUPLING (identified pad coupling matrix, decoupler state)
+ * - DIAG:COUPLING:RESET (erase the stored matrix, measured again at next boot)
+ * - DIAG:BUDGET (requested vs granted duty under POWER_BUDGET_PCT) / DIAG:BUDGET:RESET
+ * - DIAG:SENSORS (range sensor health, degraded sweep mode)
+ * - DIAG:OVERPRESSURE (over-pressure cutoff trips per pad) / DIAG:OVERPRESSURE:RESET
+ * - PARAM:LIST
+ * - PARAM:GET:<name|id>
+ * - PARAM:SET:<name|id>:<value>
+ * - PARAM:SAVE (persist all parameters to NVS)
+ * - PARAM:RESET (restore defaults and erase NVS copy)
+ * - OTA:BEGIN:<size>:<crc32> / OTA:CHUNK:<offset>:<crc16>:<base64>
+ * - OTA:STATUS / OTA:END (reboots into the new image) / OTA:ABORT
  */
 void processSerialCommand();
 
@@ -0,0 +1,100 @@
+/**
+ * @file device_info.cpp
+ * @brief Implementation of the build info and capability handshake frame
+ */
+
+#include "device_info.h"
+#include "command_handler.h"
+#include "instrumented_lock.h"
+#include "../config/pins.h"
+#include "../config/system_config.h"
+#include "../config/servo_config.h"
+#include "../config/param_registry.h"
+
+// Injected by scripts/build_info.py (falls back when building outside PlatformIO)
+#ifndef FIRMWARE_GIT_HASH
+#define FIRMWARE_GIT_HASH "unknown"
+#endif
+
+// Sector boundaries in motor order
+static const int SECTOR_MIN_ANGLES[5] = {SECTOR_MOTOR_1_MIN, SECTOR_MOTOR_2_MIN, SECTOR_MOTOR_3_MIN,
+                                         SECTOR_MOTOR_4_MIN, SECTOR_MOTOR_5_MIN};
+static const int SECTOR_MAX_ANGLES[5] = {SECTOR_MOTOR_1_MAX, SECTOR_MOTOR_2_MAX, SECTOR_MOTOR_3_MAX,
+                                         SECTOR_MOTOR_4_MAX, SECTOR_MOTOR_5_MAX};
+
+void buildDeviceInfo(DeviceInfoPayload* info) {
+    memset(info, 0, sizeof(DeviceInfoPayload));
+
+    // Protocol and hardware
+    info->protocol_version = PROTOCOL_VERSION;
+    info->motor_count = NUM_MOTORS;
+    info->pad_count = NUM_PRESSURE_PADS;
+    info->pot_count = NUM_POTENTIOMETERS;
+#ifdef CONTROL_MODE_NEWTONS
+    info->control_mode = 1;
+#else
+    info->control_mode = 0;
+#endif
+
+    // Runtime sweep mode and logging period (parameter registry)
+    ParamSnapshot params;
+    paramSnapshot(&params);
+    info->sweep_mode = params.sweep_mode;
+
+    // Rates
+    info->control_freq_hz = params.inner_rate_hz;
+    info->outer_freq_hz = params.outer_rate_hz;
+    info->logging_period_ms = params.log_period_ms;
+    info->pwm_freq_hz = PWM_FREQ_HZ;
+    info->pwm_res_bits = PWM_RES_BITS;
+    info->sweep_estimated_ms = SWEEP_ESTIMATED_TIME_MS;
+
+    // Runtime sweep configuration (compile-time defaults if the lock times out)
+    bool enabled = true;
+    int min_angle = SERVO_MIN_ANGLE;
+    int max_angle = SERVO_MAX_ANGLE;
+    int step = SERVO_STEP;
+    int manual = 90;
+    int settle = SERVO_SETTLE_MS;
+    int reading_delay = SERVO_READING_DELAY_MS;
+
+    if (lockTake(LOCK_CONFIG, 10)) {
+        enabled = sweep_enabled;
+        min_angle = servo_min_angle;
+        max_angle = servo_max_angle;
+        step = servo_step;
+        manual = servo_manual_angle;
+        settle = servo_settle_ms;
+        reading_delay = servo_reading_delay_ms;
+        lockGive(LOCK_CONFIG);
+    }
+
+    info->sweep_enabled = enabled ? 1 : 0;
+    info->servo_min_angle = (uint8_t)min_angle;
+    info->servo_max_angle = (uint8_t)max_angle;
+    info->servo_step = (uint8_t)step;
+    info->servo_manual_angle = (uint8_t)manual;
+    info->servo_settle_ms = (uint8_t)constrain(settle, 0, 255);
+    info->servo_reading_delay_ms = (uint8_t)constrain(reading_delay, 0, 255);
+    info->sector_count = NUM_MOTORS;
+
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        info->sector_min_angle[i] = (uint8_t)SECTOR_MIN_ANGLES[i];
+        info->sector_max_angle[i] = (uint8_t)SECTOR_MAX_ANGLES[i];
+    }
+
+    // Build info (truncated to fit, always NUL padded)
+    strncpy(info->git_hash, FIRMWARE_GIT_HASH, sizeof(info->git_hash) - 1);
+
+    // DataPacket layout
+    info->data_packet_header = PACKET_HEADER;
+    info->data_packet_size = sizeof(DataPacket);
+    info->field_count = DATA_PACKET_FIELD_COUNT;
+    memcpy(info->fields, DATA_PACKET_LAYOUT, sizeof(DATA_PACKET_LAYOUT));
+}
+
+void sendDeviceInfo() {
+    DeviceInfoPayload info;
+    buildDeviceInfo(&info);
+    sendFrame(FRAME_DEVICE_INFO, &info, sizeof(info));
+}
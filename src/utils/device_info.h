@@ -0,0 +1,34 @@
+/**
+ * @file device_info.h
+ * @brief Build info and capability handshake frame
+ *
+ * Emits a FRAME_DEVICE_INFO frame describing the running firmware:
+ * protocol version, motor count, control/logging rates, sweep parameters,
+ * DataPacket field layout and git hash. Clients use it to parse packets
+ * generically instead of hardcoding sizes and offsets.
+ *
+ * Sent at the end of setup() and on request (INFO:GET command).
+ */
+
+#ifndef DEVICE_INFO_H
+#define DEVICE_INFO_H
+
+#include <Arduino.h>
+#include "binary_protocol.h"
+
+/**
+ * @brief Fill a device info payload with the current configuration
+ *
+ * Reads runtime sweep configuration under LOCK_CONFIG; compile-time
+ * values are used if the lock times out.
+ *
+ * @param info Pointer to payload structure to fill
+ */
+void buildDeviceInfo(DeviceInfoPayload* info);
+
+/**
+ * @brief Send the device info frame via Serial
+ */
+void sendDeviceInfo();
+
+#endif // DEVICE_INFO_H
@@ -0,0 +1,116 @@
+/**
+ * @file instrumented_lock.cpp
+ * @brief Implementation of the instrumented cross-task mutexes
+ */
+
+#include "instrumented_lock.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct LockState {
+    SemaphoreHandle_t handle;
+    uint32_t taken_us;           // Written by the holder only
+    LockStats stats;
+};
+
+static LockState locks[LOCK_COUNT];
+static portMUX_TYPE lock_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* const LOCK_NAMES[LOCK_COUNT] = {"DISTANCE", "CONFIG", "MUX"};
+
+// ============================================================================
+// Internal Helper Functions
+// ============================================================================
+
+static int waitBucket(uint32_t wait_us) {
+    for (int i = 0; i < LOCK_WAIT_BUCKETS - 1; ++i) {
+        if (wait_us < LOCK_WAIT_BOUNDS_US[i]) {
+            return i;
+        }
+    }
+    return LOCK_WAIT_BUCKETS - 1;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+bool lockCreate(LockId id) {
+    if (id >= LOCK_COUNT) {
+        return false;
+    }
+    if (locks[id].handle == NULL) {
+        locks[id].handle = xSemaphoreCreateMutex();
+    }
+    return locks[id].handle != NULL;
+}
+
+bool lockTake(LockId id, uint32_t timeout_ms) {
+    if (id >= LOCK_COUNT || locks[id].handle == NULL) {
+        return false;
+    }
+    LockState& lock = locks[id];
+
+    uint32_t start_us = micros();
+    bool taken = xSemaphoreTake(lock.handle, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    uint32_t now_us = micros();
+    uint32_t wait_us = now_us - start_us;
+
+    portENTER_CRITICAL(&lock_stats_mux);
+    if (taken) {
+        lock.stats.acquires++;
+        lock.stats.wait_hist[waitBucket(wait_us)]++;
+        if (wait_us > lock.stats.wait_max_us) {
+            lock.stats.wait_max_us = wait_us;
+        }
+    } else {
+        lock.stats.timeouts++;
+    }
+    portEXIT_CRITICAL(&lock_stats_mux);
+
+    if (taken) {
+        lock.taken_us = now_us;
+    }
+    return taken;
+}
+
+void lockGive(LockId id) {
+    if (id >= LOCK_COUNT || locks[id].handle == NULL) {
+        return;
+    }
+    LockState& lock = locks[id];
+    uint32_t hold_us = micros() - lock.taken_us;
+
+    portENTER_CRITICAL(&lock_stats_mux);
+    if (hold_us > lock.stats.hold_max_us) {
+        lock.stats.hold_max_us = hold_us;
+    }
+    portEXIT_CRITICAL(&lock_stats_mux);
+
+    xSemaphoreGive(lock.handle);
+}
+
+void getLockStats(LockId id, LockStats* out) {
+    if (id >= LOCK_COUNT || out == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&lock_stats_mux);
+    *out = locks[id].stats;
+    portEXIT_CRITICAL(&lock_stats_mux);
+}
+
+const char* lockName(LockId id) {
+    return id < LOCK_COUNT ? LOCK_NAMES[id] : "?";
+}
+
+void resetLockStats() {
+    portENTER_CRITICAL(&lock_stats_mux);
+    for (int i = 0; i < LOCK_COUNT; ++i) {
+        locks[i].stats = LockStats();
+    }
+    portEXIT_CRITICAL(&lock_stats_mux);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file instrumented_lock.h
+ * @brief Cross-task mutexes with acquisition, wait and timeout counters
+ *
+ * Every mutex shared between tasks goes through lockTake()/lockGive(),
+ * so contention shows up in DIAG:LOCKS instead of as silently skipped
+ * reads and writes:
+ * - LOCK_DISTANCE  sector minima, servoSweepTask -> supervisory loop
+ * - LOCK_CONFIG    runtime sweep configuration, command handler -> sweep
+ * - LOCK_MUX       multiplexer channel + ADC conversion (lockMux())
+ *
+ * Counters accumulate until resetLockStats() (DIAG:LOCKS:RESET).
+ */
+
+#ifndef INSTRUMENTED_LOCK_H
+#define INSTRUMENTED_LOCK_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Instrumented mutexes
+ */
+enum LockId : uint8_t {
+    LOCK_DISTANCE = 0,
+    LOCK_CONFIG,
+    LOCK_MUX,
+    LOCK_COUNT
+};
+
+/**
+ * @brief Wait time histogram: bucket i counts waits below LOCK_WAIT_BOUNDS_US[i],
+ *        the last bucket everything above
+ */
+constexpr int LOCK_WAIT_BUCKETS = 5;
+constexpr uint32_t LOCK_WAIT_BOUNDS_US[LOCK_WAIT_BUCKETS - 1] = {10, 100, 1000, 10000};
+
+/**
+ * @brief Counters of one lock
+ */
+struct LockStats {
+    uint32_t acquires;                       // Successful takes
+    uint32_t timeouts;                       // Takes that gave up
+    uint32_t wait_hist[LOCK_WAIT_BUCKETS];   // Successful takes by wait time
+    uint32_t wait_max_us;                    // Longest successful wait
+    uint32_t hold_max_us;                    // Longest time held
+};
+
+/**
+ * @brief Create the mutex behind a lock (idempotent)
+ * @return false if the mutex could not be created
+ */
+bool lockCreate(LockId id);
+
+/**
+ * @brief Take a lock, waiting at most timeout_ms
+ * @return false on timeout or if the lock was never created
+ */
+bool lockTake(LockId id, uint32_t timeout_ms);
+
+/**
+ * @brief Release a lock taken with lockTake()
+ */
+void lockGive(LockId id);
+
+/**
+ * @brief Copy the counters of a lock
+ */
+void getLockStats(LockId id, LockStats* out);
+
+/**
+ * @brief Display name of a lock ("DISTANCE", "CONFIG", "MUX")
+ */
+const char* lockName(LockId id);
+
+/**
+ * @brief Zero the counters of every lock
+ */
+void resetLockStats();
+
+#endif // INSTRUMENTED_LOCK_H
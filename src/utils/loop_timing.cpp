@@ -0,0 +1,86 @@
+/**
+ * @file loop_timing.cpp
+ * @brief Implementation of the per-loop timing statistics
+ */
+
+#include "loop_timing.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct LoopTimingWindow {
+    uint32_t rate_hz;
+    uint32_t ticks;
+    uint32_t late_ticks;
+    uint32_t overruns;
+    uint32_t exec_sum_us;
+    uint32_t exec_max_us;
+    uint32_t period_max_us;
+    uint32_t last_start_us;      // Kept across windows
+    bool started;
+};
+
+static LoopTimingWindow windows[LOOP_COUNT];
+static portMUX_TYPE timing_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void loopTimingRecord(LoopId id, uint32_t start_us, uint32_t end_us, uint32_t rate_hz) {
+    if (id >= LOOP_COUNT || rate_hz == 0) {
+        return;
+    }
+    uint32_t period_us = 1000000UL / rate_hz;
+    uint32_t exec_us = end_us - start_us;
+
+    portENTER_CRITICAL(&timing_mux);
+    LoopTimingWindow& w = windows[id];
+    if (w.started) {
+        uint32_t gap_us = start_us - w.last_start_us;
+        if (gap_us > w.period_max_us) {
+            w.period_max_us = gap_us;
+        }
+        if (gap_us > period_us + period_us / 2) {
+            w.late_ticks++;
+        }
+    }
+    w.started = true;
+    w.last_start_us = start_us;
+    w.rate_hz = rate_hz;
+    w.ticks++;
+    w.exec_sum_us += exec_us;
+    if (exec_us > w.exec_max_us) {
+        w.exec_max_us = exec_us;
+    }
+    if (exec_us > period_us) {
+        w.overruns++;
+    }
+    portEXIT_CRITICAL(&timing_mux);
+}
+
+void takeLoopTiming(LoopId id, LoopTimingSnapshot* out) {
+    if (id >= LOOP_COUNT || out == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&timing_mux);
+    LoopTimingWindow& w = windows[id];
+    out->rate_hz = w.rate_hz;
+    out->ticks = w.ticks;
+    out->late_ticks = w.late_ticks;
+    out->overruns = w.overruns;
+    out->exec_avg_us = w.ticks ? w.exec_sum_us / w.ticks : 0;
+    out->exec_max_us = w.exec_max_us;
+    out->period_max_us = w.period_max_us;
+
+    w.ticks = 0;
+    w.late_ticks = 0;
+    w.overruns = 0;
+    w.exec_sum_us = 0;
+    w.exec_max_us = 0;
+    w.period_max_us = 0;
+    portEXIT_CRITICAL(&timing_mux);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file loop_timing.h
+ * @brief Per-loop execution time and period statistics
+ *
+ * Each periodic loop records the start and end of every tick. Statistics
+ * accumulate over a window that is read and cleared by the telemetry task
+ * (1 Hz FRAME_LOOP_TIMING frame).
+ */
+
+#ifndef LOOP_TIMING_H
+#define LOOP_TIMING_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Supervised loops
+ */
+enum LoopId : uint8_t {
+    LOOP_INNER = 0,              // Pressure loop task
+    LOOP_OUTER,                  // Supervisory loop (loop())
+    LOOP_COUNT
+};
+
+/**
+ * @brief Statistics of one loop over the last window
+ */
+struct LoopTimingSnapshot {
+    uint32_t rate_hz;            // Configured rate
+    uint32_t ticks;              // Ticks in the window
+    uint32_t late_ticks;         // Ticks started more than 1.5x the period after the previous one
+    uint32_t overruns;           // Ticks whose execution took longer than the period
+    uint32_t exec_avg_us;        // Mean execution time
+    uint32_t exec_max_us;        // Longest execution time
+    uint32_t period_max_us;      // Longest interval between tick starts
+};
+
+/**
+ * @brief Record one completed tick
+ * @param id Loop
+ * @param start_us Tick start (micros())
+ * @param end_us Tick end (micros())
+ * @param rate_hz Configured loop rate
+ */
+void loopTimingRecord(LoopId id, uint32_t start_us, uint32_t end_us, uint32_t rate_hz);
+
+/**
+ * @brief Copy and clear the statistics window of a loop
+ * @param id Loop
+ * @param out Output snapshot
+ */
+void takeLoopTiming(LoopId id, LoopTimingSnapshot* out);
+
+#endif // LOOP_TIMING_H
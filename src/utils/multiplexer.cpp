@@ -5,8 +5,30 @@
 
 #include "multiplexer.h"
 #include "../config/pins.h"
+#include "instrumented_lock.h"
+#include "power_manager.h"
+#include <freertos/FreeRTOS.h>
+#include <soc/gpio_struct.h>
+#include <hal/adc_hal.h>
+#include <esp_adc_cal.h>
+
+// Select pins are written through the GPIO 0-31 set/clear registers from the ISR
+static_assert(MUX_S0 < 32 && MUX_S1 < 32 && MUX_S2 < 32 && MUX_S3 < 32,
+              "muxSelectFromISR() only drives GPIO 0-31");
+
+// Hardware claim shared by the tasks and the over-pressure sampler ISR
+static portMUX_TYPE mux_claim_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool task_reading = false;
+static volatile bool isr_claimed = false;
+
+// ADC1 channel and calibration of the signal pin for the ISR conversions
+static int8_t mux_adc_channel = -1;
+static esp_adc_cal_characteristics_t mux_adc_chars;
 
 void initMultiplexer() {
+    // LOCK_MUX serializes channel selection + conversion between tasks
+    lockCreate(LOCK_MUX);
+
     // Configure control pins as outputs
     pinMode(MUX_S0, OUTPUT);
     pinMode(MUX_S1, OUTPUT);
@@ -22,6 +44,11 @@ void initMultiplexer() {
     // Set ADC attenuation for signal pin (0-3.3V range with ~11dB attenuation)
     analogSetPinAttenuation(MUX_SIG, ADC_11db);
 
+    // Same ADC1 setup as analogReadMilliVolts(), for muxConvertFromISR()
+    mux_adc_channel = digitalPinToAnalogChannel(MUX_SIG);
+    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &mux_adc_chars);
+    analogReadMilliVolts(MUX_SIG);  // Lets the driver configure the channel once
+
     // Initialize to channel 0
     setMuxChannel(0);
 }
@@ -35,12 +62,16 @@ void setMuxChannel(uint8_t channel) {
 }
 
 uint16_t readMuxRaw(uint8_t channel) {
+    muxBeginRead();
     setMuxChannel(channel);
     delayMicroseconds(MUX_SETTLE_US);  // Wait for multiplexer to settle
-    return analogRead(MUX_SIG);
+    uint16_t raw = analogRead(MUX_SIG);
+    muxEndRead();
+    return raw;
 }
 
 uint16_t readMuxRawAveraged(uint8_t channel, int samples) {
+    muxBeginRead();
     setMuxChannel(channel);
     delayMicroseconds(MUX_SETTLE_US);  // Wait for multiplexer to settle
 
@@ -49,17 +80,22 @@ uint16_t readMuxRawAveraged(uint8_t channel, int samples) {
         accumulator += analogRead(MUX_SIG);
         delayMicroseconds(50);  // Small delay between samples
     }
+    muxEndRead();
 
     return static_cast<uint16_t>(accumulator / samples);
 }
 
 uint16_t readMuxMilliVolts(uint8_t channel) {
+    muxBeginRead();
     setMuxChannel(channel);
     delayMicroseconds(MUX_SETTLE_US);  // Wait for multiplexer to settle
-    return analogReadMilliVolts(MUX_SIG);
+    uint16_t mv = analogReadMilliVolts(MUX_SIG);
+    muxEndRead();
+    return mv;
 }
 
 uint16_t readMuxMilliVoltsAveraged(uint8_t channel, int samples) {
+    muxBeginRead();
     setMuxChannel(channel);
     delayMicroseconds(MUX_SETTLE_US);  // Wait for multiplexer to settle
 
@@ -68,6 +104,76 @@ uint16_t readMuxMilliVoltsAveraged(uint8_t channel, int samples) {
         accumulator += analogReadMilliVolts(MUX_SIG);
         delayMicroseconds(50);  // Small delay between samples
     }
+    muxEndRead();
 
     return static_cast<uint16_t>(accumulator / samples);
 }
+
+bool lockMux(uint32_t timeout_ms) {
+    if (!lockTake(LOCK_MUX, timeout_ms)) {
+        return false;
+    }
+    // Conversions (and the PWM phase waits) run at full CPU speed
+    pmLockAcquire(PM_LOCK_ADC);
+    return true;
+}
+
+void unlockMux() {
+    pmLockRelease(PM_LOCK_ADC);
+    lockGive(LOCK_MUX);
+}
+
+void muxBeginRead() {
+    // Takes the mux even from a sampler that is still settling its channel:
+    // the sampler then drops that slot instead of the task waiting for it
+    portENTER_CRITICAL(&mux_claim_lock);
+    task_reading = true;
+    isr_claimed = false;
+    portEXIT_CRITICAL(&mux_claim_lock);
+}
+
+void muxEndRead() {
+    portENTER_CRITICAL(&mux_claim_lock);
+    task_reading = false;
+    portEXIT_CRITICAL(&mux_claim_lock);
+}
+
+static void setMuxChannelFromISR(uint8_t channel) {
+    const uint8_t pins[4] = {MUX_S0, MUX_S1, MUX_S2, MUX_S3};
+    uint32_t set_mask = 0;
+    uint32_t clear_mask = 0;
+    for (int bit = 0; bit < 4; ++bit) {
+        if (channel & (1U << bit)) {
+            set_mask |= (1UL << pins[bit]);
+        } else {
+            clear_mask |= (1UL << pins[bit]);
+        }
+    }
+    GPIO.out_w1tc = clear_mask;
+    GPIO.out_w1ts = set_mask;
+}
+
+bool muxSelectFromISR(uint8_t channel) {
+    portENTER_CRITICAL_ISR(&mux_claim_lock);
+    bool claimed = !task_reading;
+    if (claimed) {
+        isr_claimed = true;
+        setMuxChannelFromISR(channel);
+    }
+    portEXIT_CRITICAL_ISR(&mux_claim_lock);
+    return claimed;
+}
+
+bool muxConvertFromISR(uint16_t* millivolts) {
+    portENTER_CRITICAL_ISR(&mux_claim_lock);
+    bool claimed = isr_claimed;
+    if (claimed) {
+        // ADC1 through the HAL: analogRead() takes a driver lock
+        int raw = 0;
+        adc_hal_convert(ADC_NUM_1, mux_adc_channel, &raw);
+        *millivolts = (uint16_t)esp_adc_cal_raw_to_voltage((uint32_t)raw, &mux_adc_chars);
+        isr_claimed = false;
+    }
+    portEXIT_CRITICAL_ISR(&mux_claim_lock);
+    return claimed;
+}
@@ -4,6 +4,17 @@
  *
  * Provides functions to select channels and read analog values through
  * a CD74HC4067 multiplexer using 4 control pins (S0-S3) and 1 signal pin.
+ *
+ * The pads (pressure loop task) and potentiometers (supervisory loop) share
+ * the one signal pin. Tasks must hold lockMux() around a channel read so a
+ * preempting task cannot switch the channel under them.
+ *
+ * The over-pressure sampler ISR (overpressure_guard.h) also switches the
+ * channel, on another core and without any lock. Every select + convert
+ * sequence is therefore wrapped in muxBeginRead()/muxEndRead(), a short
+ * spinlock claim. A task read never waits for the sampler: it revokes the
+ * sampler's claim, and the sampler only selects while no read is in
+ * progress.
  */
 
 #ifndef MULTIPLEXER_H
@@ -75,4 +86,56 @@ uint16_t readMuxMilliVolts(uint8_t channel);
  */
 uint16_t readMuxMilliVoltsAveraged(uint8_t channel, int samples);
 
+/**
+ * @brief Take exclusive use of the multiplexer
+ *
+ * @param timeout_ms Maximum wait
+ * @return true if acquired (release with unlockMux())
+ */
+bool lockMux(uint32_t timeout_ms);
+
+/**
+ * @brief Release the multiplexer taken with lockMux()
+ */
+void unlockMux();
+
+/**
+ * @brief Claim the mux hardware for one channel read (task side)
+ *
+ * Never waits for the sampler; a sampler still settling its channel loses
+ * that slot. Keep the claim short (one channel, a few conversions): the
+ * sampler skips its slots while it is held. The readMux*() functions and
+ * the pad reads already take it.
+ */
+void muxBeginRead();
+
+/**
+ * @brief Release the claim taken with muxBeginRead()
+ */
+void muxEndRead();
+
+/**
+ * @brief Claim the mux and select a channel from the sampler ISR
+ *
+ * Uses direct GPIO register writes. The channel settles until
+ * muxConvertFromISR().
+ *
+ * @param channel Multiplexer channel to select (0-15)
+ * @return false if a task read is in progress (skip this slot)
+ */
+bool muxSelectFromISR(uint8_t channel);
+
+/**
+ * @brief Convert the channel selected with muxSelectFromISR() and release
+ *
+ * Starts the ADC1 conversion through the HAL instead of analogRead(),
+ * whose driver lock must not be taken in an ISR. The HAL and the
+ * calibration run from flash, so the calling interrupt must not be
+ * allocated with ESP_INTR_FLAG_IRAM.
+ *
+ * @param millivolts Output voltage in millivolts (mV)
+ * @return false if a task read revoked the claim while settling
+ */
+bool muxConvertFromISR(uint16_t* millivolts);
+
 #endif // MULTIPLEXER_H
@@ -0,0 +1,305 @@
+/**
+ * @file ota_update.cpp
+ * @brief Implementation of the serial firmware update and rollback
+ */
+
+#include "ota_update.h"
+#include "binary_protocol.h"
+#include "tlog.h"
+#include "../actuators/motors.h"
+#include "../control/control_watchdog.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_rom_crc.h>
+#include <sdkconfig.h>
+
+// ============================================================================
+// NVS Storage
+// ============================================================================
+
+constexpr const char* NVS_NAMESPACE = "ota";
+constexpr const char* NVS_KEY_PENDING = "pending";    // New image not yet validated
+constexpr const char* NVS_KEY_ATTEMPTS = "attempts";  // Boots of the pending image
+
+// ============================================================================
+// State
+// ============================================================================
+
+// Transfer session (only touched from the command handler on Core 1)
+static esp_ota_handle_t ota_handle = 0;
+static const esp_partition_t* ota_target = NULL;
+static uint32_t ota_image_size = 0;
+static uint32_t ota_expected_crc = 0;
+static uint32_t ota_running_crc = 0;
+static uint32_t ota_next_offset = 0;
+static OtaResult ota_last_error = OTA_OK;
+
+// Read by the telemetry task on Core 0
+static volatile OtaState ota_state = OTA_IDLE;
+
+// Boot-time rollback state
+static bool pending_verify = false;
+static uint8_t boot_attempts = 0;
+static uint32_t self_test_ticks = 0;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static void clearPending() {
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.putUChar(NVS_KEY_PENDING, 0);
+        prefs.putUChar(NVS_KEY_ATTEMPTS, 0);
+        prefs.end();
+    }
+    pending_verify = false;
+}
+
+static OtaResult fail(OtaResult result) {
+    if (ota_state == OTA_RECEIVING) {
+        esp_ota_abort(ota_handle);
+    }
+    ota_state = OTA_FAILED;
+    ota_last_error = result;
+    return result;
+}
+
+/**
+ * @brief Boot the other app slot (previous image) and restart
+ *
+ * Returns only if the other slot holds no valid image.
+ */
+static void rollBack(const char* reason) {
+    TLOG("OTA: rolling back (%s)", reason);
+    Serial.flush();
+
+    clearPending();
+    saveMotorCounters();
+
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+#endif
+
+    // esp_ota_set_boot_partition() verifies the image before selecting it
+    const esp_partition_t* previous = esp_ota_get_next_update_partition(NULL);
+    if (previous != NULL && esp_ota_set_boot_partition(previous) == ESP_OK) {
+        delay(100);
+        ESP.restart();
+    }
+    TLOG("OTA: no valid previous image, keeping this one");
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void initOtaUpdate() {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) {
+        return;
+    }
+    pending_verify = prefs.getUChar(NVS_KEY_PENDING, 0) != 0;
+    if (pending_verify) {
+        boot_attempts = prefs.getUChar(NVS_KEY_ATTEMPTS, 0) + 1;
+        prefs.putUChar(NVS_KEY_ATTEMPTS, boot_attempts);
+    }
+    prefs.end();
+
+    if (!pending_verify) {
+        return;
+    }
+
+    TLOG("OTA: new image, boot attempt %u/%u", boot_attempts, OTA_MAX_BOOT_ATTEMPTS);
+
+    if (boot_attempts > OTA_MAX_BOOT_ATTEMPTS) {
+        rollBack("BOOT_ATTEMPTS");
+    }
+}
+
+bool otaIsUpdateBoot() {
+    return pending_verify;
+}
+
+bool otaInProgress() {
+    return ota_state == OTA_RECEIVING;
+}
+
+OtaResult otaBegin(uint32_t size, uint32_t crc32) {
+    if (ota_state == OTA_RECEIVING) {
+        return OTA_ERR_BUSY;
+    }
+
+    ota_target = esp_ota_get_next_update_partition(NULL);
+    if (ota_target == NULL) {
+        ota_state = OTA_FAILED;
+        ota_last_error = OTA_ERR_FLASH;
+        return OTA_ERR_FLASH;
+    }
+    if (size == 0 || size > ota_target->size) {
+        ota_state = OTA_FAILED;
+        ota_last_error = OTA_ERR_SIZE;
+        return OTA_ERR_SIZE;
+    }
+
+    // Sequential writes erase sector by sector instead of the whole slot
+    // up front, so each command stalls the flash cache only briefly.
+    if (esp_ota_begin(ota_target, OTA_WITH_SEQUENTIAL_WRITES, &ota_handle) != ESP_OK) {
+        ota_state = OTA_FAILED;
+        ota_last_error = OTA_ERR_FLASH;
+        return OTA_ERR_FLASH;
+    }
+
+    ota_image_size = size;
+    ota_expected_crc = crc32;
+    ota_running_crc = 0;
+    ota_next_offset = 0;
+    ota_last_error = OTA_OK;
+    ota_state = OTA_RECEIVING;
+
+    // The pressure loop now holds the motors: store the actuation counters
+    // before the transfer, they are not saved again until the restart
+    saveMotorCounters();
+    return OTA_OK;
+}
+
+OtaResult otaWriteChunk(uint32_t offset, const uint8_t* data, size_t len, uint16_t crc16) {
+    if (ota_state != OTA_RECEIVING) {
+        return OTA_ERR_NOT_STARTED;
+    }
+
+    // Rejected chunks leave the session open so the host can resend
+    if (offset != ota_next_offset) {
+        return OTA_ERR_OFFSET;
+    }
+    if (len == 0 || len > OTA_CHUNK_MAX || offset + len > ota_image_size) {
+        return OTA_ERR_SIZE;
+    }
+    if (calculateCRC16(data, len) != crc16) {
+        return OTA_ERR_CHUNK_CRC;
+    }
+
+    if (esp_ota_write(ota_handle, data, len) != ESP_OK) {
+        return fail(OTA_ERR_FLASH);
+    }
+    ota_running_crc = esp_rom_crc32_le(ota_running_crc, data, len);
+    ota_next_offset += len;
+    return OTA_OK;
+}
+
+OtaResult otaEnd() {
+    if (ota_state != OTA_RECEIVING) {
+        return OTA_ERR_NOT_STARTED;
+    }
+    if (ota_next_offset != ota_image_size) {
+        return OTA_ERR_INCOMPLETE;
+    }
+    if (ota_running_crc != ota_expected_crc) {
+        return fail(OTA_ERR_IMAGE_CRC);
+    }
+
+    // esp_ota_end() also checks the image header and SHA-256 digest
+    esp_err_t err = esp_ota_end(ota_handle);
+    ota_state = OTA_IDLE;
+    if (err != ESP_OK || esp_ota_set_boot_partition(ota_target) != ESP_OK) {
+        ota_state = OTA_FAILED;
+        ota_last_error = OTA_ERR_FLASH;
+        return OTA_ERR_FLASH;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.putUChar(NVS_KEY_PENDING, 1);
+        prefs.putUChar(NVS_KEY_ATTEMPTS, 0);
+        prefs.end();
+    }
+    return OTA_OK;
+}
+
+void otaAbort() {
+    if (ota_state == OTA_RECEIVING) {
+        esp_ota_abort(ota_handle);
+    }
+    ota_state = OTA_IDLE;
+    ota_next_offset = 0;
+}
+
+void otaRestart() {
+    saveMotorCounters();
+    Serial.flush();
+    delay(100);
+    ESP.restart();
+}
+
+void getOtaStatus(OtaStatus* status) {
+    if (status == NULL) {
+        return;
+    }
+    const esp_partition_t* running = esp_ota_get_running_partition();
+
+    status->state = ota_state;
+    status->last_error = ota_last_error;
+    status->image_size = ota_image_size;
+    status->image_crc = ota_expected_crc;
+    status->next_offset = ota_next_offset;
+    status->pending_verify = pending_verify;
+    status->boot_attempts = boot_attempts;
+    status->running_label = running ? running->label : "?";
+}
+
+const char* otaResultName(OtaResult result) {
+    switch (result) {
+        case OTA_OK:              return "OK";
+        case OTA_ERR_BUSY:        return "BUSY";
+        case OTA_ERR_NOT_STARTED: return "NOT_STARTED";
+        case OTA_ERR_SIZE:        return "SIZE";
+        case OTA_ERR_OFFSET:      return "OFFSET";
+        case OTA_ERR_CHUNK_CRC:   return "CHUNK_CRC";
+        case OTA_ERR_IMAGE_CRC:   return "IMAGE_CRC";
+        case OTA_ERR_INCOMPLETE:  return "INCOMPLETE";
+        case OTA_ERR_FLASH:       return "FLASH";
+    }
+    return "UNKNOWN";
+}
+
+void otaSelfTestTick(bool calibration_ok) {
+    if (!pending_verify) {
+        return;
+    }
+    if (++self_test_ticks < OTA_SELF_TEST_TICKS) {
+        return;
+    }
+
+    ControlWatchdogStats stats;
+    getControlWatchdogStats(&stats);
+
+    if (stats.misses > 0 || stats.outer_misses > 0) {
+        rollBack("WATCHDOG");
+    } else if (ESP.getFreeHeap() < OTA_MIN_FREE_HEAP) {
+        rollBack("HEAP");
+    } else if (!calibration_ok) {
+        rollBack("CALIBRATION");
+    } else {
+        clearPending();
+        esp_ota_mark_app_valid_cancel_rollback();
+        TLOG("OTA: self-test passed, image marked valid");
+    }
+
+    // A failed rollback also ends the self-test (pending already cleared)
+    pending_verify = false;
+}
+
+// ============================================================================
+// Arduino Core Hook
+// ============================================================================
+
+/**
+ * @brief Keep the Arduino core from validating a pending image at startup
+ *
+ * With bootloader rollback enabled, initArduino() marks the image valid
+ * before setup() unless this returns true. The decision belongs to
+ * otaSelfTestTick().
+ */
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file ota_update.h
+ * @brief Firmware update over the serial link with A/B slots and rollback
+ *
+ * The image is streamed as text commands into the inactive OTA app slot
+ * (ota_0 / ota_1 of the default partition table), so no toolchain is
+ * needed at the rig. Use frontend/dev/ota-push.ts to send an image.
+ *
+ * Transfer (see docs/command-protocol.md):
+ * - OTA:BEGIN:<size>:<crc32>         open the inactive slot
+ * - OTA:CHUNK:<offset>:<crc16>:<b64> write one chunk at <offset>
+ * - OTA:STATUS                       report state and next expected offset
+ * - OTA:END                          verify CRC-32, switch slot, reboot
+ * - OTA:ABORT                        drop the session
+ *
+ * Resume: a chunk is only accepted at the next expected offset. After a
+ * dropped link the host asks OTA:STATUS and continues from that offset;
+ * the session survives until OTA:ABORT or a reset.
+ *
+ * Rollback: the new image boots in PENDING state. Each boot increments an
+ * NVS attempt counter; after OTA_MAX_BOOT_ATTEMPTS boots without passing
+ * the self-test (crash loop, hang before the control loop) the previous
+ * slot is booted again. The self-test runs after OTA_SELF_TEST_TICKS
+ * control ticks and marks the image valid or rolls back immediately.
+ * When the bootloader rollback feature is enabled the same decisions are
+ * also applied through esp_ota_mark_app_valid_cancel_rollback().
+ *
+ * While a transfer is open the control loop holds all motors braked and
+ * the telemetry task stays quiet so the link carries only the image.
+ * The motor actuation counters are saved at OTA:BEGIN and before every
+ * restart done here.
+ */
+
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include <Arduino.h>
+#include "../config/system_config.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr size_t OTA_CHUNK_MAX = 192;              // Raw bytes per OTA:CHUNK (256 base64 chars)
+constexpr uint8_t OTA_MAX_BOOT_ATTEMPTS = 3;       // Boots allowed before automatic rollback
+constexpr uint32_t OTA_SELF_TEST_TICKS = 5 * CTRL_FREQ_HZ;  // Outer ticks before the self-test (5 s at default rate)
+constexpr uint32_t OTA_MIN_FREE_HEAP = 32 * 1024;  // Self-test heap floor (bytes)
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Transfer session state
+ */
+enum OtaState : uint8_t {
+    OTA_IDLE = 0,                // No transfer open
+    OTA_RECEIVING,               // Slot open, accepting chunks
+    OTA_FAILED                   // Last transfer failed (see error)
+};
+
+/**
+ * @brief Result of an OTA operation (reported as the ERR detail)
+ */
+enum OtaResult : uint8_t {
+    OTA_OK = 0,
+    OTA_ERR_BUSY,                // BEGIN while receiving
+    OTA_ERR_NOT_STARTED,         // CHUNK/END without BEGIN
+    OTA_ERR_SIZE,                // Image larger than the slot, or chunk past the end
+    OTA_ERR_OFFSET,              // Chunk not at the expected offset
+    OTA_ERR_CHUNK_CRC,           // Chunk CRC-16 mismatch
+    OTA_ERR_IMAGE_CRC,           // Whole image CRC-32 mismatch
+    OTA_ERR_INCOMPLETE,          // END before all bytes were received
+    OTA_ERR_FLASH                // esp_ota_* call failed
+};
+
+/**
+ * @brief Transfer progress snapshot
+ */
+struct OtaStatus {
+    OtaState state;
+    OtaResult last_error;
+    uint32_t image_size;         // Bytes announced by BEGIN
+    uint32_t image_crc;          // CRC-32 announced by BEGIN
+    uint32_t next_offset;        // Next byte expected (resume point)
+    bool pending_verify;         // Running image has not passed the self-test yet
+    uint8_t boot_attempts;       // Boots of the pending image so far
+    const char* running_label;   // Partition label of the running image
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Boot-time rollback check
+ *
+ * Call first thing in setup(). If the running image is pending and has
+ * used up OTA_MAX_BOOT_ATTEMPTS, boots the previous slot (does not return).
+ */
+void initOtaUpdate();
+
+/**
+ * @brief True while running a freshly written image before its self-test
+ *
+ * Lets setup() restore the stored pad calibration instead of repeating
+ * the calibration sequence.
+ */
+bool otaIsUpdateBoot();
+
+/**
+ * @brief True while a transfer is open (motors held, telemetry paused)
+ */
+bool otaInProgress();
+
+/**
+ * @brief Open the inactive slot for an image
+ * @param size Image size in bytes
+ * @param crc32 CRC-32 (IEEE, as zlib) of the whole image
+ */
+OtaResult otaBegin(uint32_t size, uint32_t crc32);
+
+/**
+ * @brief Write one chunk
+ * @param offset Byte offset of the chunk (must equal next_offset)
+ * @param data Chunk bytes
+ * @param len Chunk length (1 to OTA_CHUNK_MAX)
+ * @param crc16 CRC-16 of the chunk (calculateCRC16)
+ */
+OtaResult otaWriteChunk(uint32_t offset, const uint8_t* data, size_t len, uint16_t crc16);
+
+/**
+ * @brief Finish the transfer and select the new slot for the next boot
+ *
+ * On OTA_OK the caller replies and then calls otaRestart().
+ */
+OtaResult otaEnd();
+
+/**
+ * @brief Drop the current transfer
+ */
+void otaAbort();
+
+/**
+ * @brief Reboot into the slot selected by otaEnd()
+ */
+void otaRestart();
+
+/**
+ * @brief Copy the current progress
+ * @param status Output snapshot
+ */
+void getOtaStatus(OtaStatus* status);
+
+/**
+ * @brief Short name of a result for ERR replies (e.g. "CHUNK_CRC")
+ */
+const char* otaResultName(OtaResult result);
+
+/**
+ * @brief Post-update self-test, called once per control tick
+ *
+ * Does nothing unless the running image is pending. After
+ * OTA_SELF_TEST_TICKS ticks, checks the control watchdog (no missed
+ * deadline in either loop), free heap and the caller's calibration result, then marks
+ * the image valid or rolls back to the previous slot.
+ *
+ * @param calibration_ok Pad calibration is usable (max above pre-stress)
+ */
+void otaSelfTestTick(bool calibration_ok);
+
+#endif // OTA_UPDATE_H
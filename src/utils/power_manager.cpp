@@ -0,0 +1,204 @@
+/**
+ * @file power_manager.cpp
+ * @brief Implementation of power management and PM lock accounting
+ */
+
+#include "power_manager.h"
+#include "tlog.h"
+#include "../config/param_registry.h"
+#include "../config/system_config.h"
+#include <freertos/FreeRTOS.h>
+#include <sdkconfig.h>
+
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/uart.h>
+#endif
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct PmLockState {
+    uint32_t depth;              // Nesting across all holders
+    uint32_t since_us;           // Start of the current held period
+    uint32_t held_us;            // Held time in this window
+    uint32_t acquires;
+};
+
+static PmLockState locks[PM_LOCK_COUNT];
+static uint32_t full_speed_depth = 0;
+static uint32_t full_speed_since_us = 0;
+static uint32_t full_speed_us = 0;
+static uint32_t window_start_us = 0;
+static portMUX_TYPE power_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Supervisory loop only
+static uint8_t applied_mode = 0xFF;
+static bool io_held = false;
+static volatile uint32_t last_host_ms = 0;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t handles[PM_LOCK_COUNT] = {NULL, NULL, NULL, NULL};
+static const char* const LOCK_NAMES[PM_LOCK_COUNT] = {"control", "adc", "sweep", "io"};
+#endif
+
+// ============================================================================
+// Internal Helper Functions
+// ============================================================================
+
+static bool raisesCpu(PmLockId id) {
+    return id != PM_LOCK_IO;
+}
+
+static void applyMode(uint8_t mode) {
+    applied_mode = mode;
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32s3_t config;
+    config.max_freq_mhz = PM_MAX_FREQ_MHZ;
+    config.min_freq_mhz = (mode == POWER_PERFORMANCE) ? PM_MAX_FREQ_MHZ : PM_MIN_FREQ_MHZ;
+    config.light_sleep_enable = (mode == POWER_DFS_LIGHT_SLEEP);
+
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_ERR_NOT_SUPPORTED && config.light_sleep_enable) {
+        // Core built without tickless idle: scale frequency only
+        config.light_sleep_enable = false;
+        err = esp_pm_configure(&config);
+        TLOG("Power: light sleep not supported by this core, DFS only");
+    }
+    if (err != ESP_OK) {
+        TLOG("Power: esp_pm_configure failed (%d)", (int)err);
+        return;
+    }
+    if (config.light_sleep_enable) {
+        // Host commands wake the chip; the waking characters are lost
+        uart_set_wakeup_threshold(UART_NUM_0, 3);
+        esp_sleep_enable_uart_wakeup(UART_NUM_0);
+    }
+    TLOG("Power: mode %u, CPU %d-%d MHz, light sleep %d", mode,
+         config.min_freq_mhz, config.max_freq_mhz, (int)config.light_sleep_enable);
+#else
+    TLOG("Power: mode %u requested, core built without CONFIG_PM_ENABLE", mode);
+#endif
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void initPowerManagement(uint8_t mode) {
+#if CONFIG_PM_ENABLE
+    for (int i = 0; i < PM_LOCK_COUNT; i++) {
+        esp_pm_lock_type_t type = raisesCpu((PmLockId)i) ? ESP_PM_CPU_FREQ_MAX : ESP_PM_NO_LIGHT_SLEEP;
+        if (esp_pm_lock_create(type, 0, LOCK_NAMES[i], &handles[i]) != ESP_OK) {
+            handles[i] = NULL;
+            TLOG("Power: failed to create %s lock", LOCK_NAMES[i]);
+        }
+    }
+#endif
+    last_host_ms = millis();
+    window_start_us = micros();
+    applyMode(mode);
+}
+
+void powerTick(uint8_t mode, bool outputs_active) {
+    if (mode != applied_mode) {
+        applyMode(mode);
+    }
+
+    bool host_active = (millis() - last_host_ms) < PM_HOST_IDLE_MS;
+    bool want_io = outputs_active || host_active;
+    if (want_io && !io_held) {
+        pmLockAcquire(PM_LOCK_IO);
+        io_held = true;
+    } else if (!want_io && io_held) {
+        pmLockRelease(PM_LOCK_IO);
+        io_held = false;
+    }
+}
+
+void powerNoteHostActivity() {
+    last_host_ms = millis();
+}
+
+void pmLockAcquire(PmLockId id) {
+    if (id >= PM_LOCK_COUNT) {
+        return;
+    }
+#if CONFIG_PM_ENABLE
+    if (handles[id] != NULL) {
+        esp_pm_lock_acquire(handles[id]);
+    }
+#endif
+    uint32_t now_us = micros();
+    portENTER_CRITICAL(&power_mux);
+    PmLockState& lock = locks[id];
+    if (lock.depth++ == 0) {
+        lock.since_us = now_us;
+    }
+    lock.acquires++;
+    if (raisesCpu(id) && full_speed_depth++ == 0) {
+        full_speed_since_us = now_us;
+    }
+    portEXIT_CRITICAL(&power_mux);
+}
+
+void pmLockRelease(PmLockId id) {
+    if (id >= PM_LOCK_COUNT) {
+        return;
+    }
+    uint32_t now_us = micros();
+    portENTER_CRITICAL(&power_mux);
+    PmLockState& lock = locks[id];
+    bool held = lock.depth > 0;
+    if (held && --lock.depth == 0) {
+        lock.held_us += now_us - lock.since_us;
+    }
+    if (held && raisesCpu(id) && full_speed_depth > 0 && --full_speed_depth == 0) {
+        full_speed_us += now_us - full_speed_since_us;
+    }
+    portEXIT_CRITICAL(&power_mux);
+#if CONFIG_PM_ENABLE
+    if (held && handles[id] != NULL) {
+        esp_pm_lock_release(handles[id]);
+    }
+#endif
+}
+
+void takePowerStats(PowerStats* out) {
+    if (out == NULL) {
+        return;
+    }
+    uint32_t now_us = micros();
+
+    portENTER_CRITICAL(&power_mux);
+    for (int i = 0; i < PM_LOCK_COUNT; i++) {
+        PmLockState& lock = locks[i];
+        uint32_t held = lock.held_us;
+        if (lock.depth > 0) {
+            held += now_us - lock.since_us;   // Still held: count up to now
+            lock.since_us = now_us;
+        }
+        out->held_us[i] = held;
+        out->acquires[i] = lock.acquires;
+        lock.held_us = 0;
+        lock.acquires = 0;
+    }
+    out->full_speed_us = full_speed_us;
+    if (full_speed_depth > 0) {
+        out->full_speed_us += now_us - full_speed_since_us;
+        full_speed_since_us = now_us;
+    }
+    full_speed_us = 0;
+    out->window_us = now_us - window_start_us;
+    window_start_us = now_us;
+    portEXIT_CRITICAL(&power_mux);
+
+#if CONFIG_PM_ENABLE
+    out->pm_available = true;
+#else
+    out->pm_available = false;
+#endif
+    out->mode = applied_mode;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file power_manager.h
+ * @brief ESP-IDF power management: DFS, light sleep and PM locks
+ *
+ * With PARAM POWER_MODE 1 or 2 the CPU runs at PM_MIN_FREQ_MHZ unless a
+ * task holds a lock for a timing-critical window:
+ * - PM_LOCK_CONTROL  pressure loop and supervisory tick bodies (CPU max)
+ * - PM_LOCK_ADC      multiplexer/ADC conversions, taken by lockMux() (CPU max)
+ * - PM_LOCK_SWEEP    TOF frame reception and sample timestamping (CPU max)
+ * - PM_LOCK_IO       no light sleep while LEDC or sensor UARTs must run:
+ *                    sweep enabled, a motor driven, or recent host commands
+ *
+ * Every lock also keeps held-time statistics (DIAG:POWER), so the duty
+ * of each window can be compared with the LOOP_TIMING jitter across
+ * power modes. Without CONFIG_PM_ENABLE in the core only the statistics
+ * run and the CPU stays at its boot frequency.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Power management locks
+ */
+enum PmLockId : uint8_t {
+    PM_LOCK_CONTROL = 0,
+    PM_LOCK_ADC,
+    PM_LOCK_SWEEP,
+    PM_LOCK_IO,
+    PM_LOCK_COUNT
+};
+
+/**
+ * @brief Lock statistics since the last takePowerStats()
+ */
+struct PowerStats {
+    bool pm_available;                       // Core built with CONFIG_PM_ENABLE
+    uint8_t mode;                            // Applied PowerMode
+    uint32_t window_us;                      // Length of the window
+    uint32_t full_speed_us;                  // Time any CPU-max lock was held
+    uint32_t held_us[PM_LOCK_COUNT];         // Time each lock was held
+    uint32_t acquires[PM_LOCK_COUNT];        // Acquisitions of each lock
+};
+
+/**
+ * @brief Create the locks and apply the boot power mode
+ *
+ * Call in setup() before any task or lockMux() window starts.
+ */
+void initPowerManagement(uint8_t mode);
+
+/**
+ * @brief Supervisory loop tick: apply POWER_MODE changes, update PM_LOCK_IO
+ * @param mode PARAM POWER_MODE
+ * @param outputs_active true while the sweep runs or any motor is driven
+ */
+void powerTick(uint8_t mode, bool outputs_active);
+
+/**
+ * @brief Record host traffic (keeps PM_LOCK_IO for PM_HOST_IDLE_MS)
+ */
+void powerNoteHostActivity();
+
+/**
+ * @brief Enter a timing-critical window (nestable, any task)
+ */
+void pmLockAcquire(PmLockId id);
+
+/**
+ * @brief Leave a window entered with pmLockAcquire()
+ */
+void pmLockRelease(PmLockId id);
+
+/**
+ * @brief Copy and clear the lock statistics window
+ */
+void takePowerStats(PowerStats* out);
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,88 @@
+/**
+ * @file spsc_queue.h
+ * @brief Wait-free single-producer/single-consumer ring buffer
+ *
+ * One task pushes, one task pops, and neither ever blocks or takes a lock,
+ * so it is safe between tasks on different cores at any priority. The
+ * producer owns head_, the consumer owns tail_; each only reads the
+ * other's index. A barrier orders the slot write before publishing head_
+ * (and the slot read before releasing it via tail_), the same pattern as
+ * the seqlocks in param_registry.cpp and pressure_loop.cpp.
+ *
+ * A full queue rejects the new element and counts it (push() returns
+ * false), so the consumer sees every accepted element exactly once and in
+ * order, and knows how many were lost.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Fixed-capacity SPSC queue
+ * @tparam T Element type (copied by value)
+ * @tparam N Slots, a power of two; N - 1 elements fit at once
+ */
+template <typename T, uint32_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    SpscQueue() : head_(0), tail_(0), overflows_(0) {}
+
+    /**
+     * @brief Append an element (producer only)
+     * @return false if the queue was full (element dropped and counted)
+     */
+    bool push(const T& item) {
+        uint32_t head = head_;
+        uint32_t next = (head + 1) & (N - 1);
+        if (next == tail_) {
+            overflows_ = overflows_ + 1;
+            return false;
+        }
+        slots_[head] = item;
+        __sync_synchronize();
+        head_ = next;
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element (consumer only)
+     * @return false if the queue was empty
+     */
+    bool pop(T* item) {
+        uint32_t tail = tail_;
+        if (tail == head_) {
+            return false;
+        }
+        __sync_synchronize();
+        *item = slots_[tail];
+        __sync_synchronize();
+        tail_ = (tail + 1) & (N - 1);
+        return true;
+    }
+
+    /**
+     * @brief Elements waiting (approximate while the other side runs)
+     */
+    uint32_t size() const {
+        return (head_ - tail_) & (N - 1);
+    }
+
+    /**
+     * @brief Total elements rejected because the queue was full
+     */
+    uint32_t overflows() const {
+        return overflows_;
+    }
+
+private:
+    T slots_[N];
+    volatile uint32_t head_;         // Next slot to write (producer)
+    volatile uint32_t tail_;         // Next slot to read (consumer)
+    volatile uint32_t overflows_;    // Written by the producer only
+};
+
+#endif // SPSC_QUEUE_H
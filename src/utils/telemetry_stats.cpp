@@ -0,0 +1,141 @@
+/**
+ * @file telemetry_stats.cpp
+ * @brief Implementation of the per-channel streaming statistics
+ */
+
+#include "telemetry_stats.h"
+#include <freertos/FreeRTOS.h>
+#include <math.h>
+
+// ============================================================================
+// Histogram Layout
+// ============================================================================
+
+struct StatsBucketLayout {
+    float min;
+    float width;
+};
+
+// Indexed by StatsKind
+static const StatsBucketLayout BUCKETS[STATS_KIND_COUNT] = {
+    {0.0f,    12.5f},            // Pad: 0-100 %
+    {-100.0f, 25.0f},            // Duty: -100 to 100 %
+    {-20.0f,  5.0f},             // Error: -20 to 20 % (open-ended edges)
+    {0.0f,    50.0f},            // Distance: 0-400 cm
+};
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct ChannelWindow {
+    uint32_t count;
+    float mean;
+    float m2;                    // Sum of squared deviations (Welford)
+    float min;
+    float max;
+    uint32_t histogram[STATS_BUCKETS];
+};
+
+static ChannelWindow windows[STATS_KIND_COUNT][NUM_MOTORS];
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static inline int bucketIndex(StatsKind kind, float value) {
+    int index = (int)floorf((value - BUCKETS[kind].min) / BUCKETS[kind].width);
+    if (index < 0) return 0;
+    if (index >= STATS_BUCKETS) return STATS_BUCKETS - 1;
+    return index;
+}
+
+/**
+ * @brief 95th percentile by linear interpolation inside the histogram
+ *
+ * The open-ended edge buckets are bounded by the observed min/max.
+ */
+static float histogramP95(StatsKind kind, const ChannelWindow& w) {
+    if (w.count == 0) {
+        return 0.0f;
+    }
+    float target = 0.95f * (float)w.count;
+    float cumulative = 0.0f;
+    for (int i = 0; i < STATS_BUCKETS; ++i) {
+        float in_bucket = (float)w.histogram[i];
+        if (in_bucket > 0.0f && cumulative + in_bucket >= target) {
+            float low = BUCKETS[kind].min + i * BUCKETS[kind].width;
+            float high = low + BUCKETS[kind].width;
+            if (i == 0 || low < w.min) low = w.min;
+            if (i == STATS_BUCKETS - 1 || high > w.max) high = w.max;
+            return low + (high - low) * ((target - cumulative) / in_bucket);
+        }
+        cumulative += in_bucket;
+    }
+    return w.max;
+}
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+void statsRecord(StatsKind kind, const float values[NUM_MOTORS], const bool valid[NUM_MOTORS]) {
+    if (kind >= STATS_KIND_COUNT) {
+        return;
+    }
+
+    portENTER_CRITICAL(&stats_mux);
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        if (valid != NULL && !valid[i]) {
+            continue;
+        }
+        float value = values[i];
+        ChannelWindow& w = windows[kind][i];
+        if (w.count == 0) {
+            w.min = value;
+            w.max = value;
+        } else {
+            if (value < w.min) w.min = value;
+            if (value > w.max) w.max = value;
+        }
+        w.count++;
+        float delta = value - w.mean;
+        w.mean += delta / (float)w.count;
+        w.m2 += delta * (value - w.mean);
+        w.histogram[bucketIndex(kind, value)]++;
+    }
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void takeStatsWindow(StatsKind kind, ChannelStatsSnapshot out[NUM_MOTORS]) {
+    if (kind >= STATS_KIND_COUNT || out == NULL) {
+        return;
+    }
+
+    // Copy under the lock, derive the outputs after releasing it
+    ChannelWindow copy[NUM_MOTORS];
+    portENTER_CRITICAL(&stats_mux);
+    memcpy(copy, windows[kind], sizeof(copy));
+    memset(windows[kind], 0, sizeof(copy));
+    portEXIT_CRITICAL(&stats_mux);
+
+    for (int i = 0; i < NUM_MOTORS; ++i) {
+        const ChannelWindow& w = copy[i];
+        out[i].count = w.count;
+        out[i].mean = w.mean;
+        out[i].stddev = (w.count > 1) ? sqrtf(w.m2 / (float)(w.count - 1)) : 0.0f;
+        out[i].min = w.min;
+        out[i].max = w.max;
+        out[i].p95 = histogramP95(kind, w);
+        memcpy(out[i].histogram, w.histogram, sizeof(w.histogram));
+    }
+}
+
+void getStatsBuckets(StatsKind kind, float* bucket_min, float* bucket_width) {
+    if (kind >= STATS_KIND_COUNT) {
+        return;
+    }
+    if (bucket_min) *bucket_min = BUCKETS[kind].min;
+    if (bucket_width) *bucket_width = BUCKETS[kind].width;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file telemetry_stats.h
+ * @brief Per-channel streaming statistics for telemetry summaries
+ *
+ * On long runs the per-sample DataPacket stream is mostly discarded by the
+ * operator. This stage aggregates every sample at the source rate instead:
+ * - Pad pressure, duty and setpoint error per motor (pressure loop rate)
+ * - Sector distance per motor (supervisory loop rate)
+ *
+ * Each channel keeps count, min, max, running mean/variance (Welford) and
+ * a STATS_BUCKETS fixed-bucket histogram over the current window. The
+ * telemetry task takes and clears the window every STATS_PERIOD_MS and
+ * sends one FRAME_STATS_SUMMARY per kind. The histogram keeps the tails
+ * visible: p95 is interpolated from it on the device.
+ *
+ * PARAM TELEMETRY_MODE selects raw DataPackets, summaries, or both.
+ */
+
+#ifndef TELEMETRY_STATS_H
+#define TELEMETRY_STATS_H
+
+#include <Arduino.h>
+#include "../config/pins.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr int STATS_BUCKETS = 8;     // Histogram buckets per channel
+
+// ============================================================================
+// Types
+// ============================================================================
+
+/**
+ * @brief Channel kinds (one summary frame each, one channel per motor)
+ */
+enum StatsKind : uint8_t {
+    STATS_PAD_PCT = 0,           // Normalized pressure (%)
+    STATS_DUTY,                  // Motor duty (%, negative = reverse)
+    STATS_ERROR,                 // Setpoint - pressure (%), PI motors only
+    STATS_DISTANCE,              // Sector minimum distance (cm), valid readings only
+    STATS_KIND_COUNT
+};
+
+/**
+ * @brief Statistics of one channel over the last window
+ */
+struct ChannelStatsSnapshot {
+    uint32_t count;
+    float mean;
+    float stddev;
+    float min;
+    float max;
+    float p95;                   // Interpolated from the histogram
+    uint32_t histogram[STATS_BUCKETS];
+};
+
+// ============================================================================
+// Public Functions
+// ============================================================================
+
+/**
+ * @brief Add one sample per motor to a kind
+ * @param kind Channel kind
+ * @param values One value per motor
+ * @param valid Per-motor flag, skipped samples are not counted (may be NULL)
+ */
+void statsRecord(StatsKind kind, const float values[NUM_MOTORS], const bool valid[NUM_MOTORS]);
+
+/**
+ * @brief Copy and clear the window of a kind
+ * @param kind Channel kind
+ * @param out Output, one snapshot per motor
+ */
+void takeStatsWindow(StatsKind kind, ChannelStatsSnapshot out[NUM_MOTORS]);
+
+/**
+ * @brief Histogram layout of a kind
+ *
+ * Bucket i covers [min + i*width, min + (i+1)*width); the first and last
+ * buckets also take values below and above the range.
+ */
+void getStatsBuckets(StatsKind kind, float* bucket_min, float* bucket_width);
+
+#endif // TELEMETRY_STATS_H
@@ -0,0 +1,23 @@
+/**
+ * @file tlog.cpp
+ * @brief FRAME_LOG transmission for tokenized logging
+ */
+
+#include "tlog.h"
+#include "binary_protocol.h"
+#include <stddef.h>
+
+static_assert(sizeof(LogPayload::args) == TLOG_MAX_ARGS_BYTES, "LogPayload args must match TLOG_MAX_ARGS_BYTES");
+
+void tlogSend(uint32_t token, const uint8_t* args, size_t length) {
+    LogPayload payload;
+    payload.timestamp_ms = millis();
+    payload.token = token;
+    if (length > sizeof(payload.args)) {
+        length = sizeof(payload.args);
+    }
+    memcpy(payload.args, args, length);
+
+    // Only the used part of args goes on the wire
+    sendFrame(FRAME_LOG, &payload, (uint16_t)(offsetof(LogPayload, args) + length));
+}
@@ -0,0 +1,150 @@
+/**
+ * @file tlog.h
+ * @brief Tokenized logging: format-string IDs plus packed binary arguments
+ *
+ * TLOG("Pressure M%d=%.1f", i + 1, pct) does not store or send the format
+ * string. With PROTOCOL_BINARY the string is hashed at compile time (32-bit
+ * FNV-1a) and only the token and the packed arguments go out in a
+ * FRAME_LOG frame. Without PROTOCOL_BINARY it prints the text as before
+ * (Serial.printf with a trailing newline), so debug builds stay readable.
+ *
+ * Argument encoding (in order, no type tags, the host reads the format):
+ * - Integers (any width, signed or unsigned, bool, char): zigzag varint
+ * - float / double: float32 little-endian
+ * - const char* / String: u8 length + bytes (max TLOG_MAX_STRING)
+ *
+ * The token database is generated at build time by scripts/tlog_db.py,
+ * which scans every TLOG("...") call in src/. Detokenize on the host with
+ * frontend/dev/detokenize.ts (the bridge does it automatically).
+ *
+ * Rules for call sites:
+ * - The format must be a single string literal (the build script reads it)
+ * - Pass integers to %d/%u/%x/%c and floating point to %f/%e/%g
+ */
+
+#ifndef TLOG_H
+#define TLOG_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "../config/system_config.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+constexpr size_t TLOG_MAX_ARGS_BYTES = 64;     // Packed arguments per message
+constexpr size_t TLOG_MAX_STRING = 32;         // Bytes kept per string argument
+
+// ============================================================================
+// Token Hash
+// ============================================================================
+
+/**
+ * @brief 32-bit FNV-1a over the bytes of a string (compile time)
+ *
+ * Must match tlog_db.py and detokenize.ts.
+ */
+constexpr uint32_t tlogHash(const char* s, uint32_t hash = 2166136261u) {
+    return *s ? tlogHash(s + 1, (hash ^ (uint8_t)*s) * 16777619u) : hash;
+}
+
+// ============================================================================
+// Argument Encoder
+// ============================================================================
+
+/**
+ * @brief Fixed-size buffer for one message's arguments
+ *
+ * Arguments that do not fit are dropped (the host shows them as missing).
+ */
+class TlogEncoder {
+public:
+    TlogEncoder() : length_(0) {}
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value>::type put(T value) {
+        int64_t wide = (int64_t)value;
+        putVarint(((uint64_t)wide << 1) ^ (uint64_t)(wide >> 63));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type put(T value) {
+        float f = (float)value;
+        putBytes(&f, sizeof(f));
+    }
+
+    void put(const char* s) {
+        size_t len = (s != NULL) ? strnlen(s, TLOG_MAX_STRING) : 0;
+        if (length_ + 1 + len > TLOG_MAX_ARGS_BYTES) {
+            return;
+        }
+        buffer_[length_++] = (uint8_t)len;
+        putBytes(s, len);
+    }
+
+    void put(const String& s) { put(s.c_str()); }
+
+    const uint8_t* data() const { return buffer_; }
+    size_t length() const { return length_; }
+
+private:
+    void putVarint(uint64_t value) {
+        uint8_t bytes[10];
+        size_t n = 0;
+        do {
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            bytes[n++] = byte | (value ? 0x80 : 0);
+        } while (value);
+        putBytes(bytes, n);
+    }
+
+    void putBytes(const void* bytes, size_t n) {
+        if (length_ + n > TLOG_MAX_ARGS_BYTES) {
+            length_ = TLOG_MAX_ARGS_BYTES;   // Nothing after a dropped argument
+            return;
+        }
+        memcpy(buffer_ + length_, bytes, n);
+        length_ += n;
+    }
+
+    uint8_t buffer_[TLOG_MAX_ARGS_BYTES];
+    size_t length_;
+};
+
+inline void tlogPack(TlogEncoder&) {}
+
+template <typename T, typename... Rest>
+inline void tlogPack(TlogEncoder& encoder, const T& value, const Rest&... rest) {
+    encoder.put(value);
+    tlogPack(encoder, rest...);
+}
+
+/**
+ * @brief Send one tokenized message (FRAME_LOG)
+ * @param token tlogHash() of the format string
+ * @param args Packed arguments
+ * @param length Bytes in args
+ */
+void tlogSend(uint32_t token, const uint8_t* args, size_t length);
+
+template <typename... Args>
+inline void tlogEmit(uint32_t token, const Args&... args) {
+    TlogEncoder encoder;
+    tlogPack(encoder, args...);
+    tlogSend(token, encoder.data(), encoder.length());
+}
+
+// ============================================================================
+// Logging Macro
+// ============================================================================
+
+#ifdef PROTOCOL_BINARY
+#define TLOG(fmt, ...) \
+    tlogEmit(std::integral_constant<uint32_t, tlogHash(fmt)>::value, ##__VA_ARGS__)
+#else
+#define TLOG(fmt, ...) Serial.printf(fmt "\n", ##__VA_ARGS__)
+#endif
+
+#endif // TLOG_H